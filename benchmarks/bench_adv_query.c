@@ -0,0 +1,196 @@
+/*
+ * bench_adv_query.c
+ *
+ * measures ADV QUERY pipelines over a generated table: the previous engine,
+ * which flattened every record into an array and made one full pass per
+ * stage over a keep mask, against adv_query_select, which filters batches
+ * of view positions through all stages, cheapest first. both are run in
+ * row and column layout and their match counts are compared.
+ *
+ * usage: ./build/bench_adv_query [repeats] [records]
+ */
+
+#include "adv_query.h"
+#include "table_view.h"
+#include "bench_utils.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_RECORDS 100000
+
+// substring check ignoring case, as the previous engine did it
+static int contains_ignoring_case(const char *text, const char *pattern) {
+  size_t length = strlen(pattern);
+  for (const char *p = text; *p; p++) {
+    size_t i = 0;
+    while (p[i] &&
+           tolower((unsigned char)p[i]) == tolower((unsigned char)pattern[i])) {
+      if (++i == length) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+typedef struct {
+  const char *pipeline;
+  const char *name;      // name pattern, or NULL
+  const char *programme; // programme pattern, or NULL
+  char op;               // mark operator, or 0
+  double value;
+} BenchQuery;
+
+// the previous engine: flatten, then one keep-mask pass per stage in the
+// order written
+static size_t keep_mask_query(const StudentTable *table,
+                              const BenchQuery *query) {
+  size_t count = table->record_count;
+  size_t *positions = malloc(count * sizeof *positions);
+  unsigned char *keep = malloc(count);
+  if (!positions || !keep) {
+    free(positions);
+    free(keep);
+    return 0;
+  }
+  size_t cursor = 0;
+  size_t p;
+  size_t n = 0;
+  while ((p = table_view_next(table, &cursor)) != TABLE_VIEW_NOT_FOUND) {
+    positions[n++] = p;
+  }
+  memset(keep, 1, count);
+
+  if (query->programme) {
+    unsigned char *verdict = malloc(table->programmes.count + 1);
+    for (uint32_t code = 0; verdict && code < table->programmes.count;
+         code++) {
+      verdict[code] = (unsigned char)contains_ignoring_case(
+          dictionary_get(&table->programmes, code), query->programme);
+    }
+    for (size_t i = 0; verdict && i < n; i++) {
+      if (keep[i] && !verdict[table->prog_codes[positions[i]]]) {
+        keep[i] = 0;
+      }
+    }
+    free(verdict);
+  }
+  if (query->name) {
+    for (size_t i = 0; i < n; i++) {
+      if (keep[i] && !contains_ignoring_case(
+                         table_record_name(table, positions[i]), query->name)) {
+        keep[i] = 0;
+      }
+    }
+  }
+  if (query->op) {
+    for (size_t i = 0; i < n; i++) {
+      float mark = table_record_mark(table, positions[i]);
+      int match = query->op == '<'   ? mark < query->value
+                  : query->op == '>' ? mark > query->value
+                                     : mark == query->value;
+      if (keep[i] && !match) {
+        keep[i] = 0;
+      }
+    }
+  }
+
+  size_t matches = 0;
+  for (size_t i = 0; i < n; i++) {
+    matches += keep[i];
+  }
+  free(positions);
+  free(keep);
+  return matches;
+}
+
+static StudentDatabase *build_database(size_t count) {
+  StudentDatabase *db = db_init();
+  StudentTable *table = table_init("StudentRecords");
+  if (!db || !table || db_add_table(db, table) != DB_SUCCESS) {
+    table_free(table);
+    db_free(db);
+    return NULL;
+  }
+  db->is_loaded = true;
+
+  static const char *programmes[] = {"Computer Science", "Data Science",
+                                     "Software Engineering", "Mathematics",
+                                     "Physics", "Chemistry"};
+  static const char *surnames[] = {"Chen", "Tan", "Lim", "Wong", "Ng", "Lee"};
+  for (size_t i = 0; i < count; i++) {
+    StudentRecord record = {.id = (int)(2500000 + i),
+                            .mark = (float)((i * 7919) % 10001) / 100.0f};
+    snprintf(record.name, sizeof record.name, "Student%zu %s", i,
+             surnames[(i / 7) % 6]);
+    snprintf(record.prog, sizeof record.prog, "%s", programmes[i % 6]);
+    table_add_record(table, &record);
+  }
+  return db;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (records < 1 || records > 100000) {
+    records = DEFAULT_RECORDS;
+  }
+
+  StudentDatabase *db = build_database(records);
+  if (!db) {
+    printf("cannot build database\n");
+    return 1;
+  }
+  StudentTable *table = db->tables[0];
+
+  static const BenchQuery queries[] = {
+      {"MARK > 90", NULL, NULL, '>', 90.0},
+      {"GREP NAME = wong", "wong", NULL, 0, 0.0},
+      {"GREP NAME = wong | MARK > 90", "wong", NULL, '>', 90.0},
+      {"GREP NAME = 12 | GREP PROGRAMME = science | MARK < 10", "12",
+       "science", '<', 10.0},
+  };
+
+  printf("ADV QUERY benchmark, %zu records, best of %d\n", records, repeats);
+  printf("%-55s  %7s  %11s  %11s  %8s  %9s\n", "pipeline", "layout",
+         "keep_mask_s", "batched_s", "speedup", "matches");
+
+  static const TableLayout layouts[] = {TABLE_LAYOUT_ROWS,
+                                        TABLE_LAYOUT_COLUMNS};
+  static const char *layout_names[] = {"rows", "columns"};
+  for (size_t l = 0; l < 2; l++) {
+    table_set_layout(table, layouts[l]);
+    for (size_t q = 0; q < sizeof queries / sizeof queries[0]; q++) {
+      double baseline = 0.0;
+      double batched = 0.0;
+      size_t expected = 0;
+      size_t found = 0;
+      for (int r = 0; r < repeats; r++) {
+        double start = now_seconds();
+        expected = keep_mask_query(table, &queries[q]);
+        double elapsed = now_seconds() - start;
+        baseline = (r == 0 || elapsed < baseline) ? elapsed : baseline;
+
+        AdvQueryResult result;
+        start = now_seconds();
+        adv_query_select(db, queries[q].pipeline, &result);
+        elapsed = now_seconds() - start;
+        batched = (r == 0 || elapsed < batched) ? elapsed : batched;
+        found = result.count;
+        adv_query_result_free(&result);
+      }
+      printf("%-55s  %7s  %11.6f  %11.6f  %7.1fx  %9zu%s\n",
+             queries[q].pipeline, layout_names[l], baseline, batched,
+             baseline / batched, found, found == expected ? "" : "  MISMATCH");
+    }
+  }
+
+  db_free(db);
+  return 0;
+}
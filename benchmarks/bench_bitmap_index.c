@@ -0,0 +1,108 @@
+/*
+ * bench_bitmap_index.c
+ *
+ * measures programme and mark pipelines through adv_query_select on a
+ * generated table with and without the filter bitmaps, and adv_query_count
+ * with them, and reports what the bitmaps cost: build time and bytes.
+ * match counts from every path are compared.
+ *
+ * usage: ./build/bench_bitmap_index [repeats] [records] [rows|columns]
+ */
+
+#include "adv_query.h"
+#include "database.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_RECORDS 1000000
+
+// best time of repeats runs of a pipeline, and its match count
+static double time_select(StudentDatabase *db, const char *pipeline,
+                          int repeats, size_t *matches) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    AdvQueryResult result;
+    double start = now_seconds();
+    adv_query_select(db, pipeline, &result);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+    *matches = result.count;
+    adv_query_result_free(&result);
+  }
+  return best;
+}
+
+// best time of repeats counts of a pipeline, and the count
+static double time_count(StudentDatabase *db, const char *pipeline,
+                         int repeats, size_t *matches) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    double start = now_seconds();
+    adv_query_count(db, pipeline, matches);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  TableLayout layout = argc > 3 && strcmp(argv[3], "columns") == 0
+                           ? TABLE_LAYOUT_COLUMNS
+                           : TABLE_LAYOUT_ROWS;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (records < 1 || records > 10000000) {
+    records = DEFAULT_RECORDS;
+  }
+
+  StudentDatabase *db = create_bench_database(records, layout);
+  if (!db) {
+    printf("cannot build database\n");
+    return 1;
+  }
+  StudentTable *table = db->tables[0];
+
+  double start = now_seconds();
+  if (table_set_filter_index(table, true) != DB_SUCCESS) {
+    printf("cannot build the bitmaps\n");
+    db_free(db);
+    return 1;
+  }
+  double build = now_seconds() - start;
+  size_t bytes = bitmap_index_memory(table->filter_bitmaps);
+  printf("Filter bitmaps, %zu records (%s): built in %.3f s, %.1f MiB (%.2f "
+         "bytes per record)\n",
+         records, layout == TABLE_LAYOUT_COLUMNS ? "columns" : "rows", build,
+         (double)bytes / (1024.0 * 1024.0), (double)bytes / (double)records);
+
+  static const char *pipelines[] = {
+      "GREP PROGRAMME = computer science | MARK > 90",
+      "GREP PROGRAMME = science | MARK > 70", "MARK > 97.5", "MARK = 42",
+      "GREP PROGRAMME = physics", "MARK > 50"};
+  printf("best of %d\n", repeats);
+  printf("%-46s  %10s  %10s  %8s  %10s  %8s  %9s\n", "pipeline", "scan_s",
+         "bitmap_s", "speedup", "count_s", "speedup", "matches");
+  for (size_t q = 0; q < sizeof pipelines / sizeof pipelines[0]; q++) {
+    size_t scanned = 0;
+    size_t selected = 0;
+    size_t counted = 0;
+    table_set_filter_index(table, false);
+    double scan = time_select(db, pipelines[q], repeats, &scanned);
+    table_set_filter_index(table, true);
+    double bitmap = time_select(db, pipelines[q], repeats, &selected);
+    double count = time_count(db, pipelines[q], repeats, &counted);
+    printf("%-46s  %10.6f  %10.6f  %7.1fx  %10.6f  %7.1fx  %9zu%s\n",
+           pipelines[q], scan, bitmap, scan / bitmap, count, scan / count,
+           selected,
+           selected == scanned && counted == scanned ? "" : "  MISMATCH");
+  }
+
+  db_free(db);
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * bench_checksum.c
+ *
+ * measures checksum throughput. a scratch file of the given size is
+ * checksummed with the previous fgetc and byte-at-a-time loop and with
+ * compute_file_checksum (64 KiB reads into the slicing-by-8 kernel). the
+ * same bytes in memory are run through the byte-at-a-time table,
+ * crc32_update and compute_fast_hash. finally a full database checksum of
+ * 100000 records is timed in each checksum mode. files are read straight
+ * after being written, so they come from the page cache.
+ *
+ * usage: ./build/bench_checksum [megabytes] [scratch_file]
+ */
+
+#include "checksum.h"
+#include "database.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_MEGABYTES 256
+#define DEFAULT_SCRATCH_FILE "build/bench_checksum.bin"
+#define RECORD_COUNT 100000
+
+// byte-at-a-time table, as crc32 was computed before slicing-by-8
+static unsigned long bytewise_table[256];
+
+static void init_bytewise_table(void) {
+  for (unsigned long i = 0; i < 256; i++) {
+    unsigned long crc = i;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    bytewise_table[i] = crc;
+  }
+}
+
+static unsigned long bytewise_crc32(const unsigned char *data, size_t length) {
+  unsigned long crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc = (crc >> 8) ^ bytewise_table[(crc ^ data[i]) & 0xFF];
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
+// the previous compute_file_checksum: one fgetc per byte
+static unsigned long bytewise_file_crc32(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    return 0;
+  }
+  unsigned long crc = 0xFFFFFFFF;
+  int byte;
+  while ((byte = fgetc(fp)) != EOF) {
+    crc = (crc >> 8) ^ bytewise_table[(crc ^ (unsigned char)byte) & 0xFF];
+  }
+  fclose(fp);
+  return crc ^ 0xFFFFFFFF;
+}
+
+static void report(const char *name, size_t bytes, double seconds,
+                   unsigned long value) {
+  printf("%-28s  %10.4f  %8.2f  0x%08lX\n", name, seconds,
+         (double)bytes / seconds / 1e9, value);
+}
+
+int main(int argc, char *argv[]) {
+  size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : DEFAULT_MEGABYTES;
+  const char *path = argc > 2 ? argv[2] : DEFAULT_SCRATCH_FILE;
+  size_t size = megabytes * 1024 * 1024;
+  if (size == 0) {
+    printf("size must be at least 1 MB\n");
+    return 1;
+  }
+
+  unsigned char *data = malloc(size);
+  if (!data) {
+    printf("cannot allocate %zu MB\n", megabytes);
+    return 1;
+  }
+  // printable pseudo-random bytes, like a database file
+  unsigned long seed = 12345;
+  for (size_t i = 0; i < size; i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = (unsigned char)(' ' + (seed >> 16) % 95);
+  }
+
+  FILE *fp = fopen(path, "wb");
+  if (!fp || fwrite(data, 1, size, fp) != size) {
+    printf("cannot write %s\n", path);
+    free(data);
+    return 1;
+  }
+  fclose(fp);
+  init_bytewise_table();
+
+  printf("Checksum benchmark, %zu MB\n", megabytes);
+  printf("%-28s  %10s  %8s  %10s\n", "method", "seconds", "GB/s", "value");
+
+  double start = now_seconds();
+  unsigned long value = bytewise_file_crc32(path);
+  report("file, fgetc bytewise", size, now_seconds() - start, value);
+
+  start = now_seconds();
+  value = compute_file_checksum(path);
+  report("file, compute_file_checksum", size, now_seconds() - start, value);
+
+  start = now_seconds();
+  value = bytewise_crc32(data, size);
+  report("memory, bytewise table", size, now_seconds() - start, value);
+
+  start = now_seconds();
+  value = crc32_update(0, data, size);
+  report("memory, crc32_update", size, now_seconds() - start, value);
+
+  start = now_seconds();
+  value = compute_fast_hash(data, size);
+  report("memory, compute_fast_hash", size, now_seconds() - start, value);
+
+  free(data);
+  remove(path);
+
+  // full database checksum in each mode
+  StudentDatabase *db = db_init();
+  StudentTable *table = table_init("StudentRecords");
+  if (!db || !table || db_add_table(db, table) != DB_SUCCESS) {
+    printf("cannot create database\n");
+    return 1;
+  }
+  db->is_loaded = true;
+  for (int i = 0; i < RECORD_COUNT; i++) {
+    StudentRecord record = {.id = 2500000 + i, .mark = (float)(i % 101)};
+    snprintf(record.name, sizeof record.name, "Student %d", i);
+    snprintf(record.prog, sizeof record.prog, "Programme %d", i % 12);
+    table_add_record(table, &record);
+  }
+
+  printf("\n%-28s  %10s  %12s\n", "database checksum", "seconds",
+         "records/s");
+  static const ChecksumMode modes[] = {CHECKSUM_MODE_CRC32,
+                                       CHECKSUM_MODE_FAST};
+  static const char *mode_names[] = {"crc32", "fast"};
+  for (size_t m = 0; m < 2; m++) {
+    table_set_checksum_mode(table, modes[m]);
+    start = now_seconds();
+    value = compute_database_checksum(db);
+    double seconds = now_seconds() - start;
+    printf("%-28s  %10.4f  %12.0f\n", mode_names[m], seconds,
+           RECORD_COUNT / seconds);
+  }
+
+  db_free(db);
+  return 0;
+}
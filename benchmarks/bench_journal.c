@@ -0,0 +1,140 @@
+/*
+ * bench_journal.c
+ *
+ * measures the journal against whole-file saves. a generated database is
+ * opened with its journal, then mark updates are journaled and saved in
+ * groups, as a session of UPDATE and SAVE commands would. reported per
+ * journal length: the journal's size, the average cost of one journaled
+ * SAVE against a full db_save rewrite, and the recovery time of an OPEN
+ * (load, checksum and replay) against a load of the same file with no
+ * journal. journal lengths stay under JOURNAL_CHECKPOINT_BYTES, which is
+ * what bounds recovery in practice.
+ *
+ * usage: ./build/bench_journal [records] [entries_per_save] [scratch_file]
+ */
+
+#include "checksum.h"
+#include "database.h"
+#include "journal.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_RECORDS 10000
+#define DEFAULT_ENTRIES_PER_SAVE 100
+#define DEFAULT_SCRATCH_FILE "build/bench_journal.txt"
+
+// write a database file with count valid records
+static int write_database(const char *path, size_t count) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    return 0;
+  }
+  fprintf(fp, "Database Name: Bench\nAuthors: Bench\n\n");
+  fprintf(fp, "Table Name: StudentRecords\nID\tName\tProgramme\tMark\n");
+  for (size_t i = 0; i < count; i++) {
+    fprintf(fp, "%zu\tStudent %zu\tComputer Science\t%.2f\n", 2500000 + i,
+            i, (double)(i % 10001) / 100.0);
+  }
+  fclose(fp);
+  return 1;
+}
+
+// open a file the way OPEN does, replaying its journal
+static StudentDatabase *open_database(const char *path, size_t *replayed) {
+  StudentDatabase *db = db_init();
+  if (!db || db_load(db, path, NULL) != DB_SUCCESS) {
+    db_free(db);
+    return NULL;
+  }
+  strncpy(db->filepath, path, sizeof db->filepath - 1);
+  db->is_loaded = true;
+  db->journal = journal_open(db, path, replayed);
+  db->last_saved_checksum = compute_database_checksum(db);
+  return db;
+}
+
+int main(int argc, char *argv[]) {
+  size_t records = argc > 1 ? (size_t)atol(argv[1]) : DEFAULT_RECORDS;
+  size_t per_save =
+      argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_ENTRIES_PER_SAVE;
+  const char *path = argc > 3 ? argv[3] : DEFAULT_SCRATCH_FILE;
+  char journal_path[MAX_FILE_PATH + sizeof JOURNAL_EXTENSION];
+  snprintf(journal_path, sizeof journal_path, "%s%s", path, JOURNAL_EXTENSION);
+
+  if (records == 0 || records > 100000 || per_save == 0) {
+    printf("records must be 1..100000 and entries_per_save positive\n");
+    return 1;
+  }
+
+  printf("Journal benchmark, %zu records, %zu update(s) per save\n", records,
+         per_save);
+  printf("%10s  %12s  %12s  %12s  %12s  %12s\n", "entries", "journal_kb",
+         "save_s", "rewrite_s", "recover_s", "load_s");
+
+  static const size_t lengths[] = {1000, 5000, 10000, 25000, 50000};
+  for (size_t l = 0; l < sizeof lengths / sizeof lengths[0]; l++) {
+    size_t entries = lengths[l];
+    if (!write_database(path, records)) {
+      printf("%10zu  cannot write %s\n", entries, path);
+      return 1;
+    }
+    remove(journal_path);
+
+    StudentDatabase *db = open_database(path, NULL);
+    if (!db || !db->journal) {
+      printf("%10zu  cannot open %s\n", entries, path);
+      return 1;
+    }
+
+    // journal the updates, saving every per_save entries
+    double save = 0.0;
+    size_t saves = 0;
+    for (size_t i = 0; i < entries; i++) {
+      int id = (int)(2500000 + (i * 7919) % records);
+      float mark = (float)(i % 101);
+      db_update_record(db, id, NULL, NULL, &mark);
+      journal_log_update(db->journal, id, NULL, NULL, &mark);
+      if ((i + 1) % per_save == 0 || i + 1 == entries) {
+        double start = now_seconds();
+        journal_save(db);
+        save += now_seconds() - start;
+        saves++;
+      }
+    }
+    long journal_bytes = db->journal->committed_size;
+    unsigned long saved_checksum = compute_database_checksum(db);
+
+    // recovery: load the file and replay the whole journal
+    size_t replayed = 0;
+    double start = now_seconds();
+    StudentDatabase *recovered = open_database(path, &replayed);
+    double recover = now_seconds() - start;
+    if (!recovered || replayed != entries ||
+        compute_database_checksum(recovered) != saved_checksum) {
+      printf("%10zu  recovery did not rebuild the saved state\n", entries);
+      return 1;
+    }
+    db_free(recovered);
+
+    // the same file with the journal removed, then a whole-file save
+    remove(journal_path);
+    start = now_seconds();
+    StudentDatabase *plain = open_database(path, NULL);
+    double load = now_seconds() - start;
+    start = now_seconds();
+    db_save(plain, path);
+    double rewrite = now_seconds() - start;
+    db_free(plain);
+
+    printf("%10zu  %12.1f  %12.6f  %12.6f  %12.6f  %12.6f\n", entries,
+           (double)journal_bytes / 1024.0, save / (double)saves, rewrite,
+           recover, load);
+    db_free(db);
+  }
+
+  remove(path);
+  remove(journal_path);
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * bench_load.c
+ *
+ * measures OPEN-style loads of generated database files: the first load
+ * into a fresh database, then reloads after db_clear, which reuse the
+ * database arena. reports the arena blocks obtained from malloc by each
+ * load so the drop to zero on reload can be confirmed. the same database
+ * is then saved as a binary snapshot and reloaded from that. record ids
+ * must lie in the valid student id range, which caps a table at 100001
+ * records.
+ *
+ * usage: ./build/bench_load [reloads] [scratch_file]
+ */
+
+#include "database.h"
+#include "snapshot.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_RELOADS 5
+#define DEFAULT_SCRATCH_FILE "build/bench_load.txt"
+#define SNAPSHOT_SCRATCH_FILE "build/bench_load" SNAPSHOT_EXTENSION
+
+// write a database file with count valid records
+static int write_database(const char *path, size_t count) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    return 0;
+  }
+  static const char *programmes[] = {"Computer Science", "Data Science",
+                                     "Software Engineering", "Mathematics"};
+  fprintf(fp, "Database Name: Bench\nAuthors: Bench\n\n");
+  fprintf(fp, "Table Name: StudentRecords\nID\tName\tProgramme\tMark\n");
+  for (size_t i = 0; i < count; i++) {
+    fprintf(fp, "%zu\tStudent %zu\t%s\t%.2f\n", 2500000 + i, i,
+            programmes[i % 4], (double)(i % 10001) / 100.0);
+  }
+  fclose(fp);
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  int reloads = argc > 1 ? atoi(argv[1]) : DEFAULT_RELOADS;
+  const char *path = argc > 2 ? argv[2] : DEFAULT_SCRATCH_FILE;
+
+  printf("Load benchmark, %d reload(s) per size\n", reloads);
+  printf("%10s  %12s  %12s  %14s  %14s  %12s\n", "records", "first_s",
+         "reload_s", "first_blocks", "reload_blocks", "snapshot_s");
+
+  for (size_t n = 1000; n <= 100000; n *= 10) {
+    if (!write_database(path, n)) {
+      printf("%10zu  cannot write %s\n", n, path);
+      return 1;
+    }
+
+    StudentDatabase *db = db_init();
+    if (!db) {
+      printf("%10zu  allocation failed\n", n);
+      return 1;
+    }
+
+    double start = now_seconds();
+    db_load(db, path, NULL);
+    double first = now_seconds() - start;
+    size_t first_blocks = db->arena.stats.block_mallocs;
+
+    double reload = 0.0;
+    for (int r = 0; r < reloads; r++) {
+      db_clear(db);
+      start = now_seconds();
+      db_load(db, path, NULL);
+      reload += now_seconds() - start;
+    }
+    size_t reload_blocks = db->arena.stats.block_mallocs - first_blocks;
+
+    double snapshot = 0.0;
+    if (db_save(db, SNAPSHOT_SCRATCH_FILE) == DB_SUCCESS) {
+      for (int r = 0; r < reloads; r++) {
+        db_clear(db);
+        start = now_seconds();
+        db_load(db, SNAPSHOT_SCRATCH_FILE, NULL);
+        snapshot += now_seconds() - start;
+      }
+    }
+
+    printf("%10zu  %12.6f  %12.6f  %14zu  %14zu  %12.6f\n", n, first,
+           reloads > 0 ? reload / reloads : 0.0, first_blocks, reload_blocks,
+           reloads > 0 ? snapshot / reloads : 0.0);
+    db_free(db);
+  }
+
+  remove(path);
+  remove(SNAPSHOT_SCRATCH_FILE);
+  return 0;
+}
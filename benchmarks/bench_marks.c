@@ -0,0 +1,121 @@
+/*
+ * bench_marks.c
+ *
+ * measures the mark kernels on a column of 10^6 up to 10^8 marks at each
+ * level the processor supports: MARK selections run in batches of
+ * ADV_QUERY_BATCH_SIZE as ADV QUERY issues them, and whole-column summaries
+ * as STATISTICS issues them. throughput is reported in records per second,
+ * and every level's results are checked against the scalar level.
+ *
+ * usage: ./build/bench_marks [repeats] [max_power_of_ten]
+ */
+
+#include "adv_query.h"
+#include "mark_kernels.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_REPEATS 3
+#define DEFAULT_MAX_POWER 8
+
+// positions passing op value, selected a batch at a time
+static size_t select_column(const float *marks, size_t count, char op,
+                            double value) {
+  size_t selection[ADV_QUERY_BATCH_SIZE];
+  size_t total = 0;
+  for (size_t start = 0; start < count; start += ADV_QUERY_BATCH_SIZE) {
+    size_t length = count - start < ADV_QUERY_BATCH_SIZE
+                        ? count - start
+                        : ADV_QUERY_BATCH_SIZE;
+    total += mark_kernel_select(marks + start, length, start, op, value,
+                                selection);
+  }
+  return total;
+}
+
+typedef struct {
+  const char *label;
+  char op; // 0 for a summary
+  double value;
+} BenchKernel;
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  int max_power = argc > 2 ? atoi(argv[2]) : DEFAULT_MAX_POWER;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (max_power < 6 || max_power > 9) {
+    max_power = DEFAULT_MAX_POWER;
+  }
+
+  MarkKernelLevel widest = mark_kernels_level();
+  printf("Mark kernel benchmark, best of %d, widest level %s\n", repeats,
+         mark_kernels_level_name(widest));
+  printf("%12s  %-14s  %7s  %10s  %14s  %8s  %9s\n", "records", "kernel",
+         "level", "seconds", "records/s", "speedup", "agrees");
+
+  static const BenchKernel kernels[] = {
+      {"MARK > 50", '>', 50.0},
+      {"MARK < 10.1", '<', 10.1},
+      {"MARK = 70.5", '=', 70.5},
+      {"summary", 0, 0.0},
+  };
+
+  size_t count = 1000000;
+  for (int power = 6; power <= max_power; power++, count *= 10) {
+    float *marks = malloc(count * sizeof *marks);
+    if (!marks) {
+      printf("%12zu  cannot allocate marks\n", count);
+      break;
+    }
+    unsigned seed = 12345;
+    for (size_t i = 0; i < count; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      marks[i] = (float)((seed >> 8) % 10001) / 100.0f;
+    }
+
+    for (size_t k = 0; k < sizeof kernels / sizeof kernels[0]; k++) {
+      double scalar_time = 0.0;
+      size_t scalar_matches = 0;
+      MarkSummary scalar_summary = {0};
+      for (int level = MARK_KERNEL_SCALAR; level <= (int)widest; level++) {
+        mark_kernels_set_level((MarkKernelLevel)level);
+        double best = 0.0;
+        size_t matches = 0;
+        MarkSummary summary = {0};
+        for (int r = 0; r < repeats; r++) {
+          double start = now_seconds();
+          if (kernels[k].op) {
+            matches = select_column(marks, count, kernels[k].op,
+                                    kernels[k].value);
+          } else {
+            mark_kernel_summarise(marks, count, &summary);
+          }
+          double elapsed = now_seconds() - start;
+          best = (r == 0 || elapsed < best) ? elapsed : best;
+        }
+
+        if (level == MARK_KERNEL_SCALAR) {
+          scalar_time = best;
+          scalar_matches = matches;
+          scalar_summary = summary;
+        }
+        bool agrees = kernels[k].op
+                          ? matches == scalar_matches
+                          : summary.min_index == scalar_summary.min_index &&
+                                summary.max_index == scalar_summary.max_index;
+        printf("%12zu  %-14s  %7s  %10.6f  %14.0f  %7.1fx  %9s\n", count,
+               kernels[k].label,
+               mark_kernels_level_name((MarkKernelLevel)level), best,
+               (double)count / best, scalar_time / best,
+               agrees ? "yes" : "NO");
+      }
+    }
+    free(marks);
+  }
+
+  mark_kernels_set_level(widest);
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * bench_parallel_query.c
+ *
+ * measures adv_query_select on a generated table with 1, 2, 4, ... worker
+ * threads pulling morsels, up to the processor count or a given maximum,
+ * and reports the speedup over the calling thread alone. match counts and
+ * order from every worker count are compared with the single-threaded run.
+ *
+ * usage: ./build/bench_parallel_query [repeats] [records] [max_workers]
+ *        [rows|columns]
+ */
+
+#include "adv_query.h"
+#include "database.h"
+#include "parallel.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 3
+#define DEFAULT_RECORDS 2000000
+
+// best time of repeats runs of a pipeline, keeping the last result
+static double time_select(StudentDatabase *db, const char *pipeline,
+                          int repeats, AdvQueryResult *result) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    adv_query_result_free(result);
+    double start = now_seconds();
+    adv_query_select(db, pipeline, result);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+  return best;
+}
+
+static bool same_matches(const AdvQueryResult *a, const AdvQueryResult *b) {
+  if (a->count != b->count) {
+    return false;
+  }
+  for (size_t i = 0; i < a->count; i++) {
+    if (a->matches[i].position != b->matches[i].position) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  size_t max_workers = argc > 3 ? (size_t)atol(argv[3]) : parallel_cpu_count();
+  TableLayout layout = argc > 4 && strcmp(argv[4], "columns") == 0
+                           ? TABLE_LAYOUT_COLUMNS
+                           : TABLE_LAYOUT_ROWS;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (records < 1 || records > 20000000) {
+    records = DEFAULT_RECORDS;
+  }
+  if (max_workers < 1 || max_workers > MAX_WORKER_THREADS) {
+    max_workers = MAX_WORKER_THREADS;
+  }
+
+  StudentDatabase *db = create_bench_database(records, layout);
+  if (!db) {
+    printf("cannot build database\n");
+    return 1;
+  }
+  // every table is split into morsels, whatever its size
+  db->query_parallel_rows = 1;
+
+  static const char *pipelines[] = {
+      "MARK > 90", "GREP PROGRAMME = science | MARK BETWEEN 40 AND 60",
+      "GREP NAME = 77 | MARK > 50", "GREP NAME = 12345",
+      "GREP PROGRAMME = physics | ORDER BY MARK DESC | LIMIT 20"};
+  printf("Parallel ADV QUERY, %zu records (%s), %zu processor(s), best of "
+         "%d\n",
+         records, layout == TABLE_LAYOUT_COLUMNS ? "columns" : "rows",
+         parallel_cpu_count(), repeats);
+  printf("%-56s  %7s  %10s  %8s  %9s\n", "pipeline", "workers", "time_s",
+         "speedup", "matches");
+  for (size_t q = 0; q < sizeof pipelines / sizeof pipelines[0]; q++) {
+    AdvQueryResult serial = {0};
+    db->query_workers = 1;
+    double base = time_select(db, pipelines[q], repeats, &serial);
+    printf("%-56s  %7d  %10.4f  %7.2fx  %9zu\n", pipelines[q], 1, base, 1.0,
+           serial.count);
+    for (size_t workers = 2; workers <= max_workers; workers *= 2) {
+      AdvQueryResult parallel = {0};
+      db->query_workers = workers;
+      double elapsed = time_select(db, pipelines[q], repeats, &parallel);
+      printf("%-56s  %7zu  %10.4f  %7.2fx  %9zu%s\n", "", workers, elapsed,
+             base / elapsed, parallel.count,
+             same_matches(&serial, &parallel) ? "" : "  MISMATCH");
+      adv_query_result_free(&parallel);
+    }
+    adv_query_result_free(&serial);
+  }
+
+  db_free(db);
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * bench_query_cache.c
+ *
+ * replays a dashboard-style workload - a handful of pipelines asked over
+ * and over, with an occasional update in between - through adv_query_select
+ * with and without the query result cache, and reports the time per query,
+ * the hit rate and the bytes the cache holds. match counts from both runs
+ * are compared.
+ *
+ * usage: ./build/bench_query_cache [rounds] [records] [update_every]
+ */
+
+#include "adv_query.h"
+#include "database.h"
+#include "query_cache.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_ROUNDS 50
+#define DEFAULT_RECORDS 200000
+#define DEFAULT_UPDATE_EVERY 20
+
+static const char *pipelines[] = {
+    "GREP PROGRAMME = computer science | MARK > 90",
+    "MARK > 90 | GREP PROGRAMME = Computer Science",
+    "GREP PROGRAMME = science | MARK > 70", "MARK > 97.5",
+    "GREP NAME = student 12 | MARK < 40", "GREP PROGRAMME = physics"};
+#define PIPELINE_COUNT (sizeof pipelines / sizeof pipelines[0])
+
+// runs the workload, returning its time and adding up the matches seen
+static double run_workload(StudentDatabase *db, size_t records, int rounds,
+                           int update_every, size_t *matches) {
+  *matches = 0;
+  double start = now_seconds();
+  for (int r = 0; r < rounds; r++) {
+    if (update_every > 0 && r > 0 && r % update_every == 0) {
+      float mark = (float)(r % 100);
+      db_update_record(db, (int)(2500000 + (size_t)r % records), NULL, NULL,
+                       &mark);
+    }
+    for (size_t q = 0; q < PIPELINE_COUNT; q++) {
+      AdvQueryResult result;
+      adv_query_select(db, pipelines[q], &result);
+      *matches += result.count;
+      adv_query_result_free(&result);
+    }
+  }
+  return now_seconds() - start;
+}
+
+int main(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  int update_every = argc > 3 ? atoi(argv[3]) : DEFAULT_UPDATE_EVERY;
+  if (rounds < 1) {
+    rounds = 1;
+  }
+  if (records < 1 || records > 10000000) {
+    records = DEFAULT_RECORDS;
+  }
+
+  // both runs make the same updates, so each needs its own copy
+  StudentDatabase *plain = create_bench_database(records, TABLE_LAYOUT_ROWS);
+  StudentDatabase *cached = create_bench_database(records, TABLE_LAYOUT_ROWS);
+  if (!plain || !cached ||
+      db_set_query_cache(cached, QUERY_CACHE_DEFAULT_BYTES) != DB_SUCCESS) {
+    printf("cannot build database\n");
+    db_free(plain);
+    db_free(cached);
+    return 1;
+  }
+
+  size_t plain_matches = 0;
+  size_t cached_matches = 0;
+  double uncached = run_workload(plain, records, rounds, update_every,
+                                 &plain_matches);
+  double with_cache = run_workload(cached, records, rounds, update_every,
+                                   &cached_matches);
+  size_t queries = (size_t)rounds * PIPELINE_COUNT;
+  const QueryCache *cache = cached->query_cache;
+
+  printf("Query cache, %zu records, %zu queries, update every %d round(s)\n",
+         records, queries, update_every);
+  printf("%-10s  %12s  %10s\n", "run", "us_per_query", "total_s");
+  printf("%-10s  %12.2f  %10.4f\n", "uncached",
+         uncached * 1e6 / (double)queries, uncached);
+  printf("%-10s  %12.2f  %10.4f  (%.1fx)\n", "cached",
+         with_cache * 1e6 / (double)queries, with_cache,
+         uncached / with_cache);
+  printf("hits %zu, misses %zu, evictions %zu, %zu entries in %.1f KiB%s\n",
+         cache->hits, cache->misses, cache->evictions, cache->count,
+         (double)cache->bytes / 1024.0,
+         plain_matches == cached_matches ? "" : "  MISMATCH");
+
+  db_free(plain);
+  db_free(cached);
+  return 0;
+}
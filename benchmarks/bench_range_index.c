@@ -0,0 +1,119 @@
+/*
+ * bench_range_index.c
+ *
+ * measures MARK and ID interval pipelines through adv_query_select on a
+ * generated table, scanning every record and then searching the sorted
+ * views, and adv_query_count with the views, and reports what the views
+ * cost to build. match counts from every path are compared.
+ *
+ * usage: ./build/bench_range_index [repeats] [records] [rows|columns]
+ */
+
+#include "adv_query.h"
+#include "database.h"
+#include "table_view.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_RECORDS 1000000
+
+// best time of repeats runs of a pipeline, and its match count
+static double time_select(StudentDatabase *db, const char *pipeline,
+                          int repeats, size_t *matches) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    AdvQueryResult result;
+    double start = now_seconds();
+    adv_query_select(db, pipeline, &result);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+    *matches = result.count;
+    adv_query_result_free(&result);
+  }
+  return best;
+}
+
+// best time of repeats counts of a pipeline, and the count
+static double time_count(StudentDatabase *db, const char *pipeline,
+                         int repeats, size_t *matches) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    double start = now_seconds();
+    adv_query_count(db, pipeline, matches);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  TableLayout layout = argc > 3 && strcmp(argv[3], "columns") == 0
+                           ? TABLE_LAYOUT_COLUMNS
+                           : TABLE_LAYOUT_ROWS;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (records < 1 || records > 10000000) {
+    records = DEFAULT_RECORDS;
+  }
+
+  StudentDatabase *db = create_bench_database(records, layout);
+  if (!db) {
+    printf("cannot build database\n");
+    return 1;
+  }
+  StudentTable *table = db->tables[0];
+
+  static const char *pipelines[] = {
+      "ID = 2500777",
+      "ID BETWEEN 2500100 AND 2501099",
+      "MARK BETWEEN 42 AND 42.5",
+      "MARK >= 99.5",
+      "ID >= 2500000 | MARK BETWEEN 10 AND 11",
+      "GREP PROGRAMME = physics | MARK BETWEEN 70 AND 72",
+      "MARK BETWEEN 20 AND 40",
+      "GREP NAME = 99 | MARK BETWEEN 0 AND 40",
+      "MARK BETWEEN 10 AND 90"};
+  enum { PIPELINE_COUNT = sizeof pipelines / sizeof pipelines[0] };
+  double scan[PIPELINE_COUNT];
+  size_t scanned[PIPELINE_COUNT];
+  for (size_t q = 0; q < PIPELINE_COUNT; q++) {
+    scan[q] = time_select(db, pipelines[q], repeats, &scanned[q]);
+  }
+
+  double start = now_seconds();
+  if (table_views_build(table) != DB_SUCCESS) {
+    printf("cannot build the sorted views\n");
+    db_free(db);
+    return 1;
+  }
+  double build = now_seconds() - start;
+  size_t bytes = 3 * table->views.capacity * sizeof(uint32_t);
+  printf("Sorted views, %zu records (%s): built in %.3f s, %.1f MiB (%.2f "
+         "bytes per record)\n",
+         records, layout == TABLE_LAYOUT_COLUMNS ? "columns" : "rows", build,
+         (double)bytes / (1024.0 * 1024.0), (double)bytes / (double)records);
+
+  printf("best of %d\n", repeats);
+  printf("%-50s  %10s  %10s  %8s  %10s  %8s  %9s\n", "pipeline", "scan_s",
+         "views_s", "speedup", "count_s", "speedup", "matches");
+  for (size_t q = 0; q < PIPELINE_COUNT; q++) {
+    size_t selected = 0;
+    size_t counted = 0;
+    double views = time_select(db, pipelines[q], repeats, &selected);
+    double count = time_count(db, pipelines[q], repeats, &counted);
+    printf("%-50s  %10.6f  %10.6f  %7.1fx  %10.6f  %7.1fx  %9zu%s\n",
+           pipelines[q], scan[q], views, scan[q] / views, count,
+           scan[q] / count, selected,
+           selected == scanned[q] && counted == scanned[q] ? ""
+                                                          : "  MISMATCH");
+  }
+
+  db_free(db);
+  return 0;
+}
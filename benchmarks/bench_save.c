@@ -0,0 +1,152 @@
+/*
+ * bench_save.c
+ *
+ * measures text saves of generated tables: the previous writer, one
+ * fprintf("%d\t%s\t%s\t%.2f\n") per record followed by re-reading the file
+ * for its checksum, against db_save, which formats rows without printf on
+ * several threads and checksums them as they are written. each size is
+ * saved in stored order and in a sorted view, and the two files are
+ * compared by size and CRC32. record ids must lie in the valid student id
+ * range, which caps a table at 100001 records.
+ *
+ * usage: ./build/bench_save [repeats] [scratch_file]
+ */
+
+#include "checksum.h"
+#include "database.h"
+#include "table_view.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_SCRATCH_FILE "build/bench_save.txt"
+#define BASELINE_SCRATCH_FILE "build/bench_save_baseline.txt"
+
+// the previous text writer, checksumming the file by reading it back
+static unsigned long fprintf_save(const StudentDatabase *db,
+                                  const StudentTable *table,
+                                  const char *path) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    return 0;
+  }
+  fprintf(fp, "Database Name: %s\n", db->db_name);
+  fprintf(fp, "Authors: %s\n", db->authors);
+  fprintf(fp, "\n");
+  fprintf(fp, "Table Name: %s\n", table->table_name);
+  for (size_t i = 0; i < table->column_count; i++) {
+    fprintf(fp, "%s", table->column_headers[i]);
+    if (i + 1 < table->column_count) {
+      fputc('\t', fp);
+    }
+  }
+  fputc('\n', fp);
+  size_t cursor = 0;
+  size_t p;
+  while ((p = table_view_next(table, &cursor)) != TABLE_VIEW_NOT_FOUND) {
+    fprintf(fp, "%d\t%s\t%s\t%.2f\n", table_record_id(table, p),
+            table_record_name(table, p), table_record_prog(table, p),
+            table_record_mark(table, p));
+  }
+  fclose(fp);
+  return compute_file_checksum(path);
+}
+
+// size of a file in bytes (0 if it cannot be opened)
+static long file_size(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    return 0;
+  }
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+static StudentDatabase *build_database(size_t count) {
+  StudentDatabase *db = db_init();
+  StudentTable *table = table_init("StudentRecords");
+  char **headers = malloc(4 * sizeof *headers);
+  if (!db || !table || !headers || db_add_table(db, table) != DB_SUCCESS) {
+    free(headers);
+    table_free(table);
+    db_free(db);
+    return NULL;
+  }
+  static const char *columns[] = {"ID", "Name", "Programme", "Mark"};
+  for (size_t i = 0; i < 4; i++) {
+    headers[i] = malloc(strlen(columns[i]) + 1);
+    strcpy(headers[i], columns[i]);
+  }
+  table_set_column_headers(table, headers, 4);
+  strcpy(db->db_name, "Bench");
+  strcpy(db->authors, "Bench");
+  db->is_loaded = true;
+
+  static const char *programmes[] = {"Computer Science", "Data Science",
+                                     "Software Engineering", "Mathematics"};
+  for (size_t i = 0; i < count; i++) {
+    StudentRecord record = {.id = (int)(2500000 + i),
+                            .mark = (float)((i * 7919) % 10001) / 100.0f};
+    snprintf(record.name, sizeof record.name, "Student %zu", i);
+    snprintf(record.prog, sizeof record.prog, "%s", programmes[i % 4]);
+    table_add_record(table, &record);
+  }
+  return db;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  const char *path = argc > 2 ? argv[2] : DEFAULT_SCRATCH_FILE;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+
+  printf("Save benchmark, best of %d\n", repeats);
+  printf("%10s  %8s  %12s  %12s  %10s  %8s  %10s\n", "records", "order",
+         "fprintf_s", "db_save_s", "MB/s", "speedup", "identical");
+
+  for (size_t n = 1000; n <= 100000; n *= 10) {
+    StudentDatabase *db = build_database(n);
+    if (!db) {
+      printf("%10zu  cannot build database\n", n);
+      return 1;
+    }
+    StudentTable *table = db->tables[0];
+
+    static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_ASC};
+    static const char *view_names[] = {"stored", "mark"};
+    for (size_t v = 0; v < 2; v++) {
+      table_set_view(table, views[v]);
+      double baseline = 0.0;
+      double fast = 0.0;
+      unsigned long baseline_crc = 0;
+      for (int r = 0; r < repeats; r++) {
+        double start = now_seconds();
+        baseline_crc = fprintf_save(db, table, BASELINE_SCRATCH_FILE);
+        double elapsed = now_seconds() - start;
+        baseline = (r == 0 || elapsed < baseline) ? elapsed : baseline;
+
+        start = now_seconds();
+        db_save(db, path);
+        elapsed = now_seconds() - start;
+        fast = (r == 0 || elapsed < fast) ? elapsed : fast;
+      }
+
+      bool identical = baseline_crc == db->file_loaded_checksum &&
+                       file_size(path) == file_size(BASELINE_SCRATCH_FILE);
+      printf("%10zu  %8s  %12.6f  %12.6f  %10.1f  %7.1fx  %10s\n", n,
+             view_names[v], baseline, fast,
+             (double)file_size(path) / fast / 1e6, baseline / fast,
+             identical ? "yes" : "NO");
+    }
+    db_free(db);
+  }
+
+  remove(path);
+  remove(BASELINE_SCRATCH_FILE);
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * bench_sorting.c
+ *
+ * compares the sort engine against the previous bubble sort implementation
+ * at 10^3..10^7 records. bubble sort is quadratic, so it is only run up to
+ * BUBBLE_SORT_LIMIT records (override with the first argument). the second
+ * argument caps the largest table size.
+ *
+ * usage: ./build/bench_sorting [bubble_limit] [max_records]
+ */
+
+#include "database.h"
+#include "parallel.h"
+#include "sorting.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUBBLE_SORT_LIMIT 10000
+#define MAX_BENCH_RECORDS 10000000
+
+// previous implementation: stable bubble sort, mark descending with id ties
+static void bubble_sort_mark_desc(StudentRecord *records, size_t count) {
+  for (size_t i = 0; i + 1 < count; i++) {
+    int swapped = 0;
+    for (size_t j = 0; j < count - i - 1; j++) {
+      const StudentRecord *a = &records[j];
+      const StudentRecord *b = &records[j + 1];
+      if (a->mark < b->mark || (a->mark == b->mark && a->id > b->id)) {
+        StudentRecord temp = records[j];
+        records[j] = records[j + 1];
+        records[j + 1] = temp;
+        swapped = 1;
+      }
+    }
+    if (!swapped) {
+      break;
+    }
+  }
+}
+
+// deterministic pseudo-random records with hundredths marks
+static void fill_records(StudentRecord *records, size_t count) {
+  unsigned long state = 12345;
+  for (size_t i = 0; i < count; i++) {
+    state = state * 6364136223846793005UL + 1442695040888963407UL;
+    records[i].id = (int)(i + 1);
+    snprintf(records[i].name, sizeof records[i].name, "Student %zu", i);
+    strcpy(records[i].prog, "Computer Science");
+    records[i].mark = (float)((state >> 33) % 10001) / 100.0f;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  size_t bubble_limit = BUBBLE_SORT_LIMIT;
+  size_t max_records = MAX_BENCH_RECORDS;
+  if (argc > 1) {
+    bubble_limit = (size_t)strtoull(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    max_records = (size_t)strtoull(argv[2], NULL, 10);
+  }
+
+  size_t workers = parallel_worker_count(max_records, 1);
+  printf("Sort benchmark (mark descending), %zu worker thread(s)\n", workers);
+  printf("%10s  %12s  %12s  %12s  %12s\n", "records", "bubble_s",
+         "engine_id_s", "engine_mk_s", "parallel_s");
+
+  for (size_t n = 1000; n <= max_records; n *= 10) {
+    StudentRecord *records = malloc(n * sizeof(StudentRecord));
+    if (!records) {
+      printf("%10zu  allocation failed\n", n);
+      break;
+    }
+
+    char bubble_col[32] = "skipped";
+    if (n <= bubble_limit) {
+      fill_records(records, n);
+      double start = now_seconds();
+      bubble_sort_mark_desc(records, n);
+      snprintf(bubble_col, sizeof bubble_col, "%.6f", now_seconds() - start);
+    }
+
+    fill_records(records, n);
+    double start = now_seconds();
+    sort_records_parallel(records, n, SORT_FIELD_ID, SORT_ORDER_DESC, 1);
+    double engine_id = now_seconds() - start;
+
+    fill_records(records, n);
+    start = now_seconds();
+    sort_records_parallel(records, n, SORT_FIELD_MARK, SORT_ORDER_DESC, 1);
+    double engine_mark = now_seconds() - start;
+
+    fill_records(records, n);
+    start = now_seconds();
+    sort_records_parallel(records, n, SORT_FIELD_MARK, SORT_ORDER_DESC,
+                          workers);
+    double parallel = now_seconds() - start;
+
+    printf("%10zu  %12s  %12.6f  %12.6f  %12.6f\n", n, bubble_col, engine_id,
+           engine_mark, parallel);
+    free(records);
+  }
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * bench_text_search.c
+ *
+ * measures GREP NAME over a generated table: the previous search, which
+ * folded both the name and the pattern with tolower at every comparison,
+ * against a needle folded once and searched for in the table's folded
+ * names. throughput is reported in names per second and the match counts
+ * of both searches are compared.
+ *
+ * usage: ./build/bench_text_search [repeats] [records]
+ */
+
+#include "database.h"
+#include "text_search.h"
+#include "bench_utils.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_RECORDS 1000000
+
+// substring check ignoring case, as GREP did it before
+static int contains_ignoring_case(const char *text, const char *pattern) {
+  size_t length = strlen(pattern);
+  for (const char *p = text; *p; p++) {
+    size_t i = 0;
+    while (p[i] &&
+           tolower((unsigned char)p[i]) == tolower((unsigned char)pattern[i])) {
+      if (++i == length) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static StudentTable *build_table(size_t count) {
+  StudentTable *table = table_init("StudentRecords");
+  if (!table) {
+    return NULL;
+  }
+  static const char *given[] = {"Wei Ming", "Siti",  "Arjun",  "Mei Ling",
+                                "Hafiz",    "Priya", "Jun Jie", "Aisyah"};
+  static const char *surnames[] = {"Chen", "Tan",   "Lim",  "Wong",
+                                   "Ng",   "Kumar", "Rahman", "Lee"};
+  unsigned seed = 12345;
+  for (size_t i = 0; i < count; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    StudentRecord record = {.id = (int)(2500000 + i), .mark = 50.0f};
+    snprintf(record.name, sizeof record.name, "%s %s %s",
+             given[(seed >> 8) % 8], surnames[(seed >> 12) % 8],
+             surnames[(seed >> 16) % 8]);
+    snprintf(record.prog, sizeof record.prog, "Computer Science");
+    if (table_add_record(table, &record) != DB_SUCCESS) {
+      table_free(table);
+      return NULL;
+    }
+  }
+  return table;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (records < 1 || records > 10000000) {
+    records = DEFAULT_RECORDS;
+  }
+
+  StudentTable *table = build_table(records);
+  if (!table) {
+    printf("cannot build table\n");
+    return 1;
+  }
+
+  static const char *patterns[] = {"wong", "KUMAR LEE", "a", "zz",
+                                   "mei ling tan chen"};
+  printf("GREP NAME benchmark, %zu records, best of %d\n", records, repeats);
+  printf("%-20s  %11s  %11s  %14s  %8s  %9s\n", "pattern", "tolower_s",
+         "folded_s", "names/s", "speedup", "matches");
+
+  for (size_t q = 0; q < sizeof patterns / sizeof patterns[0]; q++) {
+    TextNeedle needle;
+    if (!text_needle_init(&needle, patterns[q])) {
+      printf("cannot prepare %s\n", patterns[q]);
+      continue;
+    }
+    double baseline = 0.0;
+    double folded = 0.0;
+    size_t expected = 0;
+    size_t found = 0;
+    for (int r = 0; r < repeats; r++) {
+      double start = now_seconds();
+      expected = 0;
+      for (size_t p = 0; p < table->slot_count; p++) {
+        expected += (size_t)contains_ignoring_case(table_record_name(table, p),
+                                                   patterns[q]);
+      }
+      double elapsed = now_seconds() - start;
+      baseline = (r == 0 || elapsed < baseline) ? elapsed : baseline;
+
+      start = now_seconds();
+      found = 0;
+      for (size_t p = 0; p < table->slot_count; p++) {
+        found += text_needle_find(&needle,
+                                  folded_text_get(&table->folded_names, p));
+      }
+      elapsed = now_seconds() - start;
+      folded = (r == 0 || elapsed < folded) ? elapsed : folded;
+    }
+    printf("%-20s  %11.6f  %11.6f  %14.0f  %7.1fx  %9zu%s\n", patterns[q],
+           baseline, folded, (double)records / folded, baseline / folded,
+           found, found == expected ? "" : "  MISMATCH");
+    text_needle_free(&needle);
+  }
+
+  table_free(table);
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * bench_top_k.c
+ *
+ * measures "the k best marks matching a pipeline" on a generated table two
+ * ways: adv_query_select of every match followed by a full sort of the
+ * matches by mark, and the same pipeline with ORDER BY MARK DESC | LIMIT k
+ * answered from a bounded heap. the k records from both ways are compared.
+ *
+ * usage: ./build/bench_top_k [repeats] [records] [rows|columns]
+ */
+
+#include "adv_query.h"
+#include "database.h"
+#include "bench_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPEATS 5
+#define DEFAULT_RECORDS 1000000
+
+// matches ordered by mark, highest first, then as the query returned them
+static int compare_marks(const void *a, const void *b) {
+  const AdvQueryMatch *x = a;
+  const AdvQueryMatch *y = b;
+  float mx = table_record_mark(x->table, x->position);
+  float my = table_record_mark(y->table, y->position);
+  if (mx != my) {
+    return mx < my ? 1 : -1;
+  }
+  return (x->position > y->position) - (x->position < y->position);
+}
+
+// best time of repeats selects of every match then a full sort, keeping the
+// last result
+static double time_sorted(StudentDatabase *db, const char *pipeline,
+                          int repeats, AdvQueryResult *result) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    adv_query_result_free(result);
+    double start = now_seconds();
+    adv_query_select(db, pipeline, result);
+    qsort(result->matches, result->count, sizeof(AdvQueryMatch),
+          compare_marks);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+  return best;
+}
+
+// best time of repeats selects with ORDER BY and LIMIT, keeping the last
+// result
+static double time_top(StudentDatabase *db, const char *pipeline,
+                       int repeats, AdvQueryResult *result) {
+  double best = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    adv_query_result_free(result);
+    double start = now_seconds();
+    adv_query_select(db, pipeline, result);
+    double elapsed = now_seconds() - start;
+    best = (r == 0 || elapsed < best) ? elapsed : best;
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  int repeats = argc > 1 ? atoi(argv[1]) : DEFAULT_REPEATS;
+  size_t records = argc > 2 ? (size_t)atol(argv[2]) : DEFAULT_RECORDS;
+  TableLayout layout = argc > 3 && strcmp(argv[3], "columns") == 0
+                           ? TABLE_LAYOUT_COLUMNS
+                           : TABLE_LAYOUT_ROWS;
+  if (repeats < 1) {
+    repeats = 1;
+  }
+  if (records < 1 || records > 10000000) {
+    records = DEFAULT_RECORDS;
+  }
+
+  StudentDatabase *db = create_bench_database(records, layout);
+  if (!db) {
+    printf("cannot build database\n");
+    return 1;
+  }
+
+  static const char *filters[] = {"MARK >= 0",
+                                  "GREP PROGRAMME = computer science",
+                                  "GREP NAME = 7 | MARK > 40"};
+  static const size_t limits[] = {1, 20, 1000, 100000};
+  printf("Top k by mark, %zu records (%s), best of %d\n", records,
+         layout == TABLE_LAYOUT_COLUMNS ? "columns" : "rows", repeats);
+  printf("%-36s  %7s  %9s  %10s  %10s  %8s\n", "filter", "k", "matches",
+         "sort_s", "top_k_s", "speedup");
+  for (size_t f = 0; f < sizeof filters / sizeof filters[0]; f++) {
+    for (size_t l = 0; l < sizeof limits / sizeof limits[0]; l++) {
+      char pipeline[128];
+      snprintf(pipeline, sizeof pipeline, "%s | ORDER BY MARK DESC | LIMIT %zu",
+               filters[f], limits[l]);
+      AdvQueryResult sorted = {0};
+      AdvQueryResult top = {0};
+      double sort_time = time_sorted(db, filters[f], repeats, &sorted);
+      double top_time = time_top(db, pipeline, repeats, &top);
+
+      size_t k = sorted.count < limits[l] ? sorted.count : limits[l];
+      bool same = top.count == k;
+      for (size_t i = 0; same && i < k; i++) {
+        same = top.matches[i].position == sorted.matches[i].position;
+      }
+      printf("%-36s  %7zu  %9zu  %10.6f  %10.6f  %7.1fx%s\n", filters[f],
+             limits[l], sorted.count, sort_time, top_time,
+             sort_time / top_time, same ? "" : "  MISMATCH");
+      adv_query_result_free(&sorted);
+      adv_query_result_free(&top);
+    }
+  }
+
+  db_free(db);
+  return 0;
+}
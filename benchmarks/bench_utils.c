@@ -0,0 +1,48 @@
+#include "bench_utils.h"
+#include <stdio.h>
+#include <time.h>
+
+// wall-clock time in seconds
+double now_seconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// a loaded database of count generated records (IDs from 2500000, marks
+// and eight programmes drawn from a fixed seed) in the given layout, or
+// NULL if it cannot be built
+StudentDatabase *create_bench_database(size_t count, TableLayout layout) {
+  StudentDatabase *db = db_init();
+  StudentTable *table = table_init("StudentRecords");
+  if (!db || !table || db_add_table(db, table) != DB_SUCCESS) {
+    table_free(table);
+    db_free(db);
+    return NULL;
+  }
+  db->is_loaded = true;
+  if (layout == TABLE_LAYOUT_COLUMNS &&
+      table_set_layout(table, layout) != DB_SUCCESS) {
+    db_free(db);
+    return NULL;
+  }
+
+  static const char *programmes[] = {
+      "Computer Science", "Data Science",  "Cyber Security",
+      "Applied AI",       "Software Eng.", "Information Systems",
+      "Mathematics",      "Physics"};
+  unsigned seed = 12345;
+  for (size_t i = 0; i < count; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    StudentRecord record = {.id = (int)(2500000 + i),
+                            .mark = (float)((seed >> 4) % 10001) / 100.0f};
+    snprintf(record.name, sizeof record.name, "Student %zu", i);
+    snprintf(record.prog, sizeof record.prog, "%s",
+             programmes[(seed >> 20) % 8]);
+    if (table_add_record(table, &record) != DB_SUCCESS) {
+      db_free(db);
+      return NULL;
+    }
+  }
+  return db;
+}
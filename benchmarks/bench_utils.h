@@ -0,0 +1,17 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+// helpers shared by the benchmark harnesses
+
+#include "database.h"
+#include <stddef.h>
+
+// wall-clock time in seconds
+double now_seconds(void);
+
+// a loaded database of count generated records (IDs from 2500000, marks
+// and eight programmes drawn from a fixed seed) in the given layout, or
+// NULL if it cannot be built
+StudentDatabase *create_bench_database(size_t count, TableLayout layout);
+
+#endif // BENCH_UTILS_H
@@ -7,7 +7,11 @@
  *
  * provides a filter-based query system that allows chaining multiple
  * conditions. supports filtering by id, name, programme, and mark with various
- * operators. uses a pipeline syntax where filters are separated by '|'.
+ * operators. uses a pipeline syntax where filters are separated by '|',
+ * optionally followed by ORDER BY and LIMIT clauses.
+ * pipelines run batch at a time: each batch of view positions passes through
+ * every stage in turn, cheapest first, with each stage narrowing a selection
+ * vector of the positions still matching.
  *
  * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
  */
@@ -22,6 +26,79 @@ typedef enum {
   ADV_QUERY_ERROR_MEMORY            // memory allocation failed
 } AdvQueryStatus;
 
+// view positions filtered together through the whole pipeline
+#define ADV_QUERY_BATCH_SIZE 1024
+
+// view positions (or candidates) a worker claims at a time when a table is
+// queried on worker threads
+#define ADV_QUERY_MORSEL_SIZE (16 * ADV_QUERY_BATCH_SIZE)
+
+// a matching record, addressed by table and position (either layout)
+typedef struct {
+  const StudentTable *table;
+  size_t position;
+} AdvQueryMatch;
+
+typedef struct {
+  AdvQueryMatch *matches; // in table order, then active view order, or
+                          // in ORDER BY order
+  size_t count;
+  size_t capacity;
+} AdvQueryResult;
+
+/**
+ * @brief finds the records matching a query pipeline
+ * @param[in] db pointer to the database to query
+ * @param[in] pipeline query string with filter conditions separated by '|'
+ * @param[out] result matching records, in table order then active view order,
+ *             or in the order of the pipeline's ORDER BY
+ * @return ADV_QUERY_SUCCESS on success, appropriate error code on failure
+ * @note the whole pipeline is parsed before any record is read. records are
+ *       then filtered ADV_QUERY_BATCH_SIZE view positions at a time, each
+ *       stage narrowing the batch's selection vector, cheapest stage first.
+ *       with sorted views on the table, a MARK or ID interval leaving at
+ *       most 1 in RANGE_INDEX_MAX_SHARE positions is found by binary search
+ *       (db->range_index lets the query build the views first). with a
+ *       trigram index on the table, a GREP NAME pattern of 3 or more
+ *       bytes limits the positions read to the index's candidates; with
+ *       filter bitmaps, programme and mark stages leaving under 1 in
+ *       FILTER_BITMAP_MAX_SHARE positions are answered from the bitmaps.
+ *       with a query cache on the database, the matches of a pipeline are
+ *       kept under its normalised text and returned without reading any
+ *       record until the database next changes. an ORDER BY keeps only the
+ *       first LIMIT matches found so far in a bounded heap, O(n log k),
+ *       without moving any stored record or view, with ties in the order
+ *       above; a LIMIT alone stops reading records once it is reached.
+ *       a table reading db->query_parallel_rows positions or more is read in
+ *       morsels of ADV_QUERY_MORSEL_SIZE pulled by worker threads, giving
+ *       the same matches in the same order
+ */
+AdvQueryStatus adv_query_select(StudentDatabase *db, const char *pipeline,
+                                AdvQueryResult *result);
+
+/**
+ * @brief counts the records matching a query pipeline
+ * @param[in] db pointer to the database to query
+ * @param[in] pipeline query string with filter conditions separated by '|'
+ * @param[out] count number of matching records
+ * @return ADV_QUERY_SUCCESS on success, appropriate error code on failure
+ * @note a table whose filter bitmaps answer every stage (programme and mark
+ *       only) is counted by popcount over the bitmaps, comparing only the
+ *       marks in the band straddling the bound, and a single MARK or ID
+ *       interval is counted from its ranks in a table's sorted views; other
+ *       tables are counted as adv_query_select would find them. a result in
+ *       the query cache is counted without reading any record. ORDER BY is
+ *       ignored and the count stops at LIMIT
+ */
+AdvQueryStatus adv_query_count(StudentDatabase *db, const char *pipeline,
+                               size_t *count);
+
+/**
+ * @brief releases the matches held by a query result
+ * @param[in,out] result result to empty
+ */
+void adv_query_result_free(AdvQueryResult *result);
+
 /**
  * @brief executes a query pipeline and displays matching records
  * @param[in] db pointer to the database to query
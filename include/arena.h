@@ -0,0 +1,118 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/**
+ * @file arena.h
+ * @brief region allocator for memory that lives as long as a loaded database
+ *
+ * hands out memory by bumping a pointer through large blocks obtained from
+ * malloc. individual allocations are never freed; the whole arena is reset
+ * at once, which keeps every block so the next load reuses the same memory
+ * without calling malloc again. a table or column store owned by an arena
+ * points at it, and one that is not points at NULL: every function here
+ * accepts a NULL arena and then falls back to malloc/realloc/free, so owners
+ * can use the same calls in both cases.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// default size in bytes of a block (larger requests get a block of their own)
+#define ARENA_BLOCK_SIZE (256 * 1024)
+
+// alignment of every allocation (enough for any field type in this project)
+#define ARENA_ALIGNMENT 16
+
+// one malloc'd block; allocations are carved from data
+typedef struct ArenaBlock {
+  struct ArenaBlock *next; // next block in allocation order
+  size_t capacity;         // usable bytes in data
+  size_t used;             // bytes handed out since the last reset
+  _Alignas(ARENA_ALIGNMENT) unsigned char data[];
+} ArenaBlock;
+
+// counters for confirming how much work the system allocator does
+typedef struct {
+  size_t block_mallocs;  // blocks obtained from malloc (lifetime)
+  size_t allocations;    // allocations served since the last reset
+  size_t bytes_used;     // bytes handed out since the last reset
+  size_t bytes_reserved; // bytes held in blocks
+  size_t resets;         // number of arena_reset calls
+} ArenaStats;
+
+// chain of blocks; allocation continues in current and moves down the chain
+typedef struct {
+  ArenaBlock *head;    // first block (NULL until the first allocation)
+  ArenaBlock *current; // block allocations are currently carved from
+  void *last;          // most recent allocation, which may grow in place
+  ArenaStats stats;
+} Arena;
+
+/**
+ * @brief initialises an empty arena (no memory is allocated)
+ * @param[out] arena pointer to the arena to initialise
+ */
+void arena_init(Arena *arena);
+
+/**
+ * @brief releases every block held by an arena
+ * @param[in,out] arena pointer to the arena to free (can be NULL)
+ * @note all memory handed out by the arena becomes invalid
+ */
+void arena_free(Arena *arena);
+
+/**
+ * @brief discards every allocation while keeping the blocks for reuse
+ * @param[in,out] arena pointer to the arena to reset (can be NULL)
+ * @note all memory handed out by the arena becomes invalid
+ */
+void arena_reset(Arena *arena);
+
+/**
+ * @brief allocates memory from an arena, or from the heap if arena is NULL
+ * @param[in,out] arena pointer to the arena (NULL for malloc)
+ * @param[in] size number of bytes
+ * @return pointer aligned to ARENA_ALIGNMENT, NULL if memory runs out
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * @brief allocates zero-filled memory from an arena, or calloc if NULL
+ * @param[in,out] arena pointer to the arena (NULL for calloc)
+ * @param[in] count number of elements
+ * @param[in] size size of each element
+ * @return pointer to the zeroed memory, NULL on overflow or out of memory
+ */
+void *arena_calloc(Arena *arena, size_t count, size_t size);
+
+/**
+ * @brief resizes an allocation, like realloc
+ * @param[in,out] arena pointer to the arena (NULL for realloc)
+ * @param[in] ptr allocation to resize (can be NULL)
+ * @param[in] old_size current size of ptr in bytes
+ * @param[in] new_size size wanted in bytes
+ * @return pointer to the resized memory, NULL on failure (ptr stays valid)
+ * @note in an arena the most recent allocation grows in place when its block
+ *       has room; otherwise the contents are copied and the old bytes stay
+ *       unused until the next reset
+ */
+void *arena_resize(Arena *arena, void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief gives back an allocation (a no-op for arena memory)
+ * @param[in,out] arena pointer to the arena (NULL for free)
+ * @param[in] ptr allocation to release (can be NULL)
+ */
+void arena_release(Arena *arena, void *ptr);
+
+/**
+ * @brief copies a NUL-terminated string into an arena, or strdup if NULL
+ * @param[in,out] arena pointer to the arena (NULL for the heap)
+ * @param[in] text string to copy
+ * @return pointer to the copy, NULL if memory runs out
+ */
+char *arena_strdup(Arena *arena, const char *text);
+
+#endif // ARENA_H
@@ -0,0 +1,58 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+/**
+ * @file atomic_file.h
+ * @brief crash-safe replacement of whole files
+ *
+ * a file is written to "<path>.tmp" beside its target, flushed to disk and
+ * then renamed over the target, so a crash at any point leaves either the
+ * old file or the complete new one, never a truncated mix. on posix
+ * systems the directory is synced after the rename so the new name is
+ * durable too; on windows the rename is a write-through MoveFileEx.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "database.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// a file being written beside the one it will replace
+typedef struct {
+  FILE *fp;                          // open temp file, NULL once closed
+  char path[MAX_FILE_PATH];          // file to replace
+  char temp_path[MAX_FILE_PATH + 8]; // path followed by ".tmp"
+} AtomicFile;
+
+/**
+ * @brief opens a temp file to be renamed over path once written
+ * @param[out] file receives the open temp file
+ * @param[in] path file the temp file will replace
+ * @return the temp file's stream, or NULL if path is too long or the temp
+ *         file cannot be created
+ */
+FILE *atomic_file_open(AtomicFile *file, const char *path);
+
+/**
+ * @brief flushes the temp file to disk and renames it over its target
+ * @param[in,out] file file opened by atomic_file_open
+ * @return true if the target now holds the written bytes durably, false
+ *         otherwise (the temp file is removed and the target left as it was)
+ */
+bool atomic_file_commit(AtomicFile *file);
+
+/**
+ * @brief closes and removes the temp file, leaving the target untouched
+ * @param[in,out] file file opened by atomic_file_open (can be NULL)
+ */
+void atomic_file_abort(AtomicFile *file);
+
+/**
+ * @brief forces an open file's written data to disk
+ * @param[in] fp stream to sync
+ * @return true if the data was flushed and synced
+ */
+bool file_sync(FILE *fp);
+
+#endif // ATOMIC_FILE_H
@@ -0,0 +1,137 @@
+#ifndef BITMAP_INDEX_H
+#define BITMAP_INDEX_H
+
+/**
+ * @file bitmap_index.h
+ * @brief precomputed bitmaps of record positions per programme and mark band
+ *
+ * keeps one compressed bitmap (roaring.h) per programme dictionary code and
+ * one per band of MARK_BAND_WIDTH marks. a conjunction of a programme GREP
+ * and a MARK filter is then answered by ORing the bitmaps of the accepted
+ * codes and bands and ANDing the two; only records in the band holding the
+ * filter's bound need their mark compared.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "roaring.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// marks per band; band b holds marks in [b * width, (b + 1) * width)
+#define MARK_BAND_WIDTH 5
+
+// bands 0 .. 19 cover 0 to 100; the last one holds 100 and above. band 0
+// also takes negative marks and NaN
+#define MARK_BAND_COUNT 21
+
+// how every mark of a band compares with a MARK filter
+typedef enum {
+  MARK_BAND_FAIL = 0, // no mark in the band passes
+  MARK_BAND_PASS,     // every mark in the band passes
+  MARK_BAND_CHECK     // some may pass; each has to be compared
+} MarkBandVerdict;
+
+// programme and mark band bitmaps of one table
+typedef struct {
+  RoaringBitmap *programmes; // one bitmap per programme code
+  uint32_t programme_count;  // bitmaps allocated
+  RoaringBitmap bands[MARK_BAND_COUNT];
+} BitmapIndex;
+
+/**
+ * @brief initialises an empty index (no memory is allocated)
+ * @param[out] index pointer to the index to initialise
+ */
+void bitmap_index_init(BitmapIndex *index);
+
+/**
+ * @brief frees all memory held by an index, leaving it empty
+ * @param[in,out] index pointer to the index to free (can be NULL)
+ */
+void bitmap_index_free(BitmapIndex *index);
+
+/**
+ * @brief returns the band a mark falls in
+ * @param[in] mark mark to place
+ * @return band below MARK_BAND_COUNT
+ */
+size_t bitmap_index_band(float mark);
+
+/**
+ * @brief compares a whole band with a MARK filter
+ * @param[in] band band below MARK_BAND_COUNT
+ * @param[in] op comparison ('<', '>' or '=')
+ * @param[in] value bound the marks are compared with
+ * @return whether none, all or some of the band's marks can pass
+ * @note the first and last bands are open-ended, so they are always
+ *       MARK_BAND_CHECK unless no mark in them can pass
+ */
+MarkBandVerdict bitmap_index_band_verdict(size_t band, char op, double value);
+
+/**
+ * @brief compares a whole band with an interval of marks
+ * @param[in] band band below MARK_BAND_COUNT
+ * @param[in] low lowest mark of the interval (can be -INFINITY)
+ * @param[in] low_open true if low itself is outside the interval
+ * @param[in] high highest mark of the interval (can be INFINITY)
+ * @param[in] high_open true if high itself is outside the interval
+ * @return whether none, all or some of the band's marks fall in the interval
+ * @note '<', '>' and '=' filters are the intervals (-inf, v), (v, inf] and
+ *       [v, v]; the first band is never MARK_BAND_PASS, as NaN falls in no
+ *       interval
+ */
+MarkBandVerdict bitmap_index_range_verdict(size_t band, double low,
+                                           bool low_open, double high,
+                                           bool high_open);
+
+/**
+ * @brief adds a record position under its programme code and mark band
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] code programme dictionary code of the record
+ * @param[in] mark mark of the record
+ * @return true on success, false if memory allocation fails (the position
+ *         may then be under one of the two only)
+ */
+bool bitmap_index_add(BitmapIndex *index, uint32_t position, uint32_t code,
+                      float mark);
+
+/**
+ * @brief removes a record position from its programme code and mark band
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] code programme code the position was added with
+ * @param[in] mark mark the position was added with
+ */
+void bitmap_index_remove(BitmapIndex *index, uint32_t position, uint32_t code,
+                         float mark);
+
+/**
+ * @brief renumbers every position after records are moved down
+ * @param[in,out] index pointer to the index
+ * @param[in] new_position new position of each indexed position
+ * @return true on success, false if memory allocation fails (the index is
+ *         then left empty)
+ * @note new_position must keep positions in the same order (a purge)
+ */
+bool bitmap_index_remap(BitmapIndex *index, const uint32_t *new_position);
+
+/**
+ * @brief returns the positions holding a programme code
+ * @param[in] index pointer to the index
+ * @param[in] code programme dictionary code
+ * @return bitmap of the code, or NULL if no position was ever added with it
+ */
+const RoaringBitmap *bitmap_index_programme(const BitmapIndex *index,
+                                            uint32_t code);
+
+/**
+ * @brief returns the bytes an index holds
+ * @param[in] index pointer to the index
+ * @return allocated bytes of every bitmap
+ */
+size_t bitmap_index_memory(const BitmapIndex *index);
+
+#endif // BITMAP_INDEX_H
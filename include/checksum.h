@@ -6,7 +6,10 @@
  * @brief checksum module for data integrity verification
  *
  * provides CRC32 checksum computation for databases, files, and individual
- * records to detect changes and verify data integrity.
+ * records to detect changes and verify data integrity. CRC32 uses constant
+ * slicing-by-8 tables, so every function is safe to call from any thread.
+ * change detection can instead use a faster non-cryptographic hash, chosen
+ * per database (ChecksumMode); files are always checked with CRC32.
  *
  * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
  */
@@ -17,13 +20,37 @@
  * @brief computes CRC32 checksum of entire database
  * @param[in] db pointer to the database to checksum
  * @return CRC32 checksum value of the database
+ * @note reads every record; tracked_database_checksum returns the same
+ *       value from the checksum maintained as records change. tables in
+ *       CHECKSUM_MODE_FAST combine fast hashes instead of CRC32s
  */
 unsigned long compute_database_checksum(const StudentDatabase *db);
 
+/**
+ * @brief returns the database checksum maintained as records change
+ * @param[in] db pointer to the database
+ * @return CRC32 checksum value of the database, equal to
+ *         compute_database_checksum without reading any record
+ * @note builds with CMS_VERIFY_CHECKSUM defined recompute the checksum on
+ *       every call and abort if the two differ
+ */
+unsigned long tracked_database_checksum(const StudentDatabase *db);
+
+/**
+ * @brief computes the XOR of the record checksums of a table's live records
+ * @param[in] table pointer to the table to checksum
+ * @return combined record checksums (0 for an empty or NULL table)
+ * @note uses the table's checksum mode; this is the value
+ *       table->record_checksum is kept equal to
+ */
+unsigned long compute_table_checksum(const StudentTable *table);
+
 /**
  * @brief computes CRC32 checksum of file on disk
  * @param[in] filepath path to the file to checksum
  * @return CRC32 checksum value of the file, 0 on error
+ * @note reads the raw bytes; db_load and db_save produce the same value
+ *       for the files they read and write without reading them again
  */
 unsigned long compute_file_checksum(const char *filepath);
 
@@ -34,4 +61,47 @@ unsigned long compute_file_checksum(const char *filepath);
  */
 unsigned long compute_record_checksum(const StudentRecord *record);
 
+/**
+ * @brief computes the change-detection checksum of a single record
+ * @param[in] record pointer to the student record to checksum
+ * @param[in] mode CRC32 or the fast hash
+ * @return compute_record_checksum for CHECKSUM_MODE_CRC32, the fast hash of
+ *         the same bytes for CHECKSUM_MODE_FAST
+ */
+unsigned long compute_record_hash(const StudentRecord *record,
+                                  ChecksumMode mode);
+
+/**
+ * @brief extends a CRC32 checksum over more bytes
+ * @param[in] crc checksum of the bytes so far (0 to start a new checksum)
+ * @param[in] data bytes to add
+ * @param[in] length number of bytes
+ * @return CRC32 checksum of the previous bytes followed by data
+ */
+unsigned long crc32_update(unsigned long crc, const void *data,
+                           size_t length);
+
+/**
+ * @brief combines the CRC32 checksums of two adjacent byte ranges
+ * @param[in] crc1 checksum of the first range
+ * @param[in] crc2 checksum of the second range
+ * @param[in] length2 number of bytes in the second range
+ * @return CRC32 checksum of the first range followed by the second
+ * @note costs O(log length2), so ranges checksummed on separate threads
+ *       can be joined without reading them again
+ */
+unsigned long crc32_combine(unsigned long crc1, unsigned long crc2,
+                            size_t length2);
+
+/**
+ * @brief computes a fast non-cryptographic 32-bit hash of a buffer
+ * @param[in] data bytes to hash
+ * @param[in] length number of bytes
+ * @return hash of the bytes
+ * @note consumes eight bytes per multiply; meant for change detection
+ *       (CHECKSUM_MODE_FAST), not for anything stored or compared across
+ *       builds with a different hash
+ */
+unsigned long compute_fast_hash(const void *data, size_t length);
+
 #endif // CHECKSUM_H
@@ -0,0 +1,157 @@
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+/**
+ * @file column_store.h
+ * @brief columnar (structure-of-arrays) storage for student records
+ *
+ * stores each field of a table in its own contiguous array: ids and marks as
+ * plain int/float columns, names as offsets into a string pool that packs
+ * NUL-terminated strings end to end. programmes are dictionary codes kept by
+ * the owning table (see dictionary.h). scans that only need one field (marks
+ * for statistics or MARK filters, ids for lookups) then read 4 bytes per
+ * record instead of a whole StudentRecord. rows are addressed by position;
+ * the owning table tracks the row count.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "arena.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// initial size in bytes of a string pool
+#define STRING_POOL_INITIAL_CAPACITY 1024
+
+// packed NUL-terminated strings addressed by byte offset
+typedef struct {
+  char *data;      // string bytes
+  size_t used;     // bytes written (live and dead)
+  size_t capacity; // bytes allocated
+  size_t dead;     // bytes held by strings that were replaced or removed
+} StringPool;
+
+// one array per field, all indexed by row position
+typedef struct {
+  int *ids;               // student ids
+  float *marks;           // marks
+  uint32_t *name_offsets; // offsets into names
+  size_t capacity;        // rows allocated in each column
+  StringPool names;
+  Arena *arena; // source of the columns and pool (NULL for the heap)
+} ColumnStore;
+
+/**
+ * @brief returns the string stored at an offset of a pool
+ * @param[in] pool pointer to the string pool
+ * @param[in] offset offset returned when the string was stored
+ * @return pointer to the NUL-terminated string inside the pool
+ */
+static inline const char *string_pool_get(const StringPool *pool,
+                                          uint32_t offset) {
+  return pool->data + offset;
+}
+
+/**
+ * @brief ensures a pool can take extra more bytes without growing
+ * @param[in,out] arena arena the pool allocates from (NULL for the heap)
+ * @param[in,out] pool pointer to the string pool
+ * @param[in] extra number of bytes that must fit after the used ones
+ * @return true on success, false if memory allocation fails
+ */
+bool string_pool_reserve(Arena *arena, StringPool *pool, size_t extra);
+
+/**
+ * @brief rebuilds a pool so it holds only the strings referenced by offsets
+ * @param[in,out] arena arena the pool allocates from (NULL for the heap)
+ * @param[in,out] pool pointer to the string pool
+ * @param[in,out] offsets offsets of the live strings, rewritten in place
+ * @param[in] count number of offsets
+ * @param[in] spare bytes to keep free after the live strings
+ * @return true on success, false if memory allocation fails (the pool and
+ *         offsets are unchanged)
+ * @note the live strings are packed back into the pool's own buffer through
+ *       a heap scratch copy, so repeated compactions never take fresh arena
+ *       memory (which only a reset gives back)
+ */
+bool string_pool_compact(Arena *arena, StringPool *pool, uint32_t *offsets,
+                         size_t count, size_t spare);
+
+/**
+ * @brief initialises an empty column store (no memory is allocated)
+ * @param[out] store pointer to the store to initialise
+ * @note the store allocates from the heap until its arena field is set
+ */
+void column_store_init(ColumnStore *store);
+
+/**
+ * @brief frees all memory held by a column store
+ * @param[in,out] store pointer to the store to free (can be NULL)
+ * @note arena memory is only released by resetting the arena; the store
+ *       keeps its arena
+ */
+void column_store_free(ColumnStore *store);
+
+/**
+ * @brief grows every column so it can hold at least rows entries
+ * @param[in,out] store pointer to the store
+ * @param[in] rows number of rows required
+ * @return true on success, false if memory allocation fails
+ */
+bool column_store_reserve(ColumnStore *store, size_t rows);
+
+/**
+ * @brief writes a new row at position row (columns must have capacity)
+ * @param[in,out] store pointer to the store
+ * @param[in] row position to write (normally the current row count)
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] mark mark
+ * @return true on success, false if the name pool cannot grow
+ */
+bool column_store_append(ColumnStore *store, size_t row, int id,
+                         const char *name, float mark);
+
+/**
+ * @brief replaces the name and mark of an existing row
+ * @param[in,out] store pointer to the store
+ * @param[in] row position of the row
+ * @param[in] name new name
+ * @param[in] mark new mark
+ * @return true on success, false if the name pool cannot grow
+ * @note a name that fits is overwritten in place; a longer one is appended
+ */
+bool column_store_update(ColumnStore *store, size_t row, const char *name,
+                         float mark);
+
+/**
+ * @brief copies row src over row dst (used when closing gaps left by
+ *        deleted rows)
+ * @param[in,out] store pointer to the store
+ * @param[in] dst row to overwrite
+ * @param[in] src row to copy
+ * @note the overwritten name stays in the pool until the next
+ *       column_store_compact_pools
+ */
+void column_store_move_row(ColumnStore *store, size_t dst, size_t src);
+
+/**
+ * @brief reorders rows so row i holds the row previously at perm[i]
+ * @param[in,out] store pointer to the store
+ * @param[in] perm permutation of 0..count-1
+ * @param[in] count number of rows
+ * @return true on success, false if scratch memory cannot be allocated
+ */
+bool column_store_permute(ColumnStore *store, const uint32_t *perm,
+                          size_t count);
+
+/**
+ * @brief rewrites the name pool so it holds only live strings
+ * @param[in,out] store pointer to the store
+ * @param[in] count number of rows
+ * @return true on success, false if memory allocation fails
+ */
+bool column_store_compact_pools(ColumnStore *store, size_t count);
+
+#endif // COLUMN_STORE_H
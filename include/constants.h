@@ -18,8 +18,9 @@
 #define SMALL_INPUT_SIZE 10    // single-char input with buffer
 
 // file parsing constants
-#define MAX_LINE_LENGTH 512    // maximum line length in data files
+#define MAX_LINE_LENGTH 512    // maximum metadata/header line length
 #define MAX_METADATA_VALUE 200 // maximum metadata value size in parser
+#define MAX_NUMBER_TOKEN 64    // longest id or mark text accepted by parser
 
 // field size constraints (must match database.h struct sizes)
 #define MAX_NAME_LENGTH 50       // student name field size
@@ -32,6 +33,33 @@
 #define MIN_STUDENT_ID 2500000 // minimum valid student id
 #define MAX_STUDENT_ID 2600000 // maximum valid student id
 
+// environment variable selecting the table layout ("rows" or "columns")
+#define TABLE_LAYOUT_ENV "CMS_TABLE_LAYOUT"
+
+// environment variable selecting how changes are detected ("crc32" or
+// "fast")
+#define CHECKSUM_MODE_ENV "CMS_CHECKSUM_MODE"
+
+// environment variable enabling the trigram index over names ("trigram")
+#define NAME_INDEX_ENV "CMS_NAME_INDEX"
+
+// environment variable enabling programme and mark band bitmaps ("bitmap")
+#define FILTER_INDEX_ENV "CMS_FILTER_INDEX"
+
+// environment variable letting ADV QUERY build sorted views for MARK and ID
+// intervals ("ordered")
+#define RANGE_INDEX_ENV "CMS_RANGE_INDEX"
+
+// environment variable setting the ADV QUERY result cache's capacity in KiB
+// ("0" disables it)
+#define QUERY_CACHE_ENV "CMS_QUERY_CACHE_KB"
+
+// environment variables setting how many positions a table query reads
+// before ADV QUERY runs it on worker threads ("0" never does), and how many
+// workers it uses
+#define QUERY_PARALLEL_ENV "CMS_QUERY_PARALLEL_ROWS"
+#define QUERY_WORKERS_ENV "CMS_QUERY_WORKERS"
+
 // cryptographic constants
 #define CRC32_TABLE_SIZE 256 // standard crc32 lookup table size
 
@@ -8,23 +8,50 @@
  * manages student records organised in tables within a database structure.
  * uses dynamic arrays that grow automatically as needed (doubling capacity).
  * supports loading from and saving to text files, along with basic
- * operations like adding and removing records.
+ * operations like adding and removing records. tables loaded from a file
+ * take their storage from the database's arena, so unloading is one reset.
  *
  * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
  */
 
+#include "arena.h"
+#include "bitmap_index.h"
+#include "column_store.h"
 #include "constants.h"
+#include "dictionary.h"
+#include "display_widths.h"
+#include "file_map.h"
+#include "id_index.h"
+#include "text_search.h"
+#include "trigram_index.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // forward declarations to avoid circular dependency
 typedef struct EventLog EventLog;
+typedef struct Journal Journal;
+typedef struct QueryCache QueryCache;
 
 // capacity constants
 #define INITIAL_TABLE_CAPACITY 2
 #define INITIAL_RECORD_CAPACITY 10
+
+// deleted slots are purged once more than 1 in TOMBSTONE_PURGE_RATIO slots
+// holds a tombstone
+#define TOMBSTONE_PURGE_RATIO 4
 #define MAX_FILE_PATH 260
 
+// smallest share of a table worth rendering on its own thread when saving
+#define SAVE_MIN_WORKER_ROWS 16384
+
+// most rows each worker renders per save pass; bounds the per-thread buffers
+#define SAVE_MAX_WORKER_ROWS 65536
+
+// positions a table query reads from which ADV QUERY pulls them in morsels
+// on worker threads, unless the database sets query_parallel_rows
+#define QUERY_PARALLEL_MIN_ROWS 262144
+
 // operation status codes
 typedef enum {
   DB_SUCCESS = 0,          // operation succeeded
@@ -32,7 +59,7 @@ typedef enum {
   DB_ERROR_MEMORY,         // malloc/realloc failed
   DB_ERROR_FILE_NOT_FOUND, // cannot open file
   DB_ERROR_FILE_READ,      // error reading from file
-  DB_ERROR_DUPLICATE_ID,   // duplicate student ID (for future insert)
+  DB_ERROR_DUPLICATE_ID,   // duplicate student ID
   DB_ERROR_NOT_FOUND,      // record not found (for future query/update/delete)
   DB_ERROR_INVALID_DATA    // invalid data format or values
 } DBStatus;
@@ -46,20 +73,146 @@ typedef struct {
   float mark;
 } StudentRecord;
 
+// physical layout of a table's records
+typedef enum {
+  TABLE_LAYOUT_ROWS = 0, // array of StudentRecord structs (records)
+  TABLE_LAYOUT_COLUMNS,  // one array per field (columns)
+} TableLayout;
+
+// how record checksums used for change detection are computed
+typedef enum {
+  CHECKSUM_MODE_CRC32 = 0, // CRC32 of each record (compute_record_checksum)
+  CHECKSUM_MODE_FAST,      // faster non-cryptographic hash of the same bytes
+} ChecksumMode;
+
+// orderings a table can be presented in
+typedef enum {
+  TABLE_VIEW_STORAGE = 0, // physical record order (insertion order)
+  TABLE_VIEW_ID_ASC,      // id ascending
+  TABLE_VIEW_ID_DESC,     // id descending
+  TABLE_VIEW_MARK_ASC,    // mark ascending, id ascending on ties
+  TABLE_VIEW_MARK_DESC,   // mark descending, id ascending on ties
+} TableView;
+
+// sorted views: permutation indexes holding record positions in sorted order.
+// built on first use, then kept in step with every add, remove and update.
+// descending id order is read from by_id backwards.
+typedef struct {
+  uint32_t *by_id;        // positions ordered by id ascending
+  uint32_t *by_mark_asc;  // positions ordered by mark ascending
+  uint32_t *by_mark_desc; // positions ordered by mark descending
+  size_t capacity;        // allocated entries per array
+  bool built;             // false until a view is first requested
+} SortedViews;
+
 // table container for column headers and records
 typedef struct {
   char table_name[MAX_TABLE_NAME_LENGTH]; // name of this table
 
+  // arena holding the table, its headers, record storage, programme codes,
+  // folded names and tombstones (NULL if they are individually heap-allocated)
+  Arena *arena;
+
   // column headers
   char **column_headers; // array of header strings
   size_t column_count;   // number of columns
 
-  // record storage (dynamic array)
-  StudentRecord *records; // heap-allocated array
-  size_t record_count;    // current number of records
+  // record storage: rows in records, or columns when layout is
+  // TABLE_LAYOUT_COLUMNS (records is then NULL)
+  TableLayout layout;
+  StudentRecord *records; // heap-allocated array (row layout)
+  ColumnStore columns;    // per-field arrays (column layout)
+  size_t record_count;    // current number of live records
   size_t record_capacity; // allocated capacity for records
+
+  // deleted records are tombstoned in place and purged later, so positions
+  // run up to slot_count and may include dead slots
+  size_t slot_count;      // positions in use (live records + tombstones)
+  size_t tombstone_count; // dead positions awaiting a purge
+  uint64_t *tombstones;   // bit per position, NULL until the first delete
+
+  // XOR of compute_record_hash over the live records, kept in step by
+  // table_add_record, table_remove_record and db_update_record
+  unsigned long record_checksum;
+  ChecksumMode checksum_mode;
+
+  // widest rendering of each field for SHOW ALL, kept in step by the same
+  // functions and recounted lazily (read through table_display_widths)
+  DisplayWidths display_widths;
+
+  // every distinct programme interned once, plus one code per record
+  // position (both layouts); column layout keeps programmes only here
+  StringDictionary programmes;
+  uint32_t *prog_codes; // record_capacity entries
+
+  // lowercased copy of every name, one per record position (both layouts),
+  // so GREP NAME searches without folding case
+  FoldedText folded_names;
+
+  // trigram index over folded_names, kept in step by the same functions;
+  // NULL unless enabled with table_set_name_index
+  TrigramIndex *name_trigrams;
+
+  // programme and mark band bitmaps over the live records, kept in step by
+  // the same functions; NULL unless enabled with table_set_filter_index
+  BitmapIndex *filter_bitmaps;
+
+  // student id -> record position, kept in step with the records array
+  IdIndex id_index;
+
+  // sorted views over the records array and the one used for display/save
+  SortedViews views;
+  TableView active_view;
+
+  // bumped by every change to the records, their positions or the active
+  // view (see db_mutation_count)
+  uint64_t mutations;
 } StudentTable;
 
+// true if the record at position has not been deleted; scans over positions
+// 0 .. slot_count - 1 must skip positions for which this is false
+static inline bool table_is_live(const StudentTable *table, size_t position) {
+  return table->tombstone_count == 0 ||
+         !((table->tombstones[position / 64] >> (position % 64)) & 1u);
+}
+
+// field accessors that work for either layout; position must be below
+// slot_count. scans over a single field can also branch on layout and read
+// columns.ids / columns.marks directly.
+
+static inline int table_record_id(const StudentTable *table, size_t position) {
+  return table->layout == TABLE_LAYOUT_COLUMNS ? table->columns.ids[position]
+                                               : table->records[position].id;
+}
+
+static inline float table_record_mark(const StudentTable *table,
+                                      size_t position) {
+  return table->layout == TABLE_LAYOUT_COLUMNS
+             ? table->columns.marks[position]
+             : table->records[position].mark;
+}
+
+static inline const char *table_record_name(const StudentTable *table,
+                                            size_t position) {
+  return table->layout == TABLE_LAYOUT_COLUMNS
+             ? string_pool_get(&table->columns.names,
+                               table->columns.name_offsets[position])
+             : table->records[position].name;
+}
+
+static inline const char *table_record_prog(const StudentTable *table,
+                                            size_t position) {
+  return table->layout == TABLE_LAYOUT_COLUMNS
+             ? dictionary_get(&table->programmes, table->prog_codes[position])
+             : table->records[position].prog;
+}
+
+// a mapped file whose bytes back table storage (binary snapshots)
+typedef struct MappedFile {
+  FileMap map;
+  struct MappedFile *next;
+} MappedFile;
+
 // database container for tables and metadata
 typedef struct {
   // database-level metadata
@@ -85,6 +238,48 @@ typedef struct {
   // session event log for tracking operations
   // pointer to event log (NULL until first event or until initialised)
   EventLog *event_log;
+
+  // layout given to tables created when a file is loaded
+  TableLayout table_layout;
+
+  // checksum mode given to tables added to the database
+  ChecksumMode checksum_mode;
+
+  // whether tables added to the database get a trigram index over names
+  bool name_index;
+
+  // whether tables added to the database get programme and mark bitmaps
+  bool filter_index;
+
+  // whether ADV QUERY may build a table's sorted views to answer MARK and ID
+  // intervals; views built by sorting are searched either way
+  bool range_index;
+
+  // positions a table query must read before ADV QUERY splits them into
+  // morsels pulled by worker threads (0 keeps every query on the calling
+  // thread), and how many workers pull them (0 for one per processor)
+  size_t query_parallel_rows;
+  size_t query_workers;
+
+  // storage for loaded tables; reset (not freed) when the database is
+  // cleared so the next load reuses its blocks
+  Arena arena;
+
+  // snapshot files whose records are used in place; unmapped when the
+  // database is cleared
+  MappedFile *mapped_files;
+
+  // change journal of the loaded file (NULL if changes are not journaled);
+  // closed when the database is cleared
+  Journal *journal;
+
+  // mutations of tables since unloaded, plus one per table added or
+  // cleared, so db_mutation_count never repeats a value
+  uint64_t mutation_base;
+
+  // results of recent ADV QUERY pipelines (NULL unless enabled with
+  // db_set_query_cache); emptied when the database is cleared
+  QueryCache *query_cache;
 } StudentDatabase;
 
 // table lifecycle
@@ -95,6 +290,17 @@ typedef struct {
  */
 StudentTable *table_init(const char *table_name);
 
+/**
+ * @brief creates a new empty table whose storage comes from an arena
+ * @param[in,out] arena arena to allocate from (NULL behaves like table_init)
+ * @param[in] table_name name for the new table
+ * @return pointer to newly created StudentTable on success, NULL on failure
+ * @note the table stays valid until the arena is reset or freed;
+ *       table_free must still be called to release its heap-allocated
+ *       index, dictionary and views
+ */
+StudentTable *table_init_in_arena(Arena *arena, const char *table_name);
+
 /**
  * @brief frees all memory associated with a table
  * @param[in] table pointer to the table to free (can be NULL)
@@ -107,26 +313,155 @@ void table_free(StudentTable *table);
  * @param[in] headers array of header strings
  * @param[in] count number of headers in the array
  * @return DB_SUCCESS on success, appropriate error code on failure
+ * @note headers must be heap-allocated; a table in an arena copies them into
+ *       the arena and frees the originals
  */
 DBStatus table_set_column_headers(StudentTable *table, char **headers,
                                   size_t count);
 
+/**
+ * @brief grows a table's storage so it can hold at least capacity slots
+ * @param[in,out] table pointer to the table
+ * @param[in] capacity number of record slots required
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ * @note lets loaders size storage once instead of doubling per add
+ */
+DBStatus table_reserve(StudentTable *table, size_t capacity);
+
 /**
  * @brief adds a record to the table (grows capacity if needed)
  * @param[in,out] table pointer to the table to add the record to
  * @param[in] record pointer to the student record to add
- * @return DB_SUCCESS on success, DB_ERROR_MEMORY if reallocation fails
+ * @return DB_SUCCESS on success, DB_ERROR_DUPLICATE_ID if the id already
+ *         exists, DB_ERROR_MEMORY if reallocation fails
  */
 DBStatus table_add_record(StudentTable *table, StudentRecord *record);
 
+/**
+ * @brief adds a record whose checksum the caller has already computed
+ * @param[in,out] table pointer to the table to add the record to
+ * @param[in] record pointer to the student record to add
+ * @param[in] hash compute_record_hash of the record in the table's
+ *                 checksum mode
+ * @return as table_add_record
+ * @note lets loaders hash records on the threads that parse them
+ */
+DBStatus table_add_hashed_record(StudentTable *table, StudentRecord *record,
+                                 unsigned long hash);
+
 /**
  * @brief removes a record from the table by student id
  * @param[in,out] table pointer to the table to remove the record from
  * @param[in] student_id id of the student record to remove
- * @return DB_SUCCESS on success, DB_ERROR_NOT_FOUND if record not found
+ * @return DB_SUCCESS on success, DB_ERROR_NOT_FOUND if record not found,
+ *         DB_ERROR_MEMORY if the tombstone bitset cannot be allocated
+ * @note the record's slot is tombstoned rather than shifted out; slots are
+ *       purged once tombstones pass 1 in TOMBSTONE_PURGE_RATIO
  */
 DBStatus table_remove_record(StudentTable *table, int student_id);
 
+/**
+ * @brief finds a record by student id using the table's id index
+ * @param[in] table pointer to the table to search
+ * @param[in] student_id id of the student record to find
+ * @return pointer to the matching record, NULL if not found
+ * @note the pointer is invalidated by any later add, remove or compaction
+ * @note row layout only (always NULL for column layout); use
+ *       table_find_position and table_read_record for either layout
+ */
+StudentRecord *table_find_record(StudentTable *table, int student_id);
+
+/**
+ * @brief finds the position of a record by student id
+ * @param[in] table pointer to the table to search
+ * @param[in] student_id id of the student record to find
+ * @return record position, ID_INDEX_NOT_FOUND if not found
+ */
+size_t table_find_position(const StudentTable *table, int student_id);
+
+/**
+ * @brief copies the record at a position out of the table
+ * @param[in] table pointer to the table
+ * @param[in] position record position (below slot_count)
+ * @param[out] out receives a copy of the record
+ * @return DB_SUCCESS on success, DB_ERROR_NOT_FOUND if position is invalid
+ *         or holds a deleted record
+ */
+DBStatus table_read_record(const StudentTable *table, size_t position,
+                           StudentRecord *out);
+
+/**
+ * @brief converts a table between row and column layout
+ * @param[in,out] table pointer to the table
+ * @param[in] layout layout to convert to
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails (the
+ *         table is left in its original layout)
+ * @note tombstones are purged first; otherwise positions, the id index and
+ *       sorted views are unaffected
+ */
+DBStatus table_set_layout(StudentTable *table, TableLayout layout);
+
+/**
+ * @brief switches how a table's records are hashed for change detection
+ * @param[in,out] table pointer to the table
+ * @param[in] mode checksum mode to use
+ * @note recomputes record_checksum from the live records if the mode
+ *       changes
+ */
+void table_set_checksum_mode(StudentTable *table, ChecksumMode mode);
+
+/**
+ * @brief builds or drops the trigram index over a table's names
+ * @param[in,out] table pointer to the table
+ * @param[in] enabled true to index the names, false to drop the index
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the index cannot be
+ *         built (the table is left without one)
+ * @note an index that later cannot grow is dropped, and GREP NAME scans
+ *       every name again
+ */
+DBStatus table_set_name_index(StudentTable *table, bool enabled);
+
+/**
+ * @brief builds or drops the programme and mark band bitmaps of a table
+ * @param[in,out] table pointer to the table
+ * @param[in] enabled true to build the bitmaps, false to drop them
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the bitmaps cannot be
+ *         built (the table is left without them)
+ * @note bitmaps that later cannot grow are dropped, and ADV QUERY compares
+ *       every record again
+ */
+DBStatus table_set_filter_index(StudentTable *table, bool enabled);
+
+/**
+ * @brief returns the widest rendering of each displayed field
+ * @param[in,out] table pointer to the table
+ * @return widths over the live records (all zero for an empty table), NULL
+ *         if table is NULL
+ * @note recounts from the records only if the last record at a maximum was
+ *       removed since the previous call; otherwise O(1)
+ */
+const DisplayWidths *table_display_widths(StudentTable *table);
+
+/**
+ * @brief rebuilds the id index, programme codes and any built views from
+ *        the records
+ * @param[in,out] table pointer to the table whose index to rebuild
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ * @note must be called after records are reordered in place (e.g. sorting)
+ */
+DBStatus table_rebuild_index(StudentTable *table);
+
+/**
+ * @brief removes every tombstoned slot, moving live records down so
+ *        positions are dense again
+ * @param[in,out] table pointer to the table
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if scratch memory cannot be
+ *         allocated (the table is left unchanged)
+ * @note storage order of live records is preserved; the id index, programme
+ *       codes and sorted views are remapped
+ */
+DBStatus table_purge_tombstones(StudentTable *table);
+
 // database lifecycle
 /**
  * @brief creates a new empty database
@@ -140,30 +475,48 @@ StudentDatabase *db_init(void);
  */
 void db_free(StudentDatabase *db);
 
+/**
+ * @brief unloads every table and resets the database's arena for reuse
+ * @param[in,out] db pointer to the database to clear
+ * @note metadata, the event log and the table layout are kept; the arena's
+ *       blocks stay allocated for the next load, mapped snapshot files are
+ *       closed and the journal is closed without saving
+ */
+void db_clear(StudentDatabase *db);
+
 /**
  * @brief adds a table to the database (grows capacity if needed)
  * @param[in,out] db pointer to the database to add the table to
  * @param[in] table pointer to the table to add
  * @return DB_SUCCESS on success, DB_ERROR_MEMORY if reallocation fails
+ * @note the table takes the database's checksum mode
  */
 DBStatus db_add_table(StudentDatabase *db, StudentTable *table);
 
 // file operations
 /**
- * @brief loads database from a text file
+ * @brief loads database from a text file or binary snapshot
  * @param[in,out] db pointer to the database to load data into
  * @param[in] filename path to the file to load
  * @param[out] stats optional pointer to ParsingStats structure (can be NULL)
  * @return DB_SUCCESS on success, appropriate error code on failure
  * @note if stats is provided, it will be populated with parsing statistics
+ * @note files ending in SNAPSHOT_EXTENSION are read as snapshots
+ * @note on success db->file_loaded_checksum holds the file's CRC32, taken
+ *       from the bytes as they are loaded rather than by reading them again
  */
 DBStatus db_load(StudentDatabase *db, const char *filename, void *stats);
 
 /**
- * @brief saves database to a text file
+ * @brief saves database to a text file or binary snapshot
  * @param[in] db pointer to the database to save
  * @param[in] filename path to the file to save to
  * @return DB_SUCCESS on success, appropriate error code on failure
+ * @note files ending in SNAPSHOT_EXTENSION are written as snapshots
+ * @note db->file_loaded_checksum is set from the bytes as they are written,
+ *       so the saved file is not read back
+ * @note the file is replaced atomically and synced to disk before db_save
+ *       returns
  */
 DBStatus db_save(StudentDatabase *db, const char *filename);
 
@@ -187,4 +540,23 @@ const char *db_status_string(DBStatus status);
 DBStatus db_update_record(StudentDatabase *db, int id, const char *new_name,
                           const char *new_prog, const float *new_mark);
 
+/**
+ * @brief returns a count that changes whenever any table's records, their
+ *        positions or its active view change, or tables are added or
+ *        unloaded
+ * @param[in] db pointer to the database
+ * @return mutation count (0 if db is NULL); it only ever grows
+ */
+uint64_t db_mutation_count(const StudentDatabase *db);
+
+/**
+ * @brief enables, resizes or disables the ADV QUERY result cache
+ * @param[in,out] db pointer to the database
+ * @param[in] capacity most bytes the cached results may hold (0 disables
+ *                     the cache and frees it)
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the cache cannot be
+ *         created
+ */
+DBStatus db_set_query_cache(StudentDatabase *db, size_t capacity);
+
 #endif // DATABASE_H
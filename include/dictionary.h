@@ -0,0 +1,95 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+/**
+ * @file dictionary.h
+ * @brief string dictionary for dictionary-encoded columns
+ *
+ * interns strings that repeat heavily across records (programmes) so each
+ * distinct value is stored once and records hold a small integer code.
+ * codes are dense (0 .. count - 1) and stable until the dictionary is
+ * cleared, which lets predicates be evaluated once per distinct value and
+ * then applied to records as an array lookup. codes whose last record went
+ * away stay interned, so rebuilding the table's codes is what trims them.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// initial number of hash buckets (must be a power of two)
+#define DICTIONARY_INITIAL_BUCKETS 16
+
+// sentinel returned when a string has no code
+#define DICTIONARY_NOT_FOUND UINT32_MAX
+
+// distinct strings addressed by code, with a hash from string to code
+typedef struct {
+  char **entries;      // entries[code] is the interned string
+  uint32_t *refs;      // number of records currently using each code
+  uint32_t count;      // number of codes handed out
+  uint32_t capacity;   // allocated entries
+  uint32_t *buckets;   // open-addressing buckets holding code + 1 (0 = empty)
+  size_t bucket_count; // number of buckets (power of two)
+} StringDictionary;
+
+/**
+ * @brief returns the string for a code
+ * @param[in] dict pointer to the dictionary
+ * @param[in] code code returned by dictionary_intern (below count)
+ * @return pointer to the interned NUL-terminated string
+ */
+static inline const char *dictionary_get(const StringDictionary *dict,
+                                         uint32_t code) {
+  return dict->entries[code];
+}
+
+/**
+ * @brief initialises an empty dictionary (no memory is allocated)
+ * @param[out] dict pointer to the dictionary to initialise
+ */
+void dictionary_init(StringDictionary *dict);
+
+/**
+ * @brief frees all memory held by a dictionary
+ * @param[in,out] dict pointer to the dictionary to free (can be NULL)
+ */
+void dictionary_free(StringDictionary *dict);
+
+/**
+ * @brief removes every entry while keeping the allocated arrays
+ * @param[in,out] dict pointer to the dictionary to clear
+ * @note all previously returned codes become invalid
+ */
+void dictionary_clear(StringDictionary *dict);
+
+/**
+ * @brief looks up the code of a string without adding it
+ * @param[in] dict pointer to the dictionary
+ * @param[in] text string to look up (exact, case-sensitive)
+ * @return code of the string, DICTIONARY_NOT_FOUND if it is not interned
+ */
+uint32_t dictionary_find(const StringDictionary *dict, const char *text);
+
+/**
+ * @brief returns the code for a string, adding it if needed, and counts
+ *        one more record using it
+ * @param[in,out] dict pointer to the dictionary
+ * @param[in] text string to intern
+ * @param[out] code receives the string's code
+ * @return true on success, false if memory allocation fails
+ */
+bool dictionary_intern(StringDictionary *dict, const char *text,
+                       uint32_t *code);
+
+/**
+ * @brief counts one fewer record using a code
+ * @param[in,out] dict pointer to the dictionary
+ * @param[in] code code previously returned by dictionary_intern
+ * @note the entry itself is kept so the code stays valid
+ */
+void dictionary_release(StringDictionary *dict, uint32_t code);
+
+#endif // DICTIONARY_H
@@ -0,0 +1,78 @@
+#ifndef DISPLAY_WIDTHS_H
+#define DISPLAY_WIDTHS_H
+
+/**
+ * @file display_widths.h
+ * @brief column widths of a table's records, kept as records change
+ *
+ * tracks the widest rendering of each displayed field (the id, the name,
+ * the programme and the mark with two decimals) over a table's live
+ * records, so SHOW ALL can lay out its columns without measuring every
+ * record first. each maximum carries the number of records at that width;
+ * removing a record only forces a recount once the last record at a
+ * maximum is gone, and the recount is left until the widths are next read.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// fields shown by SHOW ALL, in column order
+typedef enum {
+  DISPLAY_FIELD_ID = 0,
+  DISPLAY_FIELD_NAME,
+  DISPLAY_FIELD_PROG,
+  DISPLAY_FIELD_MARK,
+  DISPLAY_FIELD_COUNT
+} DisplayField;
+
+typedef struct {
+  size_t max[DISPLAY_FIELD_COUNT];    // widest rendering of each field
+  size_t at_max[DISPLAY_FIELD_COUNT]; // live records at that width
+  bool stale; // a maximum lost its last record; recount before use
+} DisplayWidths;
+
+/**
+ * @brief empties the widths, as for a table with no records
+ * @param[out] widths widths to reset
+ */
+void display_widths_reset(DisplayWidths *widths);
+
+/**
+ * @brief measures the rendered width of each field of a record
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] prog programme
+ * @param[in] mark student mark
+ * @param[out] out width of each field, indexed by DisplayField
+ * @note widths are those of printf's "%d", "%s" and "%.2f"
+ */
+void display_widths_measure(int id, const char *name, const char *prog,
+                            float mark, size_t out[DISPLAY_FIELD_COUNT]);
+
+/**
+ * @brief accounts for a record added to the table
+ * @param[in,out] widths widths to update
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] prog programme
+ * @param[in] mark student mark
+ * @note does nothing while the widths are stale
+ */
+void display_widths_add(DisplayWidths *widths, int id, const char *name,
+                        const char *prog, float mark);
+
+/**
+ * @brief accounts for a record removed from the table
+ * @param[in,out] widths widths to update
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] prog programme
+ * @param[in] mark student mark
+ * @note marks the widths stale if the record was the last at a maximum
+ */
+void display_widths_remove(DisplayWidths *widths, int id, const char *name,
+                           const char *prog, float mark);
+
+#endif // DISPLAY_WIDTHS_H
@@ -0,0 +1,52 @@
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+/**
+ * @file file_map.h
+ * @brief read-only view of a whole file for in-place parsing
+ *
+ * maps a file into memory so loaders can scan its bytes where they lie
+ * instead of copying lines into buffers. on posix systems the file is
+ * mmap'd; elsewhere (the windows build) it is read into one heap buffer,
+ * which callers cannot tell apart. the bytes are not NUL-terminated.
+ * private maps can also be written to, which lets binary snapshots be used
+ * as table storage in place.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// contents of an opened file
+typedef struct {
+  const char *data; // first byte of the file (NULL for an empty file)
+  size_t size;      // file size in bytes
+  bool mapped;      // true if data is an mmap'd region, false if heap
+} FileMap;
+
+/**
+ * @brief opens a file and makes its whole contents readable in memory
+ * @param[in] path path of the file to open
+ * @param[out] map receives the file's contents
+ * @return true on success, false if the file cannot be opened or read
+ */
+bool file_map_open(const char *path, FileMap *map);
+
+/**
+ * @brief opens a file whose in-memory copy may be modified
+ * @param[in] path path of the file to open
+ * @param[out] map receives the file's contents
+ * @return true on success, false if the file cannot be opened or read
+ * @note pages are copy-on-write: writes through map->data stay private to
+ *       the process and never reach the file
+ */
+bool file_map_open_private(const char *path, FileMap *map);
+
+/**
+ * @brief releases the memory behind a file map
+ * @param[in,out] map pointer to the map to close (can be NULL)
+ */
+void file_map_close(FileMap *map);
+
+#endif // FILE_MAP_H
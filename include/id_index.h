@@ -0,0 +1,96 @@
+#ifndef ID_INDEX_H
+#define ID_INDEX_H
+
+/**
+ * @file id_index.h
+ * @brief student id index for constant-time record lookup
+ *
+ * maps student ids to record positions within a table. while every id lies
+ * inside MIN_STUDENT_ID..MAX_STUDENT_ID the index is a direct-address slot
+ * table (one slot per possible id). if an id outside that range is added, or
+ * the range is widened beyond ID_INDEX_DIRECT_LIMIT, the index falls back to
+ * an open-addressing hash table with linear probing.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// largest id range served by the direct-address slot table
+#define ID_INDEX_DIRECT_LIMIT (1u << 22)
+
+// initial capacity of the hash fallback (must be a power of two)
+#define ID_INDEX_INITIAL_HASH_CAPACITY 64
+
+// sentinel returned when an id is not present
+#define ID_INDEX_NOT_FOUND ((size_t)-1)
+
+// storage strategy currently used by the index
+typedef enum {
+  ID_INDEX_DIRECT = 0, // one slot per id in the valid student id range
+  ID_INDEX_HASH        // open-addressing hash table for arbitrary ids
+} IdIndexMode;
+
+// id to record position index
+typedef struct {
+  IdIndexMode mode;
+
+  // direct-address storage: slots[id - MIN_STUDENT_ID] holds position + 1
+  // (0 marks an empty slot); allocated lazily on first insert
+  uint32_t *slots;
+
+  // hash storage: parallel key/value arrays, value 0 marks an empty bucket
+  int *keys;
+  uint32_t *values;
+  size_t capacity; // number of buckets (power of two)
+
+  size_t count; // number of ids currently indexed
+} IdIndex;
+
+/**
+ * @brief initialises an empty index (no memory is allocated until first use)
+ * @param[out] index pointer to the index to initialise
+ */
+void id_index_init(IdIndex *index);
+
+/**
+ * @brief frees all memory held by an index
+ * @param[in,out] index pointer to the index to free (can be NULL)
+ */
+void id_index_free(IdIndex *index);
+
+/**
+ * @brief removes every entry while keeping the allocated storage
+ * @param[in,out] index pointer to the index to clear
+ */
+void id_index_clear(IdIndex *index);
+
+/**
+ * @brief records the position of an id
+ * @param[in,out] index pointer to the index
+ * @param[in] id student id to insert
+ * @param[in] position record position associated with the id
+ * @return true on success, false if memory allocation fails
+ * @note an existing entry for the same id is overwritten
+ */
+bool id_index_insert(IdIndex *index, int id, size_t position);
+
+/**
+ * @brief looks up the record position of an id
+ * @param[in] index pointer to the index
+ * @param[in] id student id to look up
+ * @return record position, or ID_INDEX_NOT_FOUND if the id is not indexed
+ */
+size_t id_index_find(const IdIndex *index, int id);
+
+/**
+ * @brief removes an id from the index
+ * @param[in,out] index pointer to the index
+ * @param[in] id student id to remove
+ * @return true if the id was present, false otherwise
+ */
+bool id_index_remove(IdIndex *index, int id);
+
+#endif // ID_INDEX_H
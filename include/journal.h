@@ -0,0 +1,141 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/**
+ * @file journal.h
+ * @brief append-only change journal kept beside a database file
+ *
+ * INSERT, UPDATE, DELETE and SORT record compact binary entries instead of
+ * waiting for SAVE to rewrite the whole file. entries collect in memory
+ * until SAVE, which appends them to "<file>.journal" as one group closed by
+ * a commit marker and flushes it with a single fsync. OPEN replays every
+ * committed group on top of the database file (the last checkpoint). once
+ * the journal passes JOURNAL_CHECKPOINT_BYTES, SAVE rewrites the database
+ * file instead and deletes the journal.
+ *
+ * file layout: a header (magic "CMSJ", version, CRC32 of the database file
+ * the journal applies to), then entries of a 4-byte payload length, a type
+ * byte and the payload. integers are little-endian. a commit entry carries
+ * the CRC32 of its group; a group that is torn or fails its CRC is dropped
+ * along with everything after it. a committed group is decoded in full
+ * before any entry is applied; if it cannot be read, or an entry cannot be
+ * applied, replay stops and the next SAVE checkpoints rather than cut off
+ * the committed groups that follow. a journal whose base CRC does not match
+ * the database file (e.g. the file was checkpointed or replaced) is
+ * discarded.
+ *
+ * entries apply to the student records table (the first table).
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "database.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// appended to the database file name to name its journal
+#define JOURNAL_EXTENSION ".journal"
+
+#define JOURNAL_MAGIC "CMSJ"
+#define JOURNAL_VERSION 1
+
+// SAVE checkpoints (rewrites the database file) once the journal would
+// grow past this many bytes
+#define JOURNAL_CHECKPOINT_BYTES (1024 * 1024)
+
+// journal entry types
+typedef enum {
+  JOURNAL_INSERT = 1, // id, mark, name, programme
+  JOURNAL_UPDATE,     // id, field flags, changed fields
+  JOURNAL_DELETE,     // id
+  JOURNAL_VIEW,       // active view (SORT)
+  JOURNAL_COMPACT,    // records reordered to the active view (SORT C)
+  JOURNAL_COMMIT,     // CRC32 of the entries since the previous commit
+} JournalEntryType;
+
+// open journal of a loaded database
+struct Journal {
+  char path[MAX_FILE_PATH + sizeof JOURNAL_EXTENSION];
+  unsigned long base_checksum; // CRC32 of the database file
+  long committed_size;         // bytes of valid, committed journal
+  unsigned char *pending;      // encoded entries awaiting the next SAVE
+  size_t pending_size;
+  size_t pending_capacity;
+  size_t pending_entries;
+  bool needs_checkpoint; // an entry was lost or replay stopped early, so
+                         // SAVE must rewrite the file
+};
+
+/**
+ * @brief opens the journal of a database file and replays it
+ * @param[in,out] db database just loaded from db_path
+ * @param[in] db_path path the database was loaded from
+ * @param[out] replayed optional count of entries applied (can be NULL)
+ * @return pointer to the journal, NULL if memory runs out (saves then
+ *         rewrite the whole file)
+ * @note db->file_loaded_checksum must hold the CRC32 of db_path; a journal
+ *       with a different base is discarded with a warning
+ * @note if a committed group cannot be decoded or applied, replay stops and
+ *       the journal is flagged so the next save checkpoints
+ */
+Journal *journal_open(StudentDatabase *db, const char *db_path,
+                      size_t *replayed);
+
+/**
+ * @brief closes a journal, dropping entries that were never saved
+ * @param[in] journal pointer to the journal (can be NULL)
+ */
+void journal_close(Journal *journal);
+
+/**
+ * @brief records an inserted record
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] record the record as added
+ */
+void journal_log_insert(Journal *journal, const StudentRecord *record);
+
+/**
+ * @brief records an update of a record's fields
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] id student id of the updated record
+ * @param[in] name new name (NULL if unchanged)
+ * @param[in] prog new programme (NULL if unchanged)
+ * @param[in] mark pointer to new mark (NULL if unchanged)
+ */
+void journal_log_update(Journal *journal, int id, const char *name,
+                        const char *prog, const float *mark);
+
+/**
+ * @brief records a deleted record
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] id student id of the deleted record
+ */
+void journal_log_delete(Journal *journal, int id);
+
+/**
+ * @brief records a change of the active view
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] view the view now active
+ */
+void journal_log_view(Journal *journal, TableView view);
+
+/**
+ * @brief records that the records were reordered to the active view
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ */
+void journal_log_compact(Journal *journal);
+
+/**
+ * @brief saves a database: commits its journal, or checkpoints
+ * @param[in,out] db pointer to the loaded database
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ * @note without a journal, or once the journal would pass
+ *       JOURNAL_CHECKPOINT_BYTES, the database file is rewritten with
+ *       db_save and the journal deleted; otherwise the pending entries are
+ *       appended as one group and flushed with one fsync
+ * @note if the journal file cannot be opened, the save falls back to a
+ *       checkpoint
+ */
+DBStatus journal_save(StudentDatabase *db);
+
+#endif // JOURNAL_H
@@ -0,0 +1,78 @@
+#ifndef MARK_KERNELS_H
+#define MARK_KERNELS_H
+
+/**
+ * @file mark_kernels.h
+ * @brief vectorised scans over a contiguous column of marks
+ *
+ * selects the positions whose mark passes a MARK comparison and reduces a
+ * run of marks to its sum, minimum and maximum. each kernel has a scalar
+ * version and, on x86, SSE2 and AVX2 versions; the widest one the processor
+ * supports is chosen the first time a kernel runs. every level gives the
+ * same selections and extremes; sums may differ in the last bits since
+ * lanes are added in a different order.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stddef.h>
+
+typedef enum {
+  MARK_KERNEL_SCALAR = 0, // plain C, any processor
+  MARK_KERNEL_SSE2,       // 4 marks per instruction
+  MARK_KERNEL_AVX2        // 8 marks per instruction
+} MarkKernelLevel;
+
+typedef struct {
+  double sum;       // sum of the marks, accumulated in double
+  float min;        // lowest mark
+  float max;        // highest mark
+  size_t min_index; // first index holding the lowest mark
+  size_t max_index; // first index holding the highest mark
+} MarkSummary;
+
+/**
+ * @brief returns the kernel level in use, detecting it on first call
+ * @return widest level supported by the processor, unless overridden
+ */
+MarkKernelLevel mark_kernels_level(void);
+
+/**
+ * @brief selects the kernel level used from now on
+ * @param[in] level level wanted
+ * @return level in effect: the one wanted, or the widest supported below it
+ * @note for tests and benchmarks; must not race with running kernels
+ */
+MarkKernelLevel mark_kernels_set_level(MarkKernelLevel level);
+
+/**
+ * @brief returns a printable name for a kernel level
+ * @param[in] level kernel level
+ * @return "scalar", "sse2" or "avx2"
+ */
+const char *mark_kernels_level_name(MarkKernelLevel level);
+
+/**
+ * @brief selects the marks passing a MARK comparison
+ * @param[in] marks contiguous marks to scan
+ * @param[in] count number of marks
+ * @param[in] first position of marks[0], added to every selected index
+ * @param[in] op comparison: '<', '>' or '='
+ * @param[in] value value each mark is compared with, as (double)mark op value
+ * @param[out] out positions of passing marks, in order (count entries max)
+ * @return number of positions written
+ */
+size_t mark_kernel_select(const float *marks, size_t count, size_t first,
+                          char op, double value, size_t *out);
+
+/**
+ * @brief reduces a run of marks to their sum and extremes
+ * @param[in] marks contiguous marks to scan
+ * @param[in] count number of marks (at least 1)
+ * @param[out] out sum, extremes and the first index of each extreme
+ * @note marks are expected to be numbers; NaN marks give unspecified extremes
+ */
+void mark_kernel_summarise(const float *marks, size_t count,
+                           MarkSummary *out);
+
+#endif // MARK_KERNELS_H
@@ -0,0 +1,50 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/**
+ * @file parallel.h
+ * @brief worker thread helpers for data-parallel operations
+ *
+ * runs a task once per argument block on a set of worker threads and waits
+ * for all of them to finish. used by the sorting engine and other bulk
+ * operations that split their input into independent chunks. falls back to
+ * running tasks on the calling thread if threads cannot be created.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// upper bound on worker threads used by any single operation
+#define MAX_WORKER_THREADS 16
+
+// task executed by a worker; receives a pointer to its own argument block
+typedef void (*ParallelTask)(void *arg);
+
+/**
+ * @brief returns the number of online processors (at least 1)
+ * @return processor count reported by the operating system
+ */
+size_t parallel_cpu_count(void);
+
+/**
+ * @brief chooses how many workers to use for a job
+ * @param[in] item_count number of items to process
+ * @param[in] min_items_per_worker smallest chunk worth giving to a thread
+ * @return worker count between 1 and MAX_WORKER_THREADS
+ */
+size_t parallel_worker_count(size_t item_count, size_t min_items_per_worker);
+
+/**
+ * @brief runs task on each argument block and waits for completion
+ * @param[in] task function to run for every block
+ * @param[in,out] args array of argument blocks
+ * @param[in] arg_size size in bytes of one argument block
+ * @param[in] count number of argument blocks (one worker per block)
+ * @note the calling thread runs the first block itself
+ */
+void parallel_run(ParallelTask task, void *args, size_t arg_size,
+                  size_t count);
+
+#endif // PARALLEL_H
@@ -14,6 +14,12 @@
 
 #include "database.h"
 
+// smallest share of a record section worth parsing on its own thread
+#define PARSE_MIN_WORKER_BYTES (256 * 1024)
+
+// most bytes each worker parses per pass; bounds the per-thread buffers
+#define PARSE_MAX_WORKER_BYTES (4 * 1024 * 1024)
+
 typedef enum {
   VALID_RECORD = 0,        // record is valid
   INVALID_ID_RANGE,        // id outside MIN_STUDENT_ID-MAX_STUDENT_ID
@@ -46,6 +52,13 @@ typedef struct {
  * @param[out] stats optional pointer to statistics structure (can be NULL)
  * @return DB_SUCCESS on success, appropriate error code on failure
  * @note if stats is provided, it will be populated with parsing statistics
+ * @note the file is mapped and scanned in place; record lines of any length
+ *       are parsed without being copied, and each table's storage is sized
+ *       once from the number of lines that follow it
+ * @note large record sections are parsed on worker threads and merged in
+ *       file order, so warnings and statistics match a serial load
+ * @note on success db->file_loaded_checksum is set to the file's CRC32,
+ *       computed over the mapped bytes as they are parsed
  */
 DBStatus parse_file(const char *filename, StudentDatabase *db,
                     ParseStatistics *stats);
@@ -59,6 +72,19 @@ DBStatus parse_file(const char *filename, StudentDatabase *db,
  */
 ParseStatus parse_metadata(const char *line, char *key, char *value);
 
+/**
+ * @brief parses one data record from a line that need not be NUL-terminated
+ * @param[in] line first byte of the line
+ * @param[in] length number of bytes in the line (a trailing newline and
+ *            carriage return are ignored)
+ * @param[out] record pointer to record structure to populate
+ * @return PARSE_SUCCESS on success, appropriate error code on failure
+ * @note reads the line in place without modifying it, so it is reentrant
+ *       and works directly on a mapped file
+ */
+ParseStatus parse_record_span(const char *line, size_t length,
+                              StudentRecord *record);
+
 /**
  * @brief parses single data record line into StudentRecord
  * @param[in] line input line containing student data
@@ -0,0 +1,101 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+/**
+ * @file query_cache.h
+ * @brief least-recently-used cache of ADV QUERY results
+ *
+ * keeps the matches of recent pipelines under their normalised text (see
+ * adv_query_select), together with the database's mutation count when they
+ * were found. an entry is only returned while that count is unchanged, so
+ * any insert, update, delete, sort or reload makes it stale. entries are
+ * kept most recently used first and the least recently used are evicted
+ * once the bytes held pass the cache's capacity.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "adv_query.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// capacity given to the interactive session's cache
+#define QUERY_CACHE_DEFAULT_BYTES (4u * 1024u * 1024u)
+
+// matches of one pipeline
+typedef struct QueryCacheEntry {
+  char *key;              // normalised pipeline
+  unsigned long hash;     // compute_fast_hash of key
+  uint64_t mutations;     // db_mutation_count when the matches were found
+  AdvQueryMatch *matches; // in the order adv_query_select returned them
+  size_t count;
+  size_t bytes; // entry, key and matches
+  struct QueryCacheEntry *prev;
+  struct QueryCacheEntry *next;
+} QueryCacheEntry;
+
+struct QueryCache {
+  QueryCacheEntry *head; // most recently used
+  QueryCacheEntry *tail; // least recently used
+  size_t count;          // entries held
+  size_t bytes;          // bytes held by the entries
+  size_t capacity;       // most bytes held before evicting
+  size_t hits;           // lookups answered
+  size_t misses;         // lookups finding no entry, or a stale one
+  size_t evictions;      // entries dropped to stay under capacity
+};
+
+/**
+ * @brief creates an empty cache
+ * @param[in] capacity most bytes the entries may hold
+ * @return pointer to the new cache, or NULL if memory allocation fails
+ */
+QueryCache *query_cache_create(size_t capacity);
+
+/**
+ * @brief frees a cache and every entry
+ * @param[in] cache pointer to the cache to free (can be NULL)
+ */
+void query_cache_free(QueryCache *cache);
+
+/**
+ * @brief drops every entry, keeping the counters and capacity
+ * @param[in,out] cache pointer to the cache (can be NULL)
+ */
+void query_cache_clear(QueryCache *cache);
+
+/**
+ * @brief changes the capacity, evicting entries until they fit
+ * @param[in,out] cache pointer to the cache
+ * @param[in] capacity most bytes the entries may hold
+ */
+void query_cache_set_capacity(QueryCache *cache, size_t capacity);
+
+/**
+ * @brief finds the matches of a pipeline
+ * @param[in,out] cache pointer to the cache
+ * @param[in] key normalised pipeline
+ * @param[in] mutations the database's current mutation count
+ * @return the entry (valid until the cache next changes), or NULL if there
+ *         is none or it is stale (a stale entry is dropped)
+ * @note counts a hit or a miss and makes a found entry the most recent
+ */
+const QueryCacheEntry *query_cache_lookup(QueryCache *cache, const char *key,
+                                          uint64_t mutations);
+
+/**
+ * @brief keeps a copy of the matches of a pipeline
+ * @param[in,out] cache pointer to the cache
+ * @param[in] key normalised pipeline
+ * @param[in] mutations the database's mutation count the matches are for
+ * @param[in] result matches to keep
+ * @return true if stored, false if the matches alone exceed the capacity or
+ *         memory allocation fails
+ * @note replaces any entry under the same key, then evicts the least
+ *       recently used entries until the cache is within capacity
+ */
+bool query_cache_store(QueryCache *cache, const char *key, uint64_t mutations,
+                       const AdvQueryResult *result);
+
+#endif // QUERY_CACHE_H
@@ -0,0 +1,74 @@
+#ifndef RECORD_FORMAT_H
+#define RECORD_FORMAT_H
+
+/**
+ * @file record_format.h
+ * @brief fast text formatting of record lines for saving
+ *
+ * renders the "%d\t%s\t%s\t%.2f\n" record lines of the text file format
+ * without printf. integers are written two digits at a time from a lookup
+ * table and marks are rounded to hundredths in integer arithmetic. the
+ * output is byte-identical to printf's; the rare values the fast path
+ * cannot represent exactly are handed to snprintf.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "constants.h"
+#include <stddef.h>
+
+// longest integer rendering: sign and ten digits
+#define FORMAT_INT_MAX 11
+
+// longest mark rendering, including snprintf's for huge floats
+#define FORMAT_MARK_MAX 64
+
+// line ending of saved text files. files are written in binary mode so the
+// checksum covers the bytes on disk, so the CRLF that text mode wrote on
+// Windows is spelled out
+#ifdef _WIN32
+#define TEXT_NEWLINE "\r\n"
+#else
+#define TEXT_NEWLINE "\n"
+#endif
+
+// longest record line, including its newline (no terminator is written)
+#define RECORD_LINE_MAX                                                        \
+  (FORMAT_INT_MAX + MAX_NAME_LENGTH + MAX_PROGRAMME_LENGTH + FORMAT_MARK_MAX + \
+   3 + sizeof TEXT_NEWLINE - 1)
+
+/**
+ * @brief writes an integer in decimal
+ * @param[out] out buffer of at least FORMAT_INT_MAX bytes
+ * @param[in] value integer to write
+ * @return number of bytes written (no terminator)
+ * @note matches printf("%d")
+ */
+size_t format_int(char *out, int value);
+
+/**
+ * @brief writes a mark with two decimal places
+ * @param[out] out buffer of at least FORMAT_MARK_MAX bytes
+ * @param[in] mark mark to write
+ * @return number of bytes written (no terminator)
+ * @note matches printf("%.2f") for every float, including exact halves
+ *       (rounded to even) and negative zero; infinities, NaN and values of
+ *       1e15 or more are formatted by snprintf
+ */
+size_t format_mark(char *out, float mark);
+
+/**
+ * @brief writes one record line of the text file format
+ * @param[out] out buffer of at least RECORD_LINE_MAX bytes
+ * @param[in] id student id
+ * @param[in] name student name (NUL-terminated, under MAX_NAME_LENGTH)
+ * @param[in] prog programme (NUL-terminated, under MAX_PROGRAMME_LENGTH)
+ * @param[in] mark student mark
+ * @return number of bytes written (no terminator)
+ * @note matches printf("%d\t%s\t%s\t%.2f\n") in a text-mode stream; the
+ *       line ends in TEXT_NEWLINE
+ */
+size_t format_record_line(char *out, int id, const char *name,
+                          const char *prog, float mark);
+
+#endif // RECORD_FORMAT_H
@@ -0,0 +1,137 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+/**
+ * @file roaring.h
+ * @brief compressed bitmaps of record positions (roaring-style containers)
+ *
+ * splits 32-bit positions by their high 16 bits into containers. a
+ * container holding up to ROARING_ARRAY_MAX positions is a sorted array of
+ * their low 16 bits; a fuller one is a 65536-bit bitset. sparse sets then
+ * cost 2 bytes per position and dense ones 1 bit, and intersections and
+ * unions work container by container, counting with popcount.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// most positions an array container holds before becoming a bitset
+#define ROARING_ARRAY_MAX 4096
+
+// 64-bit words in a bitset container
+#define ROARING_BITSET_WORDS 1024
+
+// representation of one container
+typedef enum {
+  ROARING_ARRAY = 0, // sorted uint16_t low bits
+  ROARING_BITSET     // ROARING_BITSET_WORDS words, bit per low value
+} RoaringKind;
+
+// positions sharing their high 16 bits
+typedef struct {
+  uint16_t key;         // high 16 bits
+  uint16_t kind;        // RoaringKind
+  uint32_t cardinality; // positions held
+  uint32_t capacity;    // array entries allocated (array containers)
+  void *data;           // uint16_t values or uint64_t words
+} RoaringContainer;
+
+// set of positions
+typedef struct {
+  RoaringContainer *containers; // ascending keys
+  uint32_t count;               // containers in use
+  uint32_t capacity;            // allocated containers
+} RoaringBitmap;
+
+/**
+ * @brief initialises an empty bitmap (no memory is allocated)
+ * @param[out] bitmap pointer to the bitmap to initialise
+ */
+void roaring_init(RoaringBitmap *bitmap);
+
+/**
+ * @brief frees all memory held by a bitmap, leaving it empty
+ * @param[in,out] bitmap pointer to the bitmap to free (can be NULL)
+ */
+void roaring_free(RoaringBitmap *bitmap);
+
+/**
+ * @brief adds a position
+ * @param[in,out] bitmap pointer to the bitmap
+ * @param[in] value position to add
+ * @return true on success (or if already present), false if memory
+ *         allocation fails
+ * @note adding in ascending order appends without moving anything
+ */
+bool roaring_add(RoaringBitmap *bitmap, uint32_t value);
+
+/**
+ * @brief removes a position (nothing happens if it is absent)
+ * @param[in,out] bitmap pointer to the bitmap
+ * @param[in] value position to remove
+ */
+void roaring_remove(RoaringBitmap *bitmap, uint32_t value);
+
+/**
+ * @brief checks whether a position is in a bitmap
+ * @param[in] bitmap pointer to the bitmap
+ * @param[in] value position to look for
+ * @return true if present
+ */
+bool roaring_contains(const RoaringBitmap *bitmap, uint32_t value);
+
+/**
+ * @brief returns the number of positions in a bitmap
+ * @param[in] bitmap pointer to the bitmap
+ * @return positions held
+ */
+size_t roaring_cardinality(const RoaringBitmap *bitmap);
+
+/**
+ * @brief adds every position of src to dst
+ * @param[in,out] dst bitmap to extend
+ * @param[in] src bitmap to add
+ * @return true on success, false if memory allocation fails (dst then
+ *         holds part of src)
+ */
+bool roaring_or_into(RoaringBitmap *dst, const RoaringBitmap *src);
+
+/**
+ * @brief computes the positions present in both bitmaps
+ * @param[in] a first bitmap
+ * @param[in] b second bitmap
+ * @param[out] out initialised bitmap receiving the intersection (emptied
+ *                 first)
+ * @return true on success, false if memory allocation fails
+ */
+bool roaring_and(const RoaringBitmap *a, const RoaringBitmap *b,
+                 RoaringBitmap *out);
+
+/**
+ * @brief counts the positions present in both bitmaps without building
+ *        their intersection
+ * @param[in] a first bitmap
+ * @param[in] b second bitmap
+ * @return size of the intersection
+ */
+size_t roaring_and_cardinality(const RoaringBitmap *a, const RoaringBitmap *b);
+
+/**
+ * @brief writes every position in ascending order
+ * @param[in] bitmap pointer to the bitmap
+ * @param[out] out array of at least roaring_cardinality(bitmap) entries
+ * @return positions written
+ */
+size_t roaring_to_array(const RoaringBitmap *bitmap, uint32_t *out);
+
+/**
+ * @brief returns the bytes a bitmap holds
+ * @param[in] bitmap pointer to the bitmap
+ * @return allocated bytes of its containers and their data
+ */
+size_t roaring_memory(const RoaringBitmap *bitmap);
+
+#endif // ROARING_H
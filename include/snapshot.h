@@ -0,0 +1,112 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/**
+ * @file snapshot.h
+ * @brief binary snapshot format for loading a database without parsing
+ *
+ * a snapshot holds a fixed header (with a CRC32 of the whole file), the
+ * database metadata, one descriptor per table, the column headers and each
+ * table's records as an array of StudentRecord structs, exactly as a row
+ * layout table keeps them in memory. loading maps the file copy-on-write
+ * and points each table's record storage straight at its array, so OPEN
+ * costs a map, a CRC pass and an index build instead of per-field parsing.
+ * the text format stays the interchange format; db_load and db_save pick
+ * the format from the file extension, so converting is a load and a save.
+ *
+ * snapshots are only portable between builds with the same byte order and
+ * StudentRecord layout; other files are rejected as invalid data.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "database.h"
+#include "parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// file name extension that selects the snapshot format
+#define SNAPSHOT_EXTENSION ".cmsb"
+
+#define SNAPSHOT_MAGIC "CMSB"
+#define SNAPSHOT_VERSION 1
+
+// written as a uint32_t; reads back differently on the other byte order
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+// record arrays start on a multiple of this many bytes
+#define SNAPSHOT_ALIGNMENT 16
+
+// fixed header at the start of every snapshot
+typedef struct {
+  char magic[4];        // SNAPSHOT_MAGIC (not NUL-terminated)
+  uint32_t version;     // SNAPSHOT_VERSION
+  uint32_t byte_order;  // SNAPSHOT_BYTE_ORDER as stored by the writer
+  uint32_t record_size; // sizeof(StudentRecord) of the writer
+  uint32_t crc;         // CRC32 of the file with this field zeroed
+  uint32_t table_count; // descriptors following the header
+  uint64_t file_size;   // total size of the file in bytes
+  char db_name[MAX_DB_NAME_LENGTH];
+  char authors[MAX_AUTHORS_LENGTH];
+} SnapshotHeader;
+
+// per-table descriptor; offsets are from the start of the file
+typedef struct {
+  char table_name[MAX_TABLE_NAME_LENGTH];
+  uint64_t column_count;
+  uint64_t headers_offset; // column_count NUL-terminated strings
+  uint64_t headers_size;
+  uint64_t record_count;
+  uint64_t records_offset; // record_count StudentRecord structs
+} SnapshotTable;
+
+/**
+ * @brief checks whether a file name selects the snapshot format
+ * @param[in] filename path to check
+ * @return true if filename ends in SNAPSHOT_EXTENSION
+ */
+bool snapshot_is_path(const char *filename);
+
+/**
+ * @brief loads a snapshot into a database
+ * @param[in,out] db pointer to the database to load into
+ * @param[in] filename path to the snapshot
+ * @param[out] stats optional pointer to statistics structure (can be NULL)
+ * @return DB_SUCCESS on success, DB_ERROR_FILE_NOT_FOUND if the file cannot
+ *         be opened, DB_ERROR_INVALID_DATA if it is not a valid snapshot for
+ *         this build, DB_ERROR_MEMORY if allocation fails
+ * @note row layout tables use the mapped records in place until they grow;
+ *       the mapping stays open until db_clear or db_free
+ * @note on success db->file_loaded_checksum is set to the file's CRC32,
+ *       taken in the same pass that verifies the snapshot
+ */
+DBStatus snapshot_load(StudentDatabase *db, const char *filename,
+                       ParseStatistics *stats);
+
+/**
+ * @brief writes every table of a database to a snapshot
+ * @param[in] db pointer to the database to save
+ * @param[in] filename path to the snapshot
+ * @param[out] file_checksum optional pointer to receive the CRC32 of the
+ *             written file, as compute_file_checksum would return it
+ * @return DB_SUCCESS on success, DB_ERROR_FILE_NOT_FOUND if the file cannot
+ *         be created, DB_ERROR_FILE_READ if writing fails
+ * @note records are written in each table's active view order, skipping
+ *       deleted slots; the file is written beside the target, synced and
+ *       renamed over it, so a snapshot still mapped by the database stays
+ *       intact and a crash never leaves a partial file
+ */
+DBStatus snapshot_save(const StudentDatabase *db, const char *filename,
+                       unsigned long *file_checksum);
+
+/**
+ * @brief converts a database file between the text and snapshot formats
+ * @param[in] source file to read (format chosen by its extension)
+ * @param[in] destination file to write (format chosen by its extension)
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ * @note changes committed to the source's journal are replayed first, as
+ *       OPEN does, so the destination holds every saved change
+ */
+DBStatus snapshot_convert(const char *source, const char *destination);
+
+#endif // SNAPSHOT_H
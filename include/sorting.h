@@ -6,13 +6,20 @@
  * @brief sorting module for student record ordering
  *
  * provides stable sorting of student records by ID or mark in ascending
- * or descending order using bubble sort algorithm.
+ * or descending order. records are keyed and ordered with an LSD radix sort
+ * (marks as fixed-point hundredths), with a stable merge sort fallback and a
+ * multi-threaded variant for large inputs.
  *
  * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
  */
 
 #include "database.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+// record count from which sort_records uses worker threads
+#define SORT_PARALLEL_THRESHOLD 262144
 
 // sort field options for student records
 typedef enum {
@@ -32,9 +39,73 @@ typedef enum {
  * @param[in] count number of records in the array
  * @param[in] field field to sort by (ID or mark)
  * @param[in] order sort order (ascending or descending)
- * @note uses stable bubble sort algorithm
+ * @note stable; tables above SORT_PARALLEL_THRESHOLD use worker threads
  */
 void sort_records(StudentRecord *records, size_t count, SortField field,
                   SortOrder order);
 
+/**
+ * @brief sorts student records with an explicit number of worker threads
+ * @param[in,out] records array of student records to sort (modified in-place)
+ * @param[in] count number of records in the array
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @param[in] workers number of worker threads (1 sorts on the calling thread)
+ * @note stable; equal keys keep their original relative order
+ */
+void sort_records_parallel(StudentRecord *records, size_t count,
+                           SortField field, SortOrder order, size_t workers);
+
+/**
+ * @brief computes the sorted order of records without moving them
+ * @param[in] records array of student records
+ * @param[in] count number of records in the array
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @param[out] positions receives count entries; positions[i] is the index of
+ *                       the record that sorts i-th
+ * @return true on success, false if working memory cannot be allocated
+ */
+bool sort_permutation(const StudentRecord *records, size_t count,
+                      SortField field, SortOrder order, uint32_t *positions);
+
+/**
+ * @brief computes the sorted order of contiguous id and mark columns
+ * @param[in] ids array of count student ids
+ * @param[in] marks array of count marks
+ * @param[in] count number of entries in each column
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @param[out] positions receives count entries; positions[i] is the index of
+ *                       the entry that sorts i-th
+ * @return true on success, false if working memory cannot be allocated
+ */
+bool sort_permutation_columns(const int *ids, const float *marks,
+                              size_t count, SortField field, SortOrder order,
+                              uint32_t *positions);
+
+/**
+ * @brief reorders records so position i holds the record previously at
+ *        positions[i]
+ * @param[in,out] records array of student records to reorder
+ * @param[in,out] perm permutation from sort_permutation (reset to the
+ *                     identity on return)
+ * @param[in] count number of records in the array
+ * @note follows permutation cycles so only one spare record is needed
+ */
+void sort_apply_permutation(StudentRecord *records, uint32_t *perm,
+                            size_t count);
+
+/**
+ * @brief compares two records in the order used by the sorting engine
+ * @param[in] a first record
+ * @param[in] b second record
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @return negative if a sorts first, positive if b sorts first, 0 if equal
+ * @note marks are tie-broken by ascending id in both orders
+ */
+int sort_compare_records(const StudentRecord *a, const StudentRecord *b,
+                         SortField field, SortOrder order);
+
 #endif // SORTING_H
@@ -46,6 +46,9 @@ typedef struct {
  * tie-breaking policy: when multiple students share the same highest or
  * lowest mark, the first occurrence in the table is reported.
  *
+ * in column layout the marks are reduced with the vector kernels of
+ * mark_kernels.h, which may add them in a different order.
+ *
  * @param table pointer to student table (must not be NULL)
  * @param stats pointer to statistics structure to populate (must not be NULL)
  * @return DB_SUCCESS on success
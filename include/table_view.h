@@ -0,0 +1,173 @@
+#ifndef TABLE_VIEW_H
+#define TABLE_VIEW_H
+
+/**
+ * @file table_view.h
+ * @brief non-destructive sorted views over a table's records
+ *
+ * keeps permutation indexes (arrays of record positions) ordered by id and
+ * by mark ascending/descending. the views are built in bulk with the sorting
+ * engine the first time they are needed and are then maintained incrementally
+ * by binary-search insertion whenever records are added, removed or updated,
+ * so switching the display order never moves the records themselves.
+ * physically reordering the records is an explicit compaction step.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "database.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// sentinel returned when a rank does not map to a record
+#define TABLE_VIEW_NOT_FOUND ((size_t)-1)
+
+/**
+ * @brief initialises empty, unbuilt views in storage order
+ * @param[out] table pointer to the table whose views to initialise
+ */
+void table_views_init(StudentTable *table);
+
+/**
+ * @brief frees the memory held by a table's views
+ * @param[in,out] table pointer to the table (can be NULL)
+ */
+void table_views_free(StudentTable *table);
+
+/**
+ * @brief builds (or rebuilds) every sorted view from the table's records
+ * @param[in,out] table pointer to the table
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ */
+DBStatus table_views_build(StudentTable *table);
+
+/**
+ * @brief returns a short description of a view ("mark descending" etc.)
+ * @param[in] view the view to describe
+ * @return pointer to a static string
+ */
+const char *table_view_name(TableView view);
+
+/**
+ * @brief selects the order used to display and save the table
+ * @param[in,out] table pointer to the table
+ * @param[in] view order to switch to (views are built on first use)
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the views cannot be built
+ * @note records are never moved; this is a constant-time switch once built
+ */
+DBStatus table_set_view(StudentTable *table, TableView view);
+
+/**
+ * @brief maps a rank within a view to a record position
+ * @param[in] table pointer to the table
+ * @param[in] view view to read (must be built unless TABLE_VIEW_STORAGE)
+ * @param[in] rank zero-based rank within the view
+ * @return record position, TABLE_VIEW_NOT_FOUND if rank is out of range or
+ *         the view has not been built
+ */
+size_t table_view_position(const StudentTable *table, TableView view,
+                           size_t rank);
+
+/**
+ * @brief returns the position of the record at a given rank of the active
+ *        view
+ * @param[in] table pointer to the table
+ * @param[in] rank zero-based rank (0 .. record_count - 1)
+ * @return record position, TABLE_VIEW_NOT_FOUND if rank is out of range
+ */
+size_t table_view_at(const StudentTable *table, size_t rank);
+
+/**
+ * @brief returns the next record position of the active view, for scanning
+ *        every live record in display order
+ * @param[in] table pointer to the table
+ * @param[in,out] cursor iteration state; start at 0
+ * @return record position, TABLE_VIEW_NOT_FOUND once every record was
+ *         returned
+ * @note tombstones are skipped; each call is O(1) amortised, unlike
+ *       table_view_at which must count live slots in stored order
+ */
+size_t table_view_next(const StudentTable *table, size_t *cursor);
+
+/**
+ * @brief returns the cursor value table_view_next reaches once it has
+ *        returned every record of the active view
+ * @param[in] table pointer to the table
+ * @return end of the cursor range: the slot count in stored order, the
+ *         record count in a sorted view
+ * @note scanning from one cursor value until the cursor passes a later one
+ *       visits a contiguous run of the view, so disjoint cursor ranges can
+ *       be scanned on separate threads
+ */
+size_t table_view_cursor_end(const StudentTable *table);
+
+/**
+ * @brief finds the ranks of ids within [min_id, max_id] in TABLE_VIEW_ID_ASC
+ * @param[in,out] table pointer to the table (views are built if needed)
+ * @param[in] min_id smallest id to include
+ * @param[in] max_id largest id to include
+ * @param[out] first rank of the first matching record
+ * @param[out] end rank one past the last matching record
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ */
+DBStatus table_id_range(StudentTable *table, int min_id, int max_id,
+                        size_t *first, size_t *end);
+
+/**
+ * @brief finds the ranks of marks within [min_mark, max_mark] in
+ *        TABLE_VIEW_MARK_ASC
+ * @param[in,out] table pointer to the table (views are built if needed)
+ * @param[in] min_mark smallest mark to include
+ * @param[in] max_mark largest mark to include
+ * @param[out] first rank of the first matching record
+ * @param[out] end rank one past the last matching record
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ */
+DBStatus table_mark_range(StudentTable *table, float min_mark, float max_mark,
+                          size_t *first, size_t *end);
+
+/**
+ * @brief physically reorders the records to match the active view
+ * @param[in,out] table pointer to the table
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ * @note afterwards storage order equals the former view and the active view
+ *       returns to TABLE_VIEW_STORAGE; the id index and views are remapped
+ */
+DBStatus table_compact(StudentTable *table);
+
+/**
+ * @brief grows view storage so it can hold capacity records
+ * @param[in,out] table pointer to the table
+ * @param[in] capacity number of records the views must be able to hold
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if reallocation fails
+ * @note no-op while the views are unbuilt
+ */
+DBStatus table_views_reserve(StudentTable *table, size_t capacity);
+
+/**
+ * @brief inserts the record at position into every view
+ * @param[in,out] table pointer to the table
+ * @param[in] position record position (already counted in record_count)
+ * @note views must hold record_count - 1 entries; no-op while unbuilt
+ */
+void table_views_link(StudentTable *table, size_t position);
+
+/**
+ * @brief removes the record at position from every view
+ * @param[in,out] table pointer to the table
+ * @param[in] position record position (still counted in record_count)
+ * @note views then hold record_count - 1 entries; no-op while unbuilt
+ */
+void table_views_unlink(StudentTable *table, size_t position);
+
+/**
+ * @brief rewrites every view entry p as new_position[p] after records were
+ *        moved without changing their relative order within each view
+ * @param[in,out] table pointer to the table
+ * @param[in] new_position new position of each old position
+ * @note no-op while unbuilt
+ */
+void table_views_remap(StudentTable *table, const uint32_t *new_position);
+
+#endif // TABLE_VIEW_H
@@ -0,0 +1,162 @@
+#ifndef TEXT_SEARCH_H
+#define TEXT_SEARCH_H
+
+/**
+ * @file text_search.h
+ * @brief case-insensitive substring search over lowercased shadow strings
+ *
+ * a FoldedText keeps an ASCII-lowercased copy of one string per record
+ * position, packed in a string pool like the column store's names, so GREP
+ * never folds case while it scans. a TextNeedle is a pattern folded once per
+ * query; on x86 it is found by comparing its first and last bytes against 16
+ * positions of the text at a time and verifying only the candidates both
+ * accept, elsewhere by strstr on the folded text. folding matches tolower in
+ * the "C" locale: only A-Z change.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include "column_store.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// longest needle found with vector compares; longer ones use strstr
+#define TEXT_NEEDLE_MAX 64
+
+// bytes kept readable after the last folded string, so a vector compare
+// for any needle up to TEXT_NEEDLE_MAX may read past the end of a string
+#define FOLDED_TEXT_PADDING (TEXT_NEEDLE_MAX + 16)
+
+// lowercased copy of one string per record position
+typedef struct {
+  uint32_t *offsets; // position -> offset of its folded string in text
+  size_t capacity;   // positions allocated in offsets
+  StringPool text;   // folded strings, followed by FOLDED_TEXT_PADDING bytes
+  Arena *arena;      // source of offsets and text (NULL for the heap)
+} FoldedText;
+
+// a pattern prepared for repeated searches
+typedef struct {
+  char *text;    // folded pattern (heap-allocated)
+  size_t length; // bytes in text
+} TextNeedle;
+
+/**
+ * @brief returns the folded string stored for a position
+ * @param[in] folded pointer to the folded text
+ * @param[in] position record position (set before)
+ * @return pointer to the NUL-terminated lowercased string
+ */
+static inline const char *folded_text_get(const FoldedText *folded,
+                                          size_t position) {
+  return string_pool_get(&folded->text, folded->offsets[position]);
+}
+
+/**
+ * @brief initialises an empty folded text (no memory is allocated)
+ * @param[out] folded pointer to the folded text to initialise
+ * @note it allocates from the heap until its arena field is set
+ */
+void folded_text_init(FoldedText *folded);
+
+/**
+ * @brief frees all memory held by a folded text
+ * @param[in,out] folded pointer to the folded text to free (can be NULL)
+ * @note keeps its arena, as column_store_free does
+ */
+void folded_text_free(FoldedText *folded);
+
+/**
+ * @brief grows the offsets so they cover at least positions entries
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] positions number of positions required
+ * @return true on success, false if memory allocation fails
+ */
+bool folded_text_reserve(FoldedText *folded, size_t positions);
+
+/**
+ * @brief ensures a string of length bytes can be stored without the pool
+ *        growing
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] length string length, excluding the terminator
+ * @return true on success, false if memory allocation fails
+ * @note lets a caller make room before changing anything else, so the
+ *       following folded_text_append or folded_text_replace cannot fail
+ */
+bool folded_text_reserve_text(FoldedText *folded, size_t length);
+
+/**
+ * @brief stores the folded copy of text for a new position
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] position position to set (below the reserved capacity)
+ * @param[in] text original string
+ * @return true on success, false if the pool cannot grow
+ */
+bool folded_text_append(FoldedText *folded, size_t position, const char *text);
+
+/**
+ * @brief replaces the folded copy stored for an existing position
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] position position already set
+ * @param[in] text new original string
+ * @return true on success, false if the pool cannot grow (the old copy
+ *         stays)
+ * @note a string that fits is overwritten in place; a longer one is appended
+ */
+bool folded_text_replace(FoldedText *folded, size_t position,
+                         const char *text);
+
+/**
+ * @brief copies the entry of position src over position dst
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] dst position to overwrite
+ * @param[in] src position to copy
+ * @note the overwritten string stays in the pool until folded_text_compact
+ */
+void folded_text_move(FoldedText *folded, size_t dst, size_t src);
+
+/**
+ * @brief rewrites the pool so it holds only the strings of positions below
+ *        count
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] count number of positions in use
+ * @return true on success, false if memory allocation fails (nothing is
+ *         lost; dead strings just stay)
+ */
+bool folded_text_compact(FoldedText *folded, size_t count);
+
+/**
+ * @brief folds a pattern once for repeated searches
+ * @param[out] needle pointer to the needle to prepare
+ * @param[in] pattern pattern to search for
+ * @return true on success, false if pattern is NULL or empty or memory
+ *         allocation fails
+ */
+bool text_needle_init(TextNeedle *needle, const char *pattern);
+
+/**
+ * @brief frees the folded copy held by a needle
+ * @param[in,out] needle pointer to the needle (can be NULL)
+ */
+void text_needle_free(TextNeedle *needle);
+
+/**
+ * @brief checks whether a folded string contains the needle
+ * @param[in] needle prepared needle
+ * @param[in] folded lowercased string followed by at least
+ *                   FOLDED_TEXT_PADDING readable bytes (folded_text_get)
+ * @return true if the needle occurs in folded
+ */
+bool text_needle_find(const TextNeedle *needle, const char *folded);
+
+/**
+ * @brief checks whether any string contains the needle, ignoring case
+ * @param[in] needle prepared needle
+ * @param[in] text string in its original case
+ * @return true if the needle occurs in text
+ * @note folds as it compares; for one-off checks such as dictionary entries
+ */
+bool text_needle_match(const TextNeedle *needle, const char *text);
+
+#endif // TEXT_SEARCH_H
@@ -0,0 +1,109 @@
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+/**
+ * @file trigram_index.h
+ * @brief trigram inverted index over folded names
+ *
+ * maps every run of three bytes (trigram) of a table's folded names to the
+ * ascending list of record positions whose name contains it. a substring
+ * of three or more bytes can only occur in a name holding all of its
+ * trigrams, so intersecting their lists gives a small candidate set that a
+ * GREP then verifies, instead of searching every name. lists are found
+ * through an open-addressing hash table keyed by the trigram.
+ *
+ * @author Group P1-08 (Timothy, Aamir, Hasif, Dalton, Gin)
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// bytes per trigram; shorter patterns cannot be looked up
+#define TRIGRAM_LENGTH 3
+
+// initial number of hash buckets (must be a power of two)
+#define TRIGRAM_INDEX_INITIAL_BUCKETS 256
+
+// positions of the names containing one trigram
+typedef struct {
+  uint32_t key;       // the three bytes, first one highest
+  uint32_t count;     // positions in the list
+  uint32_t capacity;  // allocated positions
+  uint32_t *postings; // ascending record positions
+} TrigramList;
+
+// trigram to positions index
+typedef struct {
+  TrigramList *lists;  // one list per distinct trigram seen
+  uint32_t count;      // lists in use
+  uint32_t capacity;   // allocated lists
+  uint32_t *buckets;   // open-addressing buckets holding list + 1 (0 = empty)
+  size_t bucket_count; // number of buckets (power of two)
+  size_t postings;     // positions held across all lists
+} TrigramIndex;
+
+/**
+ * @brief initialises an empty index (no memory is allocated)
+ * @param[out] index pointer to the index to initialise
+ */
+void trigram_index_init(TrigramIndex *index);
+
+/**
+ * @brief frees all memory held by an index
+ * @param[in,out] index pointer to the index to free (can be NULL)
+ */
+void trigram_index_free(TrigramIndex *index);
+
+/**
+ * @brief adds a position under every trigram of its folded name
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] folded folded name of the record
+ * @return true on success, false if memory allocation fails (the position
+ *         may then be under some of its trigrams only)
+ * @note appending positions in ascending order is the fast path; others
+ *       are inserted in order
+ */
+bool trigram_index_add(TrigramIndex *index, uint32_t position,
+                       const char *folded);
+
+/**
+ * @brief removes a position from every trigram of its folded name
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] folded folded name the position was added with
+ */
+void trigram_index_remove(TrigramIndex *index, uint32_t position,
+                          const char *folded);
+
+/**
+ * @brief renumbers every position after records are moved down
+ * @param[in,out] index pointer to the index
+ * @param[in] new_position new position of each indexed position
+ * @note new_position must keep positions in the same order (a purge)
+ */
+void trigram_index_remap(TrigramIndex *index, const uint32_t *new_position);
+
+/**
+ * @brief finds the positions whose names hold every trigram of a pattern
+ * @param[in] index pointer to the index
+ * @param[in] pattern folded pattern, at least TRIGRAM_LENGTH bytes
+ * @param[in] length bytes in pattern
+ * @param[out] positions ascending candidate positions (heap-allocated,
+ *                       caller frees; NULL when there are none)
+ * @param[out] count number of candidates
+ * @return true on success, false if memory allocation fails
+ * @note candidates still have to be checked for the whole pattern
+ */
+bool trigram_index_lookup(const TrigramIndex *index, const char *pattern,
+                          size_t length, uint32_t **positions, size_t *count);
+
+/**
+ * @brief returns the bytes an index holds
+ * @param[in] index pointer to the index
+ * @return allocated bytes of the lists, their positions and the buckets
+ */
+size_t trigram_index_memory(const TrigramIndex *index);
+
+#endif // TRIGRAM_INDEX_H
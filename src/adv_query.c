@@ -1,6 +1,16 @@
 #include "adv_query.h"
+#include "bitmap_index.h"
+#include "mark_kernels.h"
+#include "parallel.h"
+#include "query_cache.h"
+#include "table_view.h"
+#include "text_search.h"
+#include "trigram_index.h"
 
 #include <ctype.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,12 +23,24 @@ typedef enum {
   QUERY_FIELD_NAME = 0,
   QUERY_FIELD_PROGRAMME,
   QUERY_FIELD_MARK,
+  QUERY_FIELD_ID,
   QUERY_FIELD_INVALID
 } QueryField;
 
-#define ADV_QUERY_FIELD_COUNT 3
+#define ADV_QUERY_FIELD_COUNT 4
 #define ADV_QUERY_MAX_SELECTIONS 8
 
+// the filter bitmaps are read only when they leave at most 1 in this many of
+// a table's positions; past that, scanning every position is cheaper than
+// reading candidates one by one
+#define FILTER_BITMAP_MAX_SHARE 4
+
+// a sorted view is searched for a MARK or ID interval only when the
+// interval holds at most 1 in this many positions. reading candidates skips
+// the comparisons and the view walk, so it wins for wide intervals too, but
+// past half of a table the candidate list costs more than it saves
+#define RANGE_INDEX_MAX_SHARE 2
+
 // duplicate string to heap; caller frees
 static char *dup_string(const char *src) {
   if (!src) {
@@ -77,82 +99,10 @@ static QueryField parse_field(const char *token) {
   if (strcaseequal(token, "MARK") || strcaseequal(token, "MARKS")) {
     return QUERY_FIELD_MARK;
   }
-  return QUERY_FIELD_INVALID;
-}
-
-// flatten all records into one array for filtering
-static size_t collect_records(StudentDatabase *db, StudentRecord ***out) {
-  size_t total = 0;
-  for (size_t t = 0; t < db->table_count; t++) {
-    StudentTable *table = db->tables[t];
-    if (table) {
-      total += table->record_count;
-    }
-  }
-  if (total == 0) {
-    *out = NULL;
-    return 0;
-  }
-  StudentRecord **records = malloc(total * sizeof(StudentRecord *));
-  if (!records) {
-    *out = NULL;
-    return (size_t)-1;
-  }
-  size_t idx = 0;
-  for (size_t t = 0; t < db->table_count; t++) {
-    StudentTable *table = db->tables[t];
-    if (!table) {
-      continue;
-    }
-    for (size_t r = 0; r < table->record_count; r++) {
-      records[idx++] = &table->records[r];
-    }
-  }
-  *out = records;
-  return total;
-}
-
-// substring check ignoring case
-static int contains_case_insensitive(const char *haystack, const char *needle) {
-  if (!haystack || !needle || *needle == '\0') {
-    return 0;
-  }
-  size_t nlen = strlen(needle);
-  for (const char *p = haystack; *p; p++) {
-    size_t i = 0;
-    while (p[i] && tolower((unsigned char)p[i]) ==
-                      tolower((unsigned char)needle[i])) {
-      if (++i == nlen) {
-        return 1;
-      }
-    }
-  }
-  return 0;
-}
-
-// match a record against a GREP stage for a given field
-static int grep_matches(const StudentRecord *record, QueryField field,
-                        const char *pattern) {
-  if (!pattern) {
-    return 0;
-  }
-  if (field == QUERY_FIELD_NAME) {
-    return contains_case_insensitive(record->name, pattern);
+  if (strcaseequal(token, "ID")) {
+    return QUERY_FIELD_ID;
   }
-  if (field == QUERY_FIELD_PROGRAMME) {
-    return contains_case_insensitive(record->prog, pattern);
-  }
-  return 0;
-}
-
-static int mark_matches(const StudentRecord *record, char op, double value) {
-  if (op == '<') {
-    return record->mark < value;
-  }
-  if (op == '>') {
-    return record->mark > value;
-  }
-  return record->mark == value;
+  return QUERY_FIELD_INVALID;
 }
 
 static void strip_quotes(char *text) {
@@ -163,41 +113,97 @@ static void strip_quotes(char *text) {
   }
 }
 
-static int apply_text_filter(StudentRecord **records, unsigned char *keep,
-                             size_t count, QueryField field,
-                             const char *pattern) {
-  if (!pattern || *pattern == '\0') {
-    return 0;
-  }
-  for (size_t i = 0; i < count; i++) {
-    if (keep[i] && !grep_matches(records[i], field, pattern)) {
-      keep[i] = 0;
+// the text after word, trimmed, if text starts with word (in any case)
+// followed by whitespace; NULL otherwise
+static char *skip_word(char *text, const char *word) {
+  size_t len = strlen(word);
+  for (size_t i = 0; i < len; i++) {
+    if (tolower((unsigned char)text[i]) != tolower((unsigned char)word[i])) {
+      return NULL;
     }
   }
-  return 1;
+  return isspace((unsigned char)text[len]) ? trim(text + len) : NULL;
 }
 
-// apply MARK comparison to keep-mask for all records
-static int apply_mark_filter(StudentRecord **records, unsigned char *keep,
-                             size_t count, char op, double value) {
-  for (size_t i = 0; i < count; i++) {
-    if (keep[i] && !mark_matches(records[i], op, value)) {
-      keep[i] = 0;
-    }
-  }
-  return 1;
+// parse text that is exactly one number
+static int parse_number(char *text, double *out) {
+  char *endptr = NULL;
+  *out = strtod(text, &endptr);
+  return endptr != text && *trim(endptr) == '\0';
 }
 
-typedef enum { STAGE_GREP, STAGE_MARK } StageType;
+typedef enum { STAGE_GREP, STAGE_MARK, STAGE_ID } StageType;
+
+// the values from low to high that a MARK or ID comparison accepts; an open
+// end leaves the bound itself out
+typedef struct {
+  double low;
+  double high;
+  bool low_open;
+  bool high_open;
+} QueryRange;
 
 typedef struct {
   StageType type;
-  QueryField field; // for GREP
-  char op;          // for MARK
-  double value;     // for MARK
-  char *pattern;    // for GREP (points into working buffer)
+  QueryField field;       // for GREP
+  char op;                // for MARK and ID: '<', '>', '=', or 0 for an
+                          // interval (>=, <= or BETWEEN)
+  double value;           // for MARK and ID: operand of op
+  QueryRange range;       // for MARK and ID: every comparison as an interval
+  char *pattern;          // for GREP (points into working buffer)
+  TextNeedle needle;      // for GREP: pattern folded once per query
+  unsigned char *verdict; // programme GREP: match per code of current table
+  bool covered;           // answered by the current table's bitmaps or views
 } QueryStage;
 
+// parsed pipeline, stages ordered cheapest first, then how the matches are
+// ordered and how many are kept
+typedef struct {
+  QueryStage stages[ADV_QUERY_FIELD_COUNT];
+  size_t count;
+  QueryField order; // MARK or ID to order by, or QUERY_FIELD_INVALID
+  bool descending;
+  size_t limit; // most matches kept, or SIZE_MAX
+} QueryPlan;
+
+// parse what follows MARK or ID: "op value" with op one of <, >, =, <= and
+// >=, or "BETWEEN low AND high" (both bounds included)
+static int parse_comparison(char *expr, QueryStage *out) {
+  char *bounds = skip_word(expr, "BETWEEN");
+  if (bounds) {
+    char *endptr = NULL;
+    double low = strtod(bounds, &endptr);
+    char *upper = endptr != bounds ? skip_word(trim(endptr), "AND") : NULL;
+    double high;
+    if (!upper || !parse_number(upper, &high)) {
+      return 0;
+    }
+    out->op = 0;
+    out->range = (QueryRange){low, high, false, false};
+    return 1;
+  }
+
+  char op = *expr;
+  if (op != '<' && op != '>' && op != '=') {
+    return 0;
+  }
+  bool inclusive = op != '=' && expr[1] == '=';
+  double value;
+  if (!parse_number(trim(expr + 1 + inclusive), &value)) {
+    return 0;
+  }
+  out->op = inclusive ? 0 : op;
+  out->value = value;
+  if (op == '<') {
+    out->range = (QueryRange){-INFINITY, value, false, !inclusive};
+  } else if (op == '>') {
+    out->range = (QueryRange){value, INFINITY, !inclusive, false};
+  } else {
+    out->range = (QueryRange){value, value, false, false};
+  }
+  return 1;
+}
+
 // parse a single pipeline segment into a structured stage
 static int parse_stage(char *segment, QueryStage *out, int *field_used) {
   char *trimmed = trim(segment);
@@ -232,10 +238,13 @@ static int parse_stage(char *segment, QueryStage *out, int *field_used) {
 
     QueryField field = parse_field(field_buf);
     if (field == QUERY_FIELD_INVALID || field == QUERY_FIELD_MARK ||
-        field_used[field]) {
+        field == QUERY_FIELD_ID || field_used[field]) {
       return 0;
     }
     strip_quotes(expr);
+    if (*expr == '\0') {
+      return 0;
+    }
     out->type = STAGE_GREP;
     out->field = field;
     out->pattern = expr;
@@ -243,127 +252,1451 @@ static int parse_stage(char *segment, QueryStage *out, int *field_used) {
     return 1;
   }
 
-  if (strcaseequal(cmd, "MARK") || strcaseequal(cmd, "FILTER")) {
-    char op = *expr;
-    if (op != '<' && op != '>' && op != '=') {
+  bool mark = strcaseequal(cmd, "MARK") || strcaseequal(cmd, "FILTER");
+  if (mark || strcaseequal(cmd, "ID")) {
+    QueryField field = mark ? QUERY_FIELD_MARK : QUERY_FIELD_ID;
+    if (field_used[field] || !parse_comparison(expr, out)) {
       return 0;
     }
-    expr = trim(expr + 1);
-    if (*expr == '\0') {
-      return 0;
+    out->type = mark ? STAGE_MARK : STAGE_ID;
+    field_used[field] = 1;
+    return 1;
+  }
+
+  return 0;
+}
+
+// relative cost per record: a mark or id compare, a programme code lookup,
+// then a substring search over the name
+static int stage_cost(const QueryStage *stage) {
+  if (stage->type != STAGE_GREP) {
+    return 0;
+  }
+  return stage->field == QUERY_FIELD_PROGRAMME ? 1 : 2;
+}
+
+// parse an "ORDER BY <MARK|ID> [ASC|DESC]" or "LIMIT <k>" segment into the
+// plan; 1 if parsed, 0 if the segment is not one, -1 if it is malformed,
+// repeated, or an ORDER BY after the LIMIT
+static int parse_clause(char *segment, QueryPlan *plan) {
+  char *text = trim(segment);
+  char *order = skip_word(text, "ORDER");
+  if (order) {
+    char *field = skip_word(order, "BY");
+    if (!field || plan->order != QUERY_FIELD_INVALID ||
+        plan->limit != SIZE_MAX) {
+      return -1;
     }
+    char *direction = field + strcspn(field, " \t");
+    if (*direction) {
+      *direction++ = '\0';
+      direction = trim(direction);
+    }
+    plan->order = parse_field(field);
+    plan->descending = strcaseequal(direction, "DESC");
+    if ((plan->order != QUERY_FIELD_MARK && plan->order != QUERY_FIELD_ID) ||
+        !(plan->descending || *direction == '\0' ||
+          strcaseequal(direction, "ASC"))) {
+      return -1;
+    }
+    return 1;
+  }
+
+  char *limit = skip_word(text, "LIMIT");
+  if (limit) {
     char *endptr = NULL;
-    double value = strtod(expr, &endptr);
-    if (endptr == expr || *endptr != '\0') {
+    unsigned long long k = strtoull(limit, &endptr, 10);
+    if (plan->limit != SIZE_MAX || !isdigit((unsigned char)*limit) ||
+        *trim(endptr) != '\0' || k == 0 || k >= SIZE_MAX) {
+      return -1;
+    }
+    plan->limit = (size_t)k;
+    return 1;
+  }
+  return 0;
+}
+
+// parse every stage of the pipeline before any record is touched; the stages
+// are ANDed, so they are reordered cheapest first. ORDER BY and LIMIT may
+// only follow the filters, and need no filter before them
+static int parse_plan(char *working, QueryPlan *plan) {
+  int field_used[ADV_QUERY_FIELD_COUNT] = {0};
+  char *ctx = NULL;
+  plan->count = 0;
+  plan->order = QUERY_FIELD_INVALID;
+  plan->descending = false;
+  plan->limit = SIZE_MAX;
+  for (char *segment = strtok_r(working, "|", &ctx); segment;
+       segment = strtok_r(NULL, "|", &ctx)) {
+    int clause = parse_clause(segment, plan);
+    if (clause < 0) {
       return 0;
     }
-    if (field_used[QUERY_FIELD_MARK]) {
+    if (clause > 0) {
+      continue;
+    }
+    QueryStage parsed = {0};
+    if (plan->count == ADV_QUERY_FIELD_COUNT ||
+        plan->order != QUERY_FIELD_INVALID || plan->limit != SIZE_MAX ||
+        !parse_stage(segment, &parsed, field_used)) {
       return 0;
     }
-    out->type = STAGE_MARK;
-    out->op = op;
-    out->value = value;
-    field_used[QUERY_FIELD_MARK] = 1;
+    size_t slot = plan->count++;
+    while (slot > 0 && stage_cost(&plan->stages[slot - 1]) >
+                           stage_cost(&parsed)) {
+      plan->stages[slot] = plan->stages[slot - 1];
+      slot--;
+    }
+    plan->stages[slot] = parsed;
+  }
+  return plan->count > 0 || plan->order != QUERY_FIELD_INVALID ||
+         plan->limit != SIZE_MAX;
+}
+
+// fold each GREP pattern on first use, and test a programme GREP once per
+// distinct programme in the table's dictionary, so records are then
+// filtered by code lookup
+static int prepare_stages(QueryPlan *plan, const StudentTable *table) {
+  for (size_t s = 0; s < plan->count; s++) {
+    QueryStage *stage = &plan->stages[s];
+    stage->covered = false;
+    if (stage->type != STAGE_GREP) {
+      continue;
+    }
+    if (!stage->needle.text &&
+        !text_needle_init(&stage->needle, stage->pattern)) {
+      return 0;
+    }
+    if (stage->field != QUERY_FIELD_PROGRAMME) {
+      continue;
+    }
+    unsigned char *verdict =
+        realloc(stage->verdict, table->programmes.count + 1);
+    if (!verdict) {
+      return 0;
+    }
+    stage->verdict = verdict;
+    for (uint32_t code = 0; code < table->programmes.count; code++) {
+      verdict[code] = (unsigned char)text_needle_match(
+          &stage->needle, dictionary_get(&table->programmes, code));
+    }
+  }
+  return 1;
+}
+
+static void free_plan(QueryPlan *plan) {
+  for (size_t s = 0; s < plan->count; s++) {
+    free(plan->stages[s].verdict);
+    plan->stages[s].verdict = NULL;
+    text_needle_free(&plan->stages[s].needle);
+  }
+}
+
+// true if a value lies in a MARK or ID stage's interval (NaN never does);
+// evaluated without branches, as filter loops keep records on either side
+static inline bool in_range(const QueryRange *range, double value) {
+  bool above =
+      (value > range->low) | (!range->low_open & (value == range->low));
+  bool below =
+      (value < range->high) | (!range->high_open & (value == range->high));
+  return above & below;
+}
+
+// narrow a selection of positions to marks passing the comparison; the
+// operator is resolved once per batch and survivors are written branch-free
+static size_t filter_marks(const StudentTable *table, const QueryStage *stage,
+                           size_t *selection, size_t count, bool contiguous) {
+  size_t kept = 0;
+  if (stage->op == 0) {
+    for (size_t i = 0; i < count; i++) {
+      size_t p = selection[i];
+      selection[kept] = p;
+      kept += in_range(&stage->range, table_record_mark(table, p));
+    }
+    return kept;
+  }
+
+  // a run of consecutive positions in column layout is a slice of the mark
+  // column, which the vector kernels scan directly
+  if (contiguous && table->layout == TABLE_LAYOUT_COLUMNS && count > 0) {
+    return mark_kernel_select(table->columns.marks + selection[0], count,
+                              selection[0], stage->op, stage->value,
+                              selection);
+  }
+
+  double value = stage->value;
+  switch (stage->op) {
+  case '<':
+    for (size_t i = 0; i < count; i++) {
+      size_t p = selection[i];
+      selection[kept] = p;
+      kept += table_record_mark(table, p) < value;
+    }
+    break;
+  case '>':
+    for (size_t i = 0; i < count; i++) {
+      size_t p = selection[i];
+      selection[kept] = p;
+      kept += table_record_mark(table, p) > value;
+    }
+    break;
+  default:
+    for (size_t i = 0; i < count; i++) {
+      size_t p = selection[i];
+      selection[kept] = p;
+      kept += table_record_mark(table, p) == value;
+    }
+    break;
+  }
+  return kept;
+}
+
+// narrow a selection of positions to ids in the stage's interval
+static size_t filter_ids(const StudentTable *table, const QueryStage *stage,
+                         size_t *selection, size_t count) {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t p = selection[i];
+    selection[kept] = p;
+    kept += in_range(&stage->range, table_record_id(table, p));
+  }
+  return kept;
+}
+
+// narrow a selection of positions to programmes the stage's verdicts accept
+static size_t filter_programmes(const StudentTable *table,
+                                const QueryStage *stage, size_t *selection,
+                                size_t count) {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t p = selection[i];
+    selection[kept] = p;
+    kept += stage->verdict[table->prog_codes[p]];
+  }
+  return kept;
+}
+
+// narrow a selection of positions to names containing the stage's pattern;
+// the table's folded names are searched, so neither side is folded here
+static size_t filter_names(const StudentTable *table, const QueryStage *stage,
+                           size_t *selection, size_t count) {
+  const FoldedText *names = &table->folded_names;
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t p = selection[i];
+    selection[kept] = p;
+    kept += text_needle_find(&stage->needle, folded_text_get(names, p));
+  }
+  return kept;
+}
+
+// run one batch through every stage the filter bitmaps or sorted views did
+// not already answer; an empty selection skips the rest. contiguous says the
+// selection holds consecutive ascending positions
+static size_t filter_batch(const QueryPlan *plan, const StudentTable *table,
+                           size_t *selection, size_t count, bool contiguous) {
+  for (size_t s = 0; s < plan->count && count > 0; s++) {
+    const QueryStage *stage = &plan->stages[s];
+    size_t kept;
+    if (stage->covered) {
+      continue;
+    } else if (stage->type == STAGE_MARK) {
+      kept = filter_marks(table, stage, selection, count, contiguous);
+    } else if (stage->type == STAGE_ID) {
+      kept = filter_ids(table, stage, selection, count);
+    } else if (stage->field == QUERY_FIELD_PROGRAMME) {
+      kept = filter_programmes(table, stage, selection, count);
+    } else {
+      kept = filter_names(table, stage, selection, count);
+    }
+    contiguous = contiguous && kept == count;
+    count = kept;
+  }
+  return count;
+}
+
+// the GREP NAME stage a table's trigram index can narrow, or NULL if the
+// table has no index or the plan no name pattern of TRIGRAM_LENGTH bytes
+static const QueryStage *indexed_stage(const QueryPlan *plan,
+                                       const StudentTable *table) {
+  if (!table->name_trigrams) {
+    return NULL;
+  }
+  for (size_t s = 0; s < plan->count; s++) {
+    const QueryStage *stage = &plan->stages[s];
+    if (stage->type == STAGE_GREP && stage->field == QUERY_FIELD_NAME &&
+        stage->needle.length >= TRIGRAM_LENGTH) {
+      return stage;
+    }
+  }
+  return NULL;
+}
+
+// the plan's stage of a type (and field, for GREP) that no index of the
+// current table has answered yet, or NULL
+static QueryStage *find_stage(QueryPlan *plan, StageType type,
+                              QueryField field) {
+  for (size_t s = 0; s < plan->count; s++) {
+    QueryStage *stage = &plan->stages[s];
+    if (stage->type == type && (type != STAGE_GREP || stage->field == field) &&
+        !stage->covered) {
+      return stage;
+    }
+  }
+  return NULL;
+}
+
+// whether a whole band of marks lies inside, outside or across a MARK
+// stage's interval
+static MarkBandVerdict band_verdict(size_t band, const QueryStage *mark) {
+  const QueryRange *range = &mark->range;
+  return bitmap_index_range_verdict(band, range->low, range->low_open,
+                                    range->high, range->high_open);
+}
+
+// what a table's filter bitmaps say about a plan's programme and mark
+// stages: the positions of every programme the programme stage accepts, of
+// the mark bands wholly passing the MARK stage, and of the bands straddling
+// its bound, whose marks still have to be compared
+typedef struct {
+  QueryStage *programme; // programme stage, or NULL (programmes unused)
+  QueryStage *mark;      // MARK stage, or NULL (passing and boundary unused)
+  RoaringBitmap programmes;
+  RoaringBitmap passing;
+  RoaringBitmap boundary;
+} FilterSets;
+
+static void free_filter_sets(FilterSets *sets) {
+  roaring_free(&sets->programmes);
+  roaring_free(&sets->passing);
+  roaring_free(&sets->boundary);
+}
+
+// OR together the bitmaps a plan's programme and mark stages accept
+static bool gather_filter_sets(QueryPlan *plan, const StudentTable *table,
+                               FilterSets *sets) {
+  const BitmapIndex *index = table->filter_bitmaps;
+  sets->programme = find_stage(plan, STAGE_GREP, QUERY_FIELD_PROGRAMME);
+  sets->mark = find_stage(plan, STAGE_MARK, QUERY_FIELD_MARK);
+  roaring_init(&sets->programmes);
+  roaring_init(&sets->passing);
+  roaring_init(&sets->boundary);
+
+  bool ok = true;
+  for (uint32_t code = 0;
+       sets->programme && code < table->programmes.count && ok; code++) {
+    const RoaringBitmap *bitmap = bitmap_index_programme(index, code);
+    if (sets->programme->verdict[code] && bitmap) {
+      ok = roaring_or_into(&sets->programmes, bitmap);
+    }
+  }
+  for (size_t b = 0; sets->mark && b < MARK_BAND_COUNT && ok; b++) {
+    switch (band_verdict(b, sets->mark)) {
+    case MARK_BAND_PASS:
+      ok = roaring_or_into(&sets->passing, &index->bands[b]);
+      break;
+    case MARK_BAND_CHECK:
+      ok = roaring_or_into(&sets->boundary, &index->bands[b]);
+      break;
+    default:
+      break;
+    }
+  }
+  if (!ok) {
+    free_filter_sets(sets);
+  }
+  return ok;
+}
+
+// positions in maybe (initialised, empty) whose mark still has to be
+// compared: boundary bands, of an accepted programme if there is a
+// programme stage
+static bool boundary_positions(const FilterSets *sets, RoaringBitmap *maybe) {
+  if (!sets->mark) {
+    return true;
+  }
+  return sets->programme
+             ? roaring_and(&sets->programmes, &sets->boundary, maybe)
+             : roaring_or_into(maybe, &sets->boundary);
+}
+
+// positions in sure (initialised, empty) certain to pass both stages
+static bool passing_positions(const FilterSets *sets, RoaringBitmap *sure) {
+  if (!sets->mark) {
+    return roaring_or_into(sure, &sets->programmes);
+  }
+  return sets->programme
+             ? roaring_and(&sets->programmes, &sets->passing, sure)
+             : roaring_or_into(sure, &sets->passing);
+}
+
+// number of positions certain to pass both stages, by popcount without
+// building them
+static size_t passing_count(const FilterSets *sets) {
+  if (!sets->mark) {
+    return roaring_cardinality(&sets->programmes);
+  }
+  return sets->programme
+             ? roaring_and_cardinality(&sets->programmes, &sets->passing)
+             : roaring_cardinality(&sets->passing);
+}
+
+// positions of the boundary bitmap whose mark passes the MARK stage, written
+// ascending to out; returns how many
+static size_t verify_marks(const QueryStage *mark, const StudentTable *table,
+                           const uint32_t *boundary, size_t count,
+                           uint32_t *out) {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    out[kept] = boundary[i];
+    kept += in_range(&mark->range, table_record_mark(table, boundary[i]));
+  }
+  return kept;
+}
+
+// most positions the filter bitmaps can leave for a plan, from the sizes of
+// the accepted programme and band bitmaps alone
+static size_t bitmap_upper_bound(const QueryStage *programme,
+                                 const QueryStage *mark,
+                                 const StudentTable *table) {
+  const BitmapIndex *index = table->filter_bitmaps;
+  size_t bound = table->slot_count;
+  if (programme) {
+    size_t accepted = 0;
+    for (uint32_t code = 0; code < table->programmes.count; code++) {
+      accepted += programme->verdict[code]
+                      ? roaring_cardinality(bitmap_index_programme(index, code))
+                      : 0;
+    }
+    bound = accepted < bound ? accepted : bound;
+  }
+  if (mark) {
+    size_t accepted = 0;
+    for (size_t b = 0; b < MARK_BAND_COUNT; b++) {
+      accepted += band_verdict(b, mark) != MARK_BAND_FAIL
+                      ? roaring_cardinality(&index->bands[b])
+                      : 0;
+    }
+    bound = accepted < bound ? accepted : bound;
+  }
+  return bound;
+}
+
+// the ascending positions a table's filter bitmaps leave for a plan, with
+// the programme and mark stages marked covered. *used stays false when the
+// table has no bitmaps, the plan has no programme or mark stage, or the
+// bitmaps leave too many positions to be worth reading one by one
+static bool bitmap_candidates(QueryPlan *plan, const StudentTable *table,
+                              uint32_t **positions, size_t *count,
+                              bool *used) {
+  *positions = NULL;
+  *count = 0;
+  *used = false;
+  QueryStage *programme = find_stage(plan, STAGE_GREP, QUERY_FIELD_PROGRAMME);
+  QueryStage *mark = find_stage(plan, STAGE_MARK, QUERY_FIELD_MARK);
+  if (!table->filter_bitmaps || (!programme && !mark) ||
+      bitmap_upper_bound(programme, mark, table) * FILTER_BITMAP_MAX_SHARE >
+          table->slot_count) {
+    return true;
+  }
+
+  FilterSets sets;
+  if (!gather_filter_sets(plan, table, &sets)) {
+    return false;
+  }
+  RoaringBitmap sure;
+  RoaringBitmap maybe;
+  roaring_init(&sure);
+  roaring_init(&maybe);
+  bool ok =
+      passing_positions(&sets, &sure) && boundary_positions(&sets, &maybe);
+  free_filter_sets(&sets);
+  if (!ok) {
+    roaring_free(&sure);
+    roaring_free(&maybe);
+    return false;
+  }
+  size_t sure_count = roaring_cardinality(&sure);
+  size_t maybe_count = roaring_cardinality(&maybe);
+  size_t total = sure_count + maybe_count;
+  if (total * FILTER_BITMAP_MAX_SHARE > table->slot_count) {
+    roaring_free(&sure);
+    roaring_free(&maybe);
+    return true;
+  }
+
+  // sure positions first, then the boundary ones that pass, merged
+  uint32_t *merged = malloc((total ? total : 1) * 2 * sizeof(uint32_t));
+  if (!merged) {
+    roaring_free(&sure);
+    roaring_free(&maybe);
+    return false;
+  }
+  uint32_t *scratch = merged + total;
+  roaring_to_array(&sure, scratch);
+  roaring_to_array(&maybe, scratch + sure_count);
+  size_t passed =
+      mark ? verify_marks(mark, table, scratch + sure_count, maybe_count,
+                          scratch + sure_count)
+           : 0;
+  const uint32_t *a = scratch;
+  const uint32_t *b = scratch + sure_count;
+  size_t i = 0;
+  size_t j = 0;
+  size_t n = 0;
+  while (i < sure_count || j < passed) {
+    merged[n++] = j == passed || (i < sure_count && a[i] < b[j]) ? a[i++]
+                                                                 : b[j++];
+  }
+  roaring_free(&sure);
+  roaring_free(&maybe);
+
+  if (programme) {
+    programme->covered = true;
+  }
+  if (mark) {
+    mark->covered = true;
+  }
+  *used = true;
+  if (n == 0) {
+    free(merged);
+    return true;
+  }
+  *positions = merged;
+  *count = n;
+  return true;
+}
+
+// keep the positions of a also in b (both ascending); returns how many
+static size_t intersect_positions(uint32_t *a, size_t a_count,
+                                  const uint32_t *b, size_t b_count) {
+  size_t kept = 0;
+  size_t j = 0;
+  for (size_t i = 0; i < a_count && j < b_count; i++) {
+    while (j < b_count && b[j] < a[i]) {
+      j++;
+    }
+    if (j < b_count && b[j] == a[i]) {
+      a[kept++] = a[i];
+    }
+  }
+  return kept;
+}
+
+// ranks [first, end) of a MARK or ID stage's interval in the table's sorted
+// view of that field, found by binary search to each end of the interval
+static void view_ranks(const StudentTable *table, const QueryStage *stage,
+                       size_t *first, size_t *end) {
+  bool mark = stage->type == STAGE_MARK;
+  const uint32_t *view = mark ? table->views.by_mark_asc : table->views.by_id;
+  const QueryRange *range = &stage->range;
+  size_t lo = 0;
+  size_t hi = table->record_count;
+  // first rank at or past the low end
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    double value = mark ? table_record_mark(table, view[mid])
+                        : table_record_id(table, view[mid]);
+    if (value < range->low || (range->low_open && value == range->low)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *first = lo;
+  // first rank past the high end
+  hi = table->record_count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    double value = mark ? table_record_mark(table, view[mid])
+                        : table_record_id(table, view[mid]);
+    if (value < range->high || (!range->high_open && value == range->high)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *end = lo;
+}
+
+static int compare_positions(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+// the ascending positions of the MARK or ID interval holding the fewest of
+// a table's records, read from its sorted view, with that stage marked
+// covered. *used stays false when the views are unbuilt, the plan has no
+// MARK or ID stage, or the narrowest interval holds more than 1 in
+// RANGE_INDEX_MAX_SHARE positions
+static bool range_candidates(QueryPlan *plan, const StudentTable *table,
+                             uint32_t **positions, size_t *count,
+                             bool *used) {
+  *positions = NULL;
+  *count = 0;
+  *used = false;
+  if (!table->views.built) {
+    return true;
+  }
+  QueryStage *best = NULL;
+  size_t first = 0;
+  size_t end = 0;
+  for (size_t s = 0; s < plan->count; s++) {
+    QueryStage *stage = &plan->stages[s];
+    size_t stage_first;
+    size_t stage_end;
+    if (stage->type == STAGE_GREP || stage->covered) {
+      continue;
+    }
+    view_ranks(table, stage, &stage_first, &stage_end);
+    if (!best || stage_end - stage_first < end - first) {
+      best = stage;
+      first = stage_first;
+      end = stage_end;
+    }
+  }
+  size_t n = end - first;
+  if (!best || n * RANGE_INDEX_MAX_SHARE > table->slot_count) {
+    return true;
+  }
+
+  best->covered = true;
+  *used = true;
+  if (n == 0) {
+    return true;
+  }
+  const uint32_t *view = best->type == STAGE_MARK ? table->views.by_mark_asc
+                                                  : table->views.by_id;
+  uint32_t *sorted = malloc(n * sizeof(uint32_t));
+  if (!sorted) {
+    return false;
+  }
+  // a few positions are sorted directly; more are set in a bitset over the
+  // slots and read back in order, one pass over its words
+  if (n <= table->slot_count / 1024) {
+    memcpy(sorted, view + first, n * sizeof(uint32_t));
+    qsort(sorted, n, sizeof(uint32_t), compare_positions);
+  } else {
+    size_t words = (table->slot_count + 63) / 64;
+    uint64_t *bits = calloc(words, sizeof(uint64_t));
+    if (!bits) {
+      free(sorted);
+      return false;
+    }
+    for (size_t rank = first; rank < end; rank++) {
+      bits[view[rank] / 64] |= (uint64_t)1 << (view[rank] % 64);
+    }
+    size_t written = 0;
+    for (size_t w = 0; w < words; w++) {
+      for (uint64_t word = bits[w]; word; word &= word - 1) {
+        sorted[written++] = (uint32_t)(w * 64 + (size_t)__builtin_ctzll(word));
+      }
+    }
+    free(bits);
+  }
+  *positions = sorted;
+  *count = n;
+  return true;
+}
+
+// narrow the candidates found so far to those also in more (both ascending;
+// more is freed), or start from more if there were none yet
+static void add_candidates(uint32_t **candidates, size_t *count,
+                           bool *narrowed, uint32_t *more, size_t more_count) {
+  if (*narrowed) {
+    *count = intersect_positions(*candidates, *count, more, more_count);
+    free(more);
+    return;
+  }
+  *candidates = more;
+  *count = more_count;
+  *narrowed = true;
+}
+
+// positions a query reads from a table: its active view, or only the
+// candidates of the sorted views, filter bitmaps or trigram index
+// (ascending positions, or a bitset over positions when the view is sorted)
+typedef struct {
+  const StudentTable *table;
+  size_t cursor;          // view cursor, or next candidate
+  size_t end;             // cursor value or candidate the reading stops at
+  const uint32_t *picked; // candidates in stored order, or NULL
+  size_t picked_count;
+  const uint64_t *allowed; // candidate bitset for sorted views, or NULL
+} QuerySource;
+
+// fill a batch from the source; returns how many positions were written
+static size_t next_batch(QuerySource *source, size_t *selection) {
+  size_t count = 0;
+  if (source->picked) {
+    while (count < ADV_QUERY_BATCH_SIZE && source->cursor < source->end) {
+      selection[count++] = source->picked[source->cursor++];
+    }
+    return count;
+  }
+
+  size_t position;
+  while (count < ADV_QUERY_BATCH_SIZE && source->cursor < source->end &&
+         (position = table_view_next(source->table, &source->cursor)) !=
+             TABLE_VIEW_NOT_FOUND) {
+    // in stored order the cursor skips tombstones and can pass end, in
+    // which case the position belongs to the next morsel
+    if (source->cursor > source->end) {
+      break;
+    }
+    selection[count] = position;
+    count += !source->allowed ||
+             ((source->allowed[position / 64] >> (position % 64)) & 1u);
+  }
+  return count;
+}
+
+// append a batch's surviving positions to the result
+static int append_matches(AdvQueryResult *result, const StudentTable *table,
+                          const size_t *selection, size_t count) {
+  if (result->count + count > result->capacity) {
+    size_t capacity = result->capacity ? result->capacity : ADV_QUERY_BATCH_SIZE;
+    while (capacity < result->count + count) {
+      capacity *= 2;
+    }
+    AdvQueryMatch *matches =
+        realloc(result->matches, capacity * sizeof *matches);
+    if (!matches) {
+      return 0;
+    }
+    result->matches = matches;
+    result->capacity = capacity;
+  }
+  for (size_t i = 0; i < count; i++) {
+    result->matches[result->count].table = table;
+    result->matches[result->count].position = selection[i];
+    result->count++;
+  }
+  return 1;
+}
+
+// a match offered to an ORDER BY, with the value it is ordered by
+typedef struct {
+  double key;
+  size_t offered; // matches offered before it, so ties keep result order
+  AdvQueryMatch match;
+} RankedMatch;
+
+// the first matches under a plan's ORDER BY, at most limit of them, in a
+// binary heap whose root is the one ranked last; a further match costs one
+// comparison with the root, and O(log k) when it displaces it
+typedef struct {
+  RankedMatch *heap;
+  size_t count;
+  size_t capacity;
+  size_t limit;
+  size_t offered;
+  QueryField order;
+  bool descending;
+} TopMatches;
+
+// true if a comes before b in the ordered result
+static inline bool ranks_before(const TopMatches *top, const RankedMatch *a,
+                                const RankedMatch *b) {
+  if (a->key != b->key) {
+    return top->descending ? a->key > b->key : a->key < b->key;
+  }
+  return a->offered < b->offered;
+}
+
+// restore the heap below slot i after its entry was replaced
+static void top_sift_down(TopMatches *top, size_t i) {
+  RankedMatch *heap = top->heap;
+  while (1) {
+    size_t last = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < top->count && ranks_before(top, &heap[last], &heap[left])) {
+      last = left;
+    }
+    if (right < top->count && ranks_before(top, &heap[last], &heap[right])) {
+      last = right;
+    }
+    if (last == i) {
+      return;
+    }
+    RankedMatch swap = heap[i];
+    heap[i] = heap[last];
+    heap[last] = swap;
+    i = last;
+  }
+}
+
+// offer a batch's surviving positions to the heap
+static int top_offer(TopMatches *top, const StudentTable *table,
+                     const size_t *selection, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    RankedMatch entry = {top->order == QUERY_FIELD_MARK
+                             ? (double)table_record_mark(table, selection[i])
+                             : (double)table_record_id(table, selection[i]),
+                         top->offered++,
+                         {table, selection[i]}};
+    if (top->count == top->limit) {
+      if (ranks_before(top, &entry, &top->heap[0])) {
+        top->heap[0] = entry;
+        top_sift_down(top, 0);
+      }
+      continue;
+    }
+    if (top->count == top->capacity) {
+      size_t capacity =
+          top->capacity ? top->capacity * 2 : ADV_QUERY_BATCH_SIZE;
+      capacity = capacity < top->limit ? capacity : top->limit;
+      RankedMatch *heap = realloc(top->heap, capacity * sizeof *heap);
+      if (!heap) {
+        return 0;
+      }
+      top->heap = heap;
+      top->capacity = capacity;
+    }
+    // sift the new entry up past every parent it ranks after
+    size_t slot = top->count++;
+    while (slot > 0 &&
+           ranks_before(top, &top->heap[(slot - 1) / 2], &entry)) {
+      top->heap[slot] = top->heap[(slot - 1) / 2];
+      slot = (slot - 1) / 2;
+    }
+    top->heap[slot] = entry;
+  }
+  return 1;
+}
+
+// move the heap's matches into result, first ranked first, by taking the
+// root (ranked last) into the back until the heap is empty
+static int top_drain(TopMatches *top, AdvQueryResult *result) {
+  if (top->count == 0) {
     return 1;
   }
+  result->matches = malloc(top->count * sizeof(AdvQueryMatch));
+  if (!result->matches) {
+    return 0;
+  }
+  result->count = top->count;
+  result->capacity = top->count;
+  while (top->count > 0) {
+    result->matches[top->count - 1] = top->heap[0].match;
+    top->heap[0] = top->heap[--top->count];
+    top_sift_down(top, 0);
+  }
+  return 1;
+}
+
+// append a table's matches to the result, or offer them to top when the
+// plan has an ORDER BY; appending stops at the plan's LIMIT
+static int keep_matches(const QueryPlan *plan, const StudentTable *table,
+                        const size_t *positions, size_t count,
+                        AdvQueryResult *result, TopMatches *top) {
+  if (top) {
+    return top_offer(top, table, positions, count);
+  }
+  if (count > plan->limit - result->count) {
+    count = plan->limit - result->count;
+  }
+  return append_matches(result, table, positions, count);
+}
+
+// run every batch of a source through the plan on the calling thread
+static AdvQueryStatus scan_source(const QueryPlan *plan, QuerySource *source,
+                                  bool contiguous, AdvQueryResult *result,
+                                  TopMatches *top) {
+  size_t selection[ADV_QUERY_BATCH_SIZE];
+  size_t count;
+  do {
+    count = next_batch(source, selection);
+    size_t kept =
+        filter_batch(plan, source->table, selection, count, contiguous);
+    if (!keep_matches(plan, source->table, selection, kept, result, top)) {
+      return ADV_QUERY_ERROR_MEMORY;
+    }
+  } while (count == ADV_QUERY_BATCH_SIZE && result->count < plan->limit);
+  return ADV_QUERY_SUCCESS;
+}
+
+// one morsel's matches, kept apart so that morsels finishing out of order
+// are still added to the result in view order
+typedef struct {
+  size_t *positions;
+  size_t count;
+  size_t capacity;
+} MorselMatches;
+
+// a table query shared by the workers pulling its morsels: ranges of
+// ADV_QUERY_MORSEL_SIZE cursor values (or candidates) of the source,
+// claimed in order from next
+typedef struct {
+  const QueryPlan *plan;
+  const QuerySource *source;
+  bool contiguous;
+  size_t morsel_count;
+  MorselMatches *morsels;
+  size_t limit;        // matches after which no further morsel is claimed
+  atomic_size_t next;  // next morsel to claim
+  atomic_size_t found; // matches in the morsels finished so far
+  atomic_bool failed;  // a worker ran out of memory
+} MorselQuery;
+
+static int morsel_append(MorselMatches *morsel, const size_t *selection,
+                         size_t count) {
+  if (count == 0) {
+    return 1;
+  }
+  if (morsel->count + count > morsel->capacity) {
+    size_t capacity = morsel->capacity ? morsel->capacity * 2
+                                       : ADV_QUERY_BATCH_SIZE;
+    size_t *positions = realloc(morsel->positions, capacity * sizeof(size_t));
+    if (!positions) {
+      return 0;
+    }
+    morsel->positions = positions;
+    morsel->capacity = capacity;
+  }
+  memcpy(morsel->positions + morsel->count, selection, count * sizeof(size_t));
+  morsel->count += count;
+  return 1;
+}
+
+// worker: claim morsels until none are left, running each batch of one
+// through the whole plan. morsels are claimed in order, so once those
+// finished hold limit matches the first limit are among the claimed ones
+static void morsel_task(void *arg) {
+  MorselQuery *query = *(MorselQuery **)arg;
+  size_t selection[ADV_QUERY_BATCH_SIZE];
+  while (!atomic_load_explicit(&query->failed, memory_order_relaxed) &&
+         atomic_load_explicit(&query->found, memory_order_relaxed) <
+             query->limit) {
+    size_t m = atomic_fetch_add_explicit(&query->next, 1, memory_order_relaxed);
+    if (m >= query->morsel_count) {
+      return;
+    }
+    QuerySource source = *query->source;
+    source.cursor = m * ADV_QUERY_MORSEL_SIZE;
+    source.end = source.cursor + ADV_QUERY_MORSEL_SIZE < query->source->end
+                     ? source.cursor + ADV_QUERY_MORSEL_SIZE
+                     : query->source->end;
+    MorselMatches *morsel = &query->morsels[m];
+    size_t count;
+    do {
+      count = next_batch(&source, selection);
+      size_t kept = filter_batch(query->plan, source.table, selection, count,
+                                 query->contiguous);
+      if (!morsel_append(morsel, selection, kept)) {
+        atomic_store_explicit(&query->failed, true, memory_order_relaxed);
+        return;
+      }
+    } while (count == ADV_QUERY_BATCH_SIZE);
+    atomic_fetch_add_explicit(&query->found, morsel->count,
+                              memory_order_relaxed);
+  }
+}
 
+// run a source's morsels through the plan on worker threads, then keep
+// their matches morsel by morsel, so the result is in view order as if
+// scanned on one thread
+static AdvQueryStatus scan_morsels(const QueryPlan *plan,
+                                   const QuerySource *source, bool contiguous,
+                                   size_t workers, AdvQueryResult *result,
+                                   TopMatches *top) {
+  MorselQuery query = {
+      .plan = plan,
+      .source = source,
+      .contiguous = contiguous,
+      .morsel_count =
+          (source->end + ADV_QUERY_MORSEL_SIZE - 1) / ADV_QUERY_MORSEL_SIZE,
+      .limit = top ? SIZE_MAX : plan->limit - result->count};
+  atomic_init(&query.next, 0);
+  atomic_init(&query.found, 0);
+  atomic_init(&query.failed, false);
+  query.morsels = calloc(query.morsel_count, sizeof(MorselMatches));
+  if (!query.morsels) {
+    return ADV_QUERY_ERROR_MEMORY;
+  }
+
+  MorselQuery *shared[MAX_WORKER_THREADS];
+  for (size_t w = 0; w < workers; w++) {
+    shared[w] = &query;
+  }
+  parallel_run(morsel_task, shared, sizeof shared[0], workers);
+
+  AdvQueryStatus status = atomic_load(&query.failed) ? ADV_QUERY_ERROR_MEMORY
+                                                     : ADV_QUERY_SUCCESS;
+  for (size_t m = 0; m < query.morsel_count; m++) {
+    MorselMatches *morsel = &query.morsels[m];
+    if (status == ADV_QUERY_SUCCESS && result->count < plan->limit &&
+        !keep_matches(plan, source->table, morsel->positions, morsel->count,
+                      result, top)) {
+      status = ADV_QUERY_ERROR_MEMORY;
+    }
+    free(morsel->positions);
+  }
+  free(query.morsels);
+  return status;
+}
+
+// worker threads for a table query reading reads positions: one below the
+// database's query_parallel_rows, otherwise its query_workers or one per
+// processor, and never more than there are morsels
+static size_t query_worker_count(const StudentDatabase *db, size_t reads) {
+  if (db->query_parallel_rows == 0 || reads < db->query_parallel_rows) {
+    return 1;
+  }
+  size_t workers = db->query_workers ? db->query_workers : parallel_cpu_count();
+  size_t morsels = (reads + ADV_QUERY_MORSEL_SIZE - 1) / ADV_QUERY_MORSEL_SIZE;
+  workers = workers < MAX_WORKER_THREADS ? workers : MAX_WORKER_THREADS;
+  return workers < morsels ? workers : morsels;
+}
+
+// append the matches of one table, reading only the positions its sorted
+// views, filter bitmaps and trigram index leave when it has them; with top,
+// they are offered to it instead. appending stops at the plan's LIMIT.
+// tables reading enough positions are scanned in morsels on worker threads
+static AdvQueryStatus select_table(const StudentDatabase *db, QueryPlan *plan,
+                                   const StudentTable *table,
+                                   AdvQueryResult *result, TopMatches *top) {
+  if (!prepare_stages(plan, table)) {
+    return ADV_QUERY_ERROR_MEMORY;
+  }
+  // follow the active view so results come out in the chosen sort order;
+  // stored order without deletes visits every position in turn
+  QuerySource source = {table, 0, 0, NULL, 0, NULL};
+  bool contiguous = table->active_view == TABLE_VIEW_STORAGE &&
+                    table->tombstone_count == 0;
+
+  // a sorted view answers the narrowest MARK or ID interval outright
+  uint32_t *candidates = NULL;
+  size_t candidate_count = 0;
+  bool narrowed = false;
+  if (!range_candidates(plan, table, &candidates, &candidate_count,
+                        &narrowed)) {
+    return ADV_QUERY_ERROR_MEMORY;
+  }
+
+  // filter bitmaps answer the programme and any remaining mark stage
+  if (!(narrowed && candidate_count == 0)) {
+    uint32_t *bitmapped;
+    size_t bitmapped_count;
+    bool used;
+    if (!bitmap_candidates(plan, table, &bitmapped, &bitmapped_count,
+                           &used)) {
+      free(candidates);
+      return ADV_QUERY_ERROR_MEMORY;
+    }
+    if (used) {
+      add_candidates(&candidates, &candidate_count, &narrowed, bitmapped,
+                     bitmapped_count);
+    }
+  }
+
+  // a trigram index narrows the positions to names holding every trigram
+  // of the pattern; the name stage still checks the whole pattern
+  const QueryStage *name = indexed_stage(plan, table);
+  if (name && !(narrowed && candidate_count == 0)) {
+    uint32_t *names;
+    size_t name_count;
+    if (!trigram_index_lookup(table->name_trigrams, name->needle.text,
+                              name->needle.length, &names, &name_count)) {
+      free(candidates);
+      return ADV_QUERY_ERROR_MEMORY;
+    }
+    add_candidates(&candidates, &candidate_count, &narrowed, names,
+                   name_count);
+  }
+  if (narrowed && candidate_count == 0) {
+    free(candidates);
+    return ADV_QUERY_SUCCESS;
+  }
+
+  uint64_t *allowed = NULL;
+  if (narrowed) {
+    contiguous = false;
+    if (table->active_view == TABLE_VIEW_STORAGE) {
+      source.picked = candidates;
+      source.picked_count = candidate_count;
+    } else {
+      allowed = calloc((table->slot_count + 63) / 64, sizeof(uint64_t));
+      if (!allowed) {
+        free(candidates);
+        return ADV_QUERY_ERROR_MEMORY;
+      }
+      for (size_t i = 0; i < candidate_count; i++) {
+        allowed[candidates[i] / 64] |= (uint64_t)1 << (candidates[i] % 64);
+      }
+      source.allowed = allowed;
+    }
+  }
+
+  source.end = source.picked ? source.picked_count
+                             : table_view_cursor_end(table);
+  size_t workers = query_worker_count(db, source.end);
+  AdvQueryStatus status =
+      workers > 1
+          ? scan_morsels(plan, &source, contiguous, workers, result, top)
+          : scan_source(plan, &source, contiguous, result, top);
+  free(candidates);
+  free(allowed);
+  return status;
+}
+
+// order of stages in a cache key: cheapest first as in the plan, then by
+// type, field and operand, since parse_plan keeps stages of equal cost in
+// the order they were written
+static int key_stage_compare(const QueryStage *a, const QueryStage *b) {
+  int cost = stage_cost(a) - stage_cost(b);
+  if (cost != 0) {
+    return cost;
+  }
+  if (a->type != b->type) {
+    return a->type < b->type ? -1 : 1;
+  }
+  if (a->type == STAGE_GREP) {
+    if (a->field != b->field) {
+      return a->field < b->field ? -1 : 1;
+    }
+    return strcmp(a->pattern, b->pattern);
+  }
+  if (a->range.low != b->range.low) {
+    return a->range.low < b->range.low ? -1 : 1;
+  }
+  if (a->range.high != b->range.high) {
+    return a->range.high < b->range.high ? -1 : 1;
+  }
   return 0;
 }
 
-// apply a parsed stage to the keep-mask
-static int apply_stage(const QueryStage *stage, StudentRecord **records,
-                       unsigned char *keep, size_t count) {
-  if (stage->type == STAGE_GREP) {
-    return apply_text_filter(records, keep, count, stage->field,
-                             stage->pattern);
+// the plan as a cache key: stages in key_stage_compare order with one
+// spelling of each command and field, MARK and ID comparisons as intervals
+// printed exactly and GREP patterns folded (they match case-insensitively),
+// then any ORDER BY and LIMIT, so pipelines differing only in case,
+// spacing, synonyms, stage order or how an interval is written share a key.
+// NULL if memory runs out
+static char *plan_key(const QueryPlan *plan) {
+  size_t size = 64;
+  const QueryStage *order[ADV_QUERY_FIELD_COUNT];
+  for (size_t s = 0; s < plan->count; s++) {
+    const QueryStage *stage = &plan->stages[s];
+    size += 64 + (stage->type == STAGE_GREP ? strlen(stage->pattern) : 0);
+    size_t slot = s;
+    while (slot > 0 && key_stage_compare(order[slot - 1], stage) > 0) {
+      order[slot] = order[slot - 1];
+      slot--;
+    }
+    order[slot] = stage;
+  }
+  char *key = malloc(size);
+  if (!key) {
+    return NULL;
+  }
+  size_t used = 0;
+  for (size_t s = 0; s < plan->count; s++) {
+    const QueryStage *stage = order[s];
+    const char *separator = s > 0 ? " | " : "";
+    if (stage->type != STAGE_GREP) {
+      const QueryRange *range = &stage->range;
+      used += (size_t)snprintf(
+          key + used, size - used, "%s%s %c%.17g, %.17g%c", separator,
+          stage->type == STAGE_MARK ? "MARK" : "ID",
+          range->low_open ? '(' : '[', range->low, range->high,
+          range->high_open ? ')' : ']');
+      continue;
+    }
+    used += (size_t)snprintf(
+        key + used, size - used, "%sGREP %s = ", separator,
+        stage->field == QUERY_FIELD_NAME ? "NAME" : "PROGRAMME");
+    for (const char *c = stage->pattern; *c; c++) {
+      key[used++] = (*c >= 'A' && *c <= 'Z') ? (char)(*c - 'A' + 'a') : *c;
+    }
+    key[used] = '\0';
+  }
+  if (plan->order != QUERY_FIELD_INVALID) {
+    used += (size_t)snprintf(key + used, size - used, "%sORDER BY %s %s",
+                             used > 0 ? " | " : "",
+                             plan->order == QUERY_FIELD_MARK ? "MARK" : "ID",
+                             plan->descending ? "DESC" : "ASC");
+  }
+  if (plan->limit != SIZE_MAX) {
+    snprintf(key + used, size - used, "%sLIMIT %zu", used > 0 ? " | " : "",
+             plan->limit);
+  }
+  return key;
+}
+
+// build a table's sorted views for a plan's MARK or ID interval if the
+// database allows it (range_index); views that cannot be built leave the
+// table to be scanned
+static void prepare_views(const StudentDatabase *db, const QueryPlan *plan,
+                          StudentTable *table) {
+  if (!db->range_index || table->views.built) {
+    return;
+  }
+  for (size_t s = 0; s < plan->count; s++) {
+    if (plan->stages[s].type != STAGE_GREP) {
+      table_views_build(table);
+      return;
+    }
   }
-  return apply_mark_filter(records, keep, count, stage->op, stage->value);
+}
+
+// true if filter bitmaps can answer every stage of a plan (programme and
+// mark stages only)
+static bool bitmaps_answer_plan(const QueryPlan *plan) {
+  for (size_t s = 0; s < plan->count; s++) {
+    const QueryStage *stage = &plan->stages[s];
+    if (stage->type == STAGE_ID ||
+        (stage->type == STAGE_GREP && stage->field == QUERY_FIELD_NAME)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// parse a pipeline into plan, keeping the working copy its patterns point
+// into (caller frees it and the plan)
+static AdvQueryStatus start_query(StudentDatabase *db, const char *pipeline,
+                                  char **working, QueryPlan *plan) {
+  if (db->table_count == 0) {
+    return ADV_QUERY_ERROR_EMPTY_DATABASE;
+  }
+  *working = dup_string(pipeline);
+  if (!*working) {
+    return ADV_QUERY_ERROR_MEMORY;
+  }
+  memset(plan, 0, sizeof *plan);
+  if (!parse_plan(*working, plan)) {
+    free(*working);
+    *working = NULL;
+    return ADV_QUERY_ERROR_PARSE;
+  }
+  return ADV_QUERY_SUCCESS;
 }
 
 /**
- * @brief executes a query pipeline and displays matching records
+ * @brief finds the records matching a query pipeline
  * @param[in] db pointer to the database to query
  * @param[in] pipeline query string with filter conditions separated by '|'
+ * @param[out] result matching records, in table order then active view order,
+ *             or in the order of the pipeline's ORDER BY
  * @return ADV_QUERY_SUCCESS on success, appropriate error code on failure
+ * @note the whole pipeline is parsed before any record is read. records are
+ *       then filtered ADV_QUERY_BATCH_SIZE view positions at a time, each
+ *       stage narrowing the batch's selection vector, cheapest stage first.
+ *       with sorted views on the table, a MARK or ID interval leaving at
+ *       most 1 in RANGE_INDEX_MAX_SHARE positions is found by binary search
+ *       (db->range_index lets the query build the views first). with a
+ *       trigram index on the table, a GREP NAME pattern of 3 or more
+ *       bytes limits the positions read to the index's candidates; with
+ *       filter bitmaps, programme and mark stages leaving under 1 in
+ *       FILTER_BITMAP_MAX_SHARE positions are answered from the bitmaps.
+ *       with a query cache on the database, the matches of a pipeline are
+ *       kept under its normalised text and returned without reading any
+ *       record until the database next changes. an ORDER BY keeps only the
+ *       first LIMIT matches found so far in a bounded heap, O(n log k),
+ *       without moving any stored record or view, with ties in the order
+ *       above; a LIMIT alone stops reading records once it is reached.
+ *       a table reading db->query_parallel_rows positions or more is read in
+ *       morsels of ADV_QUERY_MORSEL_SIZE pulled by worker threads, giving
+ *       the same matches in the same order
  */
-AdvQueryStatus adv_query_execute(StudentDatabase *db, const char *pipeline) {
-  if (!db || !pipeline) {
+AdvQueryStatus adv_query_select(StudentDatabase *db, const char *pipeline,
+                                AdvQueryResult *result) {
+  if (!db || !pipeline || !result) {
     return ADV_QUERY_ERROR_INVALID_ARGUMENT;
   }
-  if (db->table_count == 0) {
-    return ADV_QUERY_ERROR_EMPTY_DATABASE;
+  memset(result, 0, sizeof *result);
+  char *working;
+  QueryPlan plan;
+  AdvQueryStatus status = start_query(db, pipeline, &working, &plan);
+  if (status != ADV_QUERY_SUCCESS) {
+    return status;
   }
 
-  StudentRecord **records = NULL;
-  size_t total = collect_records(db, &records);
-  if (total == (size_t)-1) {
-    return ADV_QUERY_ERROR_MEMORY;
+  // a cached result found since the last change is copied, not recomputed
+  uint64_t mutations = db_mutation_count(db);
+  char *key = db->query_cache ? plan_key(&plan) : NULL;
+  const QueryCacheEntry *cached =
+      key ? query_cache_lookup(db->query_cache, key, mutations) : NULL;
+  if (cached && cached->count > 0) {
+    result->matches = malloc(cached->count * sizeof(AdvQueryMatch));
+    if (!result->matches) {
+      status = ADV_QUERY_ERROR_MEMORY;
+    } else {
+      memcpy(result->matches, cached->matches,
+             cached->count * sizeof(AdvQueryMatch));
+      result->count = cached->count;
+      result->capacity = cached->count;
+    }
   }
-  if (total == 0) {
-    printf("ADVQUERY: No records matched the pipeline.\n");
-    return ADV_QUERY_SUCCESS;
+
+  // an ORDER BY keeps its first LIMIT matches in a heap across the tables
+  TopMatches top = {NULL, 0, 0, plan.limit, 0, plan.order, plan.descending};
+  TopMatches *ordered = plan.order != QUERY_FIELD_INVALID ? &top : NULL;
+  for (size_t t = 0; !cached && t < db->table_count &&
+                     status == ADV_QUERY_SUCCESS && result->count < plan.limit;
+       t++) {
+    StudentTable *table = db->tables[t];
+    if (table && table->record_count > 0) {
+      prepare_views(db, &plan, table);
+      status = select_table(db, &plan, table, result, ordered);
+    }
+  }
+  if (ordered && status == ADV_QUERY_SUCCESS && !top_drain(&top, result)) {
+    status = ADV_QUERY_ERROR_MEMORY;
+  }
+  free(top.heap);
+  if (!cached && key && status == ADV_QUERY_SUCCESS) {
+    query_cache_store(db->query_cache, key, mutations, result);
   }
 
-  unsigned char *keep = malloc(total);
-  if (!keep) {
-    free(records);
-    return ADV_QUERY_ERROR_MEMORY;
+  free(key);
+  free_plan(&plan);
+  free(working);
+  if (status != ADV_QUERY_SUCCESS) {
+    adv_query_result_free(result);
   }
-  memset(keep, 1, total);
+  return status;
+}
 
-  char *working = dup_string(pipeline);
-  if (!working) {
-    free(records);
-    free(keep);
-    return ADV_QUERY_ERROR_MEMORY;
+/**
+ * @brief counts the records matching a query pipeline
+ * @param[in] db pointer to the database to query
+ * @param[in] pipeline query string with filter conditions separated by '|'
+ * @param[out] count number of matching records
+ * @return ADV_QUERY_SUCCESS on success, appropriate error code on failure
+ * @note a table whose filter bitmaps answer every stage (programme and mark
+ *       only) is counted by popcount over the bitmaps, comparing only the
+ *       marks in the band straddling the bound, and a single MARK or ID
+ *       interval is counted from its ranks in a table's sorted views; other
+ *       tables are counted as adv_query_select would find them. a result in
+ *       the query cache is counted without reading any record. ORDER BY is
+ *       ignored and the count stops at LIMIT
+ */
+AdvQueryStatus adv_query_count(StudentDatabase *db, const char *pipeline,
+                               size_t *count) {
+  if (!db || !pipeline || !count) {
+    return ADV_QUERY_ERROR_INVALID_ARGUMENT;
+  }
+  *count = 0;
+  char *working;
+  QueryPlan plan;
+  AdvQueryStatus status = start_query(db, pipeline, &working, &plan);
+  if (status != ADV_QUERY_SUCCESS) {
+    return status;
   }
 
-  int field_used[3] = {0};
-  int success = 1;
-  int stages = 0;
-  char *ctx = NULL;
-  char *stage = strtok_r(working, "|", &ctx);
+  // a cached result found since the last change already knows its count
+  char *key = db->query_cache ? plan_key(&plan) : NULL;
+  const QueryCacheEntry *cached =
+      key ? query_cache_lookup(db->query_cache, key, db_mutation_count(db))
+          : NULL;
+  free(key);
 
-  while (stage && success) {
-    QueryStage parsed = {0};
-    success = parse_stage(stage, &parsed, field_used) &&
-              apply_stage(&parsed, records, keep, total);
-    if (success) {
-      stages++;
-      stage = strtok_r(NULL, "|", &ctx);
+  size_t total = cached ? cached->count : 0;
+  for (size_t t = 0;
+       !cached && t < db->table_count && status == ADV_QUERY_SUCCESS; t++) {
+    StudentTable *table = db->tables[t];
+    if (!table || table->record_count == 0) {
+      continue;
     }
+    if (plan.count == 0) {
+      total += table->record_count;
+      continue;
+    }
+    prepare_views(db, &plan, table);
+    if (plan.count == 1 && plan.stages[0].type != STAGE_GREP &&
+        table->views.built) {
+      size_t first;
+      size_t end;
+      view_ranks(table, &plan.stages[0], &first, &end);
+      total += end - first;
+      continue;
+    }
+    if (!table->filter_bitmaps || !bitmaps_answer_plan(&plan)) {
+      AdvQueryResult matches = {0};
+      status = select_table(db, &plan, table, &matches, NULL);
+      total += matches.count;
+      adv_query_result_free(&matches);
+      continue;
+    }
+
+    FilterSets sets;
+    if (!prepare_stages(&plan, table) ||
+        !gather_filter_sets(&plan, table, &sets)) {
+      status = ADV_QUERY_ERROR_MEMORY;
+      break;
+    }
+    RoaringBitmap maybe;
+    roaring_init(&maybe);
+    uint32_t *boundary = NULL;
+    size_t maybe_count = 0;
+    if (!boundary_positions(&sets, &maybe) ||
+        ((maybe_count = roaring_cardinality(&maybe)) > 0 &&
+         !(boundary = malloc(maybe_count * sizeof(uint32_t))))) {
+      status = ADV_QUERY_ERROR_MEMORY;
+    } else {
+      total += passing_count(&sets);
+      if (boundary) {
+        roaring_to_array(&maybe, boundary);
+        total += verify_marks(sets.mark, table, boundary, maybe_count,
+                              boundary);
+      }
+    }
+    free(boundary);
+    roaring_free(&maybe);
+    free_filter_sets(&sets);
   }
 
-  if (!success || stages == 0) {
-    free(records);
-    free(keep);
-    free(working);
-    return ADV_QUERY_ERROR_PARSE;
+  free_plan(&plan);
+  free(working);
+  if (status == ADV_QUERY_SUCCESS) {
+    *count = total < plan.limit ? total : plan.limit;
   }
+  return status;
+}
 
-  size_t match_count = 0;
-  for (size_t i = 0; i < total; i++) {
-    if (keep[i]) {
-      match_count++;
-    }
+/**
+ * @brief releases the matches held by a query result
+ * @param[in,out] result result to empty
+ */
+void adv_query_result_free(AdvQueryResult *result) {
+  if (!result) {
+    return;
   }
+  free(result->matches);
+  memset(result, 0, sizeof *result);
+}
 
-  if (match_count == 0) {
+/**
+ * @brief executes a query pipeline and displays matching records
+ * @param[in] db pointer to the database to query
+ * @param[in] pipeline query string with filter conditions separated by '|'
+ * @return ADV_QUERY_SUCCESS on success, appropriate error code on failure
+ */
+AdvQueryStatus adv_query_execute(StudentDatabase *db, const char *pipeline) {
+  AdvQueryResult result;
+  AdvQueryStatus status = adv_query_select(db, pipeline, &result);
+  if (status != ADV_QUERY_SUCCESS) {
+    return status;
+  }
+
+  if (result.count == 0) {
     printf("ADVQUERY: No records matched the pipeline.\n");
   } else {
     printf("ID\tName\tProgramme\tMark\n");
-    for (size_t i = 0; i < total; i++) {
-      if (keep[i]) {
-        StudentRecord *r = records[i];
-        printf("%d\t%s\t%s\t%.2f\n", r->id, r->name, r->prog, r->mark);
-      }
+    for (size_t i = 0; i < result.count; i++) {
+      const StudentTable *t = result.matches[i].table;
+      size_t p = result.matches[i].position;
+      printf("%d\t%s\t%s\t%.2f\n", table_record_id(t, p),
+             table_record_name(t, p), table_record_prog(t, p),
+             table_record_mark(t, p));
     }
-    printf("Total: %zu record(s)\n", match_count);
+    printf("Total: %zu record(s)\n", result.count);
   }
 
-  free(records);
-  free(keep);
-  free(working);
+  adv_query_result_free(&result);
   return ADV_QUERY_SUCCESS;
 }
 
@@ -394,8 +1727,8 @@ const char *adv_query_status_string(AdvQueryStatus status) {
 // ------------------------------------------------------------
 
 typedef struct {
-  int field;  // 1=Name, 2=Programme, 3=Mark
-  char op;    // for Mark comparisons
+  int field;      // 1=Name, 2=Programme, 3=Mark, 4=ID
+  const char *op; // for Mark and ID comparisons
   char value[256];
 } AdvQuerySelection;
 
@@ -449,36 +1782,50 @@ static void prompt_text(const char *label, char *out, size_t size) {
         *p = '\'';
       }
     }
-    strncpy(out, buf, size - 1);
-    out[size - 1] = '\0';
+    size_t length = strlen(buf);
+    if (length >= size) {
+      length = size - 1;
+    }
+    memcpy(out, buf, length);
+    out[length] = '\0';
     break;
   }
 }
 
-static char prompt_mark_op(void) {
+static const char *prompt_compare_op(const char *label) {
+  static const char *ops[] = {">", "<", "=", ">=", "<=", "BETWEEN"};
   int choice = 0;
   while (1) {
-    printf("\nMark comparison\n 1) Greater than\n 2) Less than\n 3) Equal to\n");
+    printf("\n%s comparison\n 1) Greater than\n 2) Less than\n 3) Equal to\n"
+           " 4) At least\n 5) At most\n 6) Between\n",
+           label);
     int rc = prompt_int("Select option: ", &choice);
-    if (rc == 1 && choice >= 1 && choice <= 3) {
-      return (choice == 1) ? '>' : (choice == 2) ? '<' : '=';
+    if (rc == 1 && choice >= 1 && choice <= 6) {
+      return ops[choice - 1];
     }
-    printf("Please enter 1, 2, or 3.\n");
+    printf("Please enter a number from 1 to 6.\n");
   }
 }
 
 static const char *field_token(int field) {
-  return (field == 1) ? "NAME" : (field == 2) ? "PROGRAMME" : "MARK";
+  return (field == 1)   ? "NAME"
+         : (field == 2) ? "PROGRAMME"
+         : (field == 3) ? "MARK"
+                        : "ID";
 }
 
 static const char *field_label(int field) {
-  return (field == 1) ? "Name" : (field == 2) ? "Programme" : "Mark";
+  return (field == 1)   ? "Name"
+         : (field == 2) ? "Programme"
+         : (field == 3) ? "Mark"
+                        : "ID";
 }
 
 static int collect_fields(AdvQuerySelection *sel, size_t *count) {
   size_t n = 0;
   while (n < ADV_QUERY_FIELD_COUNT && n < ADV_QUERY_MAX_SELECTIONS) {
-    printf("\nPick a field to filter:\n 1) Name\n 2) Programme\n 3) Mark\n 0) Cancel\n");
+    printf("\nPick a field to filter:\n 1) Name\n 2) Programme\n 3) Mark\n"
+           " 4) ID\n 0) Cancel\n");
     int choice = 0;
     int rc = prompt_int("Select option: ", &choice);
     if (rc == 0) {
@@ -491,7 +1838,7 @@ static int collect_fields(AdvQuerySelection *sel, size_t *count) {
       }
       break;
     }
-    if (rc == 1 && choice >= 1 && choice <= 3) {
+    if (rc == 1 && choice >= 1 && choice <= ADV_QUERY_FIELD_COUNT) {
       int dup = 0;
       for (size_t i = 0; i < n; i++) {
         if (sel[i].field == choice) {
@@ -505,7 +1852,7 @@ static int collect_fields(AdvQuerySelection *sel, size_t *count) {
         continue;
       }
       sel[n].field = choice;
-      sel[n].op = '=';
+      sel[n].op = "=";
       sel[n].value[0] = '\0';
       n++;
       if (n >= ADV_QUERY_FIELD_COUNT) {
@@ -525,9 +1872,23 @@ static int collect_fields(AdvQuerySelection *sel, size_t *count) {
 
 static void collect_values(AdvQuerySelection *sel, size_t count) {
   for (size_t i = 0; i < count; i++) {
-    if (sel[i].field == 3) {
-      sel[i].op = prompt_mark_op();
-      prompt_text("mark value", sel[i].value, sizeof sel[i].value);
+    if (sel[i].field >= 3) {
+      const char *noun = sel[i].field == 3 ? "mark" : "ID";
+      char what[32];
+      sel[i].op = prompt_compare_op(field_label(sel[i].field));
+      if (strcmp(sel[i].op, "BETWEEN") != 0) {
+        snprintf(what, sizeof what, "%s value", noun);
+        prompt_text(what, sel[i].value, sizeof sel[i].value);
+        continue;
+      }
+      // value holds "low AND high"
+      size_t size = sizeof sel[i].value / 2;
+      snprintf(what, sizeof what, "lowest %s", noun);
+      prompt_text(what, sel[i].value, size);
+      strcat(sel[i].value, " AND ");
+      size_t used = strlen(sel[i].value);
+      snprintf(what, sizeof what, "highest %s", noun);
+      prompt_text(what, sel[i].value + used, sizeof sel[i].value - used);
     } else {
       prompt_text(field_label(sel[i].field), sel[i].value,
                   sizeof sel[i].value);
@@ -540,8 +1901,9 @@ static void build_pipeline(const AdvQuerySelection *sel, size_t count,
   pipeline[0] = '\0';
   for (size_t i = 0; i < count; i++) {
     char stage[256];
-    if (sel[i].field == 3) {
-      snprintf(stage, sizeof stage, "MARK %c %s", sel[i].op, sel[i].value);
+    if (sel[i].field >= 3) {
+      snprintf(stage, sizeof stage, "%s %s %s", field_token(sel[i].field),
+               sel[i].op, sel[i].value);
     } else {
       snprintf(stage, sizeof stage, "GREP %s = \"%s\"",
                field_token(sel[i].field), sel[i].value);
@@ -553,6 +1915,45 @@ static void build_pipeline(const AdvQuerySelection *sel, size_t count,
   }
 }
 
+// offer to order and limit the matches, appending the clauses chosen to the
+// pipeline
+static void collect_order(char *pipeline, size_t size) {
+  static const char *orders[] = {"MARK DESC", "MARK ASC", "ID DESC",
+                                 "ID ASC"};
+  size_t used = strlen(pipeline);
+  if (prompt_yes_no("Order the results? (Y/N): ")) {
+    int choice = 0;
+    while (1) {
+      printf("\nOrder by\n 1) Mark, highest first\n 2) Mark, lowest first\n"
+             " 3) ID, highest first\n 4) ID, lowest first\n");
+      int rc = prompt_int("Select option: ", &choice);
+      if (rc == 0) {
+        return;
+      }
+      if (rc == 1 && choice >= 1 && choice <= 4) {
+        break;
+      }
+      printf("Please enter a number from 1 to 4.\n");
+    }
+    used += (size_t)snprintf(pipeline + used, size - used, " | ORDER BY %s",
+                             orders[choice - 1]);
+  }
+  if (prompt_yes_no("Limit the number of results? (Y/N): ")) {
+    int limit = 0;
+    while (1) {
+      int rc = prompt_int("Enter the most results to show: ", &limit);
+      if (rc == 0) {
+        return;
+      }
+      if (rc == 1 && limit >= 1) {
+        break;
+      }
+      printf("Please enter a whole number of at least 1.\n");
+    }
+    snprintf(pipeline + used, size - used, " | LIMIT %d", limit);
+  }
+}
+
 /**
  * @brief runs interactive query prompt with guided help
  * @param[in] db pointer to the database to query
@@ -577,6 +1978,7 @@ AdvQueryStatus adv_query_run_prompt(StudentDatabase *db) {
 
   char pipeline[256 * ADV_QUERY_MAX_SELECTIONS] = {0};
   build_pipeline(selections, selection_count, pipeline, sizeof pipeline);
+  collect_order(pipeline, sizeof pipeline);
 
   return adv_query_execute(db, pipeline);
 }
@@ -0,0 +1,224 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// round size up to the allocation alignment (0 if it would overflow)
+static size_t align_size(size_t size) {
+  if (size > SIZE_MAX - (ARENA_ALIGNMENT - 1)) {
+    return 0;
+  }
+  return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+// malloc a block of at least size bytes and append it to the chain
+static ArenaBlock *add_block(Arena *arena, size_t size) {
+  size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+  if (capacity > SIZE_MAX - sizeof(ArenaBlock)) {
+    return NULL;
+  }
+
+  ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+  if (!block) {
+    return NULL;
+  }
+  block->next = NULL;
+  block->capacity = capacity;
+  block->used = 0;
+
+  if (!arena->head) {
+    arena->head = block;
+  } else {
+    ArenaBlock *tail = arena->current;
+    while (tail->next) {
+      tail = tail->next;
+    }
+    tail->next = block;
+  }
+
+  arena->stats.block_mallocs++;
+  arena->stats.bytes_reserved += capacity;
+  return block;
+}
+
+/**
+ * @brief initialises an empty arena (no memory is allocated)
+ * @param[out] arena pointer to the arena to initialise
+ */
+void arena_init(Arena *arena) {
+  if (!arena) {
+    return;
+  }
+  memset(arena, 0, sizeof *arena);
+}
+
+/**
+ * @brief releases every block held by an arena
+ * @param[in,out] arena pointer to the arena to free (can be NULL)
+ * @note all memory handed out by the arena becomes invalid
+ */
+void arena_free(Arena *arena) {
+  if (!arena) {
+    return;
+  }
+  ArenaBlock *block = arena->head;
+  while (block) {
+    ArenaBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  arena_init(arena);
+}
+
+/**
+ * @brief discards every allocation while keeping the blocks for reuse
+ * @param[in,out] arena pointer to the arena to reset (can be NULL)
+ * @note all memory handed out by the arena becomes invalid
+ */
+void arena_reset(Arena *arena) {
+  if (!arena) {
+    return;
+  }
+  for (ArenaBlock *block = arena->head; block; block = block->next) {
+    block->used = 0;
+  }
+  arena->current = arena->head;
+  arena->last = NULL;
+  arena->stats.allocations = 0;
+  arena->stats.bytes_used = 0;
+  arena->stats.resets++;
+}
+
+/**
+ * @brief allocates memory from an arena, or from the heap if arena is NULL
+ * @param[in,out] arena pointer to the arena (NULL for malloc)
+ * @param[in] size number of bytes
+ * @return pointer aligned to ARENA_ALIGNMENT, NULL if memory runs out
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+  if (!arena) {
+    return malloc(size);
+  }
+
+  size_t aligned = align_size(size > 0 ? size : 1);
+  if (aligned == 0) {
+    return NULL;
+  }
+
+  // blocks after current are either untouched since the last reset or were
+  // just added, so the first one with room is used and earlier leftovers
+  // are skipped; the same load sequence then maps onto the same blocks
+  ArenaBlock *block = arena->current;
+  while (block && block->capacity - block->used < aligned) {
+    block = block->next;
+  }
+  if (!block) {
+    block = add_block(arena, aligned);
+    if (!block) {
+      return NULL;
+    }
+  }
+
+  void *ptr = block->data + block->used;
+  block->used += aligned;
+  arena->current = block;
+  arena->last = ptr;
+  arena->stats.allocations++;
+  arena->stats.bytes_used += aligned;
+  return ptr;
+}
+
+/**
+ * @brief allocates zero-filled memory from an arena, or calloc if NULL
+ * @param[in,out] arena pointer to the arena (NULL for calloc)
+ * @param[in] count number of elements
+ * @param[in] size size of each element
+ * @return pointer to the zeroed memory, NULL on overflow or out of memory
+ */
+void *arena_calloc(Arena *arena, size_t count, size_t size) {
+  if (!arena) {
+    return calloc(count, size);
+  }
+  if (size != 0 && count > SIZE_MAX / size) {
+    return NULL;
+  }
+  void *ptr = arena_alloc(arena, count * size);
+  if (ptr) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+/**
+ * @brief resizes an allocation, like realloc
+ * @param[in,out] arena pointer to the arena (NULL for realloc)
+ * @param[in] ptr allocation to resize (can be NULL)
+ * @param[in] old_size current size of ptr in bytes
+ * @param[in] new_size size wanted in bytes
+ * @return pointer to the resized memory, NULL on failure (ptr stays valid)
+ * @note in an arena the most recent allocation grows in place when its block
+ *       has room; otherwise the contents are copied and the old bytes stay
+ *       unused until the next reset
+ */
+void *arena_resize(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+  if (!arena) {
+    return realloc(ptr, new_size);
+  }
+  if (!ptr) {
+    return arena_alloc(arena, new_size);
+  }
+
+  size_t old_aligned = align_size(old_size > 0 ? old_size : 1);
+  size_t new_aligned = align_size(new_size > 0 ? new_size : 1);
+  if (new_aligned == 0) {
+    return NULL;
+  }
+  if (new_aligned <= old_aligned) {
+    return ptr;
+  }
+
+  ArenaBlock *block = arena->current;
+  if (ptr == arena->last &&
+      (unsigned char *)ptr + old_aligned == block->data + block->used &&
+      block->capacity - block->used >= new_aligned - old_aligned) {
+    block->used += new_aligned - old_aligned;
+    arena->stats.bytes_used += new_aligned - old_aligned;
+    return ptr;
+  }
+
+  void *moved = arena_alloc(arena, new_size);
+  if (!moved) {
+    return NULL;
+  }
+  memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+  return moved;
+}
+
+/**
+ * @brief gives back an allocation (a no-op for arena memory)
+ * @param[in,out] arena pointer to the arena (NULL for free)
+ * @param[in] ptr allocation to release (can be NULL)
+ */
+void arena_release(Arena *arena, void *ptr) {
+  if (!arena) {
+    free(ptr);
+  }
+}
+
+/**
+ * @brief copies a NUL-terminated string into an arena, or strdup if NULL
+ * @param[in,out] arena pointer to the arena (NULL for the heap)
+ * @param[in] text string to copy
+ * @return pointer to the copy, NULL if memory runs out
+ */
+char *arena_strdup(Arena *arena, const char *text) {
+  if (!text) {
+    return NULL;
+  }
+  size_t size = strlen(text) + 1;
+  char *copy = arena_alloc(arena, size);
+  if (copy) {
+    memcpy(copy, text, size);
+  }
+  return copy;
+}
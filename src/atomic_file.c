@@ -0,0 +1,107 @@
+#include "atomic_file.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief forces an open file's written data to disk
+ * @param[in] fp stream to sync
+ * @return true if the data was flushed and synced
+ */
+bool file_sync(FILE *fp) {
+  if (fflush(fp) != 0) {
+    return false;
+  }
+#ifdef _WIN32
+  return _commit(_fileno(fp)) == 0;
+#else
+  return fsync(fileno(fp)) == 0;
+#endif
+}
+
+#ifndef _WIN32
+// sync the directory holding path so a rename into it survives a crash;
+// best effort, as some file systems cannot sync directories
+static void sync_parent_directory(const char *path) {
+  char directory[MAX_FILE_PATH];
+  const char *slash = strrchr(path, '/');
+  if (!slash) {
+    strcpy(directory, ".");
+  } else {
+    size_t length = slash > path ? (size_t)(slash - path) : 1;
+    memcpy(directory, path, length);
+    directory[length] = '\0';
+  }
+  int fd = open(directory, O_RDONLY);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+#endif
+
+/**
+ * @brief opens a temp file to be renamed over path once written
+ * @param[out] file receives the open temp file
+ * @param[in] path file the temp file will replace
+ * @return the temp file's stream, or NULL if path is too long or the temp
+ *         file cannot be created
+ */
+FILE *atomic_file_open(AtomicFile *file, const char *path) {
+  file->fp = NULL;
+  size_t length = strlen(path);
+  if (length >= sizeof file->path) {
+    return NULL;
+  }
+  memcpy(file->path, path, length + 1);
+  memcpy(file->temp_path, path, length);
+  memcpy(file->temp_path + length, ".tmp", sizeof ".tmp");
+  file->fp = fopen(file->temp_path, "wb");
+  return file->fp;
+}
+
+/**
+ * @brief flushes the temp file to disk and renames it over its target
+ * @param[in,out] file file opened by atomic_file_open
+ * @return true if the target now holds the written bytes durably, false
+ *         otherwise (the temp file is removed and the target left as it was)
+ */
+bool atomic_file_commit(AtomicFile *file) {
+  bool ok = file_sync(file->fp);
+  if (fclose(file->fp) != 0) {
+    ok = false;
+  }
+  file->fp = NULL;
+#ifdef _WIN32
+  ok = ok && MoveFileExA(file->temp_path, file->path,
+                         MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+  ok = ok && rename(file->temp_path, file->path) == 0;
+  if (ok) {
+    sync_parent_directory(file->path);
+  }
+#endif
+  if (!ok) {
+    remove(file->temp_path);
+  }
+  return ok;
+}
+
+/**
+ * @brief closes and removes the temp file, leaving the target untouched
+ * @param[in,out] file file opened by atomic_file_open (can be NULL)
+ */
+void atomic_file_abort(AtomicFile *file) {
+  if (!file || !file->fp) {
+    return;
+  }
+  fclose(file->fp);
+  file->fp = NULL;
+  remove(file->temp_path);
+}
@@ -0,0 +1,252 @@
+#include "bitmap_index.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief initialises an empty index (no memory is allocated)
+ * @param[out] index pointer to the index to initialise
+ */
+void bitmap_index_init(BitmapIndex *index) {
+  if (!index) {
+    return;
+  }
+  index->programmes = NULL;
+  index->programme_count = 0;
+  for (size_t b = 0; b < MARK_BAND_COUNT; b++) {
+    roaring_init(&index->bands[b]);
+  }
+}
+
+/**
+ * @brief frees all memory held by an index, leaving it empty
+ * @param[in,out] index pointer to the index to free (can be NULL)
+ */
+void bitmap_index_free(BitmapIndex *index) {
+  if (!index) {
+    return;
+  }
+  for (uint32_t code = 0; code < index->programme_count; code++) {
+    roaring_free(&index->programmes[code]);
+  }
+  free(index->programmes);
+  for (size_t b = 0; b < MARK_BAND_COUNT; b++) {
+    roaring_free(&index->bands[b]);
+  }
+  bitmap_index_init(index);
+}
+
+/**
+ * @brief returns the band a mark falls in
+ * @param[in] mark mark to place
+ * @return band below MARK_BAND_COUNT
+ */
+size_t bitmap_index_band(float mark) {
+  if (!(mark >= MARK_BAND_WIDTH)) {
+    return 0; // negative marks and NaN as well
+  }
+  if (mark >= (float)(MARK_BAND_WIDTH * (MARK_BAND_COUNT - 1))) {
+    return MARK_BAND_COUNT - 1;
+  }
+  // a float below a band's bound is far enough below it that the double
+  // quotient cannot round up to the next band
+  return (size_t)((double)mark / MARK_BAND_WIDTH);
+}
+
+/**
+ * @brief compares a whole band with a MARK filter
+ * @param[in] band band below MARK_BAND_COUNT
+ * @param[in] op comparison ('<', '>' or '=')
+ * @param[in] value bound the marks are compared with
+ * @return whether none, all or some of the band's marks can pass
+ * @note the first and last bands are open-ended, so they are always
+ *       MARK_BAND_CHECK unless no mark in them can pass
+ */
+MarkBandVerdict bitmap_index_band_verdict(size_t band, char op, double value) {
+  switch (op) {
+  case '>':
+    return bitmap_index_range_verdict(band, value, true, INFINITY, false);
+  case '<':
+    return bitmap_index_range_verdict(band, -INFINITY, false, value, true);
+  default:
+    return bitmap_index_range_verdict(band, value, false, value, false);
+  }
+}
+
+/**
+ * @brief compares a whole band with an interval of marks
+ * @param[in] band band below MARK_BAND_COUNT
+ * @param[in] low lowest mark of the interval (can be -INFINITY)
+ * @param[in] low_open true if low itself is outside the interval
+ * @param[in] high highest mark of the interval (can be INFINITY)
+ * @param[in] high_open true if high itself is outside the interval
+ * @return whether none, all or some of the band's marks fall in the interval
+ * @note '<', '>' and '=' filters are the intervals (-inf, v), (v, inf] and
+ *       [v, v]; the first band is never MARK_BAND_PASS, as NaN falls in no
+ *       interval
+ */
+MarkBandVerdict bitmap_index_range_verdict(size_t band, double low,
+                                           bool low_open, double high,
+                                           bool high_open) {
+  // marks of the band lie in [band_low, band_high), the last band's in
+  // [band_low, inf]
+  bool last = band == MARK_BAND_COUNT - 1;
+  double band_low = band == 0 ? -INFINITY : (double)band * MARK_BAND_WIDTH;
+  double band_high = last ? INFINITY : (double)(band + 1) * MARK_BAND_WIDTH;
+
+  bool empty = low > high || (low == high && (low_open || high_open));
+  bool below = high < band_low || (high == band_low && high_open);
+  bool above = last ? low == INFINITY && low_open : low >= band_high;
+  if (empty || below || above || isnan(low) || isnan(high)) {
+    return MARK_BAND_FAIL;
+  }
+
+  bool from_low = band_low > low || (band_low == low && !low_open);
+  bool to_high = last ? high == INFINITY && !high_open : band_high <= high;
+  return from_low && to_high && band != 0 ? MARK_BAND_PASS : MARK_BAND_CHECK;
+}
+
+// grow the programme bitmaps to cover code
+static bool reserve_programmes(BitmapIndex *index, uint32_t code) {
+  if (code < index->programme_count) {
+    return true;
+  }
+  uint32_t count = index->programme_count ? index->programme_count : 8;
+  while (count <= code) {
+    count *= 2;
+  }
+  RoaringBitmap *programmes =
+      realloc(index->programmes, count * sizeof(RoaringBitmap));
+  if (!programmes) {
+    return false;
+  }
+  for (uint32_t c = index->programme_count; c < count; c++) {
+    roaring_init(&programmes[c]);
+  }
+  index->programmes = programmes;
+  index->programme_count = count;
+  return true;
+}
+
+/**
+ * @brief adds a record position under its programme code and mark band
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] code programme dictionary code of the record
+ * @param[in] mark mark of the record
+ * @return true on success, false if memory allocation fails (the position
+ *         may then be under one of the two only)
+ */
+bool bitmap_index_add(BitmapIndex *index, uint32_t position, uint32_t code,
+                      float mark) {
+  if (!index || !reserve_programmes(index, code)) {
+    return false;
+  }
+  return roaring_add(&index->programmes[code], position) &&
+         roaring_add(&index->bands[bitmap_index_band(mark)], position);
+}
+
+/**
+ * @brief removes a record position from its programme code and mark band
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] code programme code the position was added with
+ * @param[in] mark mark the position was added with
+ */
+void bitmap_index_remove(BitmapIndex *index, uint32_t position, uint32_t code,
+                         float mark) {
+  if (!index) {
+    return;
+  }
+  if (code < index->programme_count) {
+    roaring_remove(&index->programmes[code], position);
+  }
+  roaring_remove(&index->bands[bitmap_index_band(mark)], position);
+}
+
+// rebuild one bitmap with every position renumbered; ascending positions
+// stay ascending, so each add appends
+static bool remap_bitmap(RoaringBitmap *bitmap, const uint32_t *new_position) {
+  size_t count = roaring_cardinality(bitmap);
+  if (count == 0) {
+    return true;
+  }
+  uint32_t *positions = malloc(count * sizeof(uint32_t));
+  if (!positions) {
+    return false;
+  }
+  roaring_to_array(bitmap, positions);
+  RoaringBitmap remapped;
+  roaring_init(&remapped);
+  for (size_t i = 0; i < count; i++) {
+    if (!roaring_add(&remapped, new_position[positions[i]])) {
+      roaring_free(&remapped);
+      free(positions);
+      return false;
+    }
+  }
+  free(positions);
+  roaring_free(bitmap);
+  *bitmap = remapped;
+  return true;
+}
+
+/**
+ * @brief renumbers every position after records are moved down
+ * @param[in,out] index pointer to the index
+ * @param[in] new_position new position of each indexed position
+ * @return true on success, false if memory allocation fails (the index is
+ *         then left empty)
+ * @note new_position must keep positions in the same order (a purge)
+ */
+bool bitmap_index_remap(BitmapIndex *index, const uint32_t *new_position) {
+  if (!index || !new_position) {
+    return false;
+  }
+  for (uint32_t code = 0; code < index->programme_count; code++) {
+    if (!remap_bitmap(&index->programmes[code], new_position)) {
+      bitmap_index_free(index);
+      return false;
+    }
+  }
+  for (size_t b = 0; b < MARK_BAND_COUNT; b++) {
+    if (!remap_bitmap(&index->bands[b], new_position)) {
+      bitmap_index_free(index);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief returns the positions holding a programme code
+ * @param[in] index pointer to the index
+ * @param[in] code programme dictionary code
+ * @return bitmap of the code, or NULL if no position was ever added with it
+ */
+const RoaringBitmap *bitmap_index_programme(const BitmapIndex *index,
+                                            uint32_t code) {
+  if (!index || code >= index->programme_count) {
+    return NULL;
+  }
+  return &index->programmes[code];
+}
+
+/**
+ * @brief returns the bytes an index holds
+ * @param[in] index pointer to the index
+ * @return allocated bytes of every bitmap
+ */
+size_t bitmap_index_memory(const BitmapIndex *index) {
+  if (!index) {
+    return 0;
+  }
+  size_t bytes = index->programme_count * sizeof(RoaringBitmap);
+  for (uint32_t code = 0; code < index->programme_count; code++) {
+    bytes += roaring_memory(&index->programmes[code]);
+  }
+  for (size_t b = 0; b < MARK_BAND_COUNT; b++) {
+    bytes += roaring_memory(&index->bands[b]);
+  }
+  return bytes;
+}
@@ -2,6 +2,7 @@
 #include "commands/command.h"
 #include "constants.h"
 #include "database.h"
+#include "query_cache.h"
 #include "ui.h"
 #include "utils.h"
 #include <ctype.h>
@@ -211,6 +212,68 @@ CMSStatus run_cms_session(void) {
     return CMS_ERROR_DB_INIT;
   }
 
+  // optional column layout for loaded tables (see TABLE_LAYOUT_ENV)
+  const char *layout = getenv(TABLE_LAYOUT_ENV);
+  if (layout && strcmp(layout, "columns") == 0) {
+    db->table_layout = TABLE_LAYOUT_COLUMNS;
+  }
+
+  // optional fast hash for unsaved-change detection (see CHECKSUM_MODE_ENV)
+  const char *checksum_mode = getenv(CHECKSUM_MODE_ENV);
+  if (checksum_mode && strcmp(checksum_mode, "fast") == 0) {
+    db->checksum_mode = CHECKSUM_MODE_FAST;
+  }
+
+  // optional trigram index for GREP NAME (see NAME_INDEX_ENV)
+  const char *name_index = getenv(NAME_INDEX_ENV);
+  if (name_index && strcmp(name_index, "trigram") == 0) {
+    db->name_index = true;
+  }
+
+  // optional bitmaps for programme and mark filters (see FILTER_INDEX_ENV)
+  const char *filter_index = getenv(FILTER_INDEX_ENV);
+  if (filter_index && strcmp(filter_index, "bitmap") == 0) {
+    db->filter_index = true;
+  }
+
+  // optional ordered index for MARK and ID intervals (see RANGE_INDEX_ENV)
+  const char *range_index = getenv(RANGE_INDEX_ENV);
+  if (range_index && strcmp(range_index, "ordered") == 0) {
+    db->range_index = true;
+  }
+
+  // ADV QUERY result cache, on unless sized to 0 (see QUERY_CACHE_ENV)
+  size_t cache_bytes = QUERY_CACHE_DEFAULT_BYTES;
+  const char *cache_kb = getenv(QUERY_CACHE_ENV);
+  if (cache_kb) {
+    char *end = NULL;
+    unsigned long kb = strtoul(cache_kb, &end, 10);
+    if (end != cache_kb && *end == '\0' && kb <= SIZE_MAX / 1024) {
+      cache_bytes = (size_t)kb * 1024;
+    }
+  }
+  if (db_set_query_cache(db, cache_bytes) != DB_SUCCESS) {
+    fprintf(stderr, "CMS: Query cache unavailable; queries run uncached\n");
+  }
+
+  // ADV QUERY worker threads (see QUERY_PARALLEL_ENV and QUERY_WORKERS_ENV)
+  const char *parallel_rows = getenv(QUERY_PARALLEL_ENV);
+  if (parallel_rows) {
+    char *end = NULL;
+    unsigned long rows = strtoul(parallel_rows, &end, 10);
+    if (end != parallel_rows && *end == '\0') {
+      db->query_parallel_rows = (size_t)rows;
+    }
+  }
+  const char *workers = getenv(QUERY_WORKERS_ENV);
+  if (workers) {
+    char *end = NULL;
+    unsigned long count = strtoul(workers, &end, 10);
+    if (end != workers && *end == '\0') {
+      db->query_workers = (size_t)count;
+    }
+  }
+
   // display menu once at startup
   status = display_menu();
   if (status != CMS_SUCCESS) {
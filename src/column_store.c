@@ -0,0 +1,320 @@
+#include "column_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief ensures a pool can take extra more bytes without growing
+ * @param[in,out] arena arena the pool allocates from (NULL for the heap)
+ * @param[in,out] pool pointer to the string pool
+ * @param[in] extra number of bytes that must fit after the used ones
+ * @return true on success, false if memory allocation fails
+ */
+bool string_pool_reserve(Arena *arena, StringPool *pool, size_t extra) {
+  if (pool->used + extra <= pool->capacity) {
+    return true;
+  }
+
+  size_t capacity =
+      pool->capacity ? pool->capacity : STRING_POOL_INITIAL_CAPACITY;
+  while (capacity < pool->used + extra) {
+    capacity *= 2;
+  }
+  // offsets are 32-bit
+  if (capacity > UINT32_MAX) {
+    capacity = UINT32_MAX;
+    if (pool->used + extra > capacity) {
+      return false;
+    }
+  }
+
+  char *data = arena_resize(arena, pool->data, pool->capacity, capacity);
+  if (!data) {
+    return false;
+  }
+  pool->data = data;
+  pool->capacity = capacity;
+  return true;
+}
+
+// copy text onto the end of the pool and return its offset
+static bool pool_add(Arena *arena, StringPool *pool, const char *text,
+                     uint32_t *offset) {
+  size_t size = strlen(text) + 1;
+  if (!string_pool_reserve(arena, pool, size)) {
+    return false;
+  }
+  memcpy(pool->data + pool->used, text, size);
+  *offset = (uint32_t)pool->used;
+  pool->used += size;
+  return true;
+}
+
+// replace the string at *offset, in place when the new one fits
+static bool pool_replace(Arena *arena, StringPool *pool, uint32_t *offset,
+                         const char *text) {
+  char *current = pool->data + *offset;
+  if (strcmp(current, text) == 0) {
+    return true;
+  }
+
+  size_t old_size = strlen(current) + 1;
+  size_t new_size = strlen(text) + 1;
+  if (new_size <= old_size) {
+    memcpy(current, text, new_size);
+    pool->dead += old_size - new_size;
+    return true;
+  }
+
+  uint32_t new_offset;
+  if (!pool_add(arena, pool, text, &new_offset)) {
+    return false;
+  }
+  pool->dead += old_size;
+  *offset = new_offset;
+  return true;
+}
+
+/**
+ * @brief rebuilds a pool so it holds only the strings referenced by offsets
+ * @param[in,out] arena arena the pool allocates from (NULL for the heap)
+ * @param[in,out] pool pointer to the string pool
+ * @param[in,out] offsets offsets of the live strings, rewritten in place
+ * @param[in] count number of offsets
+ * @param[in] spare bytes to keep free after the live strings
+ * @return true on success, false if memory allocation fails (the pool and
+ *         offsets are unchanged)
+ * @note the live strings are packed back into the pool's own buffer through
+ *       a heap scratch copy, so repeated compactions never take fresh arena
+ *       memory (which only a reset gives back)
+ */
+bool string_pool_compact(Arena *arena, StringPool *pool, uint32_t *offsets,
+                         size_t count, size_t spare) {
+  size_t live = 0;
+  for (size_t i = 0; i < count; i++) {
+    live += strlen(pool->data + offsets[i]) + 1;
+  }
+  size_t size = live + spare;
+  if (!string_pool_reserve(arena, pool,
+                           size > pool->used ? size - pool->used : 0)) {
+    return false;
+  }
+  char *scratch = malloc(live > 0 ? live : 1);
+  if (!scratch) {
+    return false;
+  }
+
+  size_t used = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *text = pool->data + offsets[i];
+    size_t size = strlen(text) + 1;
+    memcpy(scratch + used, text, size);
+    offsets[i] = (uint32_t)used;
+    used += size;
+  }
+
+  memcpy(pool->data, scratch, live);
+  free(scratch);
+  pool->used = live;
+  pool->dead = 0;
+  return true;
+}
+
+// gather column[perm[i]] through scratch and copy it back over column
+static void gather(void *column, void *scratch, const uint32_t *perm,
+                   size_t count, size_t size) {
+  char *dst = scratch;
+  for (size_t i = 0; i < count; i++) {
+    memcpy(dst + i * size, (const char *)column + (size_t)perm[i] * size,
+           size);
+  }
+  memcpy(column, scratch, count * size);
+}
+
+/**
+ * @brief initialises an empty column store (no memory is allocated)
+ * @param[out] store pointer to the store to initialise
+ * @note the store allocates from the heap until its arena field is set
+ */
+void column_store_init(ColumnStore *store) {
+  if (!store) {
+    return;
+  }
+  memset(store, 0, sizeof *store);
+}
+
+/**
+ * @brief frees all memory held by a column store
+ * @param[in,out] store pointer to the store to free (can be NULL)
+ * @note arena memory is only released by resetting the arena; the store
+ *       keeps its arena
+ */
+void column_store_free(ColumnStore *store) {
+  if (!store) {
+    return;
+  }
+  Arena *arena = store->arena;
+  arena_release(arena, store->ids);
+  arena_release(arena, store->marks);
+  arena_release(arena, store->name_offsets);
+  arena_release(arena, store->names.data);
+  column_store_init(store);
+  store->arena = arena;
+}
+
+/**
+ * @brief grows every column so it can hold at least rows entries
+ * @param[in,out] store pointer to the store
+ * @param[in] rows number of rows required
+ * @return true on success, false if memory allocation fails
+ */
+bool column_store_reserve(ColumnStore *store, size_t rows) {
+  if (!store) {
+    return false;
+  }
+  if (rows <= store->capacity) {
+    return true;
+  }
+
+  // columns already grown stay valid at the larger size if a later one fails
+  Arena *arena = store->arena;
+  size_t old_rows = store->capacity;
+  int *ids = arena_resize(arena, store->ids, old_rows * sizeof(int),
+                          rows * sizeof(int));
+  if (!ids) {
+    return false;
+  }
+  store->ids = ids;
+
+  float *marks = arena_resize(arena, store->marks, old_rows * sizeof(float),
+                              rows * sizeof(float));
+  if (!marks) {
+    return false;
+  }
+  store->marks = marks;
+
+  uint32_t *names =
+      arena_resize(arena, store->name_offsets, old_rows * sizeof(uint32_t),
+                   rows * sizeof(uint32_t));
+  if (!names) {
+    return false;
+  }
+  store->name_offsets = names;
+
+  store->capacity = rows;
+  return true;
+}
+
+/**
+ * @brief writes a new row at position row (columns must have capacity)
+ * @param[in,out] store pointer to the store
+ * @param[in] row position to write (normally the current row count)
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] mark mark
+ * @return true on success, false if the name pool cannot grow
+ */
+bool column_store_append(ColumnStore *store, size_t row, int id,
+                         const char *name, float mark) {
+  if (!store || !name || row >= store->capacity) {
+    return false;
+  }
+
+  uint32_t name_offset;
+  if (!pool_add(store->arena, &store->names, name, &name_offset)) {
+    return false;
+  }
+
+  store->ids[row] = id;
+  store->marks[row] = mark;
+  store->name_offsets[row] = name_offset;
+  return true;
+}
+
+/**
+ * @brief replaces the name and mark of an existing row
+ * @param[in,out] store pointer to the store
+ * @param[in] row position of the row
+ * @param[in] name new name
+ * @param[in] mark new mark
+ * @return true on success, false if the name pool cannot grow
+ * @note a name that fits is overwritten in place; a longer one is appended
+ */
+bool column_store_update(ColumnStore *store, size_t row, const char *name,
+                         float mark) {
+  if (!store || !name || row >= store->capacity) {
+    return false;
+  }
+
+  // fail before touching the row so it is never left half updated
+  if (!pool_replace(store->arena, &store->names, &store->name_offsets[row],
+                    name)) {
+    return false;
+  }
+  store->marks[row] = mark;
+  return true;
+}
+
+/**
+ * @brief copies row src over row dst (used when closing gaps left by
+ *        deleted rows)
+ * @param[in,out] store pointer to the store
+ * @param[in] dst row to overwrite
+ * @param[in] src row to copy
+ * @note the overwritten name stays in the pool until the next
+ *       column_store_compact_pools
+ */
+void column_store_move_row(ColumnStore *store, size_t dst, size_t src) {
+  if (!store || dst >= store->capacity || src >= store->capacity) {
+    return;
+  }
+  store->ids[dst] = store->ids[src];
+  store->marks[dst] = store->marks[src];
+  store->name_offsets[dst] = store->name_offsets[src];
+}
+
+/**
+ * @brief reorders rows so row i holds the row previously at perm[i]
+ * @param[in,out] store pointer to the store
+ * @param[in] perm permutation of 0..count-1
+ * @param[in] count number of rows
+ * @return true on success, false if scratch memory cannot be allocated
+ */
+bool column_store_permute(ColumnStore *store, const uint32_t *perm,
+                          size_t count) {
+  if (!store || !perm) {
+    return false;
+  }
+  if (count == 0) {
+    return true;
+  }
+
+  // one scratch buffer serves every column, which keeps its own buffer
+  // rather than taking new arena memory
+  size_t widest = sizeof(int) > sizeof(float) ? sizeof(int) : sizeof(float);
+  if (sizeof(uint32_t) > widest) {
+    widest = sizeof(uint32_t);
+  }
+  void *scratch = malloc(count * widest);
+  if (!scratch) {
+    return false;
+  }
+  gather(store->ids, scratch, perm, count, sizeof(int));
+  gather(store->marks, scratch, perm, count, sizeof(float));
+  gather(store->name_offsets, scratch, perm, count, sizeof(uint32_t));
+  free(scratch);
+  return true;
+}
+
+/**
+ * @brief rewrites the name pool so it holds only live strings
+ * @param[in,out] store pointer to the store
+ * @param[in] count number of rows
+ * @return true on success, false if memory allocation fails
+ */
+bool column_store_compact_pools(ColumnStore *store, size_t count) {
+  if (!store) {
+    return false;
+  }
+  return string_pool_compact(store->arena, &store->names, store->name_offsets,
+                             count, 0);
+}
@@ -57,6 +57,8 @@ OpStatus execute_checksum(StudentDatabase *db) {
   if (db->tables && db->tables[STUDENT_RECORDS_TABLE_INDEX]) {
     StudentTable *table = db->tables[STUDENT_RECORDS_TABLE_INDEX];
     printf("\nRecord count: %zu\n", table->record_count);
+    printf("Tombstones: %zu (deleted slots awaiting compaction)\n",
+           table->tombstone_count);
   }
 
   // get file info
@@ -1,6 +1,7 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
 #include "constants.h"
+#include "journal.h"
 #include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
@@ -118,6 +119,7 @@ OpStatus execute_delete(StudentDatabase *db) {
              db_status_string(db_status));
     return cmd_report_error(err_msg, OP_ERROR_GENERAL);
   }
+  journal_log_delete(db->journal, student_id);
 
   printf("CMS: The record with ID=%d is successfully deleted.\n", student_id);
 
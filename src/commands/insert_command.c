@@ -1,6 +1,7 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
 #include "constants.h"
+#include "journal.h"
 #include "parser.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -56,13 +57,11 @@ OpStatus execute_insert(StudentDatabase *db) {
 
   int student_id = (int)id_long;
 
-  for (size_t i = 0; i < table->record_count; i++) {
-    if (table->records[i].id == student_id) {
-      char err_msg[ERROR_MESSAGE_SIZE];
-      snprintf(err_msg, sizeof err_msg, "The record with ID=%d already exists.",
-               student_id);
-      return cmd_report_error(err_msg, OP_ERROR_VALIDATION);
-    }
+  if (table_find_position(table, student_id) != ID_INDEX_NOT_FOUND) {
+    char err_msg[ERROR_MESSAGE_SIZE];
+    snprintf(err_msg, sizeof err_msg, "The record with ID=%d already exists.",
+             student_id);
+    return cmd_report_error(err_msg, OP_ERROR_VALIDATION);
   }
 
   char name_buf[INPUT_BUFFER_SIZE];
@@ -166,6 +165,7 @@ OpStatus execute_insert(StudentDatabase *db) {
              db_status_string(db_status));
     return cmd_report_error(err_msg, OP_ERROR_GENERAL);
   }
+  journal_log_insert(db->journal, &record);
 
   printf("CMS: A new record with ID=%d is successfully inserted.\n",
          student_id);
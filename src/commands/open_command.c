@@ -1,6 +1,7 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
 #include "checksum.h"
+#include "journal.h"
 #include "parser.h"
 #include <ctype.h>
 #include <stdio.h>
@@ -14,7 +15,7 @@
 OpStatus execute_open(StudentDatabase *db) {
   if (db->is_loaded) {
     // warn about unsaved changes before reload using checksums
-    unsigned long current_checksum = compute_database_checksum(db);
+    unsigned long current_checksum = tracked_database_checksum(db);
     if (current_checksum != db->last_saved_checksum) {
       printf("\nWarning: You have unsaved changes that will be lost if you "
              "reload!\n");
@@ -42,11 +43,9 @@ OpStatus execute_open(StudentDatabase *db) {
       return OP_SUCCESS;
     }
 
-    // user confirmed reload - clear existing data to prevent memory leak
-    for (size_t i = 0; i < db->table_count; i++) {
-      table_free(db->tables[i]);
-    }
-    db->table_count = 0;
+    // user confirmed reload - drop the tables, keeping the arena's blocks
+    // for the new file
+    db_clear(db);
   }
 
   char path_buf[256];
@@ -89,9 +88,11 @@ OpStatus execute_open(StudentDatabase *db) {
 
   db->is_loaded = true;
 
-  // compute and store checksums after successful load
-  db->file_loaded_checksum = compute_file_checksum(path);
-  db->last_saved_checksum = compute_database_checksum(db);
+  // db_load has checksummed the file as it read it; changes saved since
+  // the file was last rewritten are replayed from its journal
+  size_t replayed = 0;
+  db->journal = journal_open(db, path, &replayed);
+  db->last_saved_checksum = tracked_database_checksum(db);
 
   // display summary of loaded records
   printf("\n");
@@ -110,6 +111,35 @@ OpStatus execute_open(StudentDatabase *db) {
     }
   }
 
+  // the trigram index is optional (NAME_INDEX_ENV), so its cost is shown
+  size_t index_bytes = 0;
+  size_t index_trigrams = 0;
+  for (size_t t = 0; t < db->table_count; t++) {
+    if (db->tables[t]->name_trigrams) {
+      index_bytes += trigram_index_memory(db->tables[t]->name_trigrams);
+      index_trigrams += db->tables[t]->name_trigrams->count;
+    }
+  }
+  if (db->name_index) {
+    printf("CMS: Name index - %zu trigram(s), %.1f KiB.\n", index_trigrams,
+           (double)index_bytes / 1024.0);
+  }
+
+  // so are the filter bitmaps (FILTER_INDEX_ENV)
+  size_t bitmap_bytes = 0;
+  for (size_t t = 0; t < db->table_count; t++) {
+    bitmap_bytes += bitmap_index_memory(db->tables[t]->filter_bitmaps);
+  }
+  if (db->filter_index) {
+    printf("CMS: Filter bitmaps - %.1f KiB.\n",
+           (double)bitmap_bytes / 1024.0);
+  }
+
+  if (replayed > 0) {
+    printf("CMS: %zu saved change%s replayed from the journal.\n", replayed,
+           (replayed == 1) ? "" : "s");
+  }
+
   cmd_wait_for_user();
 
   return OP_SUCCESS;
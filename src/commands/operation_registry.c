@@ -1,6 +1,7 @@
 #include "commands/command.h"
 #include "checksum.h"
 #include "event_log.h"
+#include "journal.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -53,7 +54,7 @@ OpStatus execute_operation(Operation op, StudentDatabase *db) {
   if (op == EXIT) {
     // check for unsaved changes before exiting using checksums
     if (db && db->is_loaded) {
-      unsigned long current_checksum = compute_database_checksum(db);
+      unsigned long current_checksum = tracked_database_checksum(db);
       if (current_checksum != db->last_saved_checksum) {
         printf("\nWarning: You have unsaved changes!\n");
         printf("What would you like to do?\n");
@@ -77,7 +78,7 @@ OpStatus execute_operation(Operation op, StudentDatabase *db) {
         if (len == 1 && choice_buf[0] == '1') {
           // save and exit
           if (db->filepath[0] != '\0') {
-            DBStatus db_status = db_save(db, db->filepath);
+            DBStatus db_status = journal_save(db);
             if (db_status == DB_SUCCESS) {
               printf("CMS: Database saved successfully.\n");
             } else {
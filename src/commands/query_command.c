@@ -60,21 +60,19 @@ OpStatus execute_query(StudentDatabase *db) {
 
   int student_id = (int)parsed_id;
 
-  // search for record with matching ID
-  StudentRecord *record = NULL;
-  for (size_t r = 0; r < table->record_count; r++) {
-    if (table->records[r].id == student_id) {
-      record = &table->records[r];
-      break;
-    }
-  }
+  // look up record with matching ID through the id index
+  size_t position = table_find_position(table, student_id);
 
-  if (!record) {
+  if (position == ID_INDEX_NOT_FOUND) {
     printf("CMS: The record with ID=%d does not exist.\n", student_id);
     cmd_wait_for_user();
     return OP_SUCCESS;
   }
 
+  StudentRecord found;
+  table_read_record(table, position, &found);
+  const StudentRecord *record = &found;
+
   // display found record with dynamic column width formatting
   printf("CMS: The record with ID=%d is found in table \"%s\".\n", record->id,
          table->table_name);
@@ -1,5 +1,6 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
+#include "journal.h"
 #include <stdio.h>
 
 /**
@@ -21,7 +22,8 @@ OpStatus execute_save(StudentDatabase *db) {
                             OP_ERROR_VALIDATION);
   }
 
-  DBStatus db_status = db_save(db, db->filepath);
+  // commits the journal, or rewrites the file once the journal is large
+  DBStatus db_status = journal_save(db);
   if (db_status != DB_SUCCESS) {
     char err_msg[256];
     snprintf(err_msg, sizeof err_msg, "Failed to save database: %s",
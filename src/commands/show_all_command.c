@@ -1,7 +1,7 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
+#include "table_view.h"
 #include <stdio.h>
-#include <string.h>
 
 /**
  * @brief executes SHOW_ALL operation to display all records
@@ -34,41 +34,24 @@ OpStatus execute_show_all(StudentDatabase *db) {
   // print header message
   printf("Table Name: %s\n\n", table->table_name);
 
-  // calculate dynamic column widths
+  // column widths are kept by the table as records change, so records
+  // are not measured before printing
+  const DisplayWidths *widths = table_display_widths(table);
   size_t max_id_width = 2;   // "ID" header minimum
   size_t max_name_width = 4; // "Name" header minimum
   size_t max_prog_width = 9; // "Programme" header minimum
   size_t max_mark_width = 4; // "Mark" header minimum
-
-  for (size_t i = 0; i < table->record_count; i++) {
-    StudentRecord *rec = &table->records[i];
-
-    char format_buf[32];
-    int len;
-
-    // calculate id width
-    len = snprintf(format_buf, sizeof format_buf, "%d", rec->id);
-    if (len > 0 && (size_t)len > max_id_width) {
-      max_id_width = (size_t)len;
-    }
-
-    // calculate name width
-    size_t name_len = strlen(rec->name);
-    if (name_len > max_name_width) {
-      max_name_width = name_len;
-    }
-
-    // calculate programme width
-    size_t prog_len = strlen(rec->prog);
-    if (prog_len > max_prog_width) {
-      max_prog_width = prog_len;
-    }
-
-    // calculate mark width
-    len = snprintf(format_buf, sizeof format_buf, "%.2f", rec->mark);
-    if (len > 0 && (size_t)len > max_mark_width) {
-      max_mark_width = (size_t)len;
-    }
+  if (widths->max[DISPLAY_FIELD_ID] > max_id_width) {
+    max_id_width = widths->max[DISPLAY_FIELD_ID];
+  }
+  if (widths->max[DISPLAY_FIELD_NAME] > max_name_width) {
+    max_name_width = widths->max[DISPLAY_FIELD_NAME];
+  }
+  if (widths->max[DISPLAY_FIELD_PROG] > max_prog_width) {
+    max_prog_width = widths->max[DISPLAY_FIELD_PROG];
+  }
+  if (widths->max[DISPLAY_FIELD_MARK] > max_mark_width) {
+    max_mark_width = widths->max[DISPLAY_FIELD_MARK];
   }
 
   // print column headers with calculated widths
@@ -76,12 +59,15 @@ OpStatus execute_show_all(StudentDatabase *db) {
          (int)max_name_width, "Name", (int)max_prog_width, "Programme",
          (int)max_mark_width, "Mark");
 
-  // print all records
-  for (size_t i = 0; i < table->record_count; i++) {
-    StudentRecord *rec = &table->records[i];
-    printf("%-*d  %-*s  %-*s  %*.2f\n", (int)max_id_width, rec->id,
-           (int)max_name_width, rec->name, (int)max_prog_width, rec->prog,
-           (int)max_mark_width, rec->mark);
+  // print all records in the table's active view order
+  size_t cursor = 0;
+  size_t p;
+  while ((p = table_view_next(table, &cursor)) != TABLE_VIEW_NOT_FOUND) {
+    printf("%-*d  %-*s  %-*s  %*.2f\n", (int)max_id_width,
+           table_record_id(table, p), (int)max_name_width,
+           table_record_name(table, p), (int)max_prog_width,
+           table_record_prog(table, p), (int)max_mark_width,
+           table_record_mark(table, p));
   }
 
   // add trailing newline
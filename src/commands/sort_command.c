@@ -1,10 +1,36 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
-#include "sorting.h"
+#include "constants.h"
+#include "journal.h"
+#include "table_view.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 
+// physically reorders the records to match the current view
+static OpStatus compact_records(StudentTable *table, Journal *journal) {
+  if (table->active_view == TABLE_VIEW_STORAGE) {
+    printf("CMS: Records are already stored in the displayed order.\n");
+    cmd_wait_for_user();
+    return OP_SUCCESS;
+  }
+
+  const char *view_name = table_view_name(table->active_view);
+  DBStatus status = table_compact(table);
+  if (status != DB_SUCCESS) {
+    char err_msg[ERROR_MESSAGE_SIZE];
+    snprintf(err_msg, sizeof err_msg, "Failed to compact records: %s",
+             db_status_string(status));
+    return cmd_report_error(err_msg, OP_ERROR_GENERAL);
+  }
+  journal_log_compact(journal);
+
+  printf("CMS: %zu record%s physically reordered by %s.\n", table->record_count,
+         (table->record_count == 1) ? "" : "s", view_name);
+  cmd_wait_for_user();
+  return OP_SUCCESS;
+}
+
 /**
  * @brief executes SORT operation to order records
  * @param[in,out] db pointer to the database
@@ -24,11 +50,11 @@ OpStatus execute_sort(StudentDatabase *db) {
     return cmd_report_error("Table error.", OP_ERROR_GENERAL);
   }
 
-  if (!table->records) {
+  if (table->layout == TABLE_LAYOUT_ROWS && !table->records) {
     return cmd_report_error("Table records array is NULL.", OP_ERROR_GENERAL);
   }
 
-  if (table->record_count > table->record_capacity) {
+  if (table->slot_count > table->record_capacity) {
     return cmd_report_error("Table record count exceeds capacity.",
                             OP_ERROR_VALIDATION);
   }
@@ -41,6 +67,8 @@ OpStatus execute_sort(StudentDatabase *db) {
   printf("Select field to sort by:\n");
   printf("  [1] ID\n");
   printf("  [2] Mark\n");
+  printf("  [3] Stored order\n");
+  printf("  [C] Compact storage to the current order\n");
   printf("Enter your choice (or press ENTER to cancel): ");
   fflush(stdout);
 
@@ -59,15 +87,30 @@ OpStatus execute_sort(StudentDatabase *db) {
     return OP_SUCCESS;
   }
 
-  // validate field is exactly "1" or "2"
+  // validate field is exactly "1", "2", "3" or "C"
   char field;
-  if (field_len == 1 && (field_buf[0] == '1' || field_buf[0] == '2')) {
-    field = field_buf[0];
+  if (field_len == 1 && (field_buf[0] == '1' || field_buf[0] == '2' ||
+                         field_buf[0] == '3' || toupper(field_buf[0]) == 'C')) {
+    field = (char)toupper(field_buf[0]);
   } else {
-    return cmd_report_error("Invalid field. Enter '1' for ID or '2' for Mark.",
+    return cmd_report_error("Invalid field. Enter '1' for ID, '2' for Mark, "
+                            "'3' for stored order or 'C' to compact.",
                             OP_ERROR_VALIDATION);
   }
 
+  if (field == 'C') {
+    return compact_records(table, db->journal);
+  }
+
+  if (field == '3') {
+    table_set_view(table, TABLE_VIEW_STORAGE);
+    journal_log_view(db->journal, TABLE_VIEW_STORAGE);
+    printf("CMS: %zu record%s shown in stored order.\n", table->record_count,
+           (table->record_count == 1) ? "" : "s");
+    cmd_wait_for_user();
+    return OP_SUCCESS;
+  }
+
   char order_buf[10];
   printf("Select sort order:\n");
   printf("  [A] Ascending\n");
@@ -101,12 +144,22 @@ OpStatus execute_sort(StudentDatabase *db) {
         OP_ERROR_VALIDATION);
   }
 
-  // convert user input to sorting module enums
-  SortField sort_field = (field == '1') ? SORT_FIELD_ID : SORT_FIELD_MARK;
-  SortOrder sort_order = (order == 'A') ? SORT_ORDER_ASC : SORT_ORDER_DESC;
+  // switch the table's view; records themselves are not moved
+  TableView view;
+  if (field == '1') {
+    view = (order == 'A') ? TABLE_VIEW_ID_ASC : TABLE_VIEW_ID_DESC;
+  } else {
+    view = (order == 'A') ? TABLE_VIEW_MARK_ASC : TABLE_VIEW_MARK_DESC;
+  }
 
-  // perform sort using sorting module
-  sort_records(table->records, table->record_count, sort_field, sort_order);
+  DBStatus view_status = table_set_view(table, view);
+  if (view_status != DB_SUCCESS) {
+    char err_msg[ERROR_MESSAGE_SIZE];
+    snprintf(err_msg, sizeof err_msg, "Failed to build sorted view: %s",
+             db_status_string(view_status));
+    return cmd_report_error(err_msg, OP_ERROR_GENERAL);
+  }
+  journal_log_view(db->journal, view);
 
   const char *field_name = (field == '1') ? "ID" : "Mark";
   const char *order_name = (order == 'A') ? "ascending" : "descending";
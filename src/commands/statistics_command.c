@@ -27,7 +27,7 @@ OpStatus execute_statistics(StudentDatabase *db) {
   }
 
   // validate table records array
-  if (!table->records) {
+  if (table->layout == TABLE_LAYOUT_ROWS && !table->records) {
     return cmd_report_error("Table records array is NULL.", OP_ERROR_GENERAL);
   }
 
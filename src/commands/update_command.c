@@ -1,6 +1,7 @@
 #include "commands/command.h"
 #include "commands/command_utils.h"
 #include "constants.h"
+#include "journal.h"
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -63,17 +64,8 @@ OpStatus execute_update(StudentDatabase *db) {
                             OP_ERROR_VALIDATION);
   }
 
-  // search for record (same logic as QUERY)
-  StudentRecord *record = NULL;
-
-  for (size_t r = 0; r < table->record_count; r++) {
-    if (table->records[r].id == (int)parsed_id) {
-      record = &table->records[r];
-      break;
-    }
-  }
-
-  if (!record) {
+  // look up record (same logic as QUERY)
+  if (table_find_position(table, (int)parsed_id) == ID_INDEX_NOT_FOUND) {
     printf("CMS: The record with ID=%ld does not exist.\n", parsed_id);
     cmd_wait_for_user();
     return OP_SUCCESS;
@@ -176,6 +168,8 @@ OpStatus execute_update(StudentDatabase *db) {
              db_status_string(db_status));
     return cmd_report_error(err_msg, OP_ERROR_GENERAL);
   }
+  journal_log_update(db->journal, (int)parsed_id, new_name, new_prog,
+                     new_mark_ptr);
 
   printf("CMS: The record with ID=%d is successfully updated.\n",
          (int)parsed_id);
@@ -1,18 +1,194 @@
 #include "database.h"
+#include "atomic_file.h"
 #include "checksum.h"
 #include "event_log.h"
+#include "journal.h"
+#include "parallel.h"
 #include "parser.h"
+#include "query_cache.h"
+#include "record_format.h"
+#include "snapshot.h"
+#include "table_view.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// number of 64-bit words in a tombstone bitset covering capacity slots
+static size_t tombstone_words(size_t capacity) {
+  return (capacity + 63) / 64;
+}
+
+// re-intern every programme into a fresh dictionary so codes follow the
+// current record positions and entries no record uses are dropped; the codes
+// are built on the heap and copied over the table's own array, so a rebuild
+// takes no new arena memory
+static DBStatus encode_programmes(StudentTable *table) {
+  StringDictionary programmes;
+  dictionary_init(&programmes);
+  uint32_t *codes = malloc((table->slot_count + 1) * sizeof(uint32_t));
+  if (!codes) {
+    return DB_ERROR_MEMORY;
+  }
+
+  for (size_t i = 0; i < table->slot_count; i++) {
+    if (!table_is_live(table, i)) {
+      codes[i] = 0;
+      continue;
+    }
+    if (!dictionary_intern(&programmes, table_record_prog(table, i),
+                           &codes[i])) {
+      dictionary_free(&programmes);
+      free(codes);
+      return DB_ERROR_MEMORY;
+    }
+  }
+
+  // column tables read programmes through the old codes, so both are
+  // replaced only once every code is known
+  dictionary_free(&table->programmes);
+  memcpy(table->prog_codes, codes, table->slot_count * sizeof(uint32_t));
+  free(codes);
+  table->programmes = programmes;
+  return DB_SUCCESS;
+}
+
+// refold every name over the existing shadow so it follows the current
+// record positions and holds no dead strings, reusing its pool
+static DBStatus fold_names(StudentTable *table) {
+  FoldedText *folded = &table->folded_names;
+  size_t length = 0;
+  for (size_t i = 0; i < table->slot_count; i++) {
+    length += strlen(table_record_name(table, i)) + 1;
+  }
+
+  // make room before anything is overwritten, so the appends cannot fail
+  size_t used = folded->text.used;
+  folded->text.used = 0;
+  if (!folded_text_reserve(folded, table->record_capacity) ||
+      !folded_text_reserve_text(folded, length)) {
+    folded->text.used = used;
+    return DB_ERROR_MEMORY;
+  }
+  folded->text.dead = 0;
+
+  // tombstoned slots still hold their record, so they are folded as well
+  for (size_t i = 0; i < table->slot_count; i++) {
+    folded_text_append(folded, i, table_record_name(table, i));
+  }
+  return DB_SUCCESS;
+}
+
+// free the trigram index, so GREP NAME scans every name again
+static void drop_name_index(StudentTable *table) {
+  trigram_index_free(table->name_trigrams);
+  free(table->name_trigrams);
+  table->name_trigrams = NULL;
+}
+
+// refill the trigram index from the folded names of the live records
+static DBStatus index_names(StudentTable *table) {
+  trigram_index_free(table->name_trigrams);
+  for (size_t i = 0; i < table->slot_count; i++) {
+    if (table_is_live(table, i) &&
+        !trigram_index_add(table->name_trigrams, (uint32_t)i,
+                           folded_text_get(&table->folded_names, i))) {
+      return DB_ERROR_MEMORY;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+// free the programme and mark bitmaps, so ADV QUERY compares every record
+static void drop_filter_index(StudentTable *table) {
+  bitmap_index_free(table->filter_bitmaps);
+  free(table->filter_bitmaps);
+  table->filter_bitmaps = NULL;
+}
+
+// refill the programme and mark bitmaps from the live records
+static DBStatus index_filters(StudentTable *table) {
+  bitmap_index_free(table->filter_bitmaps);
+  for (size_t i = 0; i < table->slot_count; i++) {
+    if (table_is_live(table, i) &&
+        !bitmap_index_add(table->filter_bitmaps, (uint32_t)i,
+                          table->prog_codes[i], table_record_mark(table, i))) {
+      return DB_ERROR_MEMORY;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+// grow every per-position array (records or columns, programme codes,
+// folded names and tombstones) to new_capacity; arrays already grown stay
+// valid if a later one fails
+static DBStatus grow_storage(StudentTable *table, size_t new_capacity) {
+  uint32_t *codes = arena_resize(
+      table->arena, table->prog_codes,
+      table->record_capacity * sizeof(uint32_t),
+      new_capacity * sizeof(uint32_t));
+  if (!codes) {
+    return DB_ERROR_MEMORY;
+  }
+  table->prog_codes = codes;
+
+  if (!folded_text_reserve(&table->folded_names, new_capacity)) {
+    return DB_ERROR_MEMORY;
+  }
+
+  if (table->tombstones) {
+    size_t old_words = tombstone_words(table->record_capacity);
+    size_t new_words = tombstone_words(new_capacity);
+    uint64_t *bits =
+        arena_resize(table->arena, table->tombstones,
+                     old_words * sizeof(uint64_t),
+                     new_words * sizeof(uint64_t));
+    if (!bits) {
+      return DB_ERROR_MEMORY;
+    }
+    memset(bits + old_words, 0, (new_words - old_words) * sizeof(uint64_t));
+    table->tombstones = bits;
+  }
+
+  if (table->layout == TABLE_LAYOUT_COLUMNS) {
+    if (!column_store_reserve(&table->columns, new_capacity)) {
+      return DB_ERROR_MEMORY;
+    }
+  } else {
+    StudentRecord *temp = arena_resize(
+        table->arena, table->records,
+        table->record_capacity * sizeof(StudentRecord),
+        new_capacity * sizeof(StudentRecord));
+
+    if (!temp) {
+      return DB_ERROR_MEMORY;
+    }
+
+    table->records = temp;
+  }
+  table->record_capacity = new_capacity;
+  return DB_SUCCESS;
+}
+
 /**
  * @brief creates a new empty table with the given name
  * @param[in] table_name name for the new table
  * @return pointer to newly created StudentTable on success, NULL on failure
  */
 StudentTable *table_init(const char *table_name) {
-  StudentTable *table = malloc(sizeof(StudentTable));
+  return table_init_in_arena(NULL, table_name);
+}
+
+/**
+ * @brief creates a new empty table whose storage comes from an arena
+ * @param[in,out] arena arena to allocate from (NULL behaves like table_init)
+ * @param[in] table_name name for the new table
+ * @return pointer to newly created StudentTable on success, NULL on failure
+ * @note the table stays valid until the arena is reset or freed;
+ *       table_free must still be called to release its heap-allocated
+ *       index, dictionary and views
+ */
+StudentTable *table_init_in_arena(Arena *arena, const char *table_name) {
+  StudentTable *table = arena_alloc(arena, sizeof(StudentTable));
   if (!table) {
     return NULL;
   }
@@ -20,16 +196,50 @@ StudentTable *table_init(const char *table_name) {
   strncpy(table->table_name, table_name, sizeof(table->table_name) - 1);
   table->table_name[sizeof(table->table_name) - 1] = '\0';
 
+  table->arena = arena;
   table->column_headers = NULL;
   table->column_count = 0;
-  table->records = malloc(INITIAL_RECORD_CAPACITY * sizeof(StudentRecord));
+  table->records =
+      arena_alloc(arena, INITIAL_RECORD_CAPACITY * sizeof(StudentRecord));
   if (!table->records) {
-    free(table);
+    arena_release(arena, table);
     return NULL;
   }
 
+  table->prog_codes =
+      arena_alloc(arena, INITIAL_RECORD_CAPACITY * sizeof(uint32_t));
+  if (!table->prog_codes) {
+    arena_release(arena, table->records);
+    arena_release(arena, table);
+    return NULL;
+  }
+
+  folded_text_init(&table->folded_names);
+  table->folded_names.arena = arena;
+  if (!folded_text_reserve(&table->folded_names, INITIAL_RECORD_CAPACITY)) {
+    arena_release(arena, table->prog_codes);
+    arena_release(arena, table->records);
+    arena_release(arena, table);
+    return NULL;
+  }
+
+  table->name_trigrams = NULL;
+  table->filter_bitmaps = NULL;
+  table->layout = TABLE_LAYOUT_ROWS;
+  column_store_init(&table->columns);
+  table->columns.arena = arena;
+  dictionary_init(&table->programmes);
   table->record_count = 0;
   table->record_capacity = INITIAL_RECORD_CAPACITY;
+  table->slot_count = 0;
+  table->tombstone_count = 0;
+  table->tombstones = NULL;
+  table->record_checksum = 0;
+  table->checksum_mode = CHECKSUM_MODE_CRC32;
+  table->mutations = 0;
+  display_widths_reset(&table->display_widths);
+  id_index_init(&table->id_index);
+  table_views_init(table);
 
   return table;
 }
@@ -37,19 +247,31 @@ StudentTable *table_init(const char *table_name) {
 /**
  * @brief frees all memory associated with a table
  * @param[in] table pointer to the table to free (can be NULL)
+ * @note for a table in an arena only the heap-allocated parts are freed;
+ *       the rest goes when the arena is reset
  */
 void table_free(StudentTable *table) {
   if (!table) {
     return;
   }
 
+  Arena *arena = table->arena;
   for (size_t i = 0; i < table->column_count; i++) {
-    free(table->column_headers[i]);
+    arena_release(arena, table->column_headers[i]);
   }
-  free(table->column_headers);
-
-  free(table->records);
-  free(table);
+  arena_release(arena, table->column_headers);
+
+  arena_release(arena, table->records);
+  column_store_free(&table->columns);
+  dictionary_free(&table->programmes);
+  arena_release(arena, table->prog_codes);
+  folded_text_free(&table->folded_names);
+  drop_name_index(table);
+  drop_filter_index(table);
+  arena_release(arena, table->tombstones);
+  id_index_free(&table->id_index);
+  table_views_free(table);
+  arena_release(arena, table);
 }
 
 /**
@@ -65,10 +287,30 @@ DBStatus table_set_column_headers(StudentTable *table, char **headers,
     return DB_ERROR_NULL_POINTER;
   }
 
+  Arena *arena = table->arena;
+  if (arena) {
+    // copy into the arena so the table needs no per-header frees
+    char **copies = arena_alloc(arena, count * sizeof(char *));
+    if (!copies) {
+      return DB_ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < count; i++) {
+      copies[i] = arena_strdup(arena, headers[i]);
+      if (!copies[i]) {
+        return DB_ERROR_MEMORY;
+      }
+    }
+    for (size_t i = 0; i < count; i++) {
+      free(headers[i]);
+    }
+    free(headers);
+    headers = copies;
+  }
+
   for (size_t i = 0; i < table->column_count; i++) {
-    free(table->column_headers[i]);
+    arena_release(arena, table->column_headers[i]);
   }
-  free(table->column_headers);
+  arena_release(arena, table->column_headers);
 
   table->column_headers = headers;
   table->column_count = count;
@@ -76,6 +318,23 @@ DBStatus table_set_column_headers(StudentTable *table, char **headers,
   return DB_SUCCESS;
 }
 
+/**
+ * @brief grows a table's storage so it can hold at least capacity slots
+ * @param[in,out] table pointer to the table
+ * @param[in] capacity number of record slots required
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ * @note lets loaders size storage once instead of doubling per add
+ */
+DBStatus table_reserve(StudentTable *table, size_t capacity) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (capacity <= table->record_capacity) {
+    return DB_SUCCESS;
+  }
+  return grow_storage(table, capacity);
+}
+
 /**
  * @brief adds a record to the table (grows capacity if needed)
  * @param[in,out] table pointer to the table to add the record to
@@ -86,22 +345,85 @@ DBStatus table_add_record(StudentTable *table, StudentRecord *record) {
   if (!table || !record) {
     return DB_ERROR_NULL_POINTER;
   }
+  return table_add_hashed_record(
+      table, record, compute_record_hash(record, table->checksum_mode));
+}
 
-  if (table->record_count >= table->record_capacity) {
-    size_t new_capacity = table->record_capacity * 2;
-    StudentRecord *temp =
-        realloc(table->records, new_capacity * sizeof(StudentRecord));
+/**
+ * @brief adds a record whose checksum the caller has already computed
+ * @param[in,out] table pointer to the table to add the record to
+ * @param[in] record pointer to the student record to add
+ * @param[in] hash compute_record_hash of the record in the table's
+ *                 checksum mode
+ * @return as table_add_record
+ * @note lets loaders hash records on the threads that parse them
+ */
+DBStatus table_add_hashed_record(StudentTable *table, StudentRecord *record,
+                                 unsigned long hash) {
+  if (!table || !record) {
+    return DB_ERROR_NULL_POINTER;
+  }
 
-    if (!temp) {
-      return DB_ERROR_MEMORY;
-    }
+  if (id_index_find(&table->id_index, record->id) != ID_INDEX_NOT_FOUND) {
+    return DB_ERROR_DUPLICATE_ID;
+  }
 
-    table->records = temp;
-    table->record_capacity = new_capacity;
+  if (table->slot_count >= table->record_capacity &&
+      grow_storage(table, table->record_capacity * 2) != DB_SUCCESS) {
+    return DB_ERROR_MEMORY;
+  }
+
+  if (table_views_reserve(table, table->record_capacity) != DB_SUCCESS) {
+    return DB_ERROR_MEMORY;
+  }
+
+  uint32_t code;
+  if (!dictionary_intern(&table->programmes, record->prog, &code)) {
+    return DB_ERROR_MEMORY;
+  }
+
+  // new records always go into a fresh slot after any tombstones
+  size_t position = table->slot_count;
+  if (!id_index_insert(&table->id_index, record->id, position)) {
+    dictionary_release(&table->programmes, code);
+    return DB_ERROR_MEMORY;
+  }
+
+  if (!folded_text_append(&table->folded_names, position, record->name)) {
+    id_index_remove(&table->id_index, record->id);
+    dictionary_release(&table->programmes, code);
+    return DB_ERROR_MEMORY;
   }
 
-  table->records[table->record_count] = *record;
+  // the folded copy left behind on failure is dropped by the next compaction
+  if (table->layout == TABLE_LAYOUT_COLUMNS) {
+    if (!column_store_append(&table->columns, position, record->id,
+                             record->name, record->mark)) {
+      id_index_remove(&table->id_index, record->id);
+      dictionary_release(&table->programmes, code);
+      return DB_ERROR_MEMORY;
+    }
+  } else {
+    table->records[position] = *record;
+  }
+  table->prog_codes[position] = code;
+  table->slot_count++;
   table->record_count++;
+  table->record_checksum ^= hash;
+  display_widths_add(&table->display_widths, record->id, record->name,
+                     record->prog, record->mark);
+  table_views_link(table, position);
+  if (table->name_trigrams &&
+      !trigram_index_add(table->name_trigrams, (uint32_t)position,
+                         folded_text_get(&table->folded_names, position))) {
+    drop_name_index(table);
+  }
+  if (table->filter_bitmaps &&
+      !bitmap_index_add(table->filter_bitmaps, (uint32_t)position, code,
+                        record->mark)) {
+    drop_filter_index(table);
+  }
+  table->mutations++;
 
   return DB_SUCCESS;
 }
@@ -110,39 +432,426 @@ DBStatus table_add_record(StudentTable *table, StudentRecord *record) {
  * @brief removes a record from the table by student id
  * @param[in,out] table pointer to the table to remove the record from
  * @param[in] student_id id of the student record to remove
- * @return DB_SUCCESS on success, DB_ERROR_NOT_FOUND if record not found
+ * @return DB_SUCCESS on success, DB_ERROR_NOT_FOUND if record not found,
+ *         DB_ERROR_MEMORY if the tombstone bitset cannot be allocated
+ * @note the record's slot is tombstoned rather than shifted out; slots are
+ *       purged once tombstones pass 1 in TOMBSTONE_PURGE_RATIO
  */
 DBStatus table_remove_record(StudentTable *table, int student_id) {
   if (!table) {
     return DB_ERROR_NULL_POINTER;
   }
 
-  // search for record with matching id using sentinel value pattern
-  size_t deleted_index = (size_t)-1;
-  for (size_t i = 0; i < table->record_count; i++) {
-    if (table->records[i].id == student_id) {
-      deleted_index = i;
-      break;
+  // look up record position through the id index
+  size_t position = id_index_find(&table->id_index, student_id);
+  if (position == ID_INDEX_NOT_FOUND) {
+    return DB_ERROR_NOT_FOUND;
+  }
+
+  if (!table->tombstones) {
+    table->tombstones =
+        arena_calloc(table->arena, tombstone_words(table->record_capacity),
+                     sizeof(uint64_t));
+    if (!table->tombstones) {
+      return DB_ERROR_MEMORY;
     }
   }
 
-  if (deleted_index == (size_t)-1) {
+  StudentRecord removed;
+  table_read_record(table, position, &removed);
+  table->record_checksum ^=
+      compute_record_hash(&removed, table->checksum_mode);
+  display_widths_remove(&table->display_widths, removed.id, removed.name,
+                        removed.prog, removed.mark);
+
+  id_index_remove(&table->id_index, student_id);
+  table_views_unlink(table, position);
+  dictionary_release(&table->programmes, table->prog_codes[position]);
+  trigram_index_remove(table->name_trigrams, (uint32_t)position,
+                       folded_text_get(&table->folded_names, position));
+  bitmap_index_remove(table->filter_bitmaps, (uint32_t)position,
+                      table->prog_codes[position], removed.mark);
+
+  // the record stays in its slot; later records keep their positions
+  table->tombstones[position / 64] |= (uint64_t)1 << (position % 64);
+  table->tombstone_count++;
+  table->record_count--;
+  table->mutations++;
+
+  // purge lazily so a run of deletes costs O(1) each on average; if the
+  // purge cannot allocate, the tombstones simply wait for the next one
+  if (table->tombstone_count * TOMBSTONE_PURGE_RATIO > table->slot_count) {
+    table_purge_tombstones(table);
+  }
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief finds a record by student id using the table's id index
+ * @param[in] table pointer to the table to search
+ * @param[in] student_id id of the student record to find
+ * @return pointer to the matching record, NULL if not found
+ * @note the pointer is invalidated by any later add, remove or compaction
+ * @note row layout only (always NULL for column layout); use
+ *       table_find_position and table_read_record for either layout
+ */
+StudentRecord *table_find_record(StudentTable *table, int student_id) {
+  if (!table || !table->records) {
+    return NULL;
+  }
+
+  size_t position = table_find_position(table, student_id);
+  if (position == ID_INDEX_NOT_FOUND) {
+    return NULL;
+  }
+
+  return &table->records[position];
+}
+
+/**
+ * @brief finds the position of a record by student id
+ * @param[in] table pointer to the table to search
+ * @param[in] student_id id of the student record to find
+ * @return record position, ID_INDEX_NOT_FOUND if not found
+ */
+size_t table_find_position(const StudentTable *table, int student_id) {
+  if (!table) {
+    return ID_INDEX_NOT_FOUND;
+  }
+
+  size_t position = id_index_find(&table->id_index, student_id);
+  if (position >= table->slot_count) {
+    return ID_INDEX_NOT_FOUND;
+  }
+
+  return position;
+}
+
+/**
+ * @brief copies the record at a position out of the table
+ * @param[in] table pointer to the table
+ * @param[in] position record position (below slot_count)
+ * @param[out] out receives a copy of the record
+ * @return DB_SUCCESS on success, DB_ERROR_NOT_FOUND if position is invalid
+ *         or holds a deleted record
+ */
+DBStatus table_read_record(const StudentTable *table, size_t position,
+                           StudentRecord *out) {
+  if (!table || !out) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (position >= table->slot_count || !table_is_live(table, position)) {
     return DB_ERROR_NOT_FOUND;
   }
 
-  // delete record using safe array shifting
-  // only shift if deleted record is not the last element
-  if (deleted_index < table->record_count - 1) {
-    memmove(&table->records[deleted_index], &table->records[deleted_index + 1],
-            (table->record_count - deleted_index - 1) * sizeof(StudentRecord));
+  if (table->layout == TABLE_LAYOUT_ROWS) {
+    *out = table->records[position];
+    return DB_SUCCESS;
   }
 
-  table->record_count--;
-  memset(&table->records[table->record_count], 0, sizeof(StudentRecord));
+  out->id = table->columns.ids[position];
+  out->mark = table->columns.marks[position];
+  strncpy(out->name, table_record_name(table, position),
+          sizeof(out->name) - 1);
+  out->name[sizeof(out->name) - 1] = '\0';
+  strncpy(out->prog, table_record_prog(table, position),
+          sizeof(out->prog) - 1);
+  out->prog[sizeof(out->prog) - 1] = '\0';
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief converts a table between row and column layout
+ * @param[in,out] table pointer to the table
+ * @param[in] layout layout to convert to
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails (the
+ *         table is left in its original layout)
+ * @note tombstones are purged first; otherwise positions, the id index and
+ *       sorted views are unaffected
+ */
+DBStatus table_set_layout(StudentTable *table, TableLayout layout) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (layout != TABLE_LAYOUT_ROWS && layout != TABLE_LAYOUT_COLUMNS) {
+    return DB_ERROR_INVALID_DATA;
+  }
+  if (layout == table->layout) {
+    return DB_SUCCESS;
+  }
+  if (table_purge_tombstones(table) != DB_SUCCESS) {
+    return DB_ERROR_MEMORY;
+  }
+
+  if (layout == TABLE_LAYOUT_COLUMNS) {
+    ColumnStore columns;
+    column_store_init(&columns);
+    columns.arena = table->arena;
+    if (!column_store_reserve(&columns, table->record_capacity)) {
+      column_store_free(&columns);
+      return DB_ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < table->slot_count; i++) {
+      const StudentRecord *r = &table->records[i];
+      if (!column_store_append(&columns, i, r->id, r->name, r->mark)) {
+        column_store_free(&columns);
+        return DB_ERROR_MEMORY;
+      }
+    }
+
+    arena_release(table->arena, table->records);
+    table->records = NULL;
+    table->columns = columns;
+    table->layout = TABLE_LAYOUT_COLUMNS;
+    return DB_SUCCESS;
+  }
+
+  StudentRecord *records = arena_alloc(
+      table->arena, table->record_capacity * sizeof(StudentRecord));
+  if (!records) {
+    return DB_ERROR_MEMORY;
+  }
+  for (size_t i = 0; i < table->slot_count; i++) {
+    table_read_record(table, i, &records[i]);
+  }
 
+  column_store_free(&table->columns);
+  table->records = records;
+  table->layout = TABLE_LAYOUT_ROWS;
   return DB_SUCCESS;
 }
 
+/**
+ * @brief rebuilds the id index, programme codes, folded names and any built
+ *        views from the records
+ * @param[in,out] table pointer to the table whose index to rebuild
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ * @note must be called after records are reordered in place (e.g. sorting)
+ */
+DBStatus table_rebuild_index(StudentTable *table) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+
+  // callers change records in bulk (loads, in-place sorts), so the widths
+  // are recounted when next read
+  table->display_widths.stale = true;
+  table->mutations++;
+
+  if (encode_programmes(table) != DB_SUCCESS ||
+      fold_names(table) != DB_SUCCESS) {
+    return DB_ERROR_MEMORY;
+  }
+  if (table->name_trigrams && index_names(table) != DB_SUCCESS) {
+    drop_name_index(table);
+  }
+  if (table->filter_bitmaps && index_filters(table) != DB_SUCCESS) {
+    drop_filter_index(table);
+  }
+
+  id_index_clear(&table->id_index);
+  for (size_t i = 0; i < table->slot_count; i++) {
+    if (!table_is_live(table, i)) {
+      continue;
+    }
+    if (!id_index_insert(&table->id_index, table_record_id(table, i), i)) {
+      return DB_ERROR_MEMORY;
+    }
+  }
+
+  if (table->views.built) {
+    return table_views_build(table);
+  }
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief removes every tombstoned slot, moving live records down so
+ *        positions are dense again
+ * @param[in,out] table pointer to the table
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if scratch memory cannot be
+ *         allocated (the table is left unchanged)
+ * @note storage order of live records is preserved; the id index, programme
+ *       codes, folded names, trigram index, filter bitmaps and sorted views
+ *       are remapped
+ */
+DBStatus table_purge_tombstones(StudentTable *table) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (table->tombstone_count == 0) {
+    return DB_SUCCESS;
+  }
+  table->mutations++;
+
+  uint32_t *new_position = NULL;
+  if (table->views.built || table->name_trigrams || table->filter_bitmaps) {
+    new_position = malloc(table->slot_count * sizeof(uint32_t));
+    if (!new_position) {
+      return DB_ERROR_MEMORY;
+    }
+  }
+
+  size_t live = 0;
+  for (size_t i = 0; i < table->slot_count; i++) {
+    if (!table_is_live(table, i)) {
+      continue;
+    }
+    if (new_position) {
+      new_position[i] = (uint32_t)live;
+    }
+    if (live != i) {
+      if (table->layout == TABLE_LAYOUT_COLUMNS) {
+        column_store_move_row(&table->columns, live, i);
+      } else {
+        table->records[live] = table->records[i];
+      }
+      table->prog_codes[live] = table->prog_codes[i];
+      folded_text_move(&table->folded_names, live, i);
+      // the id already has an entry, so this overwrite cannot fail
+      id_index_insert(&table->id_index, table_record_id(table, live), live);
+    }
+    live++;
+  }
+
+  if (table->layout == TABLE_LAYOUT_ROWS) {
+    memset(&table->records[live], 0,
+           (table->slot_count - live) * sizeof(StudentRecord));
+  } else {
+    // dead names are dropped from the pool; on failure they just linger
+    column_store_compact_pools(&table->columns, live);
+  }
+  folded_text_compact(&table->folded_names, live);
+
+  memset(table->tombstones, 0,
+         tombstone_words(table->record_capacity) * sizeof(uint64_t));
+  table->slot_count = live;
+  table->tombstone_count = 0;
+
+  if (new_position) {
+    table_views_remap(table, new_position);
+    // deleted positions already left the index, so only live ones remain
+    trigram_index_remap(table->name_trigrams, new_position);
+    if (table->filter_bitmaps &&
+        !bitmap_index_remap(table->filter_bitmaps, new_position)) {
+      drop_filter_index(table);
+    }
+    free(new_position);
+  }
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief switches how a table's records are hashed for change detection
+ * @param[in,out] table pointer to the table
+ * @param[in] mode checksum mode to use
+ * @note recomputes record_checksum from the live records if the mode
+ *       changes
+ */
+void table_set_checksum_mode(StudentTable *table, ChecksumMode mode) {
+  if (!table || table->checksum_mode == mode) {
+    return;
+  }
+  table->checksum_mode = mode;
+  table->record_checksum = compute_table_checksum(table);
+}
+
+/**
+ * @brief builds or drops the trigram index over a table's names
+ * @param[in,out] table pointer to the table
+ * @param[in] enabled true to index the names, false to drop the index
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the index cannot be
+ *         built (the table is left without one)
+ * @note an index that later cannot grow is dropped, and GREP NAME scans
+ *       every name again
+ */
+DBStatus table_set_name_index(StudentTable *table, bool enabled) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (!enabled || table->name_trigrams) {
+    if (!enabled) {
+      drop_name_index(table);
+    }
+    return DB_SUCCESS;
+  }
+
+  table->name_trigrams = malloc(sizeof(TrigramIndex));
+  if (!table->name_trigrams) {
+    return DB_ERROR_MEMORY;
+  }
+  trigram_index_init(table->name_trigrams);
+  if (index_names(table) != DB_SUCCESS) {
+    drop_name_index(table);
+    return DB_ERROR_MEMORY;
+  }
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief builds or drops the programme and mark band bitmaps of a table
+ * @param[in,out] table pointer to the table
+ * @param[in] enabled true to build the bitmaps, false to drop them
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the bitmaps cannot be
+ *         built (the table is left without them)
+ * @note bitmaps that later cannot grow are dropped, and ADV QUERY compares
+ *       every record again
+ */
+DBStatus table_set_filter_index(StudentTable *table, bool enabled) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (!enabled || table->filter_bitmaps) {
+    if (!enabled) {
+      drop_filter_index(table);
+    }
+    return DB_SUCCESS;
+  }
+
+  table->filter_bitmaps = malloc(sizeof(BitmapIndex));
+  if (!table->filter_bitmaps) {
+    return DB_ERROR_MEMORY;
+  }
+  bitmap_index_init(table->filter_bitmaps);
+  if (index_filters(table) != DB_SUCCESS) {
+    drop_filter_index(table);
+    return DB_ERROR_MEMORY;
+  }
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief returns the widest rendering of each displayed field
+ * @param[in,out] table pointer to the table
+ * @return widths over the live records (all zero for an empty table), NULL
+ *         if table is NULL
+ * @note recounts from the records only if the last record at a maximum was
+ *       removed since the previous call; otherwise O(1)
+ */
+const DisplayWidths *table_display_widths(StudentTable *table) {
+  if (!table) {
+    return NULL;
+  }
+
+  DisplayWidths *widths = &table->display_widths;
+  if (widths->stale) {
+    display_widths_reset(widths);
+    for (size_t p = 0; p < table->slot_count; p++) {
+      if (table_is_live(table, p)) {
+        display_widths_add(widths, table_record_id(table, p),
+                           table_record_name(table, p),
+                           table_record_prog(table, p),
+                           table_record_mark(table, p));
+      }
+    }
+  }
+  return widths;
+}
+
 /**
  * @brief creates a new empty database
  * @return pointer to newly created StudentDatabase on success, NULL on failure
@@ -169,10 +878,30 @@ StudentDatabase *db_init(void) {
   db->last_saved_checksum = 0;
   db->file_loaded_checksum = 0;
   db->event_log = NULL;
+  db->table_layout = TABLE_LAYOUT_ROWS;
+  db->checksum_mode = CHECKSUM_MODE_CRC32;
+  db->name_index = false;
+  db->filter_index = false;
+  db->range_index = false;
+  db->query_parallel_rows = QUERY_PARALLEL_MIN_ROWS;
+  db->query_workers = 0;
+  arena_init(&db->arena);
+  db->mapped_files = NULL;
+  db->journal = NULL;
+  db->mutation_base = 0;
+  db->query_cache = NULL;
 
   return db;
 }
 
+// unmap every snapshot backing a table (the list lives in the arena)
+static void close_mapped_files(StudentDatabase *db) {
+  for (MappedFile *file = db->mapped_files; file; file = file->next) {
+    file_map_close(&file->map);
+  }
+  db->mapped_files = NULL;
+}
+
 /**
  * @brief frees all memory associated with a database
  * @param[in] db pointer to the database to free (can be NULL)
@@ -188,15 +917,48 @@ void db_free(StudentDatabase *db) {
   free(db->tables);
 
   event_log_free(db->event_log);
+  query_cache_free(db->query_cache);
+  journal_close(db->journal);
+  close_mapped_files(db);
+  arena_free(&db->arena);
 
   free(db);
 }
 
+/**
+ * @brief unloads every table and resets the database's arena for reuse
+ * @param[in,out] db pointer to the database to clear
+ * @note metadata, the event log and the table layout are kept; the arena's
+ *       blocks stay allocated for the next load, mapped snapshot files are
+ *       closed and the journal is closed without saving
+ */
+void db_clear(StudentDatabase *db) {
+  if (!db) {
+    return;
+  }
+
+  // the count moves on past every unloaded table's, so results cached
+  // against them can never match again
+  for (size_t i = 0; i < db->table_count; i++) {
+    db->mutation_base += db->tables[i]->mutations;
+    table_free(db->tables[i]);
+  }
+  db->table_count = 0;
+  db->mutation_base++;
+  query_cache_clear(db->query_cache);
+
+  journal_close(db->journal);
+  db->journal = NULL;
+  close_mapped_files(db);
+  arena_reset(&db->arena);
+}
+
 /**
  * @brief adds a table to the database (grows capacity if needed)
  * @param[in,out] db pointer to the database to add the table to
  * @param[in] table pointer to the table to add
  * @return DB_SUCCESS on success, DB_ERROR_MEMORY if reallocation fails
+ * @note the table takes the database's checksum mode
  */
 DBStatus db_add_table(StudentDatabase *db, StudentTable *table) {
   if (!db || !table) {
@@ -216,33 +978,213 @@ DBStatus db_add_table(StudentDatabase *db, StudentTable *table) {
     db->table_capacity = new_capacity;
   }
 
+  table_set_checksum_mode(table, db->checksum_mode);
+  // without the indexes GREP NAME and ADV QUERY filters still work by
+  // scanning, so a table that cannot be indexed is added anyway
+  table_set_name_index(table, db->name_index);
+  table_set_filter_index(table, db->filter_index);
   db->tables[db->table_count] = table;
   db->table_count++;
+  db->mutation_base++;
 
   return DB_SUCCESS;
 }
 
 /**
- * @brief loads database from a text file
+ * @brief loads database from a text file or binary snapshot
  * @param[in,out] db pointer to the database to load data into
  * @param[in] filename path to the file to load
  * @param[out] stats optional pointer to ParsingStats structure (can be NULL)
  * @return DB_SUCCESS on success, appropriate error code on failure
  * @note if stats is provided, it will be populated with parsing statistics
+ * @note files ending in SNAPSHOT_EXTENSION are read as snapshots
+ * @note on success db->file_loaded_checksum holds the file's CRC32, taken
+ *       from the bytes as they are loaded rather than by reading them again
  */
 DBStatus db_load(StudentDatabase *db, const char *filename, void *stats) {
   if (!db || !filename) {
     return DB_ERROR_NULL_POINTER;
   }
+  if (snapshot_is_path(filename)) {
+    return snapshot_load(db, filename, (ParseStatistics *)stats);
+  }
   return parse_file(filename, db, (ParseStatistics *)stats);
 }
 
+// one worker's share of a text save: the lines of the records between two
+// cursor values of the table's active view
+typedef struct {
+  const StudentTable *table;
+  size_t first; // cursor value to start from
+  size_t last;  // cursor value the scan stops at
+  char *text;   // rendered lines, kept across passes
+  size_t length;
+  size_t capacity;
+  unsigned long crc; // crc32 of text
+  bool ok;
+} SaveChunk;
+
+static void render_chunk_task(void *arg) {
+  SaveChunk *chunk = arg;
+  chunk->length = 0;
+  chunk->crc = 0;
+  chunk->ok = true;
+
+  size_t cursor = chunk->first;
+  while (cursor < chunk->last) {
+    size_t p = table_view_next(chunk->table, &cursor);
+    // in stored order the cursor skips tombstones and can pass last, in
+    // which case the record belongs to the next chunk
+    if (p == TABLE_VIEW_NOT_FOUND || cursor > chunk->last) {
+      break;
+    }
+
+    if (chunk->capacity - chunk->length < RECORD_LINE_MAX) {
+      size_t capacity = chunk->capacity ? chunk->capacity * 2 : 64 * 1024;
+      char *text = realloc(chunk->text, capacity);
+      if (!text) {
+        chunk->ok = false;
+        return;
+      }
+      chunk->text = text;
+      chunk->capacity = capacity;
+    }
+
+    char *line = chunk->text + chunk->length;
+    size_t length = format_record_line(
+        line, table_record_id(chunk->table, p),
+        table_record_name(chunk->table, p), table_record_prog(chunk->table, p),
+        table_record_mark(chunk->table, p));
+    chunk->crc = crc32_update(chunk->crc, line, length);
+    chunk->length += length;
+  }
+}
+
+// output file plus the checksum of everything written to it so far
+typedef struct {
+  FILE *fp;
+  unsigned long crc;
+  bool ok;
+} TextWriter;
+
+static void write_text(TextWriter *writer, const char *text, size_t length) {
+  if (writer->ok && fwrite(text, 1, length, writer->fp) != length) {
+    writer->ok = false;
+  }
+  writer->crc = crc32_update(writer->crc, text, length);
+}
+
+static void write_string(TextWriter *writer, const char *text) {
+  write_text(writer, text, strlen(text));
+}
+
+// write a rendered chunk in one call, joining its checksum to the file's
+static void write_chunk(TextWriter *writer, const SaveChunk *chunk) {
+  if (chunk->length == 0) {
+    return;
+  }
+  if (writer->ok &&
+      fwrite(chunk->text, 1, chunk->length, writer->fp) != chunk->length) {
+    writer->ok = false;
+  }
+  writer->crc = crc32_combine(writer->crc, chunk->crc, chunk->length);
+}
+
+/*
+ * writes the metadata and the first table to a text file, setting
+ * file_checksum to the crc32 of the bytes written. the file is written
+ * beside the target, synced and renamed over it, so a crash leaves the old
+ * file or the new one, never a partial one. records are rendered in
+ * passes of up to SAVE_MAX_WORKER_ROWS per worker: each pass splits the
+ * view into cursor ranges that workers format (without printf) and
+ * checksum in parallel, then each worker's buffer goes out in one write in
+ * view order
+ */
+static DBStatus write_text_file(const StudentDatabase *db,
+                                const StudentTable *table,
+                                const char *filename,
+                                unsigned long *file_checksum) {
+  // binary mode, so the bytes checksummed are the bytes on disk; lines end
+  // in TEXT_NEWLINE as they did when text mode translated them
+  AtomicFile file;
+  FILE *fp = atomic_file_open(&file, filename);
+  if (!fp) {
+    return DB_ERROR_FILE_NOT_FOUND;
+  }
+
+  TextWriter writer = {fp, 0, true};
+  write_string(&writer, "Database Name: ");
+  write_string(&writer, db->db_name);
+  write_string(&writer, TEXT_NEWLINE "Authors: ");
+  write_string(&writer, db->authors);
+  write_string(&writer, TEXT_NEWLINE TEXT_NEWLINE "Table Name: ");
+  write_string(&writer, table->table_name);
+  write_string(&writer, TEXT_NEWLINE);
+
+  for (size_t i = 0; i < table->column_count; i++) {
+    write_string(&writer, table->column_headers[i]);
+    if (i + 1 < table->column_count) {
+      write_string(&writer, "\t");
+    }
+  }
+  write_string(&writer, TEXT_NEWLINE);
+
+  // records are written in the table's active view order
+  SaveChunk chunks[MAX_WORKER_THREADS];
+  memset(chunks, 0, sizeof chunks);
+  DBStatus result = DB_SUCCESS;
+  size_t end = table_view_cursor_end(table);
+  size_t cursor = 0;
+  while (cursor < end && writer.ok && result == DB_SUCCESS) {
+    size_t remaining = end - cursor;
+    size_t workers = parallel_worker_count(remaining, SAVE_MIN_WORKER_ROWS);
+    size_t pass = remaining / workers > SAVE_MAX_WORKER_ROWS
+                      ? workers * SAVE_MAX_WORKER_ROWS
+                      : remaining;
+    for (size_t w = 0; w < workers; w++) {
+      chunks[w].table = table;
+      chunks[w].first = cursor + pass * w / workers;
+      chunks[w].last = cursor + pass * (w + 1) / workers;
+    }
+
+    parallel_run(render_chunk_task, chunks, sizeof chunks[0], workers);
+
+    for (size_t w = 0; w < workers; w++) {
+      if (!chunks[w].ok) {
+        result = DB_ERROR_MEMORY;
+        break;
+      }
+      write_chunk(&writer, &chunks[w]);
+    }
+    cursor += pass;
+  }
+
+  for (size_t w = 0; w < MAX_WORKER_THREADS; w++) {
+    free(chunks[w].text);
+  }
+
+  if (result != DB_SUCCESS || !writer.ok) {
+    atomic_file_abort(&file);
+    return result != DB_SUCCESS ? result : DB_ERROR_FILE_READ;
+  }
+  if (!atomic_file_commit(&file)) {
+    return DB_ERROR_FILE_READ;
+  }
+  *file_checksum = writer.crc;
+  return DB_SUCCESS;
+}
+
 /**
- * @brief saves database to a text file
+ * @brief saves database to a text file or binary snapshot
  * @param[in] db pointer to the database to save
  * @param[in] filename path to the file to save to
  * @return DB_SUCCESS on success, appropriate error code on failure
  * @note writes database metadata, table structure, and all records to file
+ * @note files ending in SNAPSHOT_EXTENSION are written as snapshots
+ * @note db->file_loaded_checksum is set from the bytes as they are written,
+ *       so the saved file is not read back
+ * @note the file is replaced atomically and synced to disk before db_save
+ *       returns
  */
 DBStatus db_save(StudentDatabase *db, const char *filename) {
   if (!db || !filename) {
@@ -262,36 +1204,22 @@ DBStatus db_save(StudentDatabase *db, const char *filename) {
     return DB_ERROR_INVALID_DATA;
   }
 
-  FILE *fp = fopen(filename, "w");
-  if (!fp) {
-    return DB_ERROR_FILE_NOT_FOUND;
-  }
-
-  fprintf(fp, "Database Name: %s\n", db->db_name);
-  fprintf(fp, "Authors: %s\n", db->authors);
-  fprintf(fp, "\n");
-  fprintf(fp, "Table Name: %s\n", table->table_name);
-
-  for (size_t i = 0; i < table->column_count; i++) {
-    fprintf(fp, "%s", table->column_headers[i]);
-    if (i + 1 < table->column_count) {
-      fputc('\t', fp);
-    }
-  }
-  fputc('\n', fp);
-
-  for (size_t i = 0; i < table->record_count; i++) {
-    const StudentRecord *r = &table->records[i];
-    fprintf(fp, "%d\t%s\t%s\t%.2f\n", r->id, r->name, r->prog, r->mark);
-  }
-
-  if (fclose(fp) != 0) {
-    return DB_ERROR_FILE_READ;
+  // saving is a natural point to reclaim deleted slots; a failed purge only
+  // means the writer below skips them
+  table_purge_tombstones(table);
+
+  // the writers checksum the bytes they write, so the file is not read back
+  unsigned long file_checksum = 0;
+  DBStatus status = snapshot_is_path(filename)
+                        ? snapshot_save(db, filename, &file_checksum)
+                        : write_text_file(db, table, filename, &file_checksum);
+  if (status != DB_SUCCESS) {
+    return status;
   }
 
   // update checksums after successful save
-  db->last_saved_checksum = compute_database_checksum(db);
-  db->file_loaded_checksum = compute_file_checksum(filename);
+  db->last_saved_checksum = tracked_database_checksum(db);
+  db->file_loaded_checksum = file_checksum;
 
   return DB_SUCCESS;
 }
@@ -322,20 +1250,15 @@ DBStatus db_update_record(StudentDatabase *db, int id, const char *new_name,
     return DB_ERROR_NULL_POINTER;
   }
 
-  StudentRecord *rec = NULL;
-  for (size_t i = 0; i < table->record_count; i++) {
-    if (table->records[i].id == id) {
-      rec = &table->records[i];
-      break;
-    }
-  }
-
-  if (!rec) {
+  size_t position = table_find_position(table, id);
+  if (position == ID_INDEX_NOT_FOUND) {
     return DB_ERROR_NOT_FOUND;
   }
 
   // Prepare copy for validation
-  StudentRecord updated = *rec;
+  StudentRecord current;
+  table_read_record(table, position, &current);
+  StudentRecord updated = current;
 
   if (new_name) {
     strncpy(updated.name, new_name, sizeof(updated.name) - 1);
@@ -357,9 +1280,131 @@ DBStatus db_update_record(StudentDatabase *db, int id, const char *new_name,
     return DB_ERROR_INVALID_DATA;
   }
 
-  *rec = updated;
+  // room for the folded copy of a new name is also made up front, so the
+  // replacement below cannot fail once the record has changed
+  bool renamed = strcmp(updated.name, current.name) != 0;
+  if (renamed && !folded_text_reserve_text(&table->folded_names,
+                                           strlen(updated.name))) {
+    return DB_ERROR_MEMORY;
+  }
+
+  // a new programme takes its code before anything is modified
+  uint32_t old_code = table->prog_codes[position];
+  uint32_t new_code = old_code;
+  bool recode = strcmp(updated.prog, current.prog) != 0;
+  if (recode &&
+      !dictionary_intern(&table->programmes, updated.prog, &new_code)) {
+    return DB_ERROR_MEMORY;
+  }
 
-  return DB_SUCCESS;
+  // a changed mark moves the record within the mark views
+  bool reorder = table->views.built && updated.mark != current.mark;
+  if (reorder) {
+    table_views_unlink(table, position);
+  }
+
+  DBStatus status = DB_SUCCESS;
+  if (table->layout == TABLE_LAYOUT_COLUMNS) {
+    if (!column_store_update(&table->columns, position, updated.name,
+                             updated.mark)) {
+      status = DB_ERROR_MEMORY;
+    }
+  } else {
+    table->records[position] = updated;
+  }
+
+  if (status == DB_SUCCESS) {
+    table->mutations++;
+    if (renamed) {
+      trigram_index_remove(table->name_trigrams, (uint32_t)position,
+                           folded_text_get(&table->folded_names, position));
+      folded_text_replace(&table->folded_names, position, updated.name);
+      if (table->name_trigrams &&
+          !trigram_index_add(table->name_trigrams, (uint32_t)position,
+                             folded_text_get(&table->folded_names,
+                                             position))) {
+        drop_name_index(table);
+      }
+    }
+    table->record_checksum ^=
+        compute_record_hash(&current, table->checksum_mode) ^
+        compute_record_hash(&updated, table->checksum_mode);
+    display_widths_remove(&table->display_widths, current.id, current.name,
+                          current.prog, current.mark);
+    display_widths_add(&table->display_widths, updated.id, updated.name,
+                       updated.prog, updated.mark);
+  }
+
+  if (recode) {
+    // on failure the new code is dropped and the record keeps its programme
+    uint32_t unused = status == DB_SUCCESS ? old_code : new_code;
+    dictionary_release(&table->programmes, unused);
+    if (status == DB_SUCCESS) {
+      table->prog_codes[position] = new_code;
+    }
+  }
+
+  // a new programme or mark band moves the record between bitmaps
+  if (status == DB_SUCCESS && table->filter_bitmaps &&
+      (recode ||
+       bitmap_index_band(updated.mark) != bitmap_index_band(current.mark))) {
+    bitmap_index_remove(table->filter_bitmaps, (uint32_t)position, old_code,
+                        current.mark);
+    if (!bitmap_index_add(table->filter_bitmaps, (uint32_t)position,
+                          new_code, updated.mark)) {
+      drop_filter_index(table);
+    }
+  }
+
+  // relinking uses whichever mark is now stored
+  if (reorder) {
+    table_views_link(table, position);
+  }
+
+  return status;
+}
+
+/**
+ * @brief returns a count that changes whenever any table's records, their
+ *        positions or its active view change, or tables are added or
+ *        unloaded
+ * @param[in] db pointer to the database
+ * @return mutation count (0 if db is NULL); it only ever grows
+ */
+uint64_t db_mutation_count(const StudentDatabase *db) {
+  if (!db) {
+    return 0;
+  }
+  uint64_t count = db->mutation_base;
+  for (size_t i = 0; i < db->table_count; i++) {
+    count += db->tables[i]->mutations;
+  }
+  return count;
+}
+
+/**
+ * @brief enables, resizes or disables the ADV QUERY result cache
+ * @param[in,out] db pointer to the database
+ * @param[in] capacity most bytes the cached results may hold (0 disables
+ *                     the cache and frees it)
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the cache cannot be
+ *         created
+ */
+DBStatus db_set_query_cache(StudentDatabase *db, size_t capacity) {
+  if (!db) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (capacity == 0) {
+    query_cache_free(db->query_cache);
+    db->query_cache = NULL;
+    return DB_SUCCESS;
+  }
+  if (db->query_cache) {
+    query_cache_set_capacity(db->query_cache, capacity);
+    return DB_SUCCESS;
+  }
+  db->query_cache = query_cache_create(capacity);
+  return db->query_cache ? DB_SUCCESS : DB_ERROR_MEMORY;
 }
 
 /**
@@ -0,0 +1,180 @@
+#include "dictionary.h"
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a hash of a NUL-terminated string
+static size_t hash_text(const char *text, size_t bucket_count) {
+  uint32_t h = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+    h ^= *p;
+    h *= 16777619u;
+  }
+  return (size_t)h & (bucket_count - 1);
+}
+
+// bucket holding text, or the empty bucket where it would go
+static size_t find_bucket(const StringDictionary *dict, const char *text) {
+  size_t i = hash_text(text, dict->bucket_count);
+  while (dict->buckets[i] != 0 &&
+         strcmp(dict->entries[dict->buckets[i] - 1], text) != 0) {
+    i = (i + 1) & (dict->bucket_count - 1);
+  }
+  return i;
+}
+
+// grow the bucket array to new_count and re-insert every code
+static bool rehash(StringDictionary *dict, size_t new_count) {
+  uint32_t *buckets = calloc(new_count, sizeof(uint32_t));
+  if (!buckets) {
+    return false;
+  }
+
+  free(dict->buckets);
+  dict->buckets = buckets;
+  dict->bucket_count = new_count;
+  for (uint32_t code = 0; code < dict->count; code++) {
+    dict->buckets[find_bucket(dict, dict->entries[code])] = code + 1;
+  }
+  return true;
+}
+
+// ensure there is room for one more entry and the load factor stays <= 1/2
+static bool reserve_entry(StringDictionary *dict) {
+  if (dict->count == DICTIONARY_NOT_FOUND - 1) {
+    return false;
+  }
+
+  if (dict->count >= dict->capacity) {
+    uint32_t capacity = dict->capacity ? dict->capacity * 2 : 8;
+    char **entries = realloc(dict->entries, capacity * sizeof(char *));
+    if (!entries) {
+      return false;
+    }
+    dict->entries = entries;
+
+    uint32_t *refs = realloc(dict->refs, capacity * sizeof(uint32_t));
+    if (!refs) {
+      return false;
+    }
+    dict->refs = refs;
+    dict->capacity = capacity;
+  }
+
+  if (((size_t)dict->count + 1) * 2 > dict->bucket_count) {
+    size_t buckets =
+        dict->bucket_count ? dict->bucket_count * 2 : DICTIONARY_INITIAL_BUCKETS;
+    return rehash(dict, buckets);
+  }
+  return true;
+}
+
+/**
+ * @brief initialises an empty dictionary (no memory is allocated)
+ * @param[out] dict pointer to the dictionary to initialise
+ */
+void dictionary_init(StringDictionary *dict) {
+  if (!dict) {
+    return;
+  }
+  memset(dict, 0, sizeof *dict);
+}
+
+/**
+ * @brief frees all memory held by a dictionary
+ * @param[in,out] dict pointer to the dictionary to free (can be NULL)
+ */
+void dictionary_free(StringDictionary *dict) {
+  if (!dict) {
+    return;
+  }
+  dictionary_clear(dict);
+  free(dict->entries);
+  free(dict->refs);
+  free(dict->buckets);
+  dictionary_init(dict);
+}
+
+/**
+ * @brief removes every entry while keeping the allocated arrays
+ * @param[in,out] dict pointer to the dictionary to clear
+ * @note all previously returned codes become invalid
+ */
+void dictionary_clear(StringDictionary *dict) {
+  if (!dict) {
+    return;
+  }
+  for (uint32_t code = 0; code < dict->count; code++) {
+    free(dict->entries[code]);
+  }
+  dict->count = 0;
+  if (dict->buckets) {
+    memset(dict->buckets, 0, dict->bucket_count * sizeof(uint32_t));
+  }
+}
+
+/**
+ * @brief looks up the code of a string without adding it
+ * @param[in] dict pointer to the dictionary
+ * @param[in] text string to look up (exact, case-sensitive)
+ * @return code of the string, DICTIONARY_NOT_FOUND if it is not interned
+ */
+uint32_t dictionary_find(const StringDictionary *dict, const char *text) {
+  if (!dict || !text || dict->count == 0) {
+    return DICTIONARY_NOT_FOUND;
+  }
+  uint32_t slot = dict->buckets[find_bucket(dict, text)];
+  return slot ? slot - 1 : DICTIONARY_NOT_FOUND;
+}
+
+/**
+ * @brief returns the code for a string, adding it if needed, and counts
+ *        one more record using it
+ * @param[in,out] dict pointer to the dictionary
+ * @param[in] text string to intern
+ * @param[out] code receives the string's code
+ * @return true on success, false if memory allocation fails
+ */
+bool dictionary_intern(StringDictionary *dict, const char *text,
+                       uint32_t *code) {
+  if (!dict || !text || !code) {
+    return false;
+  }
+
+  uint32_t existing = dictionary_find(dict, text);
+  if (existing != DICTIONARY_NOT_FOUND) {
+    dict->refs[existing]++;
+    *code = existing;
+    return true;
+  }
+
+  if (!reserve_entry(dict)) {
+    return false;
+  }
+
+  size_t size = strlen(text) + 1;
+  char *copy = malloc(size);
+  if (!copy) {
+    return false;
+  }
+  memcpy(copy, text, size);
+
+  uint32_t added = dict->count++;
+  dict->entries[added] = copy;
+  dict->refs[added] = 1;
+  dict->buckets[find_bucket(dict, text)] = added + 1;
+  *code = added;
+  return true;
+}
+
+/**
+ * @brief counts one fewer record using a code
+ * @param[in,out] dict pointer to the dictionary
+ * @param[in] code code previously returned by dictionary_intern
+ * @note the entry itself is kept so the code stays valid
+ */
+void dictionary_release(StringDictionary *dict, uint32_t code) {
+  if (!dict || code >= dict->count || dict->refs[code] == 0) {
+    return;
+  }
+  dict->refs[code]--;
+}
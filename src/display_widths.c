@@ -0,0 +1,85 @@
+#include "display_widths.h"
+#include "record_format.h"
+#include <string.h>
+
+/**
+ * @brief empties the widths, as for a table with no records
+ * @param[out] widths widths to reset
+ */
+void display_widths_reset(DisplayWidths *widths) {
+  if (!widths) {
+    return;
+  }
+  memset(widths, 0, sizeof *widths);
+}
+
+/**
+ * @brief measures the rendered width of each field of a record
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] prog programme
+ * @param[in] mark student mark
+ * @param[out] out width of each field, indexed by DisplayField
+ * @note widths are those of printf's "%d", "%s" and "%.2f"
+ */
+void display_widths_measure(int id, const char *name, const char *prog,
+                            float mark, size_t out[DISPLAY_FIELD_COUNT]) {
+  char text[FORMAT_MARK_MAX];
+  out[DISPLAY_FIELD_ID] = format_int(text, id);
+  out[DISPLAY_FIELD_NAME] = strlen(name);
+  out[DISPLAY_FIELD_PROG] = strlen(prog);
+  out[DISPLAY_FIELD_MARK] = format_mark(text, mark);
+}
+
+/**
+ * @brief accounts for a record added to the table
+ * @param[in,out] widths widths to update
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] prog programme
+ * @param[in] mark student mark
+ * @note does nothing while the widths are stale
+ */
+void display_widths_add(DisplayWidths *widths, int id, const char *name,
+                        const char *prog, float mark) {
+  if (!widths || widths->stale) {
+    return;
+  }
+
+  size_t measured[DISPLAY_FIELD_COUNT];
+  display_widths_measure(id, name, prog, mark, measured);
+  for (size_t f = 0; f < DISPLAY_FIELD_COUNT; f++) {
+    if (measured[f] > widths->max[f]) {
+      widths->max[f] = measured[f];
+      widths->at_max[f] = 1;
+    } else if (measured[f] == widths->max[f]) {
+      widths->at_max[f]++;
+    }
+  }
+}
+
+/**
+ * @brief accounts for a record removed from the table
+ * @param[in,out] widths widths to update
+ * @param[in] id student id
+ * @param[in] name student name
+ * @param[in] prog programme
+ * @param[in] mark student mark
+ * @note marks the widths stale if the record was the last at a maximum
+ */
+void display_widths_remove(DisplayWidths *widths, int id, const char *name,
+                           const char *prog, float mark) {
+  if (!widths || widths->stale) {
+    return;
+  }
+
+  size_t measured[DISPLAY_FIELD_COUNT];
+  display_widths_measure(id, name, prog, mark, measured);
+  for (size_t f = 0; f < DISPLAY_FIELD_COUNT; f++) {
+    if (measured[f] == widths->max[f] && widths->at_max[f] > 0 &&
+        --widths->at_max[f] == 0) {
+      // the next widest width is unknown until the records are recounted
+      widths->stale = true;
+    }
+  }
+}
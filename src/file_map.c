@@ -0,0 +1,132 @@
+#include "file_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// read the whole file into a heap buffer (used where mmap is unavailable)
+static bool read_whole_file(const char *path, FileMap *map) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    return false;
+  }
+
+  if (fseek(fp, 0, SEEK_END) != 0) {
+    fclose(fp);
+    return false;
+  }
+  long size = ftell(fp);
+  if (size < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+    fclose(fp);
+    return false;
+  }
+
+  char *data = NULL;
+  if (size > 0) {
+    data = malloc((size_t)size);
+    if (!data || fread(data, 1, (size_t)size, fp) != (size_t)size) {
+      free(data);
+      fclose(fp);
+      return false;
+    }
+  }
+
+  fclose(fp);
+  map->data = data;
+  map->size = (size_t)size;
+  map->mapped = false;
+  return true;
+}
+
+// map path read-only, or copy-on-write if writable is true
+static bool map_file(const char *path, FileMap *map, bool writable) {
+  if (!path || !map) {
+    return false;
+  }
+  memset(map, 0, sizeof *map);
+
+#ifndef _WIN32
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    // not a regular file (e.g. a pipe): fall back to reading it
+    return read_whole_file(path, map);
+  }
+
+  if (st.st_size == 0) {
+    close(fd);
+    return true;
+  }
+
+  int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void *data =
+      mmap(NULL, (size_t)st.st_size, protection, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return read_whole_file(path, map);
+  }
+
+  // loaders read front to back exactly once
+  madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+  map->data = data;
+  map->size = (size_t)st.st_size;
+  map->mapped = true;
+  return true;
+#else
+  (void)writable;
+  return read_whole_file(path, map);
+#endif
+}
+
+/**
+ * @brief opens a file and makes its whole contents readable in memory
+ * @param[in] path path of the file to open
+ * @param[out] map receives the file's contents
+ * @return true on success, false if the file cannot be opened or read
+ */
+bool file_map_open(const char *path, FileMap *map) {
+  return map_file(path, map, false);
+}
+
+/**
+ * @brief opens a file whose in-memory copy may be modified
+ * @param[in] path path of the file to open
+ * @param[out] map receives the file's contents
+ * @return true on success, false if the file cannot be opened or read
+ * @note pages are copy-on-write: writes through map->data stay private to
+ *       the process and never reach the file
+ */
+bool file_map_open_private(const char *path, FileMap *map) {
+  return map_file(path, map, true);
+}
+
+/**
+ * @brief releases the memory behind a file map
+ * @param[in,out] map pointer to the map to close (can be NULL)
+ */
+void file_map_close(FileMap *map) {
+  if (!map) {
+    return;
+  }
+#ifndef _WIN32
+  if (map->mapped) {
+    munmap((void *)map->data, map->size);
+  } else {
+    free((void *)map->data);
+  }
+#else
+  free((void *)map->data);
+#endif
+  memset(map, 0, sizeof *map);
+}
@@ -0,0 +1,284 @@
+#include "id_index.h"
+#include "constants.h"
+#include <stdlib.h>
+#include <string.h>
+
+// number of slots needed to cover the valid student id range
+static size_t direct_range(void) {
+  long long range = (long long)MAX_STUDENT_ID - (long long)MIN_STUDENT_ID + 1;
+  if (range <= 0 || range > (long long)ID_INDEX_DIRECT_LIMIT) {
+    return 0;
+  }
+  return (size_t)range;
+}
+
+// true if the id can be stored in the direct-address slot table
+static bool in_direct_range(int id) {
+  return id >= MIN_STUDENT_ID && id <= MAX_STUDENT_ID;
+}
+
+// mix bits of the id so sequential ids spread across buckets
+static size_t hash_id(int id, size_t capacity) {
+  uint32_t h = (uint32_t)id;
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return (size_t)h & (capacity - 1);
+}
+
+// insert into hash buckets without growing (caller guarantees free space)
+static void hash_put(int *keys, uint32_t *values, size_t capacity, int id,
+                     uint32_t value) {
+  size_t i = hash_id(id, capacity);
+  while (values[i] != 0 && keys[i] != id) {
+    i = (i + 1) & (capacity - 1);
+  }
+  keys[i] = id;
+  values[i] = value;
+}
+
+// grow hash storage to new_capacity and re-insert every entry
+static bool hash_resize(IdIndex *index, size_t new_capacity) {
+  int *keys = malloc(new_capacity * sizeof(int));
+  uint32_t *values = calloc(new_capacity, sizeof(uint32_t));
+  if (!keys || !values) {
+    free(keys);
+    free(values);
+    return false;
+  }
+
+  for (size_t i = 0; i < index->capacity; i++) {
+    if (index->values[i] != 0) {
+      hash_put(keys, values, new_capacity, index->keys[i], index->values[i]);
+    }
+  }
+
+  free(index->keys);
+  free(index->values);
+  index->keys = keys;
+  index->values = values;
+  index->capacity = new_capacity;
+  return true;
+}
+
+// move every direct-address entry into a freshly allocated hash table
+static bool switch_to_hash(IdIndex *index) {
+  size_t capacity = ID_INDEX_INITIAL_HASH_CAPACITY;
+  while (capacity < (index->count + 1) * 2) {
+    capacity *= 2;
+  }
+
+  int *keys = malloc(capacity * sizeof(int));
+  uint32_t *values = calloc(capacity, sizeof(uint32_t));
+  if (!keys || !values) {
+    free(keys);
+    free(values);
+    return false;
+  }
+
+  if (index->slots) {
+    size_t range = direct_range();
+    for (size_t i = 0; i < range; i++) {
+      if (index->slots[i] != 0) {
+        hash_put(keys, values, capacity, (int)(MIN_STUDENT_ID + (long long)i),
+                 index->slots[i]);
+      }
+    }
+    free(index->slots);
+    index->slots = NULL;
+  }
+
+  index->keys = keys;
+  index->values = values;
+  index->capacity = capacity;
+  index->mode = ID_INDEX_HASH;
+  return true;
+}
+
+/**
+ * @brief initialises an empty index (no memory is allocated until first use)
+ * @param[out] index pointer to the index to initialise
+ */
+void id_index_init(IdIndex *index) {
+  if (!index) {
+    return;
+  }
+  index->mode = direct_range() > 0 ? ID_INDEX_DIRECT : ID_INDEX_HASH;
+  index->slots = NULL;
+  index->keys = NULL;
+  index->values = NULL;
+  index->capacity = 0;
+  index->count = 0;
+}
+
+/**
+ * @brief frees all memory held by an index
+ * @param[in,out] index pointer to the index to free (can be NULL)
+ */
+void id_index_free(IdIndex *index) {
+  if (!index) {
+    return;
+  }
+  free(index->slots);
+  free(index->keys);
+  free(index->values);
+  id_index_init(index);
+}
+
+/**
+ * @brief removes every entry while keeping the allocated storage
+ * @param[in,out] index pointer to the index to clear
+ */
+void id_index_clear(IdIndex *index) {
+  if (!index) {
+    return;
+  }
+  if (index->slots) {
+    memset(index->slots, 0, direct_range() * sizeof(uint32_t));
+  }
+  if (index->values) {
+    memset(index->values, 0, index->capacity * sizeof(uint32_t));
+  }
+  index->count = 0;
+}
+
+/**
+ * @brief records the position of an id
+ * @param[in,out] index pointer to the index
+ * @param[in] id student id to insert
+ * @param[in] position record position associated with the id
+ * @return true on success, false if memory allocation fails
+ * @note an existing entry for the same id is overwritten
+ */
+bool id_index_insert(IdIndex *index, int id, size_t position) {
+  if (!index || position >= UINT32_MAX) {
+    return false;
+  }
+
+  // ids outside the valid range force the hash fallback
+  if (index->mode == ID_INDEX_DIRECT && !in_direct_range(id)) {
+    if (!switch_to_hash(index)) {
+      return false;
+    }
+  }
+
+  uint32_t value = (uint32_t)position + 1;
+
+  if (index->mode == ID_INDEX_DIRECT) {
+    if (!index->slots) {
+      index->slots = calloc(direct_range(), sizeof(uint32_t));
+      if (!index->slots) {
+        return false;
+      }
+    }
+    uint32_t *slot = &index->slots[id - MIN_STUDENT_ID];
+    if (*slot == 0) {
+      index->count++;
+    }
+    *slot = value;
+    return true;
+  }
+
+  // keep load factor at or below one half
+  if ((index->count + 1) * 2 > index->capacity) {
+    size_t new_capacity = index->capacity ? index->capacity * 2
+                                          : ID_INDEX_INITIAL_HASH_CAPACITY;
+    if (!hash_resize(index, new_capacity)) {
+      return false;
+    }
+  }
+
+  size_t i = hash_id(id, index->capacity);
+  while (index->values[i] != 0) {
+    if (index->keys[i] == id) {
+      index->values[i] = value;
+      return true;
+    }
+    i = (i + 1) & (index->capacity - 1);
+  }
+  index->keys[i] = id;
+  index->values[i] = value;
+  index->count++;
+  return true;
+}
+
+/**
+ * @brief looks up the record position of an id
+ * @param[in] index pointer to the index
+ * @param[in] id student id to look up
+ * @return record position, or ID_INDEX_NOT_FOUND if the id is not indexed
+ */
+size_t id_index_find(const IdIndex *index, int id) {
+  if (!index || index->count == 0) {
+    return ID_INDEX_NOT_FOUND;
+  }
+
+  if (index->mode == ID_INDEX_DIRECT) {
+    if (!index->slots || !in_direct_range(id)) {
+      return ID_INDEX_NOT_FOUND;
+    }
+    uint32_t value = index->slots[id - MIN_STUDENT_ID];
+    return value ? (size_t)value - 1 : ID_INDEX_NOT_FOUND;
+  }
+
+  size_t i = hash_id(id, index->capacity);
+  while (index->values[i] != 0) {
+    if (index->keys[i] == id) {
+      return (size_t)index->values[i] - 1;
+    }
+    i = (i + 1) & (index->capacity - 1);
+  }
+  return ID_INDEX_NOT_FOUND;
+}
+
+/**
+ * @brief removes an id from the index
+ * @param[in,out] index pointer to the index
+ * @param[in] id student id to remove
+ * @return true if the id was present, false otherwise
+ */
+bool id_index_remove(IdIndex *index, int id) {
+  if (!index || index->count == 0) {
+    return false;
+  }
+
+  if (index->mode == ID_INDEX_DIRECT) {
+    if (!index->slots || !in_direct_range(id) ||
+        index->slots[id - MIN_STUDENT_ID] == 0) {
+      return false;
+    }
+    index->slots[id - MIN_STUDENT_ID] = 0;
+    index->count--;
+    return true;
+  }
+
+  size_t mask = index->capacity - 1;
+  size_t i = hash_id(id, index->capacity);
+  while (index->values[i] != 0 && index->keys[i] != id) {
+    i = (i + 1) & mask;
+  }
+  if (index->values[i] == 0) {
+    return false;
+  }
+
+  // backward-shift deletion keeps probe chains intact without tombstones
+  size_t hole = i;
+  size_t j = (i + 1) & mask;
+  while (index->values[j] != 0) {
+    size_t home = hash_id(index->keys[j], index->capacity);
+    // move entry j into the hole if its home bucket does not lie in (hole, j]
+    bool movable = (hole <= j) ? (home <= hole || home > j)
+                               : (home <= hole && home > j);
+    if (movable) {
+      index->keys[hole] = index->keys[j];
+      index->values[hole] = index->values[j];
+      hole = j;
+    }
+    j = (j + 1) & mask;
+  }
+  index->values[hole] = 0;
+  index->count--;
+  return true;
+}
@@ -0,0 +1,577 @@
+#include "journal.h"
+#include "atomic_file.h"
+#include "checksum.h"
+#include "file_map.h"
+#include "table_view.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// bytes before the first entry: magic, version, base checksum
+#define JOURNAL_HEADER_SIZE 12
+
+// bytes before an entry's payload: payload length and type
+#define ENTRY_HEADER_SIZE 5
+
+// size of a whole commit entry
+#define COMMIT_ENTRY_SIZE (ENTRY_HEADER_SIZE + 4)
+
+// fields present in an update entry
+#define UPDATE_NAME 1u
+#define UPDATE_PROG 2u
+#define UPDATE_MARK 4u
+
+static void put_u32(unsigned char *out, uint32_t value) {
+  out[0] = (unsigned char)value;
+  out[1] = (unsigned char)(value >> 8);
+  out[2] = (unsigned char)(value >> 16);
+  out[3] = (unsigned char)(value >> 24);
+}
+
+static uint32_t get_u32(const unsigned char *in) {
+  return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 |
+         (uint32_t)in[3] << 24;
+}
+
+static uint32_t float_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof bits);
+  return bits;
+}
+
+// encoded length of a text field (length byte plus characters)
+static size_t text_size(const char *text, size_t field_size) {
+  size_t length = strlen(text);
+  return 1 + (length < field_size ? length : field_size - 1);
+}
+
+static unsigned char *put_text(unsigned char *out, const char *text,
+                               size_t field_size) {
+  size_t length = text_size(text, field_size) - 1;
+  out[0] = (unsigned char)length;
+  memcpy(out + 1, text, length);
+  return out + 1 + length;
+}
+
+// appends an entry header to the pending group and returns its payload,
+// or NULL (and forces the next save to checkpoint) if memory runs out
+static unsigned char *begin_entry(Journal *journal, JournalEntryType type,
+                                  size_t payload_size) {
+  size_t needed = journal->pending_size + ENTRY_HEADER_SIZE + payload_size;
+  if (needed > journal->pending_capacity) {
+    size_t capacity = journal->pending_capacity ? journal->pending_capacity
+                                                : 256;
+    while (capacity < needed) {
+      capacity *= 2;
+    }
+    unsigned char *pending = realloc(journal->pending, capacity);
+    if (!pending) {
+      journal->needs_checkpoint = true;
+      return NULL;
+    }
+    journal->pending = pending;
+    journal->pending_capacity = capacity;
+  }
+
+  unsigned char *entry = journal->pending + journal->pending_size;
+  put_u32(entry, (uint32_t)payload_size);
+  entry[4] = (unsigned char)type;
+  journal->pending_size = needed;
+  return entry + ENTRY_HEADER_SIZE;
+}
+
+/**
+ * @brief records an inserted record
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] record the record as added
+ */
+void journal_log_insert(Journal *journal, const StudentRecord *record) {
+  if (!journal || !record) {
+    return;
+  }
+  size_t size = 8 + text_size(record->name, sizeof record->name) +
+                text_size(record->prog, sizeof record->prog);
+  unsigned char *out = begin_entry(journal, JOURNAL_INSERT, size);
+  if (!out) {
+    return;
+  }
+  put_u32(out, (uint32_t)record->id);
+  put_u32(out + 4, float_bits(record->mark));
+  out = put_text(out + 8, record->name, sizeof record->name);
+  put_text(out, record->prog, sizeof record->prog);
+  journal->pending_entries++;
+}
+
+/**
+ * @brief records an update of a record's fields
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] id student id of the updated record
+ * @param[in] name new name (NULL if unchanged)
+ * @param[in] prog new programme (NULL if unchanged)
+ * @param[in] mark pointer to new mark (NULL if unchanged)
+ */
+void journal_log_update(Journal *journal, int id, const char *name,
+                        const char *prog, const float *mark) {
+  if (!journal) {
+    return;
+  }
+  size_t size = 5;
+  size += name ? text_size(name, MAX_NAME_LENGTH) : 0;
+  size += prog ? text_size(prog, MAX_PROGRAMME_LENGTH) : 0;
+  size += mark ? 4 : 0;
+  unsigned char *out = begin_entry(journal, JOURNAL_UPDATE, size);
+  if (!out) {
+    return;
+  }
+  put_u32(out, (uint32_t)id);
+  out[4] = (unsigned char)((name ? UPDATE_NAME : 0) |
+                           (prog ? UPDATE_PROG : 0) |
+                           (mark ? UPDATE_MARK : 0));
+  out += 5;
+  if (name) {
+    out = put_text(out, name, MAX_NAME_LENGTH);
+  }
+  if (prog) {
+    out = put_text(out, prog, MAX_PROGRAMME_LENGTH);
+  }
+  if (mark) {
+    put_u32(out, float_bits(*mark));
+  }
+  journal->pending_entries++;
+}
+
+/**
+ * @brief records a deleted record
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] id student id of the deleted record
+ */
+void journal_log_delete(Journal *journal, int id) {
+  if (!journal) {
+    return;
+  }
+  unsigned char *out = begin_entry(journal, JOURNAL_DELETE, 4);
+  if (out) {
+    put_u32(out, (uint32_t)id);
+    journal->pending_entries++;
+  }
+}
+
+/**
+ * @brief records a change of the active view
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ * @param[in] view the view now active
+ */
+void journal_log_view(Journal *journal, TableView view) {
+  if (!journal) {
+    return;
+  }
+  unsigned char *out = begin_entry(journal, JOURNAL_VIEW, 1);
+  if (out) {
+    out[0] = (unsigned char)view;
+    journal->pending_entries++;
+  }
+}
+
+/**
+ * @brief records that the records were reordered to the active view
+ * @param[in,out] journal pointer to the journal (can be NULL)
+ */
+void journal_log_compact(Journal *journal) {
+  if (!journal) {
+    return;
+  }
+  if (begin_entry(journal, JOURNAL_COMPACT, 0)) {
+    journal->pending_entries++;
+  }
+}
+
+// bounded reader over one entry's payload
+typedef struct {
+  const unsigned char *cursor;
+  const unsigned char *end;
+  bool ok;
+} EntryReader;
+
+static uint32_t read_u32(EntryReader *reader) {
+  if (!reader->ok || reader->end - reader->cursor < 4) {
+    reader->ok = false;
+    return 0;
+  }
+  uint32_t value = get_u32(reader->cursor);
+  reader->cursor += 4;
+  return value;
+}
+
+static float read_float(EntryReader *reader) {
+  uint32_t bits = read_u32(reader);
+  float value;
+  memcpy(&value, &bits, sizeof value);
+  return value;
+}
+
+static void read_text(EntryReader *reader, char *field, size_t size) {
+  field[0] = '\0';
+  if (!reader->ok || reader->cursor >= reader->end ||
+      (size_t)(reader->end - reader->cursor) < 1u + reader->cursor[0] ||
+      reader->cursor[0] >= size) {
+    reader->ok = false;
+    return;
+  }
+  size_t length = reader->cursor[0];
+  memcpy(field, reader->cursor + 1, length);
+  field[length] = '\0';
+  reader->cursor += 1 + length;
+}
+
+// one decoded journal entry
+typedef struct {
+  unsigned char type;
+  StudentRecord record; // id plus the fields the entry carries
+  unsigned flags;       // UPDATE_* fields present in an update
+  TableView view;
+} JournalChange;
+
+// decodes one entry without touching the database; false if the payload
+// does not hold exactly what its type requires
+static bool decode_entry(unsigned char type, const unsigned char *payload,
+                         size_t size, JournalChange *change) {
+  EntryReader reader = {payload, payload + size, true};
+  memset(change, 0, sizeof *change);
+  change->type = type;
+
+  switch (type) {
+  case JOURNAL_INSERT:
+    change->record.id = (int)read_u32(&reader);
+    change->record.mark = read_float(&reader);
+    read_text(&reader, change->record.name, sizeof change->record.name);
+    read_text(&reader, change->record.prog, sizeof change->record.prog);
+    break;
+  case JOURNAL_UPDATE:
+    change->record.id = (int)read_u32(&reader);
+    if (reader.ok && reader.cursor < reader.end) {
+      change->flags = *reader.cursor++;
+    } else {
+      reader.ok = false;
+    }
+    if (change->flags & UPDATE_NAME) {
+      read_text(&reader, change->record.name, sizeof change->record.name);
+    }
+    if (change->flags & UPDATE_PROG) {
+      read_text(&reader, change->record.prog, sizeof change->record.prog);
+    }
+    if (change->flags & UPDATE_MARK) {
+      change->record.mark = read_float(&reader);
+    }
+    break;
+  case JOURNAL_DELETE:
+    change->record.id = (int)read_u32(&reader);
+    break;
+  case JOURNAL_VIEW:
+    if (size != 1 || payload[0] > TABLE_VIEW_MARK_DESC) {
+      return false;
+    }
+    change->view = (TableView)payload[0];
+    reader.cursor = reader.end;
+    break;
+  case JOURNAL_COMPACT:
+    break;
+  default:
+    return false;
+  }
+  return reader.ok && reader.cursor == reader.end;
+}
+
+// applies one decoded entry to the student records table
+static bool apply_change(StudentDatabase *db, JournalChange *change) {
+  if (db->table_count == 0) {
+    return false;
+  }
+  StudentTable *table = db->tables[0];
+
+  switch (change->type) {
+  case JOURNAL_INSERT:
+    return table_add_record(table, &change->record) == DB_SUCCESS;
+  case JOURNAL_UPDATE:
+    return db_update_record(
+               db, change->record.id,
+               (change->flags & UPDATE_NAME) ? change->record.name : NULL,
+               (change->flags & UPDATE_PROG) ? change->record.prog : NULL,
+               (change->flags & UPDATE_MARK) ? &change->record.mark : NULL) ==
+           DB_SUCCESS;
+  case JOURNAL_DELETE:
+    return table_remove_record(table, change->record.id) == DB_SUCCESS;
+  case JOURNAL_VIEW:
+    return table_set_view(table, change->view) == DB_SUCCESS;
+  case JOURNAL_COMPACT:
+    return table_compact(table) == DB_SUCCESS;
+  default:
+    return false;
+  }
+}
+
+// replays committed groups from data; returns the length of the valid
+// prefix (the header plus every group that was applied). failed is set if
+// a committed group could not be decoded or applied, so groups after the
+// returned length are committed data that must not be cut off
+static size_t replay(StudentDatabase *db, const unsigned char *data,
+                     size_t size, size_t *applied, bool *failed) {
+  size_t group = JOURNAL_HEADER_SIZE;
+  *failed = false;
+
+  while (group < size) {
+    // find the commit entry that closes this group
+    size_t scan = group;
+    size_t group_end = 0;
+    while (size - scan >= ENTRY_HEADER_SIZE) {
+      uint32_t length = get_u32(data + scan);
+      if (length > size - scan - ENTRY_HEADER_SIZE) {
+        break;
+      }
+      if (data[scan + 4] == JOURNAL_COMMIT) {
+        if (length == 4 &&
+            get_u32(data + scan + ENTRY_HEADER_SIZE) ==
+                (uint32_t)crc32_update(0, data + group, scan - group)) {
+          group_end = scan + ENTRY_HEADER_SIZE + length;
+        }
+        break;
+      }
+      scan += ENTRY_HEADER_SIZE + length;
+    }
+    if (group_end == 0) {
+      break; // torn or corrupt group: drop it and everything after
+    }
+
+    // every entry is decoded before any is applied, so a group that cannot
+    // be read leaves the database as the previous group left it
+    JournalChange change;
+    for (size_t entry = group; entry < scan;) {
+      uint32_t length = get_u32(data + entry);
+      if (!decode_entry(data[entry + 4], data + entry + ENTRY_HEADER_SIZE,
+                        length, &change)) {
+        printf("CMS: Warning - a journal group could not be read; replay "
+               "stopped\n");
+        *failed = true;
+        return group;
+      }
+      entry += ENTRY_HEADER_SIZE + length;
+    }
+
+    for (size_t entry = group; entry < scan;) {
+      uint32_t length = get_u32(data + entry);
+      decode_entry(data[entry + 4], data + entry + ENTRY_HEADER_SIZE, length,
+                   &change);
+      if (!apply_change(db, &change)) {
+        printf("CMS: Warning - journal entry %zu could not be applied; "
+               "replay stopped\n",
+               *applied + 1);
+        *failed = true;
+        return group;
+      }
+      (*applied)++;
+      entry += ENTRY_HEADER_SIZE + length;
+    }
+    group = group_end;
+  }
+  return group;
+}
+
+/**
+ * @brief opens the journal of a database file and replays it
+ * @param[in,out] db database just loaded from db_path
+ * @param[in] db_path path the database was loaded from
+ * @param[out] replayed optional count of entries applied (can be NULL)
+ * @return pointer to the journal, NULL if memory runs out (saves then
+ *         rewrite the whole file)
+ * @note db->file_loaded_checksum must hold the CRC32 of db_path; a journal
+ *       with a different base is discarded with a warning
+ * @note if a committed group cannot be decoded or applied, replay stops and
+ *       the journal is flagged so the next save checkpoints
+ */
+Journal *journal_open(StudentDatabase *db, const char *db_path,
+                      size_t *replayed) {
+  if (replayed) {
+    *replayed = 0;
+  }
+  if (!db || !db_path) {
+    return NULL;
+  }
+
+  Journal *journal = calloc(1, sizeof *journal);
+  if (!journal) {
+    return NULL;
+  }
+  int length = snprintf(journal->path, sizeof journal->path, "%s%s", db_path,
+                        JOURNAL_EXTENSION);
+  if (length < 0 || (size_t)length >= sizeof journal->path) {
+    free(journal);
+    return NULL;
+  }
+  journal->base_checksum = db->file_loaded_checksum;
+
+  FileMap map;
+  if (!file_map_open(journal->path, &map)) {
+    return journal; // nothing journaled since the last checkpoint
+  }
+
+  const unsigned char *data = (const unsigned char *)map.data;
+  if (map.size < JOURNAL_HEADER_SIZE ||
+      memcmp(data, JOURNAL_MAGIC, 4) != 0 ||
+      get_u32(data + 4) != JOURNAL_VERSION ||
+      get_u32(data + 8) != (uint32_t)journal->base_checksum) {
+    // committed_size stays 0, so the next save starts the file afresh
+    printf("CMS: Warning - journal '%s' does not match the database file "
+           "and was ignored\n",
+           journal->path);
+  } else {
+    size_t applied = 0;
+    bool failed = false;
+    size_t valid = replay(db, data, map.size, &applied, &failed);
+    if (failed) {
+      // committed groups start at valid, so the next save rewrites the
+      // database file from memory instead of cutting the journal back
+      journal->needs_checkpoint = true;
+      printf("CMS: Warning - the next save will rewrite the database file "
+             "from the records now loaded\n");
+    } else if (valid < map.size) {
+      printf("CMS: Warning - incomplete journal entries in '%s' were "
+             "dropped\n",
+             journal->path);
+    }
+    journal->committed_size = (long)valid;
+    if (replayed) {
+      *replayed = applied;
+    }
+  }
+
+  file_map_close(&map);
+  return journal;
+}
+
+/**
+ * @brief closes a journal, dropping entries that were never saved
+ * @param[in] journal pointer to the journal (can be NULL)
+ */
+void journal_close(Journal *journal) {
+  if (!journal) {
+    return;
+  }
+  free(journal->pending);
+  free(journal);
+}
+
+// cut an open file to size bytes
+static bool truncate_file(FILE *fp, long size) {
+#ifdef _WIN32
+  return _chsize(_fileno(fp), size) == 0;
+#else
+  return ftruncate(fileno(fp), (off_t)size) == 0;
+#endif
+}
+
+// appends the pending entries and a commit entry to the journal file with
+// one write and one fsync
+static DBStatus write_group(Journal *journal) {
+  size_t group_size = journal->pending_size;
+  unsigned long crc = crc32_update(0, journal->pending, group_size);
+  unsigned char *commit = begin_entry(journal, JOURNAL_COMMIT, 4);
+  if (!commit) {
+    return DB_ERROR_MEMORY;
+  }
+  put_u32(commit, (uint32_t)crc);
+
+  // a failed earlier write may have left bytes past the committed end
+  bool fresh = journal->committed_size == 0;
+  FILE *fp = fopen(journal->path, fresh ? "wb" : "r+b");
+  bool ok = fp != NULL;
+  if (ok && fresh) {
+    unsigned char header[JOURNAL_HEADER_SIZE];
+    memcpy(header, JOURNAL_MAGIC, 4);
+    put_u32(header + 4, JOURNAL_VERSION);
+    put_u32(header + 8, (uint32_t)journal->base_checksum);
+    ok = fwrite(header, 1, sizeof header, fp) == sizeof header;
+  } else if (ok) {
+    ok = truncate_file(fp, journal->committed_size) &&
+         fseek(fp, journal->committed_size, SEEK_SET) == 0;
+  }
+  ok = ok &&
+       fwrite(journal->pending, 1, journal->pending_size, fp) ==
+           journal->pending_size &&
+       file_sync(fp);
+  if (fp && fclose(fp) != 0) {
+    ok = false;
+  }
+
+  if (!ok) {
+    // keep the entries so the next save can retry
+    journal->pending_size = group_size;
+    return fp ? DB_ERROR_FILE_READ : DB_ERROR_FILE_NOT_FOUND;
+  }
+
+  journal->committed_size += (fresh ? JOURNAL_HEADER_SIZE : 0) +
+                             (long)journal->pending_size;
+  journal->pending_size = 0;
+  journal->pending_entries = 0;
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief saves a database: commits its journal, or checkpoints
+ * @param[in,out] db pointer to the loaded database
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ * @note without a journal, or once the journal would pass
+ *       JOURNAL_CHECKPOINT_BYTES, the database file is rewritten with
+ *       db_save and the journal deleted; otherwise the pending entries are
+ *       appended as one group and flushed with one fsync
+ * @note if the journal file cannot be opened, the save falls back to a
+ *       checkpoint
+ */
+DBStatus journal_save(StudentDatabase *db) {
+  if (!db) {
+    return DB_ERROR_NULL_POINTER;
+  }
+
+  // committed_size counts the header once the journal file exists
+  Journal *journal = db->journal;
+  if (journal && !journal->needs_checkpoint &&
+      (journal->committed_size > 0 ? (size_t)journal->committed_size
+                                   : JOURNAL_HEADER_SIZE) +
+              journal->pending_size + COMMIT_ENTRY_SIZE <=
+          JOURNAL_CHECKPOINT_BYTES) {
+    DBStatus status =
+        journal->pending_size > 0 ? write_group(journal) : DB_SUCCESS;
+    if (status == DB_SUCCESS) {
+      db->last_saved_checksum = tracked_database_checksum(db);
+      return DB_SUCCESS;
+    }
+    if (status != DB_ERROR_FILE_NOT_FOUND) {
+      return status;
+    }
+    // the journal could not be opened (e.g. it was removed), so its
+    // committed groups cannot be trusted to be on disk
+    printf("CMS: Warning - the journal could not be opened; rewriting the "
+           "database file instead\n");
+  }
+
+  // checkpoint: the rewritten file holds every change, so the journal
+  // starts again from it. db_save has synced the new file into place before
+  // the journal goes; a crash in between leaves a journal whose base no
+  // longer matches, which OPEN ignores
+  DBStatus status = db_save(db, db->filepath);
+  if (status != DB_SUCCESS || !journal) {
+    return status;
+  }
+  remove(journal->path);
+  journal->base_checksum = db->file_loaded_checksum;
+  journal->committed_size = 0;
+  journal->pending_size = 0;
+  journal->pending_entries = 0;
+  journal->needs_checkpoint = false;
+  return DB_SUCCESS;
+}
@@ -1,11 +1,29 @@
 #include "cms.h"
+#include "snapshot.h"
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @brief main entry point for the cms application
+ * @param[in] argc number of command line arguments
+ * @param[in] argv command line arguments; "--convert <source> <destination>"
+ *            converts a database file between the text and snapshot formats
+ *            instead of starting a session
  * @return EXIT_SUCCESS on successful completion, EXIT_FAILURE on error
  */
-int main(void) {
+int main(int argc, char *argv[]) {
+  if (argc == 4 && strcmp(argv[1], "--convert") == 0) {
+    DBStatus status = snapshot_convert(argv[2], argv[3]);
+    if (status != DB_SUCCESS) {
+      printf("CMS: Failed to convert \"%s\": %s\n", argv[2],
+             db_status_string(status));
+      return EXIT_FAILURE;
+    }
+    printf("CMS: Converted \"%s\" to \"%s\".\n", argv[2], argv[3]);
+    return EXIT_SUCCESS;
+  }
+
   CMSStatus status = run_cms_session();
   return (status == CMS_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,429 @@
+#include "mark_kernels.h"
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define MARK_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// marks reduced at a time before their extremes are compared; the first
+// index of an extreme is then looked for only inside the block it came from
+#define MARK_SUMMARY_BLOCK 1024
+
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static MarkKernelLevel supported_level = MARK_KERNEL_SCALAR;
+static MarkKernelLevel active_level = MARK_KERNEL_SCALAR;
+
+#ifdef MARK_KERNELS_X86
+// for each mask of four comparison lanes: the passing lanes packed to the
+// front, and how many there are; filled in with the level
+static uint64_t lane_offsets[16][4];
+static uint8_t lane_counts[16];
+#endif
+
+static void detect_level(void) {
+#ifdef MARK_KERNELS_X86
+  for (unsigned mask = 0; mask < 16; mask++) {
+    uint8_t count = 0;
+    for (uint8_t lane = 0; lane < 4; lane++) {
+      if (mask & (1u << lane)) {
+        lane_offsets[mask][count++] = lane;
+      }
+    }
+    lane_counts[mask] = count;
+  }
+
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    supported_level = MARK_KERNEL_AVX2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    supported_level = MARK_KERNEL_SSE2;
+  }
+#endif
+  active_level = supported_level;
+}
+
+/**
+ * @brief returns the kernel level in use, detecting it on first call
+ * @return widest level supported by the processor, unless overridden
+ */
+MarkKernelLevel mark_kernels_level(void) {
+  pthread_once(&detect_once, detect_level);
+  return active_level;
+}
+
+/**
+ * @brief selects the kernel level used from now on
+ * @param[in] level level wanted
+ * @return level in effect: the one wanted, or the widest supported below it
+ * @note for tests and benchmarks; must not race with running kernels
+ */
+MarkKernelLevel mark_kernels_set_level(MarkKernelLevel level) {
+  pthread_once(&detect_once, detect_level);
+  active_level = level < supported_level ? level : supported_level;
+  return active_level;
+}
+
+/**
+ * @brief returns a printable name for a kernel level
+ * @param[in] level kernel level
+ * @return "scalar", "sse2" or "avx2"
+ */
+const char *mark_kernels_level_name(MarkKernelLevel level) {
+  switch (level) {
+  case MARK_KERNEL_SSE2:
+    return "sse2";
+  case MARK_KERNEL_AVX2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+// ------------------------------------------------------------
+// comparison thresholds
+// ------------------------------------------------------------
+
+// the neighbouring float towards +infinity (up) or -infinity
+static float float_step(float value, int up) {
+  if (value == 0.0f) {
+    uint32_t tiny = 1; // smallest subnormal
+    float step;
+    memcpy(&step, &tiny, sizeof step);
+    return up ? step : -step;
+  }
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof bits);
+  bits = ((value > 0.0f) == (up != 0)) ? bits + 1 : bits - 1;
+  memcpy(&value, &bits, sizeof value);
+  return value;
+}
+
+// turn "(double)mark op value" into "mark op threshold" on floats, so the
+// comparison can run in float lanes; returns 0 if no mark can pass
+static int float_threshold(char op, double value, float *threshold) {
+  if (isnan(value)) {
+    return 0;
+  }
+  if (!isinf(value) && (value > FLT_MAX || value < -FLT_MAX)) {
+    // beyond every finite float: only infinities are on the far side
+    if (op == '=') {
+      return 0;
+    }
+    if (value > 0) {
+      *threshold = op == '<' ? INFINITY : FLT_MAX;
+    } else {
+      *threshold = op == '<' ? -FLT_MAX : -INFINITY;
+    }
+    return 1;
+  }
+
+  float rounded = (float)value;
+  if (op == '<' && (double)rounded < value) {
+    rounded = float_step(rounded, 1);
+  } else if (op == '>' && (double)rounded > value) {
+    rounded = float_step(rounded, 0);
+  } else if (op == '=' && (double)rounded != value) {
+    return 0;
+  }
+  *threshold = rounded;
+  return 1;
+}
+
+// ------------------------------------------------------------
+// scalar kernels
+// ------------------------------------------------------------
+
+// survivors are written unconditionally and kept by advancing the count
+#define SELECT_SCALAR(cmp)                                                     \
+  for (; i < count; i++) {                                                     \
+    out[kept] = first + i;                                                     \
+    kept += marks[i] cmp threshold;                                            \
+  }
+
+static size_t select_scalar(const float *marks, size_t count, size_t first,
+                            char op, float threshold, size_t *out, size_t i,
+                            size_t kept) {
+  if (op == '<') {
+    SELECT_SCALAR(<)
+  } else if (op == '>') {
+    SELECT_SCALAR(>)
+  } else {
+    SELECT_SCALAR(==)
+  }
+  return kept;
+}
+
+static void summarise_block_scalar(const float *marks, size_t count,
+                                   double *sum, float *min, float *max) {
+  float low = marks[0];
+  float high = marks[0];
+  double total = *sum;
+  for (size_t i = 0; i < count; i++) {
+    total += (double)marks[i];
+    low = marks[i] < low ? marks[i] : low;
+    high = marks[i] > high ? marks[i] : high;
+  }
+  *sum = total;
+  *min = low;
+  *max = high;
+}
+
+// ------------------------------------------------------------
+// x86 kernels
+// ------------------------------------------------------------
+
+#ifdef MARK_KERNELS_X86
+
+// the four lanes from start that passed are stored as positions with two
+// vector stores from the mask's entry in the offset table, then the count
+// moves past them; the stores stay inside out since kept never passes start
+#define STORE_LANES(lanes, start)                                              \
+  do {                                                                         \
+    __m128i base = _mm_set1_epi64x((long long)(first + (start)));              \
+    const __m128i *offsets = (const __m128i *)lane_offsets[lanes];             \
+    _mm_storeu_si128((__m128i *)(out + kept),                                  \
+                     _mm_add_epi64(_mm_loadu_si128(offsets), base));           \
+    _mm_storeu_si128((__m128i *)(out + kept + 2),                              \
+                     _mm_add_epi64(_mm_loadu_si128(offsets + 1), base));       \
+    kept += lane_counts[lanes];                                                \
+  } while (0)
+
+#define SELECT_SSE2(cmp)                                                       \
+  for (; i + 4 <= count; i += 4) {                                             \
+    unsigned lanes = (unsigned)_mm_movemask_ps(                                \
+        cmp(_mm_loadu_ps(marks + i), limit));                                  \
+    STORE_LANES(lanes, i);                                                     \
+  }
+
+__attribute__((target("sse2"))) static size_t
+select_sse2(const float *marks, size_t count, size_t first, char op,
+            float threshold, size_t *out) {
+  __m128 limit = _mm_set1_ps(threshold);
+  size_t i = 0;
+  size_t kept = 0;
+  if (op == '<') {
+    SELECT_SSE2(_mm_cmplt_ps)
+  } else if (op == '>') {
+    SELECT_SSE2(_mm_cmpgt_ps)
+  } else {
+    SELECT_SSE2(_mm_cmpeq_ps)
+  }
+  return select_scalar(marks, count, first, op, threshold, out, i, kept);
+}
+
+#define SELECT_AVX2(predicate)                                                 \
+  for (; i + 8 <= count; i += 8) {                                             \
+    unsigned lanes = (unsigned)_mm256_movemask_ps(                             \
+        _mm256_cmp_ps(_mm256_loadu_ps(marks + i), limit, predicate));          \
+    STORE_LANES(lanes & 15, i);                                                \
+    STORE_LANES(lanes >> 4, i + 4);                                            \
+  }
+
+__attribute__((target("avx2"))) static size_t
+select_avx2(const float *marks, size_t count, size_t first, char op,
+            float threshold, size_t *out) {
+  __m256 limit = _mm256_set1_ps(threshold);
+  size_t i = 0;
+  size_t kept = 0;
+  if (op == '<') {
+    SELECT_AVX2(_CMP_LT_OQ)
+  } else if (op == '>') {
+    SELECT_AVX2(_CMP_GT_OQ)
+  } else {
+    SELECT_AVX2(_CMP_EQ_OQ)
+  }
+  _mm256_zeroupper(); // the tail and the caller run legacy SSE code
+  return select_scalar(marks, count, first, op, threshold, out, i, kept);
+}
+
+__attribute__((target("sse2"))) static void
+summarise_block_sse2(const float *marks, size_t count, double *sum,
+                     float *min, float *max) {
+  __m128 low = _mm_set1_ps(marks[0]);
+  __m128 high = low;
+  __m128d total_lo = _mm_setzero_pd();
+  __m128d total_hi = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_loadu_ps(marks + i);
+    low = _mm_min_ps(low, v);
+    high = _mm_max_ps(high, v);
+    total_lo = _mm_add_pd(total_lo, _mm_cvtps_pd(v));
+    total_hi = _mm_add_pd(total_hi, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+  double lanes[2];
+  float low_lanes[4];
+  float high_lanes[4];
+  _mm_storeu_pd(lanes, _mm_add_pd(total_lo, total_hi));
+  _mm_storeu_ps(low_lanes, low);
+  _mm_storeu_ps(high_lanes, high);
+
+  double total = lanes[0] + lanes[1];
+  float lowest = low_lanes[0];
+  float highest = high_lanes[0];
+  for (size_t lane = 1; lane < 4; lane++) {
+    lowest = low_lanes[lane] < lowest ? low_lanes[lane] : lowest;
+    highest = high_lanes[lane] > highest ? high_lanes[lane] : highest;
+  }
+  for (; i < count; i++) {
+    total += (double)marks[i];
+    lowest = marks[i] < lowest ? marks[i] : lowest;
+    highest = marks[i] > highest ? marks[i] : highest;
+  }
+  *sum += total;
+  *min = lowest;
+  *max = highest;
+}
+
+__attribute__((target("avx2"))) static void
+summarise_block_avx2(const float *marks, size_t count, double *sum,
+                     float *min, float *max) {
+  __m256 low = _mm256_set1_ps(marks[0]);
+  __m256 high = low;
+  __m256d total_lo = _mm256_setzero_pd();
+  __m256d total_hi = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 v = _mm256_loadu_ps(marks + i);
+    low = _mm256_min_ps(low, v);
+    high = _mm256_max_ps(high, v);
+    total_lo =
+        _mm256_add_pd(total_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+    total_hi =
+        _mm256_add_pd(total_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+  }
+  double lanes[4];
+  float low_lanes[8];
+  float high_lanes[8];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(total_lo, total_hi));
+  _mm256_storeu_ps(low_lanes, low);
+  _mm256_storeu_ps(high_lanes, high);
+  _mm256_zeroupper();
+
+  double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  float lowest = low_lanes[0];
+  float highest = high_lanes[0];
+  for (size_t lane = 1; lane < 8; lane++) {
+    lowest = low_lanes[lane] < lowest ? low_lanes[lane] : lowest;
+    highest = high_lanes[lane] > highest ? high_lanes[lane] : highest;
+  }
+  for (; i < count; i++) {
+    total += (double)marks[i];
+    lowest = marks[i] < lowest ? marks[i] : lowest;
+    highest = marks[i] > highest ? marks[i] : highest;
+  }
+  *sum += total;
+  *min = lowest;
+  *max = highest;
+}
+
+#endif // MARK_KERNELS_X86
+
+// ------------------------------------------------------------
+// dispatch
+// ------------------------------------------------------------
+
+/**
+ * @brief selects the marks passing a MARK comparison
+ * @param[in] marks contiguous marks to scan
+ * @param[in] count number of marks
+ * @param[in] first position of marks[0], added to every selected index
+ * @param[in] op comparison: '<', '>' or '='
+ * @param[in] value value each mark is compared with, as (double)mark op value
+ * @param[out] out positions of passing marks, in order (count entries max)
+ * @return number of positions written
+ */
+size_t mark_kernel_select(const float *marks, size_t count, size_t first,
+                          char op, double value, size_t *out) {
+  float threshold;
+  if (!marks || !out || count == 0 || !float_threshold(op, value, &threshold)) {
+    return 0;
+  }
+  switch (mark_kernels_level()) {
+#ifdef MARK_KERNELS_X86
+  case MARK_KERNEL_AVX2:
+    return select_avx2(marks, count, first, op, threshold, out);
+  case MARK_KERNEL_SSE2:
+    return select_sse2(marks, count, first, op, threshold, out);
+#endif
+  default:
+    return select_scalar(marks, count, first, op, threshold, out, 0, 0);
+  }
+}
+
+// first index in a block holding value
+static size_t find_in_block(const float *marks, size_t count, float value) {
+  size_t i = 0;
+  while (i + 1 < count && marks[i] != value) {
+    i++;
+  }
+  return i;
+}
+
+/**
+ * @brief reduces a run of marks to their sum and extremes
+ * @param[in] marks contiguous marks to scan
+ * @param[in] count number of marks (at least 1)
+ * @param[out] out sum, extremes and the first index of each extreme
+ * @note marks are expected to be numbers; NaN marks give unspecified extremes
+ */
+void mark_kernel_summarise(const float *marks, size_t count,
+                           MarkSummary *out) {
+  if (!out) {
+    return;
+  }
+  memset(out, 0, sizeof *out);
+  if (!marks || count == 0) {
+    return;
+  }
+
+  void (*summarise_block)(const float *, size_t, double *, float *, float *) =
+      summarise_block_scalar;
+#ifdef MARK_KERNELS_X86
+  MarkKernelLevel level = mark_kernels_level();
+  if (level == MARK_KERNEL_AVX2) {
+    summarise_block = summarise_block_avx2;
+  } else if (level == MARK_KERNEL_SSE2) {
+    summarise_block = summarise_block_sse2;
+  }
+#endif
+
+  // keep the first block reaching each extreme, so ties resolve to the
+  // first occurrence as a record-at-a-time scan would
+  size_t min_block = 0;
+  size_t max_block = 0;
+  for (size_t start = 0; start < count; start += MARK_SUMMARY_BLOCK) {
+    size_t length = count - start < MARK_SUMMARY_BLOCK ? count - start
+                                                       : MARK_SUMMARY_BLOCK;
+    float low;
+    float high;
+    summarise_block(marks + start, length, &out->sum, &low, &high);
+    if (start == 0 || low < out->min) {
+      out->min = low;
+      min_block = start;
+    }
+    if (start == 0 || high > out->max) {
+      out->max = high;
+      max_block = start;
+    }
+  }
+
+  size_t min_length = count - min_block < MARK_SUMMARY_BLOCK
+                          ? count - min_block
+                          : MARK_SUMMARY_BLOCK;
+  size_t max_length = count - max_block < MARK_SUMMARY_BLOCK
+                          ? count - max_block
+                          : MARK_SUMMARY_BLOCK;
+  out->min_index =
+      min_block + find_in_block(marks + min_block, min_length, out->min);
+  out->max_index =
+      max_block + find_in_block(marks + max_block, max_length, out->max);
+  // -0.0 and 0.0 compare equal; report the sign of the first occurrence
+  out->min = marks[out->min_index];
+  out->max = marks[out->max_index];
+}
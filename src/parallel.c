@@ -0,0 +1,100 @@
+#include "parallel.h"
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// argument wrapper so pthread entry points can call a ParallelTask
+typedef struct {
+  ParallelTask task;
+  void *arg;
+} WorkerStart;
+
+static void *worker_entry(void *arg) {
+  WorkerStart *start = arg;
+  start->task(start->arg);
+  return NULL;
+}
+
+/**
+ * @brief returns the number of online processors (at least 1)
+ * @return processor count reported by the operating system
+ */
+size_t parallel_cpu_count(void) {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  long count = (long)info.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return count > 0 ? (size_t)count : 1;
+}
+
+/**
+ * @brief chooses how many workers to use for a job
+ * @param[in] item_count number of items to process
+ * @param[in] min_items_per_worker smallest chunk worth giving to a thread
+ * @return worker count between 1 and MAX_WORKER_THREADS
+ */
+size_t parallel_worker_count(size_t item_count, size_t min_items_per_worker) {
+  if (min_items_per_worker == 0) {
+    min_items_per_worker = 1;
+  }
+
+  size_t workers = parallel_cpu_count();
+  if (workers > MAX_WORKER_THREADS) {
+    workers = MAX_WORKER_THREADS;
+  }
+
+  size_t by_size = item_count / min_items_per_worker;
+  if (by_size < workers) {
+    workers = by_size;
+  }
+
+  return workers > 0 ? workers : 1;
+}
+
+/**
+ * @brief runs task on each argument block and waits for completion
+ * @param[in] task function to run for every block
+ * @param[in,out] args array of argument blocks
+ * @param[in] arg_size size in bytes of one argument block
+ * @param[in] count number of argument blocks (one worker per block)
+ * @note the calling thread runs the first block itself
+ */
+void parallel_run(ParallelTask task, void *args, size_t arg_size,
+                  size_t count) {
+  if (!task || !args || count == 0) {
+    return;
+  }
+
+  if (count > MAX_WORKER_THREADS) {
+    count = MAX_WORKER_THREADS;
+  }
+
+  char *base = args;
+  pthread_t threads[MAX_WORKER_THREADS];
+  WorkerStart starts[MAX_WORKER_THREADS];
+  bool started[MAX_WORKER_THREADS] = {false};
+
+  for (size_t i = 1; i < count; i++) {
+    starts[i].task = task;
+    starts[i].arg = base + i * arg_size;
+    started[i] =
+        pthread_create(&threads[i], NULL, worker_entry, &starts[i]) == 0;
+  }
+
+  // calling thread takes the first block, plus any that failed to start
+  task(base);
+  for (size_t i = 1; i < count; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    } else {
+      task(base + i * arg_size);
+    }
+  }
+}
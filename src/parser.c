@@ -1,5 +1,8 @@
 #include "parser.h"
+#include "checksum.h"
 #include "constants.h"
+#include "file_map.h"
+#include "parallel.h"
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -131,50 +134,96 @@ ParseStatus parse_metadata(const char *line, char *key, char *value) {
   return PARSE_SUCCESS;
 }
 
+// next tab-separated token in [*cursor, end), skipping empty fields the way
+// strtok does; returns NULL when no token is left
+static const char *next_token(const char **cursor, const char *end,
+                              size_t *length) {
+  const char *start = *cursor;
+  while (start < end && *start == '\t') {
+    start++;
+  }
+  if (start == end) {
+    *cursor = end;
+    return NULL;
+  }
+
+  const char *tab = memchr(start, '\t', (size_t)(end - start));
+  const char *stop = tab ? tab : end;
+  *length = (size_t)(stop - start);
+  *cursor = tab ? tab + 1 : end;
+  return start;
+}
+
+// copy a token into a fixed-size field, truncating like strncpy
+static void copy_field(char *field, size_t size, const char *token,
+                       size_t length) {
+  if (length > size - 1) {
+    length = size - 1;
+  }
+  memcpy(field, token, length);
+  field[length] = '\0';
+}
+
+// NUL-terminate a numeric token in buf for strtol/strtof; false if too long
+static bool number_text(char *buf, size_t size, const char *token,
+                        size_t length) {
+  if (length >= size) {
+    return false;
+  }
+  memcpy(buf, token, length);
+  buf[length] = '\0';
+  return true;
+}
+
 /**
- * @brief parses single data record line into StudentRecord
- * @param[in] line input line containing student data
+ * @brief parses one data record from a line that need not be NUL-terminated
+ * @param[in] line first byte of the line
+ * @param[in] length number of bytes in the line (a trailing newline and
+ *            carriage return are ignored)
  * @param[out] record pointer to record structure to populate
  * @return PARSE_SUCCESS on success, appropriate error code on failure
+ * @note reads the line in place without modifying it, so it is reentrant
+ *       and works directly on a mapped file
  */
-ParseStatus parse_record_line(const char *line, StudentRecord *record) {
+ParseStatus parse_record_span(const char *line, size_t length,
+                              StudentRecord *record) {
   if (!line || !record) {
     return PARSE_ERROR_FORMAT;
   }
 
-  char line_copy[INPUT_BUFFER_SIZE];
-  strncpy(line_copy, line, sizeof(line_copy) - 1);
-  line_copy[sizeof(line_copy) - 1] = '\0';
-
-  // remove trailing newline
-  size_t len = strlen(line_copy);
-  if (len > 0 && line_copy[len - 1] == '\n') {
-    line_copy[len - 1] = '\0';
+  // remove trailing newline, then carriage return (windows-style endings)
+  if (length > 0 && line[length - 1] == '\n') {
+    length--;
   }
-  // remove trailing carriage return (windows-style line endings)
-  len = strlen(line_copy);
-  if (len > 0 && line_copy[len - 1] == '\r') {
-    line_copy[len - 1] = '\0';
+  if (length > 0 && line[length - 1] == '\r') {
+    length--;
   }
 
   // check for empty line
-  if (len == 0 || line_copy[0] == '\0') {
+  if (length == 0) {
     return PARSE_ERROR_EMPTY;
   }
 
-  // tokenise by tab
-  char *token = strtok(line_copy, "\t");
+  const char *cursor = line;
+  const char *end = line + length;
+  size_t token_length = 0;
+  char number[MAX_NUMBER_TOKEN];
+
+  // parse id with error checking
+  const char *token = next_token(&cursor, end, &token_length);
   if (!token) {
     return PARSE_ERROR_INCOMPLETE;
   }
+  if (!number_text(number, sizeof number, token, token_length)) {
+    return PARSE_ERROR_FORMAT;
+  }
 
-  // parse id with error checking
   char *endptr;
   errno = 0;
-  long id_val = strtol(token, &endptr, 10);
+  long id_val = strtol(number, &endptr, 10);
 
   // check for conversion errors
-  if (errno == ERANGE || *endptr != '\0' || endptr == token) {
+  if (errno == ERANGE || *endptr != '\0' || endptr == number) {
     return PARSE_ERROR_FORMAT;
   }
 
@@ -186,32 +235,34 @@ ParseStatus parse_record_line(const char *line, StudentRecord *record) {
 
   record->id = (int)id_val;
 
-  token = strtok(NULL, "\t");
+  token = next_token(&cursor, end, &token_length);
   if (!token) {
     return PARSE_ERROR_INCOMPLETE;
   }
-  strncpy(record->name, token, sizeof(record->name) - 1);
-  record->name[sizeof(record->name) - 1] = '\0';
+  copy_field(record->name, sizeof(record->name), token, token_length);
 
-  token = strtok(NULL, "\t");
+  token = next_token(&cursor, end, &token_length);
   if (!token) {
     return PARSE_ERROR_INCOMPLETE;
   }
-  strncpy(record->prog, token, sizeof(record->prog) - 1);
-  record->prog[sizeof(record->prog) - 1] = '\0';
+  copy_field(record->prog, sizeof(record->prog), token, token_length);
 
-  token = strtok(NULL, "\t");
+  token = next_token(&cursor, end, &token_length);
   if (!token) {
     return PARSE_ERROR_INCOMPLETE;
   }
 
   // parse mark with error checking
+  if (!number_text(number, sizeof number, token, token_length)) {
+    return PARSE_ERROR_FORMAT;
+  }
+
   char *mark_endptr;
   errno = 0;
-  float mark_val = strtof(token, &mark_endptr);
+  float mark_val = strtof(number, &mark_endptr);
 
   // check for conversion errors
-  if (errno == ERANGE || *mark_endptr != '\0' || mark_endptr == token) {
+  if (errno == ERANGE || *mark_endptr != '\0' || mark_endptr == number) {
     return PARSE_ERROR_FORMAT;
   }
 
@@ -225,6 +276,19 @@ ParseStatus parse_record_line(const char *line, StudentRecord *record) {
   return PARSE_SUCCESS;
 }
 
+/**
+ * @brief parses single data record line into StudentRecord
+ * @param[in] line input line containing student data
+ * @param[out] record pointer to record structure to populate
+ * @return PARSE_SUCCESS on success, appropriate error code on failure
+ */
+ParseStatus parse_record_line(const char *line, StudentRecord *record) {
+  if (!line || !record) {
+    return PARSE_ERROR_FORMAT;
+  }
+  return parse_record_span(line, strlen(line), record);
+}
+
 /**
  * @brief parses column header line
  * @param[in] line input line containing column headers
@@ -296,6 +360,274 @@ ParseStatus parse_column_headers(const char *line, char ***headers,
   return PARSE_SUCCESS;
 }
 
+// true if needle occurs inside the length bytes at text
+static bool span_contains(const char *text, size_t length, const char *needle) {
+  size_t needle_length = strlen(needle);
+  const char *end = text + length;
+  while ((size_t)(end - text) >= needle_length) {
+    const char *hit = memchr(text, needle[0], (size_t)(end - text));
+    if (!hit || (size_t)(end - hit) < needle_length) {
+      return false;
+    }
+    if (memcmp(hit, needle, needle_length) == 0) {
+      return true;
+    }
+    text = hit + 1;
+  }
+  return false;
+}
+
+// copy a line into a NUL-terminated buffer for the string-based parsers
+static void copy_line(char *buffer, size_t size, const char *line,
+                      size_t length) {
+  if (length > size - 1) {
+    length = size - 1;
+  }
+  memcpy(buffer, line, length);
+  buffer[length] = '\0';
+}
+
+// true for the lines parse_file skips as empty
+static bool is_blank_line(const char *line, size_t length, bool has_newline) {
+  return length == 0 || line[0] == '\r' ||
+         (length == 1 && line[0] == ' ' && has_newline);
+}
+
+// true if the line carries one of the metadata keys parse_file recognises
+static bool is_metadata_line(const char *line, size_t length) {
+  // metadata keys all contain a colon, which record lines rarely do
+  if (!memchr(line, ':', length)) {
+    return false;
+  }
+  return span_contains(line, length, "Database Name:") ||
+         span_contains(line, length, "Authors:") ||
+         span_contains(line, length, "Table Name:");
+}
+
+// end of the record section starting at cursor (the start of the next
+// metadata line, or end); stores the number of lines in the section
+static const char *find_section_end(const char *cursor, const char *end,
+                                    size_t *lines) {
+  *lines = 0;
+  while (cursor < end) {
+    const char *newline = memchr(cursor, '\n', (size_t)(end - cursor));
+    const char *stop = newline ? newline : end;
+    if (is_metadata_line(cursor, (size_t)(stop - cursor))) {
+      break;
+    }
+    (*lines)++;
+    cursor = newline ? newline + 1 : end;
+  }
+  return cursor;
+}
+
+// start of the line after the one containing pos (end if there is none)
+static const char *next_line_start(const char *pos, const char *end) {
+  if (pos >= end) {
+    return end;
+  }
+  const char *newline = memchr(pos, '\n', (size_t)(end - pos));
+  return newline ? newline + 1 : end;
+}
+
+// outcome of one non-empty record line, produced by a parse worker
+typedef struct {
+  StudentRecord record;        // parsed fields (valid if parse is success)
+  size_t line;                 // line number within the chunk, from 1
+  ParseStatus parse;           // result of parse_record_span
+  ValidationStatus validation; // result of validate_record
+  unsigned long hash;          // compute_record_hash (if valid)
+} ParsedLine;
+
+// per-worker arguments: one newline-aligned chunk of a record section
+typedef struct {
+  const char *begin;
+  const char *end;
+  ParsedLine *items; // thread-local results, in file order
+  size_t count;
+  size_t capacity;
+  size_t lines; // lines in the chunk, including skipped ones
+  ChecksumMode mode; // the table's checksum mode, for record hashes
+  unsigned long crc; // crc32 of the chunk's bytes
+  int ok;
+} ParseChunk;
+
+static void parse_chunk_task(void *arg) {
+  ParseChunk *chunk = arg;
+  const char *cursor = chunk->begin;
+  chunk->count = 0;
+  chunk->lines = 0;
+  chunk->crc = 0;
+  chunk->ok = 1;
+
+  while (cursor < chunk->end) {
+    const char *newline =
+        memchr(cursor, '\n', (size_t)(chunk->end - cursor));
+    const char *line = cursor;
+    size_t length = (size_t)((newline ? newline : chunk->end) - line);
+    cursor = newline ? newline + 1 : chunk->end;
+    chunk->lines++;
+    // the file checksum is taken while the line is still in cache
+    chunk->crc = crc32_update(chunk->crc, line, (size_t)(cursor - line));
+
+    if (is_blank_line(line, length, newline != NULL)) {
+      continue;
+    }
+
+    StudentRecord record;
+    ParseStatus parse_status = parse_record_span(line, length, &record);
+    if (parse_status == PARSE_ERROR_EMPTY) {
+      continue;
+    }
+
+    if (chunk->count == chunk->capacity) {
+      size_t capacity = chunk->capacity ? chunk->capacity * 2 : 1024;
+      ParsedLine *items = realloc(chunk->items, capacity * sizeof *items);
+      if (!items) {
+        chunk->ok = 0;
+        return;
+      }
+      chunk->items = items;
+      chunk->capacity = capacity;
+    }
+
+    ParsedLine *item = &chunk->items[chunk->count++];
+    item->line = chunk->lines;
+    item->parse = parse_status;
+    item->validation = VALID_RECORD;
+    if (parse_status == PARSE_SUCCESS) {
+      item->record = record;
+      item->validation = validate_record(&record);
+      if (item->validation == VALID_RECORD) {
+        item->hash = compute_record_hash(&record, chunk->mode);
+      }
+    }
+  }
+}
+
+// adds one parsed line to the table, printing its warning and counting it
+// exactly as a line-by-line load would
+static DBStatus merge_parsed_line(StudentTable *table, ParsedLine *item,
+                                  int line_num, ParseStatistics *stats) {
+  if (item->parse != PARSE_SUCCESS) {
+    if (stats) {
+      stats->total_records_attempted++;
+      stats->records_skipped++;
+      stats->parse_errors++;
+    }
+    printf("CMS: Warning - %s at line %d\n", parse_status_string(item->parse),
+           line_num);
+    return DB_SUCCESS;
+  }
+
+  if (stats) {
+    stats->total_records_attempted++;
+  }
+
+  if (item->validation != VALID_RECORD) {
+    printf("CMS: Warning - %s at line %d\n",
+           validation_error_string(item->validation), line_num);
+    if (stats) {
+      stats->records_skipped++;
+      stats->validation_errors++;
+    }
+    return DB_SUCCESS;
+  }
+
+  // the id index rejects duplicate ids in constant time
+  DBStatus add_status =
+      table_add_hashed_record(table, &item->record, item->hash);
+  if (add_status == DB_ERROR_DUPLICATE_ID) {
+    printf("CMS: Warning - duplicate ID %d at line %d (ignored)\n",
+           item->record.id, line_num);
+    if (stats) {
+      stats->records_skipped++;
+      stats->validation_errors++;
+    }
+    return DB_SUCCESS;
+  }
+  if (add_status != DB_SUCCESS) {
+    return add_status;
+  }
+  if (stats) {
+    stats->records_loaded++;
+  }
+  return DB_SUCCESS;
+}
+
+/*
+ * parses the record lines in [begin, end) into table. the section is taken
+ * in passes of up to PARSE_MAX_WORKER_BYTES per worker: each pass is cut
+ * into newline-aligned chunks that are parsed and validated in parallel,
+ * then merged into the table in file order on the calling thread, so
+ * duplicate detection, warnings and statistics match a serial load.
+ * workers also hash their valid records and checksum their bytes, and crc
+ * is extended over the section by combining the chunk checksums.
+ * first_line is the file line number of begin
+ */
+static DBStatus parse_record_section(StudentTable *table, const char *begin,
+                                     const char *end, int first_line,
+                                     unsigned long *crc,
+                                     ParseStatistics *stats) {
+  ParseChunk chunks[MAX_WORKER_THREADS];
+  memset(chunks, 0, sizeof chunks);
+  const char *cursor = begin;
+  int line_num = first_line;
+  DBStatus result = DB_SUCCESS;
+
+  while (cursor < end && result == DB_SUCCESS) {
+    size_t remaining = (size_t)(end - cursor);
+    size_t workers = parallel_worker_count(remaining, PARSE_MIN_WORKER_BYTES);
+    size_t pass = remaining / workers > PARSE_MAX_WORKER_BYTES
+                      ? workers * PARSE_MAX_WORKER_BYTES
+                      : remaining;
+    const char *pass_end = next_line_start(cursor + pass - 1, end);
+
+    // split the pass at the first line start after each even share
+    const char *start = cursor;
+    for (size_t w = 0; w < workers; w++) {
+      const char *stop = pass_end;
+      if (w + 1 < workers) {
+        size_t share = (size_t)(pass_end - cursor) * (w + 1) / workers;
+        stop = next_line_start(cursor + share - 1, pass_end);
+        if (stop < start) {
+          stop = start;
+        }
+      }
+      chunks[w].begin = start;
+      chunks[w].end = stop;
+      chunks[w].mode = table->checksum_mode;
+      start = stop;
+    }
+
+    parallel_run(parse_chunk_task, chunks, sizeof chunks[0], workers);
+
+    for (size_t w = 0; w < workers && result == DB_SUCCESS; w++) {
+      if (!chunks[w].ok) {
+        result = DB_ERROR_MEMORY;
+        break;
+      }
+      *crc = crc32_combine(*crc, chunks[w].crc,
+                           (size_t)(chunks[w].end - chunks[w].begin));
+      for (size_t i = 0; i < chunks[w].count; i++) {
+        ParsedLine *item = &chunks[w].items[i];
+        result = merge_parsed_line(table, item, line_num + (int)item->line,
+                                   stats);
+        if (result != DB_SUCCESS) {
+          break;
+        }
+      }
+      line_num += (int)chunks[w].lines;
+    }
+    cursor = pass_end;
+  }
+
+  for (size_t w = 0; w < MAX_WORKER_THREADS; w++) {
+    free(chunks[w].items);
+  }
+  return result;
+}
+
 /**
  * @brief parses entire file into database
  * @param[in] filename path to the file to parse
@@ -303,6 +635,13 @@ ParseStatus parse_column_headers(const char *line, char ***headers,
  * @param[out] stats optional pointer to statistics structure (can be NULL)
  * @return DB_SUCCESS on success, appropriate error code on failure
  * @note if stats is provided, it will be populated with parsing statistics
+ * @note the file is mapped and scanned in place; record lines of any length
+ *       are parsed without being copied, and each table's storage is sized
+ *       once from the number of lines that follow it
+ * @note large record sections are parsed on worker threads and merged in
+ *       file order, so warnings and statistics match a serial load
+ * @note on success db->file_loaded_checksum is set to the file's CRC32,
+ *       computed over the mapped bytes as they are parsed
  */
 DBStatus parse_file(const char *filename, StudentDatabase *db,
                     ParseStatistics *stats) {
@@ -319,54 +658,95 @@ DBStatus parse_file(const char *filename, StudentDatabase *db,
     stats->parse_errors = 0;
   }
 
-  FILE *fp = fopen(filename, "r");
-  if (!fp) {
+  FileMap map;
+  if (!file_map_open(filename, &map)) {
     printf("CMS: Error - Cannot open file '%s'\n", filename);
     return DB_ERROR_FILE_NOT_FOUND;
   }
 
-  char line[MAX_LINE_LENGTH];
+  const char *cursor = map.data;
+  const char *end = map.data ? map.data + map.size : NULL;
+  char text[MAX_LINE_LENGTH]; // copy of a metadata or header line
   int line_num = 0;
   StudentTable *current_table = NULL;
   int awaiting_headers = 0; // flag: next line is column headers
+  unsigned long crc = 0;    // file checksum of the bytes parsed so far
+  DBStatus result = DB_SUCCESS;
+
+  while (cursor < end) {
+    const char *newline = memchr(cursor, '\n', (size_t)(end - cursor));
+    const char *line = cursor;
+    size_t length = (size_t)((newline ? newline : end) - line);
+
+    // everything up to the next metadata line is records
+    if (current_table && !awaiting_headers &&
+        !is_metadata_line(line, length)) {
+      size_t lines;
+      const char *section_end = find_section_end(line, end, &lines);
+
+      // size storage once; if this fails, adds fall back to doubling
+      table_reserve(current_table, current_table->slot_count + lines);
+
+      result = parse_record_section(current_table, line, section_end,
+                                    line_num, &crc, stats);
+      if (result != DB_SUCCESS) {
+        break;
+      }
+      line_num += (int)lines;
+      cursor = section_end;
+      continue;
+    }
 
-  while (fgets(line, sizeof(line), fp)) {
+    cursor = newline ? newline + 1 : end;
     line_num++;
+    crc = crc32_update(crc, line, (size_t)(cursor - line));
 
     // skip empty lines
-    if (line[0] == '\n' || line[0] == '\r' ||
-        (line[0] == ' ' && line[1] == '\n')) {
+    if (is_blank_line(line, length, newline != NULL)) {
       continue;
     }
 
+    // metadata keys all contain a colon, which record lines rarely do
+    bool has_colon = memchr(line, ':', length) != NULL;
+
     // parse database metadata
-    if (strstr(line, "Database Name:")) {
-      char key[50], value[100];
-      if (parse_metadata(line, key, value) == PARSE_SUCCESS) {
+    if (has_colon && span_contains(line, length, "Database Name:")) {
+      char key[MAX_LINE_LENGTH], value[MAX_METADATA_VALUE];
+      copy_line(text, sizeof text, line, length);
+      if (parse_metadata(text, key, value) == PARSE_SUCCESS) {
         strncpy(db->db_name, value, sizeof(db->db_name) - 1);
         db->db_name[sizeof(db->db_name) - 1] = '\0';
       }
-    } else if (strstr(line, "Authors:")) {
-      char key[50], value[200];
-      if (parse_metadata(line, key, value) == PARSE_SUCCESS) {
+    } else if (has_colon && span_contains(line, length, "Authors:")) {
+      char key[MAX_LINE_LENGTH], value[MAX_METADATA_VALUE];
+      copy_line(text, sizeof text, line, length);
+      if (parse_metadata(text, key, value) == PARSE_SUCCESS) {
         strncpy(db->authors, value, sizeof(db->authors) - 1);
         db->authors[sizeof(db->authors) - 1] = '\0';
       }
-    } else if (strstr(line, "Table Name:")) {
+    } else if (has_colon && span_contains(line, length, "Table Name:")) {
       // create new table
-      char key[50], value[50];
-      if (parse_metadata(line, key, value) == PARSE_SUCCESS) {
-        current_table = table_init(value);
+      char key[MAX_LINE_LENGTH], value[MAX_METADATA_VALUE];
+      copy_line(text, sizeof text, line, length);
+      if (parse_metadata(text, key, value) == PARSE_SUCCESS) {
+        current_table = table_init_in_arena(&db->arena, value);
         if (!current_table) {
-          fclose(fp);
-          return DB_ERROR_MEMORY;
+          result = DB_ERROR_MEMORY;
+          break;
+        }
+
+        // empty table, so switching layout only swaps the storage arrays
+        if (table_set_layout(current_table, db->table_layout) != DB_SUCCESS) {
+          table_free(current_table);
+          result = DB_ERROR_MEMORY;
+          break;
         }
 
         DBStatus add_status = db_add_table(db, current_table);
         if (add_status != DB_SUCCESS) {
           table_free(current_table);
-          fclose(fp);
-          return add_status;
+          result = add_status;
+          break;
         }
 
         awaiting_headers = 1; // next line should be headers
@@ -375,7 +755,8 @@ DBStatus parse_file(const char *filename, StudentDatabase *db,
       // parse column headers
       char **headers;
       size_t count;
-      ParseStatus status = parse_column_headers(line, &headers, &count);
+      copy_line(text, sizeof text, line, length);
+      ParseStatus status = parse_column_headers(text, &headers, &count);
 
       if (status == PARSE_SUCCESS) {
         table_set_column_headers(current_table, headers, count);
@@ -385,65 +766,12 @@ DBStatus parse_file(const char *filename, StudentDatabase *db,
                line_num);
         awaiting_headers = 0; // skip to records anyway
       }
-    } else if (current_table && !awaiting_headers) {
-      // parse data record
-      StudentRecord record;
-      ParseStatus parse_status = parse_record_line(line, &record);
-
-      if (parse_status == PARSE_SUCCESS) {
-        if (stats) {
-          stats->total_records_attempted++;
-        }
-
-        ValidationStatus validation = validate_record(&record);
-
-        if (validation == VALID_RECORD) {
-          // check for duplicate id
-          int duplicate_found = 0;
-          for (size_t i = 0; i < current_table->record_count; i++) {
-            if (current_table->records[i].id == record.id) {
-              duplicate_found = 1;
-              break;
-            }
-          }
-
-          if (duplicate_found) {
-            printf("CMS: Warning - duplicate ID %d at line %d (ignored)\n",
-                   record.id, line_num);
-            if (stats) {
-              stats->records_skipped++;
-              stats->validation_errors++;
-            }
-          } else {
-            DBStatus add_status = table_add_record(current_table, &record);
-            if (add_status != DB_SUCCESS) {
-              fclose(fp);
-              return add_status;
-            }
-            if (stats) {
-              stats->records_loaded++;
-            }
-          }
-        } else {
-          printf("CMS: Warning - %s at line %d\n",
-                 validation_error_string(validation), line_num);
-          if (stats) {
-            stats->records_skipped++;
-            stats->validation_errors++;
-          }
-        }
-      } else if (parse_status != PARSE_ERROR_EMPTY) {
-        if (stats) {
-          stats->total_records_attempted++;
-          stats->records_skipped++;
-          stats->parse_errors++;
-        }
-        printf("CMS: Warning - %s at line %d\n",
-               parse_status_string(parse_status), line_num);
-      }
     }
   }
 
-  fclose(fp);
-  return DB_SUCCESS;
+  if (result == DB_SUCCESS) {
+    db->file_loaded_checksum = crc;
+  }
+  file_map_close(&map);
+  return result;
 }
@@ -0,0 +1,192 @@
+#include "query_cache.h"
+#include "checksum.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void unlink_entry(QueryCache *cache, QueryCacheEntry *entry) {
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    cache->head = entry->next;
+  }
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    cache->tail = entry->prev;
+  }
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+static void push_front(QueryCache *cache, QueryCacheEntry *entry) {
+  entry->prev = NULL;
+  entry->next = cache->head;
+  if (cache->head) {
+    cache->head->prev = entry;
+  } else {
+    cache->tail = entry;
+  }
+  cache->head = entry;
+}
+
+static void drop_entry(QueryCache *cache, QueryCacheEntry *entry) {
+  unlink_entry(cache, entry);
+  cache->count--;
+  cache->bytes -= entry->bytes;
+  free(entry->key);
+  free(entry->matches);
+  free(entry);
+}
+
+// the entry under key, or NULL; hashes are compared before the text
+static QueryCacheEntry *find_entry(const QueryCache *cache, const char *key,
+                                   unsigned long hash) {
+  for (QueryCacheEntry *entry = cache->head; entry; entry = entry->next) {
+    if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// evict from the least recently used end until the entries fit
+static void evict_to_capacity(QueryCache *cache) {
+  while (cache->tail && cache->bytes > cache->capacity) {
+    drop_entry(cache, cache->tail);
+    cache->evictions++;
+  }
+}
+
+/**
+ * @brief creates an empty cache
+ * @param[in] capacity most bytes the entries may hold
+ * @return pointer to the new cache, or NULL if memory allocation fails
+ */
+QueryCache *query_cache_create(size_t capacity) {
+  QueryCache *cache = calloc(1, sizeof *cache);
+  if (cache) {
+    cache->capacity = capacity;
+  }
+  return cache;
+}
+
+/**
+ * @brief frees a cache and every entry
+ * @param[in] cache pointer to the cache to free (can be NULL)
+ */
+void query_cache_free(QueryCache *cache) {
+  query_cache_clear(cache);
+  free(cache);
+}
+
+/**
+ * @brief drops every entry, keeping the counters and capacity
+ * @param[in,out] cache pointer to the cache (can be NULL)
+ */
+void query_cache_clear(QueryCache *cache) {
+  if (!cache) {
+    return;
+  }
+  while (cache->head) {
+    drop_entry(cache, cache->head);
+  }
+}
+
+/**
+ * @brief changes the capacity, evicting entries until they fit
+ * @param[in,out] cache pointer to the cache
+ * @param[in] capacity most bytes the entries may hold
+ */
+void query_cache_set_capacity(QueryCache *cache, size_t capacity) {
+  if (!cache) {
+    return;
+  }
+  cache->capacity = capacity;
+  evict_to_capacity(cache);
+}
+
+/**
+ * @brief finds the matches of a pipeline
+ * @param[in,out] cache pointer to the cache
+ * @param[in] key normalised pipeline
+ * @param[in] mutations the database's current mutation count
+ * @return the entry (valid until the cache next changes), or NULL if there
+ *         is none or it is stale (a stale entry is dropped)
+ * @note counts a hit or a miss and makes a found entry the most recent
+ */
+const QueryCacheEntry *query_cache_lookup(QueryCache *cache, const char *key,
+                                          uint64_t mutations) {
+  if (!cache || !key) {
+    return NULL;
+  }
+  QueryCacheEntry *entry =
+      find_entry(cache, key, compute_fast_hash(key, strlen(key)));
+  if (entry && entry->mutations != mutations) {
+    drop_entry(cache, entry);
+    entry = NULL;
+  }
+  if (!entry) {
+    cache->misses++;
+    return NULL;
+  }
+  cache->hits++;
+  unlink_entry(cache, entry);
+  push_front(cache, entry);
+  return entry;
+}
+
+/**
+ * @brief keeps a copy of the matches of a pipeline
+ * @param[in,out] cache pointer to the cache
+ * @param[in] key normalised pipeline
+ * @param[in] mutations the database's mutation count the matches are for
+ * @param[in] result matches to keep
+ * @return true if stored, false if the matches alone exceed the capacity or
+ *         memory allocation fails
+ * @note replaces any entry under the same key, then evicts the least
+ *       recently used entries until the cache is within capacity
+ */
+bool query_cache_store(QueryCache *cache, const char *key, uint64_t mutations,
+                       const AdvQueryResult *result) {
+  if (!cache || !key || !result) {
+    return false;
+  }
+  size_t key_length = strlen(key);
+  unsigned long hash = compute_fast_hash(key, key_length);
+  QueryCacheEntry *old = find_entry(cache, key, hash);
+  if (old) {
+    drop_entry(cache, old);
+  }
+
+  size_t bytes = sizeof(QueryCacheEntry) + key_length + 1 +
+                 result->count * sizeof(AdvQueryMatch);
+  if (bytes > cache->capacity) {
+    return false;
+  }
+  QueryCacheEntry *entry = calloc(1, sizeof *entry);
+  char *copy = malloc(key_length + 1);
+  AdvQueryMatch *matches =
+      malloc((result->count ? result->count : 1) * sizeof(AdvQueryMatch));
+  if (!entry || !copy || !matches) {
+    free(entry);
+    free(copy);
+    free(matches);
+    return false;
+  }
+  memcpy(copy, key, key_length + 1);
+  if (result->count > 0) {
+    memcpy(matches, result->matches, result->count * sizeof(AdvQueryMatch));
+  }
+  entry->key = copy;
+  entry->hash = hash;
+  entry->mutations = mutations;
+  entry->matches = matches;
+  entry->count = result->count;
+  entry->bytes = bytes;
+
+  push_front(cache, entry);
+  cache->count++;
+  cache->bytes += bytes;
+  evict_to_capacity(cache);
+  return true;
+}
@@ -0,0 +1,131 @@
+#include "record_format.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// "00" to "99", so integers are written two digits per division
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+// marks from here up are left to snprintf
+#define FORMAT_MARK_FAST_LIMIT 1e15
+
+// write an unsigned value in decimal, returning its length
+static size_t format_unsigned(char *out, uint64_t value) {
+  char digits[20];
+  size_t start = sizeof digits;
+  while (value >= 100) {
+    const char *pair = &digit_pairs[(value % 100) * 2];
+    value /= 100;
+    digits[--start] = pair[1];
+    digits[--start] = pair[0];
+  }
+  if (value >= 10) {
+    digits[--start] = digit_pairs[value * 2 + 1];
+    digits[--start] = digit_pairs[value * 2];
+  } else {
+    digits[--start] = (char)('0' + value);
+  }
+  size_t length = sizeof digits - start;
+  memcpy(out, digits + start, length);
+  return length;
+}
+
+// copy a field up to its terminator, reading at most size bytes
+static size_t copy_field(char *out, const char *field, size_t size) {
+  const char *end = memchr(field, '\0', size);
+  size_t length = end ? (size_t)(end - field) : size - 1;
+  memcpy(out, field, length);
+  return length;
+}
+
+/**
+ * @brief writes an integer in decimal
+ * @param[out] out buffer of at least FORMAT_INT_MAX bytes
+ * @param[in] value integer to write
+ * @return number of bytes written (no terminator)
+ * @note matches printf("%d")
+ */
+size_t format_int(char *out, int value) {
+  if (value < 0) {
+    *out = '-';
+    // negate in unsigned arithmetic so INT_MIN does not overflow
+    return 1 + format_unsigned(out + 1, 0u - (uint64_t)(int64_t)value);
+  }
+  return format_unsigned(out, (uint64_t)value);
+}
+
+/**
+ * @brief writes a mark with two decimal places
+ * @param[out] out buffer of at least FORMAT_MARK_MAX bytes
+ * @param[in] mark mark to write
+ * @return number of bytes written (no terminator)
+ * @note matches printf("%.2f") for every float, including exact halves
+ *       (rounded to even) and negative zero; infinities, NaN and values of
+ *       1e15 or more are formatted by snprintf
+ */
+size_t format_mark(char *out, float mark) {
+  double value = mark;
+  bool negative = value < 0 || (value == 0 && 1.0 / value < 0);
+  double magnitude = negative ? -value : value;
+
+  // NaN fails this test too
+  if (!(magnitude < FORMAT_MARK_FAST_LIMIT)) {
+    char text[FORMAT_MARK_MAX + 1];
+    int length = snprintf(text, sizeof text, "%.2f", value);
+    if (length < 0) {
+      return 0;
+    }
+    size_t written = (size_t)length < FORMAT_MARK_MAX ? (size_t)length
+                                                      : FORMAT_MARK_MAX;
+    memcpy(out, text, written);
+    return written;
+  }
+
+  // a float has 24 significant bits, so times 100 it is still exact in a
+  // double; rounding that to an integer is rounding the mark to hundredths
+  double scaled = magnitude * 100.0;
+  uint64_t hundredths = (uint64_t)scaled;
+  double fraction = scaled - (double)hundredths;
+  if (fraction > 0.5 || (fraction == 0.5 && (hundredths & 1))) {
+    hundredths++;
+  }
+
+  size_t length = 0;
+  if (negative) {
+    out[length++] = '-';
+  }
+  length += format_unsigned(out + length, hundredths / 100);
+  const char *pair = &digit_pairs[(hundredths % 100) * 2];
+  out[length++] = '.';
+  out[length++] = pair[0];
+  out[length++] = pair[1];
+  return length;
+}
+
+/**
+ * @brief writes one record line of the text file format
+ * @param[out] out buffer of at least RECORD_LINE_MAX bytes
+ * @param[in] id student id
+ * @param[in] name student name (NUL-terminated, under MAX_NAME_LENGTH)
+ * @param[in] prog programme (NUL-terminated, under MAX_PROGRAMME_LENGTH)
+ * @param[in] mark student mark
+ * @return number of bytes written (no terminator)
+ * @note matches printf("%d\t%s\t%s\t%.2f\n") in a text-mode stream; the
+ *       line ends in TEXT_NEWLINE
+ */
+size_t format_record_line(char *out, int id, const char *name,
+                          const char *prog, float mark) {
+  size_t length = format_int(out, id);
+  out[length++] = '\t';
+  length += copy_field(out + length, name, MAX_NAME_LENGTH);
+  out[length++] = '\t';
+  length += copy_field(out + length, prog, MAX_PROGRAMME_LENGTH);
+  out[length++] = '\t';
+  length += format_mark(out + length, mark);
+  memcpy(out + length, TEXT_NEWLINE, sizeof TEXT_NEWLINE - 1);
+  return length + sizeof TEXT_NEWLINE - 1;
+}
@@ -0,0 +1,633 @@
+#include "roaring.h"
+#include <stdlib.h>
+#include <string.h>
+
+// first capacity of an array container
+#define INITIAL_ARRAY 4
+
+// a bitset emptied to this many positions turns back into an array; the
+// gap below ROARING_ARRAY_MAX stops a set hovering at the limit converting
+// on every add and remove
+#define BITSET_SHRINK (ROARING_ARRAY_MAX / 2)
+
+static uint16_t *array_of(const RoaringContainer *container) {
+  return (uint16_t *)container->data;
+}
+
+static uint64_t *words_of(const RoaringContainer *container) {
+  return (uint64_t *)container->data;
+}
+
+// first index of values whose value is not below target
+static uint32_t lower_bound(const uint16_t *values, uint32_t count,
+                            uint16_t target) {
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (values[mid] < target) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// first container whose key is not below key
+static uint32_t find_slot(const RoaringBitmap *bitmap, uint16_t key) {
+  uint32_t count = bitmap->count;
+  if (count == 0 || bitmap->containers[count - 1].key < key) {
+    return count; // appending in ascending order
+  }
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (bitmap->containers[mid].key < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static const RoaringContainer *find_container(const RoaringBitmap *bitmap,
+                                              uint16_t key) {
+  uint32_t slot = find_slot(bitmap, key);
+  if (slot == bitmap->count || bitmap->containers[slot].key != key) {
+    return NULL;
+  }
+  return &bitmap->containers[slot];
+}
+
+// make room for a container at slot; the caller fills it in
+static bool open_slot(RoaringBitmap *bitmap, uint32_t slot) {
+  if (bitmap->count == bitmap->capacity) {
+    uint32_t capacity = bitmap->capacity ? bitmap->capacity * 2 : 4;
+    RoaringContainer *containers =
+        realloc(bitmap->containers, capacity * sizeof *containers);
+    if (!containers) {
+      return false;
+    }
+    bitmap->containers = containers;
+    bitmap->capacity = capacity;
+  }
+  memmove(&bitmap->containers[slot + 1], &bitmap->containers[slot],
+          (bitmap->count - slot) * sizeof(RoaringContainer));
+  bitmap->count++;
+  return true;
+}
+
+static void close_slot(RoaringBitmap *bitmap, uint32_t slot) {
+  free(bitmap->containers[slot].data);
+  memmove(&bitmap->containers[slot], &bitmap->containers[slot + 1],
+          (bitmap->count - slot - 1) * sizeof(RoaringContainer));
+  bitmap->count--;
+}
+
+static uint32_t popcount_words(const uint64_t *words) {
+  uint32_t count = 0;
+  for (size_t w = 0; w < ROARING_BITSET_WORDS; w++) {
+    count += (uint32_t)__builtin_popcountll(words[w]);
+  }
+  return count;
+}
+
+// turn an array container into a bitset
+static bool to_bitset(RoaringContainer *container) {
+  uint64_t *words = calloc(ROARING_BITSET_WORDS, sizeof(uint64_t));
+  if (!words) {
+    return false;
+  }
+  const uint16_t *values = array_of(container);
+  for (uint32_t i = 0; i < container->cardinality; i++) {
+    words[values[i] >> 6] |= UINT64_C(1) << (values[i] & 63);
+  }
+  free(container->data);
+  container->data = words;
+  container->kind = ROARING_BITSET;
+  container->capacity = 0;
+  return true;
+}
+
+// low bits set in words, ascending, written to out
+static uint32_t bitset_values(const uint64_t *words, uint16_t *out) {
+  uint32_t count = 0;
+  for (uint32_t w = 0; w < ROARING_BITSET_WORDS; w++) {
+    uint64_t word = words[w];
+    while (word) {
+      out[count++] = (uint16_t)(w * 64 + (uint32_t)__builtin_ctzll(word));
+      word &= word - 1;
+    }
+  }
+  return count;
+}
+
+// turn a bitset container holding at most ROARING_ARRAY_MAX positions into
+// an array
+static bool to_array(RoaringContainer *container) {
+  uint32_t capacity = container->cardinality ? container->cardinality : 1;
+  uint16_t *values = malloc(capacity * sizeof(uint16_t));
+  if (!values) {
+    return false;
+  }
+  bitset_values(words_of(container), values);
+  free(container->data);
+  container->data = values;
+  container->kind = ROARING_ARRAY;
+  container->capacity = capacity;
+  return true;
+}
+
+static bool container_add(RoaringContainer *container, uint16_t low) {
+  if (container->kind == ROARING_BITSET) {
+    uint64_t *word = &words_of(container)[low >> 6];
+    uint64_t bit = UINT64_C(1) << (low & 63);
+    container->cardinality += (*word & bit) == 0;
+    *word |= bit;
+    return true;
+  }
+
+  uint16_t *values = array_of(container);
+  uint32_t count = container->cardinality;
+  uint32_t at = count;
+  if (count > 0 && values[count - 1] >= low) {
+    at = lower_bound(values, count, low);
+    if (values[at] == low) {
+      return true;
+    }
+  }
+  if (count == ROARING_ARRAY_MAX) {
+    return to_bitset(container) && container_add(container, low);
+  }
+  if (count == container->capacity) {
+    uint32_t capacity = container->capacity ? container->capacity * 2
+                                            : INITIAL_ARRAY;
+    capacity = capacity > ROARING_ARRAY_MAX ? ROARING_ARRAY_MAX : capacity;
+    values = realloc(container->data, capacity * sizeof(uint16_t));
+    if (!values) {
+      return false;
+    }
+    container->data = values;
+    container->capacity = capacity;
+  }
+  memmove(&values[at + 1], &values[at], (count - at) * sizeof(uint16_t));
+  values[at] = low;
+  container->cardinality++;
+  return true;
+}
+
+// copy of src into dst
+static bool container_clone(RoaringContainer *dst,
+                            const RoaringContainer *src) {
+  size_t bytes = src->kind == ROARING_BITSET
+                     ? ROARING_BITSET_WORDS * sizeof(uint64_t)
+                     : (src->cardinality ? src->cardinality : 1) *
+                           sizeof(uint16_t);
+  void *data = malloc(bytes);
+  if (!data) {
+    return false;
+  }
+  memcpy(data, src->data,
+         src->kind == ROARING_BITSET ? bytes
+                                     : src->cardinality * sizeof(uint16_t));
+  *dst = *src;
+  dst->data = data;
+  dst->capacity = src->kind == ROARING_BITSET ? 0 : (uint32_t)(bytes / 2);
+  return true;
+}
+
+// dst |= src for containers sharing a key
+static bool container_or(RoaringContainer *dst, const RoaringContainer *src) {
+  if (dst->kind == ROARING_ARRAY &&
+      (src->kind == ROARING_BITSET ||
+       dst->cardinality + src->cardinality > ROARING_ARRAY_MAX)) {
+    if (!to_bitset(dst)) {
+      return false;
+    }
+  }
+
+  if (dst->kind == ROARING_BITSET) {
+    uint64_t *words = words_of(dst);
+    if (src->kind == ROARING_BITSET) {
+      const uint64_t *other = words_of(src);
+      for (size_t w = 0; w < ROARING_BITSET_WORDS; w++) {
+        words[w] |= other[w];
+      }
+      dst->cardinality = popcount_words(words);
+    } else {
+      const uint16_t *values = array_of(src);
+      for (uint32_t i = 0; i < src->cardinality; i++) {
+        container_add(dst, values[i]);
+      }
+    }
+    return true;
+  }
+
+  // two arrays that fit in one: merge them
+  uint32_t capacity = dst->cardinality + src->cardinality;
+  uint16_t *merged = malloc(capacity * sizeof(uint16_t));
+  if (!merged) {
+    return false;
+  }
+  const uint16_t *a = array_of(dst);
+  const uint16_t *b = array_of(src);
+  uint32_t i = 0;
+  uint32_t j = 0;
+  uint32_t count = 0;
+  while (i < dst->cardinality && j < src->cardinality) {
+    uint16_t next = a[i] < b[j] ? a[i] : b[j];
+    i += a[i] == next;
+    j += b[j] == next;
+    merged[count++] = next;
+  }
+  while (i < dst->cardinality) {
+    merged[count++] = a[i++];
+  }
+  while (j < src->cardinality) {
+    merged[count++] = b[j++];
+  }
+  free(dst->data);
+  dst->data = merged;
+  dst->cardinality = count;
+  dst->capacity = capacity;
+  return true;
+}
+
+// positions of a array container also present in b
+static uint32_t and_array(const RoaringContainer *a, const RoaringContainer *b,
+                          uint16_t *out) {
+  const uint16_t *values = array_of(a);
+  uint32_t count = 0;
+  if (b->kind == ROARING_BITSET) {
+    const uint64_t *words = words_of(b);
+    for (uint32_t i = 0; i < a->cardinality; i++) {
+      uint16_t v = values[i];
+      bool hit = (words[v >> 6] >> (v & 63)) & 1;
+      if (out) {
+        out[count] = v;
+      }
+      count += hit;
+    }
+    return count;
+  }
+  const uint16_t *other = array_of(b);
+  uint32_t i = 0;
+  uint32_t j = 0;
+  while (i < a->cardinality && j < b->cardinality) {
+    if (values[i] < other[j]) {
+      i++;
+    } else if (values[i] > other[j]) {
+      j++;
+    } else {
+      if (out) {
+        out[count] = values[i];
+      }
+      count++;
+      i++;
+      j++;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief initialises an empty bitmap (no memory is allocated)
+ * @param[out] bitmap pointer to the bitmap to initialise
+ */
+void roaring_init(RoaringBitmap *bitmap) {
+  if (!bitmap) {
+    return;
+  }
+  memset(bitmap, 0, sizeof *bitmap);
+}
+
+/**
+ * @brief frees all memory held by a bitmap, leaving it empty
+ * @param[in,out] bitmap pointer to the bitmap to free (can be NULL)
+ */
+void roaring_free(RoaringBitmap *bitmap) {
+  if (!bitmap) {
+    return;
+  }
+  for (uint32_t c = 0; c < bitmap->count; c++) {
+    free(bitmap->containers[c].data);
+  }
+  free(bitmap->containers);
+  roaring_init(bitmap);
+}
+
+/**
+ * @brief adds a position
+ * @param[in,out] bitmap pointer to the bitmap
+ * @param[in] value position to add
+ * @return true on success (or if already present), false if memory
+ *         allocation fails
+ * @note adding in ascending order appends without moving anything
+ */
+bool roaring_add(RoaringBitmap *bitmap, uint32_t value) {
+  if (!bitmap) {
+    return false;
+  }
+  uint16_t key = (uint16_t)(value >> 16);
+  uint32_t slot = find_slot(bitmap, key);
+  if (slot == bitmap->count || bitmap->containers[slot].key != key) {
+    if (!open_slot(bitmap, slot)) {
+      return false;
+    }
+    bitmap->containers[slot] =
+        (RoaringContainer){key, ROARING_ARRAY, 0, 0, NULL};
+  }
+  RoaringContainer *container = &bitmap->containers[slot];
+  if (!container_add(container, (uint16_t)value)) {
+    if (container->cardinality == 0) {
+      close_slot(bitmap, slot);
+    }
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief removes a position (nothing happens if it is absent)
+ * @param[in,out] bitmap pointer to the bitmap
+ * @param[in] value position to remove
+ */
+void roaring_remove(RoaringBitmap *bitmap, uint32_t value) {
+  if (!bitmap) {
+    return;
+  }
+  uint16_t key = (uint16_t)(value >> 16);
+  uint16_t low = (uint16_t)value;
+  uint32_t slot = find_slot(bitmap, key);
+  if (slot == bitmap->count || bitmap->containers[slot].key != key) {
+    return;
+  }
+  RoaringContainer *container = &bitmap->containers[slot];
+  if (container->kind == ROARING_BITSET) {
+    uint64_t *word = &words_of(container)[low >> 6];
+    uint64_t bit = UINT64_C(1) << (low & 63);
+    if ((*word & bit) == 0) {
+      return;
+    }
+    *word &= ~bit;
+    container->cardinality--;
+    if (container->cardinality <= BITSET_SHRINK) {
+      to_array(container); // stays a bitset if memory runs out
+    }
+  } else {
+    uint16_t *values = array_of(container);
+    uint32_t at = lower_bound(values, container->cardinality, low);
+    if (at == container->cardinality || values[at] != low) {
+      return;
+    }
+    memmove(&values[at], &values[at + 1],
+            (container->cardinality - at - 1) * sizeof(uint16_t));
+    container->cardinality--;
+  }
+  if (container->cardinality == 0) {
+    close_slot(bitmap, slot);
+  }
+}
+
+/**
+ * @brief checks whether a position is in a bitmap
+ * @param[in] bitmap pointer to the bitmap
+ * @param[in] value position to look for
+ * @return true if present
+ */
+bool roaring_contains(const RoaringBitmap *bitmap, uint32_t value) {
+  if (!bitmap) {
+    return false;
+  }
+  const RoaringContainer *container =
+      find_container(bitmap, (uint16_t)(value >> 16));
+  if (!container) {
+    return false;
+  }
+  uint16_t low = (uint16_t)value;
+  if (container->kind == ROARING_BITSET) {
+    return (words_of(container)[low >> 6] >> (low & 63)) & 1;
+  }
+  const uint16_t *values = array_of(container);
+  uint32_t at = lower_bound(values, container->cardinality, low);
+  return at < container->cardinality && values[at] == low;
+}
+
+/**
+ * @brief returns the number of positions in a bitmap
+ * @param[in] bitmap pointer to the bitmap
+ * @return positions held
+ */
+size_t roaring_cardinality(const RoaringBitmap *bitmap) {
+  if (!bitmap) {
+    return 0;
+  }
+  size_t count = 0;
+  for (uint32_t c = 0; c < bitmap->count; c++) {
+    count += bitmap->containers[c].cardinality;
+  }
+  return count;
+}
+
+/**
+ * @brief adds every position of src to dst
+ * @param[in,out] dst bitmap to extend
+ * @param[in] src bitmap to add
+ * @return true on success, false if memory allocation fails (dst then
+ *         holds part of src)
+ */
+bool roaring_or_into(RoaringBitmap *dst, const RoaringBitmap *src) {
+  if (!dst || !src) {
+    return false;
+  }
+  uint32_t slot = 0;
+  for (uint32_t c = 0; c < src->count; c++) {
+    const RoaringContainer *from = &src->containers[c];
+    while (slot < dst->count && dst->containers[slot].key < from->key) {
+      slot++;
+    }
+    if (slot < dst->count && dst->containers[slot].key == from->key) {
+      if (!container_or(&dst->containers[slot], from)) {
+        return false;
+      }
+      continue;
+    }
+    RoaringContainer copy;
+    if (!container_clone(&copy, from)) {
+      return false;
+    }
+    if (!open_slot(dst, slot)) {
+      free(copy.data);
+      return false;
+    }
+    dst->containers[slot] = copy;
+  }
+  return true;
+}
+
+/**
+ * @brief computes the positions present in both bitmaps
+ * @param[in] a first bitmap
+ * @param[in] b second bitmap
+ * @param[out] out initialised bitmap receiving the intersection (emptied
+ *                 first)
+ * @return true on success, false if memory allocation fails
+ */
+bool roaring_and(const RoaringBitmap *a, const RoaringBitmap *b,
+                 RoaringBitmap *out) {
+  if (!a || !b || !out || out == a || out == b) {
+    return false;
+  }
+  roaring_free(out);
+  uint32_t i = 0;
+  uint32_t j = 0;
+  while (i < a->count && j < b->count) {
+    const RoaringContainer *ca = &a->containers[i];
+    const RoaringContainer *cb = &b->containers[j];
+    if (ca->key != cb->key) {
+      i += ca->key < cb->key;
+      j += cb->key < ca->key;
+      continue;
+    }
+    i++;
+    j++;
+
+    RoaringContainer result = {ca->key, ROARING_ARRAY, 0, 0, NULL};
+    if (ca->kind == ROARING_BITSET && cb->kind == ROARING_BITSET) {
+      uint64_t *words = malloc(ROARING_BITSET_WORDS * sizeof(uint64_t));
+      if (!words) {
+        return false;
+      }
+      const uint64_t *wa = words_of(ca);
+      const uint64_t *wb = words_of(cb);
+      for (size_t w = 0; w < ROARING_BITSET_WORDS; w++) {
+        words[w] = wa[w] & wb[w];
+      }
+      result.kind = ROARING_BITSET;
+      result.data = words;
+      result.cardinality = popcount_words(words);
+      if (result.cardinality <= ROARING_ARRAY_MAX && !to_array(&result)) {
+        free(result.data);
+        return false;
+      }
+    } else {
+      // walk the array side; the result is never larger than it
+      const RoaringContainer *small = ca->kind == ROARING_ARRAY ? ca : cb;
+      const RoaringContainer *other = small == ca ? cb : ca;
+      uint32_t capacity = small->cardinality ? small->cardinality : 1;
+      uint16_t *values = malloc(capacity * sizeof(uint16_t));
+      if (!values) {
+        return false;
+      }
+      result.data = values;
+      result.capacity = capacity;
+      result.cardinality = and_array(small, other, values);
+    }
+
+    if (result.cardinality == 0) {
+      free(result.data);
+      continue;
+    }
+    if (!open_slot(out, out->count)) {
+      free(result.data);
+      return false;
+    }
+    out->containers[out->count - 1] = result;
+  }
+  return true;
+}
+
+/**
+ * @brief counts the positions present in both bitmaps without building
+ *        their intersection
+ * @param[in] a first bitmap
+ * @param[in] b second bitmap
+ * @return size of the intersection
+ */
+size_t roaring_and_cardinality(const RoaringBitmap *a,
+                               const RoaringBitmap *b) {
+  if (!a || !b) {
+    return 0;
+  }
+  size_t count = 0;
+  uint32_t i = 0;
+  uint32_t j = 0;
+  while (i < a->count && j < b->count) {
+    const RoaringContainer *ca = &a->containers[i];
+    const RoaringContainer *cb = &b->containers[j];
+    if (ca->key != cb->key) {
+      i += ca->key < cb->key;
+      j += cb->key < ca->key;
+      continue;
+    }
+    i++;
+    j++;
+    if (ca->kind == ROARING_BITSET && cb->kind == ROARING_BITSET) {
+      const uint64_t *wa = words_of(ca);
+      const uint64_t *wb = words_of(cb);
+      for (size_t w = 0; w < ROARING_BITSET_WORDS; w++) {
+        count += (size_t)__builtin_popcountll(wa[w] & wb[w]);
+      }
+    } else if (ca->kind == ROARING_ARRAY) {
+      count += and_array(ca, cb, NULL);
+    } else {
+      count += and_array(cb, ca, NULL);
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief writes every position in ascending order
+ * @param[in] bitmap pointer to the bitmap
+ * @param[out] out array of at least roaring_cardinality(bitmap) entries
+ * @return positions written
+ */
+size_t roaring_to_array(const RoaringBitmap *bitmap, uint32_t *out) {
+  if (!bitmap || !out) {
+    return 0;
+  }
+  size_t count = 0;
+  for (uint32_t c = 0; c < bitmap->count; c++) {
+    const RoaringContainer *container = &bitmap->containers[c];
+    uint32_t high = (uint32_t)container->key << 16;
+    if (container->kind == ROARING_BITSET) {
+      const uint64_t *words = words_of(container);
+      for (uint32_t w = 0; w < ROARING_BITSET_WORDS; w++) {
+        uint64_t word = words[w];
+        while (word) {
+          out[count++] = high | (w * 64 + (uint32_t)__builtin_ctzll(word));
+          word &= word - 1;
+        }
+      }
+    } else {
+      const uint16_t *values = array_of(container);
+      for (uint32_t i = 0; i < container->cardinality; i++) {
+        out[count++] = high | values[i];
+      }
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief returns the bytes a bitmap holds
+ * @param[in] bitmap pointer to the bitmap
+ * @return allocated bytes of its containers and their data
+ */
+size_t roaring_memory(const RoaringBitmap *bitmap) {
+  if (!bitmap) {
+    return 0;
+  }
+  size_t bytes = bitmap->capacity * sizeof(RoaringContainer);
+  for (uint32_t c = 0; c < bitmap->count; c++) {
+    const RoaringContainer *container = &bitmap->containers[c];
+    bytes += container->kind == ROARING_BITSET
+                 ? ROARING_BITSET_WORDS * sizeof(uint64_t)
+                 : container->capacity * sizeof(uint16_t);
+  }
+  return bytes;
+}
@@ -0,0 +1,466 @@
+#include "snapshot.h"
+#include "atomic_file.h"
+#include "checksum.h"
+#include "journal.h"
+#include "table_view.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// records packed per write
+#define SNAPSHOT_WRITE_BATCH 256
+
+// output file plus the checksum of everything written after the header
+typedef struct {
+  FILE *fp;
+  unsigned long crc;
+  bool ok;
+} SnapshotWriter;
+
+static void write_bytes(SnapshotWriter *writer, const void *data,
+                        size_t size) {
+  if (size == 0) {
+    return;
+  }
+  if (writer->ok && fwrite(data, 1, size, writer->fp) != size) {
+    writer->ok = false;
+  }
+  writer->crc = crc32_update(writer->crc, data, size);
+}
+
+// write zero bytes until position reaches target
+static void write_padding(SnapshotWriter *writer, uint64_t position,
+                          uint64_t target) {
+  static const char zeros[SNAPSHOT_ALIGNMENT];
+  write_bytes(writer, zeros, (size_t)(target - position));
+}
+
+static uint64_t align_offset(uint64_t offset) {
+  return (offset + SNAPSHOT_ALIGNMENT - 1) &
+         ~(uint64_t)(SNAPSHOT_ALIGNMENT - 1);
+}
+
+// copy a string into a zero-filled fixed-size field, truncating if needed
+static void copy_text(char *field, size_t size, const char *text) {
+  size_t length = strlen(text);
+  memcpy(field, text, length < size ? length : size - 1);
+}
+
+// bytes taken by a table's column headers, terminators included
+static uint64_t headers_size(const StudentTable *table) {
+  uint64_t size = 0;
+  for (size_t i = 0; i < table->column_count; i++) {
+    size += strlen(table->column_headers[i]) + 1;
+  }
+  return size;
+}
+
+// copy a record's fields into a zeroed record, so struct padding and any
+// bytes left after a name's terminator (an earlier, longer name) never reach
+// the file
+static void pack_record(StudentRecord *packed, const StudentRecord *record) {
+  memset(packed, 0, sizeof *packed);
+  packed->id = record->id;
+  memcpy(packed->name, record->name, strlen(record->name) + 1);
+  memcpy(packed->prog, record->prog, strlen(record->prog) + 1);
+  packed->mark = record->mark;
+}
+
+// write a table's live records in its active view order
+static void write_records(SnapshotWriter *writer, const StudentTable *table) {
+  StudentRecord batch[SNAPSHOT_WRITE_BATCH];
+  size_t count = 0;
+  size_t cursor = 0;
+  size_t p;
+  while ((p = table_view_next(table, &cursor)) != TABLE_VIEW_NOT_FOUND) {
+    // rows are packed straight from storage, columns are read out first
+    if (table->layout == TABLE_LAYOUT_ROWS) {
+      pack_record(&batch[count], &table->records[p]);
+    } else {
+      StudentRecord record;
+      table_read_record(table, p, &record);
+      pack_record(&batch[count], &record);
+    }
+    if (++count == SNAPSHOT_WRITE_BATCH) {
+      write_bytes(writer, batch, sizeof batch);
+      count = 0;
+    }
+  }
+  write_bytes(writer, batch, count * sizeof(StudentRecord));
+}
+
+/**
+ * @brief checks whether a file name selects the snapshot format
+ * @param[in] filename path to check
+ * @return true if filename ends in SNAPSHOT_EXTENSION
+ */
+bool snapshot_is_path(const char *filename) {
+  if (!filename) {
+    return false;
+  }
+  size_t length = strlen(filename);
+  size_t extension = strlen(SNAPSHOT_EXTENSION);
+  return length > extension &&
+         strcmp(filename + length - extension, SNAPSHOT_EXTENSION) == 0;
+}
+
+/**
+ * @brief writes every table of a database to a snapshot
+ * @param[in] db pointer to the database to save
+ * @param[in] filename path to the snapshot
+ * @param[out] file_checksum optional pointer to receive the CRC32 of the
+ *             written file, as compute_file_checksum would return it
+ * @return DB_SUCCESS on success, DB_ERROR_FILE_NOT_FOUND if the file cannot
+ *         be created, DB_ERROR_FILE_READ if writing fails
+ * @note records are written in each table's active view order, skipping
+ *       deleted slots; the file is written beside the target, synced and
+ *       renamed over it, so a snapshot still mapped by the database stays
+ *       intact and a crash never leaves a partial file
+ */
+DBStatus snapshot_save(const StudentDatabase *db, const char *filename,
+                       unsigned long *file_checksum) {
+  if (!db || !filename) {
+    return DB_ERROR_NULL_POINTER;
+  }
+
+  SnapshotHeader header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+  header.version = SNAPSHOT_VERSION;
+  header.byte_order = SNAPSHOT_BYTE_ORDER;
+  header.record_size = sizeof(StudentRecord);
+  header.table_count = (uint32_t)db->table_count;
+  copy_text(header.db_name, sizeof header.db_name, db->db_name);
+  copy_text(header.authors, sizeof header.authors, db->authors);
+
+  SnapshotTable *entries =
+      calloc(db->table_count > 0 ? db->table_count : 1, sizeof *entries);
+  if (!entries) {
+    return DB_ERROR_MEMORY;
+  }
+
+  // lay the file out first so the descriptors can precede the data
+  uint64_t offset =
+      sizeof header + (uint64_t)db->table_count * sizeof(SnapshotTable);
+  for (size_t t = 0; t < db->table_count; t++) {
+    const StudentTable *table = db->tables[t];
+    SnapshotTable *entry = &entries[t];
+    copy_text(entry->table_name, sizeof entry->table_name, table->table_name);
+    entry->column_count = table->column_count;
+    entry->headers_offset = offset;
+    entry->headers_size = headers_size(table);
+    entry->records_offset =
+        align_offset(entry->headers_offset + entry->headers_size);
+    entry->record_count = table->record_count;
+    offset = entry->records_offset +
+             entry->record_count * (uint64_t)sizeof(StudentRecord);
+  }
+  header.file_size = offset;
+
+  AtomicFile file;
+  FILE *fp = atomic_file_open(&file, filename);
+  if (!fp) {
+    free(entries);
+    return DB_ERROR_FILE_NOT_FOUND;
+  }
+
+  // the rest of the file is checksummed on its own, so the stored crc (of
+  // the header with its crc field zero) and the crc of the file as written
+  // both follow from it
+  SnapshotWriter writer = {fp, 0, true};
+  if (fwrite(&header, sizeof header, 1, fp) != 1) {
+    writer.ok = false;
+  }
+  write_bytes(&writer, entries, db->table_count * sizeof *entries);
+
+  for (size_t t = 0; t < db->table_count; t++) {
+    const StudentTable *table = db->tables[t];
+    for (size_t i = 0; i < table->column_count; i++) {
+      write_bytes(&writer, table->column_headers[i],
+                  strlen(table->column_headers[i]) + 1);
+    }
+    write_padding(&writer, entries[t].headers_offset + entries[t].headers_size,
+                  entries[t].records_offset);
+    write_records(&writer, table);
+  }
+
+  uint64_t body_size = header.file_size - sizeof header;
+  header.crc = (uint32_t)crc32_combine(crc32_update(0, &header, sizeof header),
+                                       writer.crc, (size_t)body_size);
+  if (writer.ok &&
+      (fseek(fp, (long)offsetof(SnapshotHeader, crc), SEEK_SET) != 0 ||
+       fwrite(&header.crc, sizeof header.crc, 1, fp) != 1)) {
+    writer.ok = false;
+  }
+  free(entries);
+
+  if (!writer.ok) {
+    atomic_file_abort(&file);
+    return DB_ERROR_FILE_READ;
+  }
+  // snapshots are read into memory on windows, so replacing the file there
+  // does not disturb the database using it
+  if (!atomic_file_commit(&file)) {
+    return DB_ERROR_FILE_READ;
+  }
+
+  if (file_checksum) {
+    *file_checksum = crc32_combine(crc32_update(0, &header, sizeof header),
+                                   writer.crc, (size_t)body_size);
+  }
+  return DB_SUCCESS;
+}
+
+// true if the size bytes at offset lie inside the file
+static bool in_file(const FileMap *map, uint64_t offset, uint64_t size) {
+  return offset <= map->size && size <= map->size - offset;
+}
+
+// checks that a descriptor's headers and records lie inside the file, that
+// every string the table will read is terminated and that every record
+// passes the same validation as a record in a text file
+static bool verify_table(const FileMap *map, const SnapshotTable *entry) {
+  if (!in_file(map, entry->headers_offset, entry->headers_size)) {
+    return false;
+  }
+  const char *headers = map->data + entry->headers_offset;
+  uint64_t strings = 0;
+  for (uint64_t i = 0; i < entry->headers_size; i++) {
+    strings += headers[i] == '\0';
+  }
+  if (strings != entry->column_count ||
+      (entry->headers_size > 0 && headers[entry->headers_size - 1] != '\0')) {
+    return false;
+  }
+
+  if (entry->records_offset % SNAPSHOT_ALIGNMENT != 0 ||
+      entry->record_count >= UINT32_MAX ||
+      entry->record_count > map->size / sizeof(StudentRecord) ||
+      !in_file(map, entry->records_offset,
+               entry->record_count * sizeof(StudentRecord))) {
+    return false;
+  }
+  const StudentRecord *records =
+      (const StudentRecord *)(map->data + entry->records_offset);
+  for (uint64_t i = 0; i < entry->record_count; i++) {
+    if (!memchr(records[i].name, '\0', sizeof records[i].name) ||
+        !memchr(records[i].prog, '\0', sizeof records[i].prog) ||
+        validate_record(&records[i]) != VALID_RECORD) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// checks a mapped snapshot's header, checksum and descriptors, setting
+// file_crc to the crc32 of the whole file
+static bool verify_snapshot(const FileMap *map, SnapshotHeader *header,
+                            unsigned long *file_crc) {
+  if (map->size < sizeof *header) {
+    return false;
+  }
+  memcpy(header, map->data, sizeof *header);
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof header->magic) != 0 ||
+      header->version != SNAPSHOT_VERSION ||
+      header->byte_order != SNAPSHOT_BYTE_ORDER ||
+      header->record_size != sizeof(StudentRecord) ||
+      header->file_size != map->size ||
+      header->table_count >
+          (map->size - sizeof *header) / sizeof(SnapshotTable)) {
+    return false;
+  }
+
+  // one pass over the body gives both the stored crc, taken with the
+  // header's crc field zero, and the crc of the file as it is
+  size_t body_size = map->size - sizeof *header;
+  unsigned long body_crc =
+      crc32_update(0, map->data + sizeof *header, body_size);
+  SnapshotHeader zeroed = *header;
+  zeroed.crc = 0;
+  unsigned long crc = crc32_combine(crc32_update(0, &zeroed, sizeof zeroed),
+                                    body_crc, body_size);
+  if ((uint32_t)crc != header->crc) {
+    return false;
+  }
+  *file_crc = crc32_combine(crc32_update(0, header, sizeof *header), body_crc,
+                            body_size);
+
+  for (uint32_t t = 0; t < header->table_count; t++) {
+    SnapshotTable entry;
+    memcpy(&entry, map->data + sizeof *header + t * sizeof entry,
+           sizeof entry);
+    if (!verify_table(map, &entry)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// create a table whose headers and records point into the mapped file
+static DBStatus load_table(StudentDatabase *db, const FileMap *map,
+                           const SnapshotTable *entry) {
+  char name[MAX_TABLE_NAME_LENGTH];
+  memcpy(name, entry->table_name, sizeof name);
+  name[sizeof name - 1] = '\0';
+
+  StudentTable *table = table_init_in_arena(&db->arena, name);
+  if (!table) {
+    return DB_ERROR_MEMORY;
+  }
+  DBStatus status = db_add_table(db, table);
+  if (status != DB_SUCCESS) {
+    table_free(table);
+    return status;
+  }
+
+  if (entry->column_count > 0) {
+    char **headers =
+        arena_alloc(&db->arena, entry->column_count * sizeof *headers);
+    if (!headers) {
+      return DB_ERROR_MEMORY;
+    }
+    char *text = (char *)map->data + entry->headers_offset;
+    for (uint64_t i = 0; i < entry->column_count; i++) {
+      headers[i] = text;
+      text += strlen(text) + 1;
+    }
+    table->column_headers = headers;
+    table->column_count = (size_t)entry->column_count;
+  }
+
+  if (entry->record_count > 0) {
+    // the mapped array is the table's storage until an add needs more room,
+    // which copies it into the arena
+    table->records = (StudentRecord *)(map->data + entry->records_offset);
+    // the rebuild refills the programme codes in place, so they need room
+    // for every record first
+    uint32_t *codes = arena_resize(
+        &db->arena, table->prog_codes,
+        table->record_capacity * sizeof(uint32_t),
+        (size_t)entry->record_count * sizeof(uint32_t));
+    if (!codes) {
+      return DB_ERROR_MEMORY;
+    }
+    table->prog_codes = codes;
+    table->record_count = (size_t)entry->record_count;
+    table->slot_count = table->record_count;
+    table->record_capacity = table->record_count;
+
+    status = table_rebuild_index(table);
+    if (status != DB_SUCCESS) {
+      return status;
+    }
+    if (table->id_index.count != table->record_count) {
+      return DB_ERROR_DUPLICATE_ID;
+    }
+    // records arrived without table_add_record, so their checksum does too
+    table->record_checksum = compute_table_checksum(table);
+  }
+
+  if (db->table_layout != TABLE_LAYOUT_ROWS) {
+    return table_set_layout(table, db->table_layout);
+  }
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief loads a snapshot into a database
+ * @param[in,out] db pointer to the database to load into
+ * @param[in] filename path to the snapshot
+ * @param[out] stats optional pointer to statistics structure (can be NULL)
+ * @return DB_SUCCESS on success, DB_ERROR_FILE_NOT_FOUND if the file cannot
+ *         be opened, DB_ERROR_INVALID_DATA if it is not a valid snapshot for
+ *         this build, DB_ERROR_MEMORY if allocation fails
+ * @note row layout tables use the mapped records in place until they grow;
+ *       the mapping stays open until db_clear or db_free
+ * @note on success db->file_loaded_checksum is set to the file's CRC32,
+ *       taken in the same pass that verifies the snapshot
+ */
+DBStatus snapshot_load(StudentDatabase *db, const char *filename,
+                       ParseStatistics *stats) {
+  if (!db || !filename) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+  }
+
+  MappedFile *file = arena_alloc(&db->arena, sizeof *file);
+  if (!file) {
+    return DB_ERROR_MEMORY;
+  }
+  if (!file_map_open_private(filename, &file->map)) {
+    printf("CMS: Error - Cannot open file '%s'\n", filename);
+    return DB_ERROR_FILE_NOT_FOUND;
+  }
+
+  SnapshotHeader header;
+  unsigned long file_crc;
+  if (!verify_snapshot(&file->map, &header, &file_crc)) {
+    printf("CMS: Error - '%s' is not a valid snapshot for this build\n",
+           filename);
+    file_map_close(&file->map);
+    return DB_ERROR_INVALID_DATA;
+  }
+
+  // tables below point into the map, so it lives as long as they do
+  file->next = db->mapped_files;
+  db->mapped_files = file;
+
+  memcpy(db->db_name, header.db_name, sizeof db->db_name);
+  db->db_name[sizeof db->db_name - 1] = '\0';
+  memcpy(db->authors, header.authors, sizeof db->authors);
+  db->authors[sizeof db->authors - 1] = '\0';
+
+  for (uint32_t t = 0; t < header.table_count; t++) {
+    SnapshotTable entry;
+    memcpy(&entry, file->map.data + sizeof header + t * sizeof entry,
+           sizeof entry);
+    DBStatus status = load_table(db, &file->map, &entry);
+    if (status != DB_SUCCESS) {
+      return status;
+    }
+    if (stats) {
+      stats->total_records_attempted += (int)entry.record_count;
+      stats->records_loaded += (int)entry.record_count;
+    }
+  }
+
+  db->file_loaded_checksum = file_crc;
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief converts a database file between the text and snapshot formats
+ * @param[in] source file to read (format chosen by its extension)
+ * @param[in] destination file to write (format chosen by its extension)
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ * @note changes committed to the source's journal are replayed first, as
+ *       OPEN does, so the destination holds every saved change
+ */
+DBStatus snapshot_convert(const char *source, const char *destination) {
+  if (!source || !destination) {
+    return DB_ERROR_NULL_POINTER;
+  }
+
+  StudentDatabase *db = db_init();
+  if (!db) {
+    return DB_ERROR_MEMORY;
+  }
+
+  DBStatus status = db_load(db, source, NULL);
+  if (status == DB_SUCCESS) {
+    // SAVE since the source was last rewritten only appended to its journal
+    db->journal = journal_open(db, source, NULL);
+    if (!db->journal) {
+      status = DB_ERROR_MEMORY;
+    }
+  }
+  if (status == DB_SUCCESS) {
+    status = db_save(db, destination);
+  }
+
+  db_free(db);
+  return status;
+}
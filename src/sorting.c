@@ -1,40 +1,64 @@
 #include "sorting.h"
 #include "database.h"
+#include "parallel.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 /*
- * sort student records using bubble sort algorithm
- * sorts in-place by modifying the records array
- * stable sort - maintains relative order of equal elements
- */
-static void bubble_sort_records(StudentRecord *records, size_t count,
-                                int (*compare)(const StudentRecord *,
-                                               const StudentRecord *)) {
-  // defensive check
-  if (!records || count == 0 || !compare) {
-    return;
-  }
+ * sorting engine
+ *
+ * every record is reduced to a 64-bit composite key whose unsigned order is
+ * exactly the comparator order (primary field, then id as tie-breaker).
+ * keys are sorted together with their original positions by an LSD radix
+ * sort, which is stable, and the resulting permutation is applied to the
+ * records in place. marks that are exact hundredths are keyed as fixed-point
+ * integers so only a few radix passes are needed. if a mark cannot be keyed
+ * (NaN), a stable merge sort over the comparator functions is used instead.
+ */
 
-  // bubble sort with early termination optimisation
-  for (size_t i = 0; i < count - 1; i++) {
-    int swapped = 0;
+// radix digit width and derived sizes
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1u << RADIX_BITS)
+#define RADIX_PASSES ((64 + RADIX_BITS - 1) / RADIX_BITS)
 
-    for (size_t j = 0; j < count - i - 1; j++) {
-      // compare adjacent elements
-      if (compare(&records[j], &records[j + 1]) > 0) {
-        // swap records
-        StudentRecord temp = records[j];
-        records[j] = records[j + 1];
-        records[j + 1] = temp;
-        swapped = 1;
-      }
-    }
+// below this size insertion sort beats the radix setup cost
+#define SORT_INSERTION_THRESHOLD 48
 
-    // if no swaps occurred, array is sorted
-    if (!swapped) {
-      break;
-    }
-  }
+// key plus original position of the record
+typedef struct {
+  uint64_t key;
+  uint32_t pos;
+} SortItem;
+
+typedef int (*RecordComparator)(const StudentRecord *, const StudentRecord *);
+
+// strided view of the id and mark fields, so keys can be built from either
+// an array of records or contiguous columns
+typedef struct {
+  const char *ids;
+  size_t id_stride;
+  const char *marks;
+  size_t mark_stride;
+} SortColumns;
+
+static int column_id(const SortColumns *cols, size_t i) {
+  int id;
+  memcpy(&id, cols->ids + i * cols->id_stride, sizeof id);
+  return id;
+}
+
+static float column_mark(const SortColumns *cols, size_t i) {
+  float mark;
+  memcpy(&mark, cols->marks + i * cols->mark_stride, sizeof mark);
+  return mark;
+}
+
+static SortColumns record_columns(const StudentRecord *records) {
+  SortColumns cols = {(const char *)&records[0].id, sizeof(StudentRecord),
+                      (const char *)&records[0].mark, sizeof(StudentRecord)};
+  return cols;
 }
 
 /*
@@ -42,10 +66,6 @@ static void bubble_sort_records(StudentRecord *records, size_t count,
  * returns: negative if a < b, zero if a == b, positive if a > b
  */
 static int compare_id_asc(const StudentRecord *a, const StudentRecord *b) {
-  // defensive null checks
-  if (!a || !b)
-    return 0;
-
   // safe comparison - avoid integer overflow from subtraction
   if (a->id < b->id)
     return -1;
@@ -59,11 +79,6 @@ static int compare_id_asc(const StudentRecord *a, const StudentRecord *b) {
  * returns: negative if a > b, zero if a == b, positive if a < b
  */
 static int compare_id_desc(const StudentRecord *a, const StudentRecord *b) {
-  // defensive null checks
-  if (!a || !b)
-    return 0;
-
-  // independent implementation - not just reversed parameter order
   if (a->id > b->id)
     return -1;
   if (a->id < b->id)
@@ -77,22 +92,13 @@ static int compare_id_desc(const StudentRecord *a, const StudentRecord *b) {
  * returns: negative if a < b, zero if a == b, positive if a > b
  */
 static int compare_mark_asc(const StudentRecord *a, const StudentRecord *b) {
-  // defensive null checks
-  if (!a || !b)
-    return 0;
-
-  // safe float comparison - validation ensures marks in [0.0, 100.0]
   if (a->mark < b->mark)
     return -1;
   if (a->mark > b->mark)
     return 1;
 
   // tie-breaker: sort by id when marks are equal (ensures stable sort)
-  if (a->id < b->id)
-    return -1;
-  if (a->id > b->id)
-    return 1;
-  return 0;
+  return compare_id_asc(a, b);
 }
 
 /*
@@ -101,22 +107,448 @@ static int compare_mark_asc(const StudentRecord *a, const StudentRecord *b) {
  * returns: negative if a > b, zero if a == b, positive if a < b
  */
 static int compare_mark_desc(const StudentRecord *a, const StudentRecord *b) {
-  // defensive null checks
-  if (!a || !b)
-    return 0;
-
-  // independent implementation with tie-breaker
   if (a->mark > b->mark)
     return -1;
   if (a->mark < b->mark)
     return 1;
 
   // tie-breaker: sort by id when marks are equal
-  if (a->id < b->id)
-    return -1;
-  if (a->id > b->id)
+  return compare_id_asc(a, b);
+}
+
+static RecordComparator select_comparator(SortField field, SortOrder order) {
+  if (field == SORT_FIELD_ID) {
+    return order == SORT_ORDER_ASC ? compare_id_asc : compare_id_desc;
+  }
+  return order == SORT_ORDER_ASC ? compare_mark_asc : compare_mark_desc;
+}
+
+// map a signed id onto an unsigned value with the same ordering
+static uint32_t id_key(int id) { return (uint32_t)id ^ 0x80000000u; }
+
+// true if the mark is an exact hundredth in [0, 100]
+static int mark_is_fixed_point(float mark) {
+  if (!(mark >= 0.0f && mark <= 100.0f)) {
+    return 0;
+  }
+  uint32_t hundredths = (uint32_t)((double)mark * 100.0 + 0.5);
+  return (float)((double)hundredths / 100.0) == mark;
+}
+
+// order-preserving key for any non-NaN float (-0.0 collapses onto 0.0)
+static uint32_t mark_bits_key(float mark) {
+  if (mark == 0.0f) {
+    mark = 0.0f;
+  }
+  uint32_t bits;
+  memcpy(&bits, &mark, sizeof bits);
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/*
+ * fill items with composite keys for the requested ordering
+ * returns 0 if some mark cannot be keyed (NaN)
+ */
+static int build_keys(const SortColumns *cols, size_t count, SortField field,
+                      SortOrder order, SortItem *items) {
+  if (field == SORT_FIELD_ID) {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t key = id_key(column_id(cols, i));
+      items[i].key = (order == SORT_ORDER_ASC) ? key : (uint32_t)~key;
+      items[i].pos = (uint32_t)i;
+    }
     return 1;
-  return 0;
+  }
+
+  int fixed_point = 1;
+  for (size_t i = 0; i < count; i++) {
+    float mark = column_mark(cols, i);
+    if (mark != mark) {
+      return 0;
+    }
+    if (fixed_point && !mark_is_fixed_point(mark)) {
+      fixed_point = 0;
+    }
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    float mark = column_mark(cols, i);
+    uint32_t mark_key = fixed_point
+                            ? (uint32_t)((double)mark * 100.0 + 0.5)
+                            : mark_bits_key(mark);
+    if (order == SORT_ORDER_DESC) {
+      mark_key = ~mark_key;
+    }
+    // id ascending breaks ties in both directions
+    items[i].key = ((uint64_t)mark_key << 32) | id_key(column_id(cols, i));
+    items[i].pos = (uint32_t)i;
+  }
+  return 1;
+}
+
+// stable insertion sort for short runs
+static void insertion_sort_items(SortItem *items, size_t count) {
+  for (size_t i = 1; i < count; i++) {
+    SortItem current = items[i];
+    size_t j = i;
+    while (j > 0 && items[j - 1].key > current.key) {
+      items[j] = items[j - 1];
+      j--;
+    }
+    items[j] = current;
+  }
+}
+
+/*
+ * stable LSD radix sort of items by key
+ * temp must hold count items; passes where every key shares the same digit
+ * are skipped. returns 0 if the histogram cannot be allocated.
+ */
+static int radix_sort_items(SortItem *items, SortItem *temp, size_t count) {
+  if (count <= SORT_INSERTION_THRESHOLD) {
+    insertion_sort_items(items, count);
+    return 1;
+  }
+
+  size_t *histogram = calloc((size_t)RADIX_PASSES * RADIX_BUCKETS,
+                             sizeof(size_t));
+  if (!histogram) {
+    return 0;
+  }
+
+  // one read pass builds the histograms for every digit
+  for (size_t i = 0; i < count; i++) {
+    uint64_t key = items[i].key;
+    for (unsigned p = 0; p < RADIX_PASSES; p++) {
+      histogram[p * RADIX_BUCKETS +
+                ((key >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+  }
+
+  SortItem *src = items;
+  SortItem *dst = temp;
+
+  for (unsigned p = 0; p < RADIX_PASSES; p++) {
+    size_t *counts = &histogram[p * RADIX_BUCKETS];
+    unsigned shift = p * RADIX_BITS;
+
+    // skip passes where every key lands in the same bucket
+    size_t first_digit = (src[0].key >> shift) & (RADIX_BUCKETS - 1);
+    if (counts[first_digit] == count) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (unsigned b = 0; b < RADIX_BUCKETS; b++) {
+      size_t bucket_size = counts[b];
+      counts[b] = offset;
+      offset += bucket_size;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      size_t digit = (src[i].key >> shift) & (RADIX_BUCKETS - 1);
+      dst[counts[digit]++] = src[i];
+    }
+
+    SortItem *swap = src;
+    src = dst;
+    dst = swap;
+  }
+
+  if (src != items) {
+    memcpy(items, src, count * sizeof(SortItem));
+  }
+
+  free(histogram);
+  return 1;
+}
+
+// stable merge of two sorted runs (left wins ties)
+static void merge_items(const SortItem *left, size_t left_count,
+                        const SortItem *right, size_t right_count,
+                        SortItem *out) {
+  size_t i = 0, j = 0, k = 0;
+  while (i < left_count && j < right_count) {
+    if (right[j].key < left[i].key) {
+      out[k++] = right[j++];
+    } else {
+      out[k++] = left[i++];
+    }
+  }
+  while (i < left_count) {
+    out[k++] = left[i++];
+  }
+  while (j < right_count) {
+    out[k++] = right[j++];
+  }
+}
+
+// per-worker arguments for the parallel radix phase
+typedef struct {
+  SortItem *items;
+  SortItem *temp;
+  size_t count;
+  int ok;
+} RadixChunk;
+
+static void radix_chunk_task(void *arg) {
+  RadixChunk *chunk = arg;
+  chunk->ok = radix_sort_items(chunk->items, chunk->temp, chunk->count);
+}
+
+// per-worker arguments for one pairwise merge
+typedef struct {
+  const SortItem *src;
+  SortItem *dst;
+  size_t start;
+  size_t middle;
+  size_t end;
+} MergeJob;
+
+static void merge_job_task(void *arg) {
+  MergeJob *job = arg;
+  merge_items(job->src + job->start, job->middle - job->start,
+              job->src + job->middle, job->end - job->middle,
+              job->dst + job->start);
+}
+
+/*
+ * radix sorts workers chunks in parallel, then merges them pairwise
+ * (each merge round also runs in parallel)
+ */
+static int parallel_sort_items(SortItem *items, SortItem *temp, size_t count,
+                               size_t workers) {
+  size_t bounds[MAX_WORKER_THREADS + 1];
+  RadixChunk chunks[MAX_WORKER_THREADS];
+
+  for (size_t w = 0; w <= workers; w++) {
+    bounds[w] = count * w / workers;
+  }
+  for (size_t w = 0; w < workers; w++) {
+    chunks[w].items = items + bounds[w];
+    chunks[w].temp = temp + bounds[w];
+    chunks[w].count = bounds[w + 1] - bounds[w];
+    chunks[w].ok = 0;
+  }
+
+  parallel_run(radix_chunk_task, chunks, sizeof(RadixChunk), workers);
+  for (size_t w = 0; w < workers; w++) {
+    if (!chunks[w].ok) {
+      return 0;
+    }
+  }
+
+  SortItem *src = items;
+  SortItem *dst = temp;
+  size_t runs = workers;
+
+  while (runs > 1) {
+    MergeJob jobs[MAX_WORKER_THREADS];
+    size_t job_count = 0;
+    size_t next_runs = 0;
+
+    for (size_t r = 0; r < runs; r += 2) {
+      size_t start = bounds[r];
+      size_t middle = bounds[r + 1];
+      size_t end = (r + 2 <= runs) ? bounds[r + 2] : middle;
+      jobs[job_count].src = src;
+      jobs[job_count].dst = dst;
+      jobs[job_count].start = start;
+      jobs[job_count].middle = middle;
+      jobs[job_count].end = end;
+      job_count++;
+      bounds[next_runs++] = start;
+    }
+    bounds[next_runs] = count;
+
+    parallel_run(merge_job_task, jobs, sizeof(MergeJob), job_count);
+
+    SortItem *swap = src;
+    src = dst;
+    dst = swap;
+    runs = next_runs;
+  }
+
+  if (src != items) {
+    memcpy(items, src, count * sizeof(SortItem));
+  }
+  return 1;
+}
+
+// compare two column positions with the same rules as the record comparators
+static int compare_positions(const SortColumns *cols, size_t a, size_t b,
+                             SortField field, SortOrder order) {
+  int id_a = column_id(cols, a);
+  int id_b = column_id(cols, b);
+  int by_id = (id_a > id_b) - (id_a < id_b);
+
+  if (field == SORT_FIELD_ID) {
+    return order == SORT_ORDER_ASC ? by_id : -by_id;
+  }
+
+  float mark_a = column_mark(cols, a);
+  float mark_b = column_mark(cols, b);
+  int by_mark = (mark_a > mark_b) - (mark_a < mark_b);
+  if (order == SORT_ORDER_DESC) {
+    by_mark = -by_mark;
+  }
+  // id ascending breaks ties in both directions
+  return by_mark != 0 ? by_mark : by_id;
+}
+
+// stable top-down merge sort of positions using the comparator rules
+static void merge_sort_positions(const SortColumns *cols, uint32_t *positions,
+                                 uint32_t *temp, size_t count, SortField field,
+                                 SortOrder order) {
+  if (count < 2) {
+    return;
+  }
+
+  size_t half = count / 2;
+  merge_sort_positions(cols, positions, temp, half, field, order);
+  merge_sort_positions(cols, positions + half, temp, count - half, field,
+                       order);
+
+  size_t i = 0, j = half, k = 0;
+  while (i < half && j < count) {
+    if (compare_positions(cols, positions[j], positions[i], field, order) <
+        0) {
+      temp[k++] = positions[j++];
+    } else {
+      temp[k++] = positions[i++];
+    }
+  }
+  while (i < half) {
+    temp[k++] = positions[i++];
+  }
+  while (j < count) {
+    temp[k++] = positions[j++];
+  }
+  memcpy(positions, temp, count * sizeof(uint32_t));
+}
+
+/**
+ * @brief reorders records so position i holds the record previously at
+ *        positions[i]
+ * @param[in,out] records array of student records to reorder
+ * @param[in,out] perm permutation from sort_permutation (reset to the
+ *                     identity on return)
+ * @param[in] count number of records in the array
+ * @note follows permutation cycles so only one spare record is needed
+ */
+void sort_apply_permutation(StudentRecord *records, uint32_t *perm,
+                            size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (perm[i] == i) {
+      continue;
+    }
+    StudentRecord temp = records[i];
+    size_t j = i;
+    while (perm[j] != i) {
+      size_t next = perm[j];
+      records[j] = records[next];
+      perm[j] = (uint32_t)j;
+      j = next;
+    }
+    records[j] = temp;
+    perm[j] = (uint32_t)j;
+  }
+}
+
+/*
+ * in-place stable insertion sort over records
+ * last resort when the engine's working buffers cannot be allocated
+ */
+static void insertion_sort_records(StudentRecord *records, size_t count,
+                                   RecordComparator compare) {
+  for (size_t i = 1; i < count; i++) {
+    StudentRecord current = records[i];
+    size_t j = i;
+    while (j > 0 && compare(&records[j - 1], &current) > 0) {
+      records[j] = records[j - 1];
+      j--;
+    }
+    records[j] = current;
+  }
+}
+
+/*
+ * compute the sorted order of records without moving them
+ * perm[i] receives the position of the record that sorts i-th
+ * returns 0 on allocation failure
+ */
+static int build_permutation(const SortColumns *cols, size_t count,
+                             SortField field, SortOrder order, size_t workers,
+                             uint32_t *perm) {
+  SortItem *items = malloc(count * sizeof(SortItem));
+  SortItem *temp = malloc(count * sizeof(SortItem));
+  if (!items || !temp) {
+    free(items);
+    free(temp);
+    return 0;
+  }
+
+  int ok;
+  if (build_keys(cols, count, field, order, items)) {
+    ok = (workers > 1) ? parallel_sort_items(items, temp, count, workers)
+                       : radix_sort_items(items, temp, count);
+    if (ok) {
+      for (size_t i = 0; i < count; i++) {
+        perm[i] = items[i].pos;
+      }
+    }
+  } else {
+    // general fallback: comparator-driven merge sort
+    for (size_t i = 0; i < count; i++) {
+      perm[i] = (uint32_t)i;
+    }
+    merge_sort_positions(cols, perm, (uint32_t *)temp, count, field, order);
+    ok = 1;
+  }
+
+  free(items);
+  free(temp);
+  return ok;
+}
+
+/**
+ * @brief sorts student records with an explicit number of worker threads
+ * @param[in,out] records array of student records to sort (modified in-place)
+ * @param[in] count number of records in the array
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @param[in] workers number of worker threads (1 sorts on the calling thread)
+ * @note stable; equal keys keep their original relative order
+ */
+void sort_records_parallel(StudentRecord *records, size_t count,
+                           SortField field, SortOrder order, size_t workers) {
+  // defensive checks
+  if (!records || count < 2) {
+    return;
+  }
+
+  if (workers < 1) {
+    workers = 1;
+  }
+  if (workers > MAX_WORKER_THREADS) {
+    workers = MAX_WORKER_THREADS;
+  }
+
+  uint32_t *perm = NULL;
+  if (count < UINT32_MAX) {
+    perm = malloc(count * sizeof(uint32_t));
+  }
+
+  SortColumns cols = record_columns(records);
+  if (!perm ||
+      !build_permutation(&cols, count, field, order, workers, perm)) {
+    free(perm);
+    insertion_sort_records(records, count, select_comparator(field, order));
+    return;
+  }
+
+  sort_apply_permutation(records, perm, count);
+  free(perm);
 }
 
 /**
@@ -125,30 +557,89 @@ static int compare_mark_desc(const StudentRecord *a, const StudentRecord *b) {
  * @param[in] count number of records in the array
  * @param[in] field field to sort by (ID or mark)
  * @param[in] order sort order (ascending or descending)
- * @note uses stable bubble sort algorithm
+ * @note stable; tables above SORT_PARALLEL_THRESHOLD use worker threads
  */
 void sort_records(StudentRecord *records, size_t count, SortField field,
                   SortOrder order) {
-  // defensive checks
-  if (!records || count == 0) {
-    return;
+  size_t workers = 1;
+  if (count >= SORT_PARALLEL_THRESHOLD) {
+    workers = parallel_worker_count(count, SORT_PARALLEL_THRESHOLD / 2);
   }
+  sort_records_parallel(records, count, field, order, workers);
+}
 
-  // select appropriate comparator based on field and order
-  int (*comparator)(const StudentRecord *, const StudentRecord *) = NULL;
+// shared body of the public permutation builders
+static bool permutation_from_columns(const SortColumns *cols, size_t count,
+                                     SortField field, SortOrder order,
+                                     uint32_t *positions) {
+  if (!positions || count >= UINT32_MAX) {
+    return false;
+  }
+  if (count < 2) {
+    if (count == 1) {
+      positions[0] = 0;
+    }
+    return true;
+  }
 
-  if (field == SORT_FIELD_ID && order == SORT_ORDER_ASC) {
-    comparator = compare_id_asc;
-  } else if (field == SORT_FIELD_ID && order == SORT_ORDER_DESC) {
-    comparator = compare_id_desc;
-  } else if (field == SORT_FIELD_MARK && order == SORT_ORDER_ASC) {
-    comparator = compare_mark_asc;
-  } else if (field == SORT_FIELD_MARK && order == SORT_ORDER_DESC) {
-    comparator = compare_mark_desc;
+  size_t workers = 1;
+  if (count >= SORT_PARALLEL_THRESHOLD) {
+    workers = parallel_worker_count(count, SORT_PARALLEL_THRESHOLD / 2);
   }
+  return build_permutation(cols, count, field, order, workers, positions) != 0;
+}
 
-  // perform bubble sort using selected comparator
-  if (comparator) {
-    bubble_sort_records(records, count, comparator);
+/**
+ * @brief computes the sorted order of records without moving them
+ * @param[in] records array of student records
+ * @param[in] count number of records in the array
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @param[out] positions receives count entries; positions[i] is the index of
+ *                       the record that sorts i-th
+ * @return true on success, false if working memory cannot be allocated
+ */
+bool sort_permutation(const StudentRecord *records, size_t count,
+                      SortField field, SortOrder order, uint32_t *positions) {
+  if (!records) {
+    return false;
   }
+  SortColumns cols = record_columns(records);
+  return permutation_from_columns(&cols, count, field, order, positions);
+}
+
+/**
+ * @brief computes the sorted order of contiguous id and mark columns
+ * @param[in] ids array of count student ids
+ * @param[in] marks array of count marks
+ * @param[in] count number of entries in each column
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @param[out] positions receives count entries; positions[i] is the index of
+ *                       the entry that sorts i-th
+ * @return true on success, false if working memory cannot be allocated
+ */
+bool sort_permutation_columns(const int *ids, const float *marks,
+                              size_t count, SortField field, SortOrder order,
+                              uint32_t *positions) {
+  if (!ids || !marks) {
+    return false;
+  }
+  SortColumns cols = {(const char *)ids, sizeof(int), (const char *)marks,
+                      sizeof(float)};
+  return permutation_from_columns(&cols, count, field, order, positions);
+}
+
+/**
+ * @brief compares two records in the order used by the sorting engine
+ * @param[in] a first record
+ * @param[in] b second record
+ * @param[in] field field to sort by (ID or mark)
+ * @param[in] order sort order (ascending or descending)
+ * @return negative if a sorts first, positive if b sorts first, 0 if equal
+ * @note marks are tie-broken by ascending id in both orders
+ */
+int sort_compare_records(const StudentRecord *a, const StudentRecord *b,
+                         SortField field, SortOrder order) {
+  return select_comparator(field, order)(a, b);
 }
@@ -1,7 +1,29 @@
 #include "statistics.h"
 #include "database.h"
+#include "mark_kernels.h"
 #include <string.h>
 
+// end of the run of live slots starting at a live position
+static size_t live_run_end(const StudentTable *table, size_t start) {
+  if (table->tombstone_count == 0) {
+    return table->slot_count;
+  }
+  size_t end = start;
+  while (end < table->slot_count) {
+    uint64_t dead = table->tombstones[end / 64] >> (end % 64);
+    if (dead == 0) {
+      end += 64 - end % 64; // no deletes in the rest of this word
+      continue;
+    }
+    while (!(dead & 1u)) {
+      dead >>= 1;
+      end++;
+    }
+    break;
+  }
+  return end < table->slot_count ? end : table->slot_count;
+}
+
 /**
  * @brief calculates summary statistics for all student records in a table
  * @param[in] table pointer to student table (must not be NULL)
@@ -13,6 +35,8 @@
  * @note uses double precision for accumulation to prevent overflow with large datasets
  * @note tie-breaking policy: when multiple students share the same highest or
  *       lowest mark, the first occurrence in the table is reported
+ * @note in column layout the marks are reduced with the vector kernels of
+ *       mark_kernels.h, which may add them in a different order
  */
 DBStatus calculate_statistics(StudentTable *table, StudentStatistics *stats) {
   // defensive null pointer checks
@@ -25,54 +49,95 @@ DBStatus calculate_statistics(StudentTable *table, StudentStatistics *stats) {
     return DB_ERROR_INVALID_DATA;
   }
 
-  // validate records array exists
-  if (!table->records) {
+  // validate record storage exists
+  if (table->layout == TABLE_LAYOUT_ROWS && !table->records) {
     return DB_ERROR_INVALID_DATA;
   }
 
   // initialise total count
   stats->total_count = table->record_count;
 
-  // initialise with first record's values
-  // this ensures first occurrence is selected in case of ties
-  stats->highest_mark = table->records[0].mark;
-  stats->lowest_mark = table->records[0].mark;
-  stats->highest_student_id = table->records[0].id;
-  stats->lowest_student_id = table->records[0].id;
-
-  // safely copy names with explicit null termination
-  strncpy(stats->highest_student_name, table->records[0].name, 49);
-  stats->highest_student_name[49] = '\0';
-  strncpy(stats->lowest_student_name, table->records[0].name, 49);
-  stats->lowest_student_name[49] = '\0';
-
+  size_t highest = 0;
+  size_t lowest = 0;
+  float highest_mark = 0.0f;
+  float lowest_mark = 0.0f;
   // use double for accumulation to prevent overflow with large datasets
-  double sum = (double)table->records[0].mark;
+  double sum = 0.0;
 
-  // iterate through remaining records to find max, min, and accumulate sum
-  for (size_t i = 1; i < table->record_count; i++) {
-    float current_mark = table->records[i].mark;
+  if (table->layout == TABLE_LAYOUT_COLUMNS) {
+    // marks are a contiguous array: reduce each run of live slots with the
+    // vector kernels, keeping the first run to reach each extreme
+    bool found = false;
+    size_t start = 0;
+    while (start < table->slot_count) {
+      if (!table_is_live(table, start)) {
+        start++;
+        continue;
+      }
+      size_t end = live_run_end(table, start);
+      MarkSummary run;
+      mark_kernel_summarise(table->columns.marks + start, end - start, &run);
+      sum += run.sum;
+      if (!found || run.max > highest_mark) {
+        highest_mark = run.max;
+        highest = start + run.max_index;
+      }
+      if (!found || run.min < lowest_mark) {
+        lowest_mark = run.min;
+        lowest = start + run.min_index;
+      }
+      found = true;
+      start = end;
+    }
+  } else {
+    // initialise with first live record's values
+    // this ensures first occurrence is selected in case of ties
+    size_t first = 0;
+    while (!table_is_live(table, first)) {
+      first++;
+    }
+    highest = first;
+    lowest = first;
+    highest_mark = table->records[first].mark;
+    lowest_mark = highest_mark;
+    sum = (double)highest_mark;
 
-    // accumulate sum for average calculation
-    sum += (double)current_mark;
+    // iterate through remaining slots to find max, min, and accumulate sum,
+    // skipping deleted records
+    for (size_t i = first + 1; i < table->slot_count; i++) {
+      if (!table_is_live(table, i)) {
+        continue;
+      }
+      float current_mark = table->records[i].mark;
 
-    // update highest if strictly greater (first occurrence for ties)
-    if (current_mark > stats->highest_mark) {
-      stats->highest_mark = current_mark;
-      stats->highest_student_id = table->records[i].id;
-      strncpy(stats->highest_student_name, table->records[i].name, 49);
-      stats->highest_student_name[49] = '\0';
-    }
+      // accumulate sum for average calculation
+      sum += (double)current_mark;
+
+      // update highest if strictly greater (first occurrence for ties)
+      if (current_mark > highest_mark) {
+        highest_mark = current_mark;
+        highest = i;
+      }
 
-    // update lowest if strictly less (first occurrence for ties)
-    if (current_mark < stats->lowest_mark) {
-      stats->lowest_mark = current_mark;
-      stats->lowest_student_id = table->records[i].id;
-      strncpy(stats->lowest_student_name, table->records[i].name, 49);
-      stats->lowest_student_name[49] = '\0';
+      // update lowest if strictly less (first occurrence for ties)
+      if (current_mark < lowest_mark) {
+        lowest_mark = current_mark;
+        lowest = i;
+      }
     }
   }
 
+  stats->highest_mark = highest_mark;
+  stats->lowest_mark = lowest_mark;
+  stats->highest_student_id = table_record_id(table, highest);
+  stats->lowest_student_id = table_record_id(table, lowest);
+
+  // safely copy names with explicit null termination
+  strncpy(stats->highest_student_name, table_record_name(table, highest), 49);
+  stats->highest_student_name[49] = '\0';
+  strncpy(stats->lowest_student_name, table_record_name(table, lowest), 49);
+  stats->lowest_student_name[49] = '\0';
+
   // calculate average mark
   stats->average_mark = (float)(sum / table->record_count);
 
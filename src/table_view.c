@@ -0,0 +1,590 @@
+#include "table_view.h"
+#include "sorting.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of position arrays backing the views
+#define VIEW_ARRAY_COUNT 3
+
+// ordering kept by each position array
+typedef struct {
+  SortField field;
+  SortOrder order;
+} ViewOrder;
+
+static const ViewOrder VIEW_ORDERS[VIEW_ARRAY_COUNT] = {
+    {SORT_FIELD_ID, SORT_ORDER_ASC},
+    {SORT_FIELD_MARK, SORT_ORDER_ASC},
+    {SORT_FIELD_MARK, SORT_ORDER_DESC},
+};
+
+// address of the i-th position array
+static uint32_t **view_array(SortedViews *views, size_t i) {
+  switch (i) {
+  case 0:
+    return &views->by_id;
+  case 1:
+    return &views->by_mark_asc;
+  default:
+    return &views->by_mark_desc;
+  }
+}
+
+// compare the records at two positions in a view's order (same rules as
+// the sorting engine: id ascending breaks mark ties in both directions)
+static int compare_positions(const StudentTable *table, size_t a, size_t b,
+                             const ViewOrder *order) {
+  int id_a = table_record_id(table, a);
+  int id_b = table_record_id(table, b);
+  int by_id = (id_a > id_b) - (id_a < id_b);
+
+  if (order->field == SORT_FIELD_ID) {
+    return order->order == SORT_ORDER_ASC ? by_id : -by_id;
+  }
+
+  float mark_a = table_record_mark(table, a);
+  float mark_b = table_record_mark(table, b);
+  int by_mark = (mark_a > mark_b) - (mark_a < mark_b);
+  if (order->order == SORT_ORDER_DESC) {
+    by_mark = -by_mark;
+  }
+  return by_mark != 0 ? by_mark : by_id;
+}
+
+// first rank in array (of n entries) whose record does not sort before the
+// record at position probe
+static size_t lower_bound(const StudentTable *table, const uint32_t *array,
+                          size_t n, size_t probe, const ViewOrder *order) {
+  size_t lo = 0;
+  size_t hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (compare_positions(table, array[mid], probe, order) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// rank of position in array, searching by key first and scanning as a
+// fallback; returns n if the position is missing
+static size_t find_rank(const StudentTable *table, const uint32_t *array,
+                        size_t n, size_t position, const ViewOrder *order) {
+  size_t rank = lower_bound(table, array, n, position, order);
+  if (rank < n && array[rank] == position) {
+    return rank;
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (array[i] == position) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// drop tombstoned positions from a sorted array of slot_count positions,
+// leaving the record_count live ones in order
+static void remove_dead_positions(const StudentTable *table, uint32_t *array) {
+  if (table->tombstone_count == 0) {
+    return;
+  }
+  size_t kept = 0;
+  for (size_t rank = 0; rank < table->slot_count; rank++) {
+    if (table_is_live(table, array[rank])) {
+      array[kept++] = array[rank];
+    }
+  }
+}
+
+/**
+ * @brief initialises empty, unbuilt views in storage order
+ * @param[out] table pointer to the table whose views to initialise
+ */
+void table_views_init(StudentTable *table) {
+  if (!table) {
+    return;
+  }
+  table->views.by_id = NULL;
+  table->views.by_mark_asc = NULL;
+  table->views.by_mark_desc = NULL;
+  table->views.capacity = 0;
+  table->views.built = false;
+  table->active_view = TABLE_VIEW_STORAGE;
+}
+
+/**
+ * @brief frees the memory held by a table's views
+ * @param[in,out] table pointer to the table (can be NULL)
+ */
+void table_views_free(StudentTable *table) {
+  if (!table) {
+    return;
+  }
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    free(*view_array(&table->views, i));
+  }
+  table_views_init(table);
+}
+
+/**
+ * @brief builds (or rebuilds) every sorted view from the table's records
+ * @param[in,out] table pointer to the table
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ */
+DBStatus table_views_build(StudentTable *table) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+
+  size_t capacity = table->record_capacity > 0 ? table->record_capacity : 1;
+  if (capacity >= UINT32_MAX) {
+    return DB_ERROR_MEMORY;
+  }
+
+  uint32_t *arrays[VIEW_ARRAY_COUNT] = {NULL};
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    arrays[i] = malloc(capacity * sizeof(uint32_t));
+    bool sorted = false;
+    if (arrays[i] && table->layout == TABLE_LAYOUT_COLUMNS) {
+      sorted = sort_permutation_columns(
+          table->columns.ids, table->columns.marks, table->slot_count,
+          VIEW_ORDERS[i].field, VIEW_ORDERS[i].order, arrays[i]);
+    } else if (arrays[i]) {
+      sorted = sort_permutation(table->records, table->slot_count,
+                                VIEW_ORDERS[i].field, VIEW_ORDERS[i].order,
+                                arrays[i]);
+    }
+    if (!sorted) {
+      for (size_t j = 0; j <= i; j++) {
+        free(arrays[j]);
+      }
+      return DB_ERROR_MEMORY;
+    }
+    remove_dead_positions(table, arrays[i]);
+  }
+
+  TableView active = table->active_view;
+  table_views_free(table);
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    *view_array(&table->views, i) = arrays[i];
+  }
+  table->views.capacity = capacity;
+  table->views.built = true;
+  table->active_view = active;
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief returns a short description of a view ("mark descending" etc.)
+ * @param[in] view the view to describe
+ * @return pointer to a static string
+ */
+const char *table_view_name(TableView view) {
+  switch (view) {
+  case TABLE_VIEW_STORAGE:
+    return "stored order";
+  case TABLE_VIEW_ID_ASC:
+    return "ID ascending";
+  case TABLE_VIEW_ID_DESC:
+    return "ID descending";
+  case TABLE_VIEW_MARK_ASC:
+    return "mark ascending";
+  case TABLE_VIEW_MARK_DESC:
+    return "mark descending";
+  default:
+    return "unknown order";
+  }
+}
+
+/**
+ * @brief selects the order used to display and save the table
+ * @param[in,out] table pointer to the table
+ * @param[in] view order to switch to (views are built on first use)
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if the views cannot be built
+ * @note records are never moved; this is a constant-time switch once built
+ */
+DBStatus table_set_view(StudentTable *table, TableView view) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (view < TABLE_VIEW_STORAGE || view > TABLE_VIEW_MARK_DESC) {
+    return DB_ERROR_INVALID_DATA;
+  }
+
+  if (view != TABLE_VIEW_STORAGE && !table->views.built) {
+    DBStatus status = table_views_build(table);
+    if (status != DB_SUCCESS) {
+      return status;
+    }
+  }
+
+  if (table->active_view != view) {
+    table->active_view = view;
+    table->mutations++; // query results follow the view's order
+  }
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief maps a rank within a view to a record position
+ * @param[in] table pointer to the table
+ * @param[in] view view to read (must be built unless TABLE_VIEW_STORAGE)
+ * @param[in] rank zero-based rank within the view
+ * @return record position, TABLE_VIEW_NOT_FOUND if rank is out of range or
+ *         the view has not been built
+ */
+size_t table_view_position(const StudentTable *table, TableView view,
+                           size_t rank) {
+  if (!table || rank >= table->record_count) {
+    return TABLE_VIEW_NOT_FOUND;
+  }
+  if (view == TABLE_VIEW_STORAGE) {
+    if (table->tombstone_count == 0) {
+      return rank;
+    }
+    // skip tombstones to find the rank-th live slot
+    for (size_t position = 0; position < table->slot_count; position++) {
+      if (table_is_live(table, position) && rank-- == 0) {
+        return position;
+      }
+    }
+    return TABLE_VIEW_NOT_FOUND;
+  }
+  if (!table->views.built) {
+    return TABLE_VIEW_NOT_FOUND;
+  }
+
+  switch (view) {
+  case TABLE_VIEW_ID_ASC:
+    return table->views.by_id[rank];
+  case TABLE_VIEW_ID_DESC:
+    return table->views.by_id[table->record_count - 1 - rank];
+  case TABLE_VIEW_MARK_ASC:
+    return table->views.by_mark_asc[rank];
+  case TABLE_VIEW_MARK_DESC:
+    return table->views.by_mark_desc[rank];
+  default:
+    return TABLE_VIEW_NOT_FOUND;
+  }
+}
+
+/**
+ * @brief returns the position of the record at a given rank of the active
+ *        view
+ * @param[in] table pointer to the table
+ * @param[in] rank zero-based rank (0 .. record_count - 1)
+ * @return record position, TABLE_VIEW_NOT_FOUND if rank is out of range
+ */
+size_t table_view_at(const StudentTable *table, size_t rank) {
+  if (!table) {
+    return TABLE_VIEW_NOT_FOUND;
+  }
+  return table_view_position(table, table->active_view, rank);
+}
+
+/**
+ * @brief returns the next record position of the active view, for scanning
+ *        every live record in display order
+ * @param[in] table pointer to the table
+ * @param[in,out] cursor iteration state; start at 0
+ * @return record position, TABLE_VIEW_NOT_FOUND once every record was
+ *         returned
+ * @note tombstones are skipped; each call is O(1) amortised, unlike
+ *       table_view_at which must count live slots in stored order
+ */
+size_t table_view_next(const StudentTable *table, size_t *cursor) {
+  if (!table || !cursor) {
+    return TABLE_VIEW_NOT_FOUND;
+  }
+
+  if (table->active_view == TABLE_VIEW_STORAGE) {
+    // the cursor is a slot position
+    while (*cursor < table->slot_count) {
+      size_t position = (*cursor)++;
+      if (table_is_live(table, position)) {
+        return position;
+      }
+    }
+    return TABLE_VIEW_NOT_FOUND;
+  }
+
+  // the cursor is a rank within the sorted view
+  size_t position = table_view_position(table, table->active_view, *cursor);
+  if (position != TABLE_VIEW_NOT_FOUND) {
+    (*cursor)++;
+  }
+  return position;
+}
+
+/**
+ * @brief returns the cursor value table_view_next reaches once it has
+ *        returned every record of the active view
+ * @param[in] table pointer to the table
+ * @return end of the cursor range: the slot count in stored order, the
+ *         record count in a sorted view
+ * @note scanning from one cursor value until the cursor passes a later one
+ *       visits a contiguous run of the view, so disjoint cursor ranges can
+ *       be scanned on separate threads
+ */
+size_t table_view_cursor_end(const StudentTable *table) {
+  if (!table) {
+    return 0;
+  }
+  return table->active_view == TABLE_VIEW_STORAGE ? table->slot_count
+                                                  : table->record_count;
+}
+
+/**
+ * @brief finds the ranks of ids within [min_id, max_id] in TABLE_VIEW_ID_ASC
+ * @param[in,out] table pointer to the table (views are built if needed)
+ * @param[in] min_id smallest id to include
+ * @param[in] max_id largest id to include
+ * @param[out] first rank of the first matching record
+ * @param[out] end rank one past the last matching record
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ */
+DBStatus table_id_range(StudentTable *table, int min_id, int max_id,
+                        size_t *first, size_t *end) {
+  if (!table || !first || !end) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (!table->views.built) {
+    DBStatus status = table_views_build(table);
+    if (status != DB_SUCCESS) {
+      return status;
+    }
+  }
+
+  const uint32_t *by_id = table->views.by_id;
+  size_t n = table->record_count;
+
+  // first rank with id >= min_id
+  size_t lo = 0, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (table_record_id(table, by_id[mid]) < min_id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *first = lo;
+
+  // first rank with id > max_id
+  hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (table_record_id(table, by_id[mid]) <= max_id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *end = lo;
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief finds the ranks of marks within [min_mark, max_mark] in
+ *        TABLE_VIEW_MARK_ASC
+ * @param[in,out] table pointer to the table (views are built if needed)
+ * @param[in] min_mark smallest mark to include
+ * @param[in] max_mark largest mark to include
+ * @param[out] first rank of the first matching record
+ * @param[out] end rank one past the last matching record
+ * @return DB_SUCCESS on success, appropriate error code on failure
+ */
+DBStatus table_mark_range(StudentTable *table, float min_mark, float max_mark,
+                          size_t *first, size_t *end) {
+  if (!table || !first || !end) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (!table->views.built) {
+    DBStatus status = table_views_build(table);
+    if (status != DB_SUCCESS) {
+      return status;
+    }
+  }
+
+  const uint32_t *by_mark = table->views.by_mark_asc;
+  size_t n = table->record_count;
+
+  // first rank with mark >= min_mark
+  size_t lo = 0, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (table_record_mark(table, by_mark[mid]) < min_mark) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *first = lo;
+
+  // first rank with mark > max_mark
+  hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (table_record_mark(table, by_mark[mid]) <= max_mark) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *end = lo > *first ? lo : *first;
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief physically reorders the records to match the active view
+ * @param[in,out] table pointer to the table
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if allocation fails
+ * @note afterwards storage order equals the former view and the active view
+ *       returns to TABLE_VIEW_STORAGE; the id index and views are rebuilt
+ */
+DBStatus table_compact(StudentTable *table) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (table->active_view == TABLE_VIEW_STORAGE || table->record_count < 2) {
+    table->active_view = TABLE_VIEW_STORAGE;
+    return DB_SUCCESS;
+  }
+
+  // deleted slots go first so positions and ranks cover the same records
+  if (table_purge_tombstones(table) != DB_SUCCESS) {
+    return DB_ERROR_MEMORY;
+  }
+
+  size_t n = table->record_count;
+  // the codes are gathered on the heap and copied back, so the table keeps
+  // its own array rather than taking new arena memory
+  uint32_t *perm = malloc(n * sizeof(uint32_t));
+  uint32_t *codes = malloc(n * sizeof(uint32_t));
+  if (!perm || !codes) {
+    free(perm);
+    free(codes);
+    return DB_ERROR_MEMORY;
+  }
+
+  for (size_t rank = 0; rank < n; rank++) {
+    perm[rank] = (uint32_t)table_view_position(table, table->active_view, rank);
+    codes[rank] = table->prog_codes[perm[rank]];
+  }
+
+  if (table->layout == TABLE_LAYOUT_COLUMNS) {
+    if (!column_store_permute(&table->columns, perm, n)) {
+      free(perm);
+      free(codes);
+      return DB_ERROR_MEMORY;
+    }
+  } else {
+    sort_apply_permutation(table->records, perm, n);
+  }
+  free(perm);
+  memcpy(table->prog_codes, codes, n * sizeof(uint32_t));
+  free(codes);
+
+  // every position moves, so the id index, folded names and views are
+  // rebuilt in one pass; the views break ties by position, which a remap of
+  // the old arrays would not
+  table->active_view = TABLE_VIEW_STORAGE;
+  return table_rebuild_index(table);
+}
+
+/**
+ * @brief grows view storage so it can hold capacity records
+ * @param[in,out] table pointer to the table
+ * @param[in] capacity number of records the views must be able to hold
+ * @return DB_SUCCESS on success, DB_ERROR_MEMORY if reallocation fails
+ * @note no-op while the views are unbuilt
+ */
+DBStatus table_views_reserve(StudentTable *table, size_t capacity) {
+  if (!table) {
+    return DB_ERROR_NULL_POINTER;
+  }
+  if (!table->views.built || capacity <= table->views.capacity) {
+    return DB_SUCCESS;
+  }
+
+  // arrays already grown stay valid at the larger size if a later one fails
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    uint32_t **array = view_array(&table->views, i);
+    uint32_t *temp = realloc(*array, capacity * sizeof(uint32_t));
+    if (!temp) {
+      return DB_ERROR_MEMORY;
+    }
+    *array = temp;
+  }
+  table->views.capacity = capacity;
+
+  return DB_SUCCESS;
+}
+
+/**
+ * @brief inserts the record at position into every view
+ * @param[in,out] table pointer to the table
+ * @param[in] position record position (already counted in record_count)
+ * @note views must hold record_count - 1 entries; no-op while unbuilt
+ */
+void table_views_link(StudentTable *table, size_t position) {
+  if (!table || !table->views.built || table->record_count == 0) {
+    return;
+  }
+
+  size_t n = table->record_count - 1;
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    uint32_t *array = *view_array(&table->views, i);
+    size_t rank = lower_bound(table, array, n, position, &VIEW_ORDERS[i]);
+    memmove(&array[rank + 1], &array[rank], (n - rank) * sizeof(uint32_t));
+    array[rank] = (uint32_t)position;
+  }
+}
+
+/**
+ * @brief removes the record at position from every view
+ * @param[in,out] table pointer to the table
+ * @param[in] position record position (still counted in record_count)
+ * @note views then hold record_count - 1 entries; no-op while unbuilt
+ */
+void table_views_unlink(StudentTable *table, size_t position) {
+  if (!table || !table->views.built || table->record_count == 0) {
+    return;
+  }
+
+  size_t n = table->record_count;
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    uint32_t *array = *view_array(&table->views, i);
+    size_t rank = find_rank(table, array, n, position, &VIEW_ORDERS[i]);
+    if (rank < n) {
+      memmove(&array[rank], &array[rank + 1],
+              (n - rank - 1) * sizeof(uint32_t));
+    }
+  }
+}
+
+/**
+ * @brief rewrites every view entry p as new_position[p] after records were
+ *        moved without changing their relative order within each view
+ * @param[in,out] table pointer to the table
+ * @param[in] new_position new position of each old position
+ * @note no-op while unbuilt
+ */
+void table_views_remap(StudentTable *table, const uint32_t *new_position) {
+  if (!table || !new_position || !table->views.built) {
+    return;
+  }
+
+  for (size_t i = 0; i < VIEW_ARRAY_COUNT; i++) {
+    uint32_t *array = *view_array(&table->views, i);
+    for (size_t rank = 0; rank < table->record_count; rank++) {
+      array[rank] = new_position[array[rank]];
+    }
+  }
+}
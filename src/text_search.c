@@ -0,0 +1,301 @@
+#include "text_search.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define TEXT_SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// lowercase an ASCII letter; every other byte is left alone
+static inline char fold(char c) {
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// copy size bytes of src to dst, folding each one
+static void fold_copy(char *dst, const char *src, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    dst[i] = fold(src[i]);
+  }
+}
+
+/**
+ * @brief initialises an empty folded text (no memory is allocated)
+ * @param[out] folded pointer to the folded text to initialise
+ * @note it allocates from the heap until its arena field is set
+ */
+void folded_text_init(FoldedText *folded) {
+  if (!folded) {
+    return;
+  }
+  memset(folded, 0, sizeof *folded);
+}
+
+/**
+ * @brief frees all memory held by a folded text
+ * @param[in,out] folded pointer to the folded text to free (can be NULL)
+ * @note keeps its arena, as column_store_free does
+ */
+void folded_text_free(FoldedText *folded) {
+  if (!folded) {
+    return;
+  }
+  Arena *arena = folded->arena;
+  arena_release(arena, folded->offsets);
+  arena_release(arena, folded->text.data);
+  folded_text_init(folded);
+  folded->arena = arena;
+}
+
+/**
+ * @brief grows the offsets so they cover at least positions entries
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] positions number of positions required
+ * @return true on success, false if memory allocation fails
+ */
+bool folded_text_reserve(FoldedText *folded, size_t positions) {
+  if (!folded) {
+    return false;
+  }
+  if (positions <= folded->capacity) {
+    return true;
+  }
+  uint32_t *offsets = arena_resize(folded->arena, folded->offsets,
+                                   folded->capacity * sizeof(uint32_t),
+                                   positions * sizeof(uint32_t));
+  if (!offsets) {
+    return false;
+  }
+  folded->offsets = offsets;
+  folded->capacity = positions;
+  return true;
+}
+
+/**
+ * @brief ensures a string of length bytes can be stored without the pool
+ *        growing
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] length string length, excluding the terminator
+ * @return true on success, false if memory allocation fails
+ * @note lets a caller make room before changing anything else, so the
+ *       following folded_text_append or folded_text_replace cannot fail
+ */
+bool folded_text_reserve_text(FoldedText *folded, size_t length) {
+  if (!folded) {
+    return false;
+  }
+  return string_pool_reserve(folded->arena, &folded->text,
+                             length + 1 + FOLDED_TEXT_PADDING);
+}
+
+/**
+ * @brief stores the folded copy of text for a new position
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] position position to set (below the reserved capacity)
+ * @param[in] text original string
+ * @return true on success, false if the pool cannot grow
+ */
+bool folded_text_append(FoldedText *folded, size_t position,
+                        const char *text) {
+  if (!folded || !text || position >= folded->capacity) {
+    return false;
+  }
+  StringPool *pool = &folded->text;
+  size_t size = strlen(text) + 1;
+  if (!folded_text_reserve_text(folded, size - 1)) {
+    return false;
+  }
+  fold_copy(pool->data + pool->used, text, size);
+  folded->offsets[position] = (uint32_t)pool->used;
+  pool->used += size;
+  return true;
+}
+
+/**
+ * @brief replaces the folded copy stored for an existing position
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] position position already set
+ * @param[in] text new original string
+ * @return true on success, false if the pool cannot grow (the old copy
+ *         stays)
+ * @note a string that fits is overwritten in place; a longer one is appended
+ */
+bool folded_text_replace(FoldedText *folded, size_t position,
+                         const char *text) {
+  if (!folded || !text || position >= folded->capacity) {
+    return false;
+  }
+  StringPool *pool = &folded->text;
+  char *current = pool->data + folded->offsets[position];
+  size_t old_size = strlen(current) + 1;
+  size_t new_size = strlen(text) + 1;
+  if (new_size <= old_size) {
+    fold_copy(current, text, new_size);
+    pool->dead += old_size - new_size;
+    return true;
+  }
+
+  if (!folded_text_append(folded, position, text)) {
+    return false;
+  }
+  pool->dead += old_size;
+  return true;
+}
+
+/**
+ * @brief copies the entry of position src over position dst
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] dst position to overwrite
+ * @param[in] src position to copy
+ * @note the overwritten string stays in the pool until folded_text_compact
+ */
+void folded_text_move(FoldedText *folded, size_t dst, size_t src) {
+  if (!folded || dst >= folded->capacity || src >= folded->capacity) {
+    return;
+  }
+  folded->offsets[dst] = folded->offsets[src];
+}
+
+/**
+ * @brief rewrites the pool so it holds only the strings of positions below
+ *        count
+ * @param[in,out] folded pointer to the folded text
+ * @param[in] count number of positions in use
+ * @return true on success, false if memory allocation fails (nothing is
+ *         lost; dead strings just stay)
+ */
+bool folded_text_compact(FoldedText *folded, size_t count) {
+  if (!folded) {
+    return false;
+  }
+  if (!folded->text.data) {
+    return true;
+  }
+  return string_pool_compact(folded->arena, &folded->text, folded->offsets,
+                             count, FOLDED_TEXT_PADDING);
+}
+
+/**
+ * @brief folds a pattern once for repeated searches
+ * @param[out] needle pointer to the needle to prepare
+ * @param[in] pattern pattern to search for
+ * @return true on success, false if pattern is NULL or empty or memory
+ *         allocation fails
+ */
+bool text_needle_init(TextNeedle *needle, const char *pattern) {
+  if (!needle) {
+    return false;
+  }
+  needle->text = NULL;
+  needle->length = 0;
+  if (!pattern || *pattern == '\0') {
+    return false;
+  }
+
+  size_t size = strlen(pattern) + 1;
+  needle->text = malloc(size);
+  if (!needle->text) {
+    return false;
+  }
+  fold_copy(needle->text, pattern, size);
+  needle->length = size - 1;
+  return true;
+}
+
+/**
+ * @brief frees the folded copy held by a needle
+ * @param[in,out] needle pointer to the needle (can be NULL)
+ */
+void text_needle_free(TextNeedle *needle) {
+  if (!needle) {
+    return;
+  }
+  free(needle->text);
+  needle->text = NULL;
+  needle->length = 0;
+}
+
+#ifdef TEXT_SEARCH_SSE2
+// compare the needle's first byte with 16 positions of the text and its last
+// byte with the 16 positions m - 1 further on; only positions where both
+// agree are verified. the block holding the terminator bounds the string, so
+// its length is never computed separately. reads reach at most
+// TEXT_NEEDLE_MAX + 14 bytes past the terminator
+static bool find_sse2(const TextNeedle *needle, const char *folded) {
+  size_t m = needle->length;
+  const __m128i first = _mm_set1_epi8(needle->text[0]);
+  const __m128i last = _mm_set1_epi8(needle->text[m - 1]);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (size_t k = 0;; k += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)(folded + k));
+    __m128i tail = _mm_loadu_si128((const __m128i *)(folded + k + m - 1));
+    unsigned hits =
+        (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, first)) &
+        (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(tail, last));
+    unsigned ends = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero));
+    if (ends) {
+      // starts at or after the terminator are not in the string; a start
+      // before it whose window reaches past it fails the checks below on
+      // the terminator, since the needle holds no NUL
+      hits &= (1u << __builtin_ctz(ends)) - 1;
+    }
+    while (hits) {
+      const char *start = folded + k + (size_t)__builtin_ctz(hits);
+      if (m <= 2 || memcmp(start + 1, needle->text + 1, m - 2) == 0) {
+        return true;
+      }
+      hits &= hits - 1;
+    }
+    if (ends) {
+      return false;
+    }
+  }
+}
+#endif
+
+/**
+ * @brief checks whether a folded string contains the needle
+ * @param[in] needle prepared needle
+ * @param[in] folded lowercased string followed by at least
+ *                   FOLDED_TEXT_PADDING readable bytes (folded_text_get)
+ * @return true if the needle occurs in folded
+ */
+bool text_needle_find(const TextNeedle *needle, const char *folded) {
+  if (!needle || !needle->text || !folded) {
+    return false;
+  }
+#ifdef TEXT_SEARCH_SSE2
+  if (needle->length <= TEXT_NEEDLE_MAX) {
+    return find_sse2(needle, folded);
+  }
+#endif
+  return strstr(folded, needle->text) != NULL;
+}
+
+/**
+ * @brief checks whether any string contains the needle, ignoring case
+ * @param[in] needle prepared needle
+ * @param[in] text string in its original case
+ * @return true if the needle occurs in text
+ * @note folds as it compares; for one-off checks such as dictionary entries
+ */
+bool text_needle_match(const TextNeedle *needle, const char *text) {
+  if (!needle || !needle->text || !text) {
+    return false;
+  }
+  for (const char *p = text; *p; p++) {
+    if (fold(*p) != needle->text[0]) {
+      continue;
+    }
+    // the needle holds no NUL, so the end of text stops the comparison
+    size_t i = 1;
+    while (i < needle->length && fold(p[i]) == needle->text[i]) {
+      i++;
+    }
+    if (i == needle->length) {
+      return true;
+    }
+  }
+  return false;
+}
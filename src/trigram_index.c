@@ -0,0 +1,345 @@
+#include "trigram_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+// sentinel for a trigram without a list
+#define NO_LIST UINT32_MAX
+
+// first capacity of a posting list
+#define INITIAL_POSTINGS 4
+
+// the three bytes starting at text, first one highest
+static uint32_t trigram_key(const char *text) {
+  return ((uint32_t)(unsigned char)text[0] << 16) |
+         ((uint32_t)(unsigned char)text[1] << 8) |
+         (uint32_t)(unsigned char)text[2];
+}
+
+static size_t bucket_of(uint32_t key, size_t bucket_count) {
+  uint32_t h = key * 2654435761u;
+  h ^= h >> 15;
+  return h & (bucket_count - 1);
+}
+
+// list holding key, or NO_LIST
+static uint32_t find_list(const TrigramIndex *index, uint32_t key) {
+  if (!index->buckets) {
+    return NO_LIST;
+  }
+  size_t i = bucket_of(key, index->bucket_count);
+  while (index->buckets[i] != 0) {
+    uint32_t list = index->buckets[i] - 1;
+    if (index->lists[list].key == key) {
+      return list;
+    }
+    i = (i + 1) & (index->bucket_count - 1);
+  }
+  return NO_LIST;
+}
+
+// re-insert every list into bucket_count fresh buckets
+static bool rehash(TrigramIndex *index, size_t bucket_count) {
+  uint32_t *buckets = calloc(bucket_count, sizeof(uint32_t));
+  if (!buckets) {
+    return false;
+  }
+  for (uint32_t list = 0; list < index->count; list++) {
+    size_t i = bucket_of(index->lists[list].key, bucket_count);
+    while (buckets[i] != 0) {
+      i = (i + 1) & (bucket_count - 1);
+    }
+    buckets[i] = list + 1;
+  }
+  free(index->buckets);
+  index->buckets = buckets;
+  index->bucket_count = bucket_count;
+  return true;
+}
+
+// list holding key, created empty if the trigram is new; NO_LIST if memory
+// runs out
+static uint32_t find_or_add_list(TrigramIndex *index, uint32_t key) {
+  uint32_t list = find_list(index, key);
+  if (list != NO_LIST) {
+    return list;
+  }
+
+  // buckets stay at most half full
+  if ((size_t)(index->count + 1) * 2 > index->bucket_count &&
+      !rehash(index, index->bucket_count ? index->bucket_count * 2
+                                         : TRIGRAM_INDEX_INITIAL_BUCKETS)) {
+    return NO_LIST;
+  }
+  if (index->count == index->capacity) {
+    uint32_t capacity = index->capacity ? index->capacity * 2 : 64;
+    TrigramList *lists = realloc(index->lists, capacity * sizeof *lists);
+    if (!lists) {
+      return NO_LIST;
+    }
+    index->lists = lists;
+    index->capacity = capacity;
+  }
+
+  list = index->count++;
+  index->lists[list] = (TrigramList){key, 0, 0, NULL};
+  size_t i = bucket_of(key, index->bucket_count);
+  while (index->buckets[i] != 0) {
+    i = (i + 1) & (index->bucket_count - 1);
+  }
+  index->buckets[i] = list + 1;
+  return list;
+}
+
+// first index at or after lo whose posting is not below target; steps
+// double from lo, so a run of nearby targets costs little each
+static uint32_t gallop(const uint32_t *postings, uint32_t lo, uint32_t count,
+                       uint32_t target) {
+  uint32_t step = 1;
+  uint32_t hi = lo;
+  while (hi < count && postings[hi] < target) {
+    lo = hi + 1;
+    hi = count - hi > step ? hi + step : count;
+    step *= 2;
+  }
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (postings[mid] < target) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// add position to one list, keeping it ascending and without repeats
+static bool list_insert(TrigramList *list, uint32_t position) {
+  uint32_t at = list->count;
+  if (list->count > 0 && list->postings[list->count - 1] >= position) {
+    at = gallop(list->postings, 0, list->count, position);
+    if (list->postings[at] == position) {
+      return true; // trigram repeated within the name
+    }
+  }
+
+  if (list->count == list->capacity) {
+    uint32_t capacity = list->capacity ? list->capacity * 2 : INITIAL_POSTINGS;
+    uint32_t *postings =
+        realloc(list->postings, capacity * sizeof(uint32_t));
+    if (!postings) {
+      return false;
+    }
+    list->postings = postings;
+    list->capacity = capacity;
+  }
+  memmove(&list->postings[at + 1], &list->postings[at],
+          (list->count - at) * sizeof(uint32_t));
+  list->postings[at] = position;
+  list->count++;
+  return true;
+}
+
+/**
+ * @brief initialises an empty index (no memory is allocated)
+ * @param[out] index pointer to the index to initialise
+ */
+void trigram_index_init(TrigramIndex *index) {
+  if (!index) {
+    return;
+  }
+  memset(index, 0, sizeof *index);
+}
+
+/**
+ * @brief frees all memory held by an index
+ * @param[in,out] index pointer to the index to free (can be NULL)
+ */
+void trigram_index_free(TrigramIndex *index) {
+  if (!index) {
+    return;
+  }
+  for (uint32_t list = 0; list < index->count; list++) {
+    free(index->lists[list].postings);
+  }
+  free(index->lists);
+  free(index->buckets);
+  trigram_index_init(index);
+}
+
+/**
+ * @brief adds a position under every trigram of its folded name
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] folded folded name of the record
+ * @return true on success, false if memory allocation fails (the position
+ *         may then be under some of its trigrams only)
+ * @note appending positions in ascending order is the fast path; others
+ *       are inserted in order
+ */
+bool trigram_index_add(TrigramIndex *index, uint32_t position,
+                       const char *folded) {
+  if (!index || !folded) {
+    return false;
+  }
+  size_t length = strlen(folded);
+  for (size_t i = 0; i + TRIGRAM_LENGTH <= length; i++) {
+    uint32_t list = find_or_add_list(index, trigram_key(folded + i));
+    if (list == NO_LIST) {
+      return false;
+    }
+    uint32_t before = index->lists[list].count;
+    if (!list_insert(&index->lists[list], position)) {
+      return false;
+    }
+    index->postings += index->lists[list].count - before;
+  }
+  return true;
+}
+
+/**
+ * @brief removes a position from every trigram of its folded name
+ * @param[in,out] index pointer to the index
+ * @param[in] position record position
+ * @param[in] folded folded name the position was added with
+ */
+void trigram_index_remove(TrigramIndex *index, uint32_t position,
+                          const char *folded) {
+  if (!index || !folded) {
+    return;
+  }
+  size_t length = strlen(folded);
+  for (size_t i = 0; i + TRIGRAM_LENGTH <= length; i++) {
+    uint32_t found = find_list(index, trigram_key(folded + i));
+    if (found == NO_LIST) {
+      continue;
+    }
+    // a repeated trigram finds the position already gone
+    TrigramList *list = &index->lists[found];
+    uint32_t at = gallop(list->postings, 0, list->count, position);
+    if (at == list->count || list->postings[at] != position) {
+      continue;
+    }
+    memmove(&list->postings[at], &list->postings[at + 1],
+            (list->count - at - 1) * sizeof(uint32_t));
+    list->count--;
+    index->postings--;
+  }
+}
+
+/**
+ * @brief renumbers every position after records are moved down
+ * @param[in,out] index pointer to the index
+ * @param[in] new_position new position of each indexed position
+ * @note new_position must keep positions in the same order (a purge)
+ */
+void trigram_index_remap(TrigramIndex *index, const uint32_t *new_position) {
+  if (!index || !new_position) {
+    return;
+  }
+  for (uint32_t list = 0; list < index->count; list++) {
+    uint32_t *postings = index->lists[list].postings;
+    for (uint32_t i = 0; i < index->lists[list].count; i++) {
+      postings[i] = new_position[postings[i]];
+    }
+  }
+}
+
+/**
+ * @brief finds the positions whose names hold every trigram of a pattern
+ * @param[in] index pointer to the index
+ * @param[in] pattern folded pattern, at least TRIGRAM_LENGTH bytes
+ * @param[in] length bytes in pattern
+ * @param[out] positions ascending candidate positions (heap-allocated,
+ *                       caller frees; NULL when there are none)
+ * @param[out] count number of candidates
+ * @return true on success, false if memory allocation fails
+ * @note candidates still have to be checked for the whole pattern
+ */
+bool trigram_index_lookup(const TrigramIndex *index, const char *pattern,
+                          size_t length, uint32_t **positions, size_t *count) {
+  if (!positions || !count) {
+    return false;
+  }
+  *positions = NULL;
+  *count = 0;
+  if (!index || !pattern || length < TRIGRAM_LENGTH) {
+    return false;
+  }
+
+  size_t trigrams = length - TRIGRAM_LENGTH + 1;
+  const TrigramList **lists = malloc(trigrams * sizeof *lists);
+  if (!lists) {
+    return false;
+  }
+
+  // shortest list first, so each intersection shrinks the fewest candidates
+  size_t used = 0;
+  for (size_t i = 0; i < trigrams; i++) {
+    uint32_t found = find_list(index, trigram_key(pattern + i));
+    if (found == NO_LIST || index->lists[found].count == 0) {
+      free(lists); // a missing trigram rules out every name
+      return true;
+    }
+    const TrigramList *list = &index->lists[found];
+    size_t slot = used;
+    bool repeated = false;
+    for (size_t j = 0; j < used; j++) {
+      repeated = repeated || lists[j] == list;
+    }
+    if (repeated) {
+      continue;
+    }
+    while (slot > 0 && lists[slot - 1]->count > list->count) {
+      lists[slot] = lists[slot - 1];
+      slot--;
+    }
+    lists[slot] = list;
+    used++;
+  }
+
+  uint32_t *result = malloc(lists[0]->count * sizeof(uint32_t));
+  if (!result) {
+    free(lists);
+    return false;
+  }
+  memcpy(result, lists[0]->postings, lists[0]->count * sizeof(uint32_t));
+  size_t kept = lists[0]->count;
+  for (size_t l = 1; l < used && kept > 0; l++) {
+    const TrigramList *list = lists[l];
+    size_t survivors = 0;
+    uint32_t at = 0;
+    for (size_t i = 0; i < kept && at < list->count; i++) {
+      at = gallop(list->postings, at, list->count, result[i]);
+      if (at < list->count && list->postings[at] == result[i]) {
+        result[survivors++] = result[i];
+      }
+    }
+    kept = survivors;
+  }
+  free(lists);
+
+  if (kept == 0) {
+    free(result);
+    return true;
+  }
+  *positions = result;
+  *count = kept;
+  return true;
+}
+
+/**
+ * @brief returns the bytes an index holds
+ * @param[in] index pointer to the index
+ * @return allocated bytes of the lists, their positions and the buckets
+ */
+size_t trigram_index_memory(const TrigramIndex *index) {
+  if (!index) {
+    return 0;
+  }
+  size_t bytes = index->capacity * sizeof(TrigramList) +
+                 index->bucket_count * sizeof(uint32_t);
+  for (uint32_t list = 0; list < index->count; list++) {
+    bytes += index->lists[list].capacity * sizeof(uint32_t);
+  }
+  return bytes;
+}
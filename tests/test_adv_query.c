@@ -2,11 +2,18 @@
  * test_adv_query.c
  *
  * Test suite for adv_query_execute(): pipeline parsing, validation, and happy
- * paths using the shared test utilities and fixtures.
+ * paths using the shared test utilities and fixtures. adv_query_select() is
+ * checked against a record-at-a-time scan across batch boundaries.
  */
 
 #include "../include/adv_query.h"
+#include "../include/query_cache.h"
+#include "../include/table_view.h"
 #include "test_utils.h"
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 // helper to load a small database fixture
 static StudentDatabase *load_fixture_db(void) {
@@ -135,6 +142,80 @@ void test_adv_query_invalid_mark_operator_or_value(void) {
   db_free(db);
 }
 
+void test_adv_query_range_syntax(void) {
+  StudentDatabase *db = load_fixture_db();
+  if (!db) {
+    ASSERT_TRUE(false, "Fixture DB should load");
+    return;
+  }
+
+  static const char *valid[] = {
+      "MARK BETWEEN 60 AND 80", "mark between 60.5 and 61", "MARK >= 70",
+      "FILTER <= 70", "ID BETWEEN 2500000 AND 2600000", "id > 0",
+      "ID = 2500123 | MARK BETWEEN 0 AND 100"};
+  bool parsed = true;
+  for (size_t i = 0; i < sizeof valid / sizeof valid[0]; i++) {
+    AdvQueryResult result;
+    parsed = parsed && adv_query_select(db, valid[i], &result) ==
+                           ADV_QUERY_SUCCESS;
+    adv_query_result_free(&result);
+  }
+  ASSERT_TRUE(parsed, "Range and ID comparisons should parse");
+
+  static const char *invalid[] = {
+      "MARK BETWEEN 60", "MARK BETWEEN 60 OR 70", "MARK BETWEEN AND 70",
+      "MARK BETWEEN60 AND 70", "ID BETWEEN 1 AND x", "ID >", "ID == 4",
+      "ID > 1 | ID < 9", "MARK >= 1 | FILTER <= 9"};
+  bool rejected = true;
+  for (size_t i = 0; i < sizeof invalid / sizeof invalid[0]; i++) {
+    rejected = rejected &&
+               adv_query_execute(db, invalid[i]) == ADV_QUERY_ERROR_PARSE;
+  }
+  ASSERT_TRUE(rejected, "Malformed or repeated ranges should parse-fail");
+
+  size_t count = 1;
+  adv_query_count(db, "MARK BETWEEN 80 AND 60", &count);
+  ASSERT_EQUAL_INT(0, (int)count, "A reversed BETWEEN matches nothing");
+
+  db_free(db);
+}
+
+void test_adv_query_order_and_limit_syntax(void) {
+  StudentDatabase *db = load_fixture_db();
+  if (!db) {
+    ASSERT_TRUE(false, "Fixture DB should load");
+    return;
+  }
+
+  static const char *valid[] = {
+      "MARK > 60 | ORDER BY MARK DESC | LIMIT 5", "ORDER BY MARK",
+      "order by id desc", "ORDER BY MARKS ASC", "LIMIT 3",
+      "GREP NAME = a | LIMIT 1"};
+  bool parsed = true;
+  for (size_t i = 0; i < sizeof valid / sizeof valid[0]; i++) {
+    AdvQueryResult result;
+    parsed = parsed && adv_query_select(db, valid[i], &result) ==
+                           ADV_QUERY_SUCCESS;
+    adv_query_result_free(&result);
+  }
+  ASSERT_TRUE(parsed, "ORDER BY and LIMIT clauses should parse");
+
+  static const char *invalid[] = {
+      "LIMIT 0", "LIMIT -2", "LIMIT 2.5", "LIMIT", "ORDER BY", "ORDER MARK",
+      "ORDER BY NAME", "ORDER BY MARK DOWN", "LIMIT 2 | ORDER BY MARK",
+      "ORDER BY MARK | MARK > 50", "LIMIT 3 | GREP NAME = a",
+      "ORDER BY MARK | ORDER BY ID", "LIMIT 2 | LIMIT 3"};
+  bool rejected = true;
+  for (size_t i = 0; i < sizeof invalid / sizeof invalid[0]; i++) {
+    rejected = rejected &&
+               adv_query_execute(db, invalid[i]) == ADV_QUERY_ERROR_PARSE;
+  }
+  ASSERT_TRUE(rejected, "Malformed, repeated or misplaced clauses should "
+                        "parse-fail");
+
+  db_free(db);
+}
+
 // ---------------------------------------------------------------------------
 // successful pipelines
 // ---------------------------------------------------------------------------
@@ -190,8 +271,8 @@ void test_adv_query_combined_filters(void) {
   }
 
   AdvQueryStatus status =
-      adv_query_execute(db, "GREP PROGRAMME = Science | MARK >= 67");
-  // MARK "=" is allowed; using ">=" is not supported, so split into two stages
+      adv_query_execute(db, "GREP PROGRAMME = Science | MARK => 67");
+  // ">=" and "<=" are allowed; "=>" is not an operator
   ASSERT_EQUAL_INT(ADV_QUERY_ERROR_PARSE, status,
                    "Unsupported operator should parse-fail");
 
@@ -217,6 +298,584 @@ void test_adv_query_success_zero_matches(void) {
   db_free(db);
 }
 
+// ---------------------------------------------------------------------------
+// batch execution against a record-at-a-time scan
+// ---------------------------------------------------------------------------
+
+// substring check ignoring case, kept separate from the engine's
+static bool contains_ignoring_case(const char *text, const char *pattern) {
+  size_t length = strlen(pattern);
+  for (; *text; text++) {
+    size_t i = 0;
+    while (i < length && text[i] &&
+           tolower((unsigned char)text[i]) ==
+               tolower((unsigned char)pattern[i])) {
+      i++;
+    }
+    if (i == length) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// "GREP NAME = 7 | GREP PROGRAMME = programme2 | MARK > 60", one record at a
+// time, compared with a result in active view order
+static bool result_matches_scan(const StudentTable *table,
+                                const AdvQueryResult *result) {
+  size_t cursor = 0;
+  size_t p;
+  size_t found = 0;
+  while ((p = table_view_next(table, &cursor)) != TABLE_VIEW_NOT_FOUND) {
+    if (!contains_ignoring_case(table_record_name(table, p), "7") ||
+        !contains_ignoring_case(table_record_prog(table, p), "programme2") ||
+        !(table_record_mark(table, p) > 60.0)) {
+      continue;
+    }
+    if (found >= result->count || result->matches[found].table != table ||
+        result->matches[found].position != p) {
+      return false;
+    }
+    found++;
+  }
+  return found == result->count && found > 0;
+}
+
+void test_adv_query_select_across_batches(void) {
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", 3 * ADV_QUERY_BATCH_SIZE + 17);
+  db_add_table(db, table);
+  for (int id = 2500100; id < 2500100 + 600; id += 3) {
+    table_remove_record(table, id);
+  }
+
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC};
+  for (size_t v = 0; v < 2; v++) {
+    table_set_view(table, views[v]);
+    AdvQueryResult result;
+    AdvQueryStatus status = adv_query_select(
+        db, "GREP NAME = 7 | GREP PROGRAMME = programme2 | MARK > 60", &result);
+    ASSERT_EQUAL_INT(ADV_QUERY_SUCCESS, status, "Select should succeed");
+    ASSERT_TRUE(result_matches_scan(table, &result),
+                "Batches should match a record-at-a-time scan in view order");
+    adv_query_result_free(&result);
+  }
+
+  table_set_view(table, TABLE_VIEW_STORAGE);
+  table_set_layout(table, TABLE_LAYOUT_COLUMNS);
+  AdvQueryResult result;
+  adv_query_select(db, "MARK > 60 | GREP PROGRAMME = programme2 | GREP NAME = 7",
+                   &result);
+  ASSERT_TRUE(result_matches_scan(table, &result),
+              "Stage order and column layout should not change the result");
+  adv_query_result_free(&result);
+
+  db_free(db);
+}
+
+void test_adv_query_select_column_kernels(void) {
+  // stored order with no deletes hands whole slices of the mark column to
+  // the vector kernels
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", 2 * ADV_QUERY_BATCH_SIZE + 5);
+  db_add_table(db, table);
+  table_set_layout(table, TABLE_LAYOUT_COLUMNS);
+
+  AdvQueryResult result;
+  adv_query_select(db, "MARK > 60 | GREP PROGRAMME = programme2 | GREP NAME = 7",
+                   &result);
+  ASSERT_TRUE(result_matches_scan(table, &result),
+              "Vector mark stage should match a record-at-a-time scan");
+  adv_query_result_free(&result);
+
+  adv_query_select(db, "MARK = 60", &result);
+  bool equal = result.count > 0;
+  for (size_t i = 0; i < result.count; i++) {
+    equal = equal && table_record_mark(table, result.matches[i].position) ==
+                         60.0f &&
+            (i == 0 ||
+             result.matches[i].position > result.matches[i - 1].position);
+  }
+  ASSERT_TRUE(equal, "MARK = 60 should find each 60 in stored order");
+  adv_query_result_free(&result);
+
+  db_free(db);
+}
+
+void test_adv_query_select_names_after_updates(void) {
+  // GREP NAME searches the folded names, which must follow renames
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records("StudentRecords", 30);
+  db_add_table(db, table);
+  db->is_loaded = true;
+  db_update_record(db, 2500105, "Nurul AISYAH binte Rahman", NULL, NULL);
+  db_update_record(db, 2500106, "Ai", NULL, NULL);
+
+  AdvQueryResult result;
+  adv_query_select(db, "GREP NAME = aisyah", &result);
+  ASSERT_EQUAL_INT(1, (int)result.count, "Renamed record should be found");
+  adv_query_result_free(&result);
+
+  adv_query_select(db, "GREP NAME = STUDENT1", &result);
+  size_t expected = 0;
+  for (size_t p = 0; p < table->slot_count; p++) {
+    expected += contains_ignoring_case(table_record_name(table, p), "student1");
+  }
+  ASSERT_EQUAL_INT((int)expected, (int)result.count,
+                   "Name search should match a record-at-a-time scan");
+  adv_query_result_free(&result);
+
+  db_free(db);
+}
+
+void test_adv_query_select_with_name_index(void) {
+  // the trigram index must only skip names that cannot match, in any view
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", ADV_QUERY_BATCH_SIZE + 300);
+  db_add_table(db, table);
+  for (int i = 0; i < 200; i += 3) {
+    table_remove_record(table, 2500100 + i);
+  }
+
+  static const char *pipelines[] = {
+      "GREP NAME = 7 | GREP PROGRAMME = programme2 | MARK > 60",
+      "GREP NAME = DENT12", "GREP NAME = nt1 | MARK < 70",
+      "GREP NAME = studentx"};
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC};
+  bool same = true;
+  for (size_t v = 0; v < 2; v++) {
+    table_set_view(table, views[v]);
+    for (size_t q = 0; q < 4; q++) {
+      AdvQueryResult scanned;
+      AdvQueryResult indexed;
+      table_set_name_index(table, false);
+      adv_query_select(db, pipelines[q], &scanned);
+      table_set_name_index(table, true);
+      adv_query_select(db, pipelines[q], &indexed);
+      same = same && scanned.count == indexed.count;
+      for (size_t i = 0; same && i < scanned.count; i++) {
+        same = scanned.matches[i].position == indexed.matches[i].position;
+      }
+      adv_query_result_free(&scanned);
+      adv_query_result_free(&indexed);
+    }
+  }
+  ASSERT_TRUE(same, "Indexed results should equal scanned results in order");
+  ASSERT_NOT_NULL(table->name_trigrams, "Index should be in place");
+
+  db_free(db);
+}
+
+void test_adv_query_select_with_filter_bitmaps(void) {
+  // filter bitmaps must give the scan's matches, in order, in any view
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", ADV_QUERY_BATCH_SIZE + 300);
+  db_add_table(db, table);
+  for (int i = 0; i < 200; i += 3) {
+    table_remove_record(table, 2500100 + i);
+  }
+  db_update_record(db, 2500101, NULL, "Programme2", &(float){97.5f});
+
+  static const char *pipelines[] = {
+      "GREP PROGRAMME = programme2 | MARK > 92", "MARK = 73",
+      "MARK < 57.5", "GREP PROGRAMME = programme3",
+      "GREP NAME = 7 | GREP PROGRAMME = programme2 | MARK > 90",
+      "GREP PROGRAMME = nothing | MARK > 10"};
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC};
+  table_set_name_index(table, true);
+  bool same = true;
+  bool counted = true;
+  for (size_t v = 0; v < 2; v++) {
+    table_set_view(table, views[v]);
+    for (size_t q = 0; q < 6; q++) {
+      AdvQueryResult scanned;
+      AdvQueryResult indexed;
+      size_t count = 0;
+      table_set_filter_index(table, false);
+      adv_query_select(db, pipelines[q], &scanned);
+      table_set_filter_index(table, true);
+      adv_query_select(db, pipelines[q], &indexed);
+      adv_query_count(db, pipelines[q], &count);
+      same = same && scanned.count == indexed.count;
+      for (size_t i = 0; same && i < scanned.count; i++) {
+        same = scanned.matches[i].position == indexed.matches[i].position;
+      }
+      counted = counted && count == scanned.count;
+      adv_query_result_free(&scanned);
+      adv_query_result_free(&indexed);
+    }
+  }
+  ASSERT_TRUE(same, "Bitmap results should equal scanned results in order");
+  ASSERT_TRUE(counted, "Counts should equal the number of matches");
+  ASSERT_NOT_NULL(table->filter_bitmaps, "Bitmaps should be in place");
+
+  size_t count = 0;
+  ASSERT_EQUAL_INT(ADV_QUERY_ERROR_PARSE,
+                   adv_query_count(db, "MARK ! 3", &count),
+                   "Count should parse the pipeline first");
+  db_free(db);
+}
+
+typedef bool (*RecordTest)(const StudentTable *table, size_t position);
+
+static bool marks_60_to_61(const StudentTable *table, size_t position) {
+  float mark = table_record_mark(table, position);
+  return mark >= 60.0f && mark <= 61.5f;
+}
+
+static bool ids_200_to_260(const StudentTable *table, size_t position) {
+  int id = table_record_id(table, position);
+  return id >= 2500200 && id <= 2500260;
+}
+
+static bool low_ids_low_marks(const StudentTable *table, size_t position) {
+  return table_record_id(table, position) < 2500190 &&
+         table_record_mark(table, position) <= 55.0f;
+}
+
+static bool top_marks_programme2(const StudentTable *table, size_t position) {
+  return table_record_mark(table, position) >= 98.0f &&
+         strcmp(table_record_prog(table, position), "Programme2") == 0;
+}
+
+static bool named_t12_early(const StudentTable *table, size_t position) {
+  int id = table_record_id(table, position);
+  return strstr(table_record_name(table, position), "t12") && id > 2500100 &&
+         id <= 2500400;
+}
+
+static bool marks_above_52(const StudentTable *table, size_t position) {
+  return table_record_mark(table, position) > 52.0f;
+}
+
+static bool id_2500500(const StudentTable *table, size_t position) {
+  return table_record_id(table, position) == 2500500;
+}
+
+// true if a result holds exactly the records passing test, in the order of
+// the table's active view
+static bool matches_in_view_order(const StudentTable *table,
+                                  const AdvQueryResult *result,
+                                  RecordTest test) {
+  size_t cursor = 0;
+  size_t next = 0;
+  size_t position;
+  while ((position = table_view_next(table, &cursor)) !=
+         TABLE_VIEW_NOT_FOUND) {
+    if (!test(table, position)) {
+      continue;
+    }
+    if (next == result->count || result->matches[next].position != position) {
+      return false;
+    }
+    next++;
+  }
+  return next == result->count;
+}
+
+void test_adv_query_select_with_sorted_views(void) {
+  // intervals answered from the sorted views must give the scan's matches,
+  // in order, whichever other indexes narrow the same table
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", ADV_QUERY_BATCH_SIZE + 300);
+  db_add_table(db, table);
+  for (int i = 0; i < 200; i += 3) {
+    table_remove_record(table, 2500100 + i);
+  }
+  db_update_record(db, 2500101, NULL, "Programme2", &(float){98.5f});
+
+  AdvQueryResult result;
+  adv_query_select(db, "MARK BETWEEN 60 AND 61.5", &result);
+  ASSERT_TRUE(matches_in_view_order(table, &result, marks_60_to_61),
+              "Intervals are scanned without sorted views");
+  ASSERT_FALSE(table->views.built, "Queries build no views by default");
+  adv_query_result_free(&result);
+  db->range_index = true;
+
+  static const struct {
+    const char *pipeline;
+    RecordTest test;
+  } cases[] = {
+      {"MARK BETWEEN 60 AND 61.5", marks_60_to_61},
+      {"ID BETWEEN 2500200 AND 2500260", ids_200_to_260},
+      {"ID < 2500190 | MARK <= 55", low_ids_low_marks},
+      {"MARK >= 98 | GREP PROGRAMME = programme2", top_marks_programme2},
+      {"GREP NAME = t12 | ID BETWEEN 2500101 AND 2500400", named_t12_early},
+      {"MARK > 52", marks_above_52},
+      {"ID = 2500500", id_2500500}};
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC,
+                                    TABLE_VIEW_ID_ASC};
+  bool same = true;
+  bool counted = true;
+  for (size_t v = 0; v < 3; v++) {
+    table_set_view(table, views[v]);
+    table_set_filter_index(table, v > 0);
+    table_set_name_index(table, v > 0);
+    for (size_t q = 0; q < sizeof cases / sizeof cases[0]; q++) {
+      size_t count = 0;
+      adv_query_select(db, cases[q].pipeline, &result);
+      adv_query_count(db, cases[q].pipeline, &count);
+      same = same && matches_in_view_order(table, &result, cases[q].test);
+      counted = counted && count == result.count;
+      adv_query_result_free(&result);
+    }
+    ASSERT_TRUE(table->views.built, "A range query builds the views");
+  }
+  ASSERT_TRUE(same, "View results should equal scanned results in order");
+  ASSERT_TRUE(counted, "Counts should equal the number of matches");
+
+  // the views follow changes, so later intervals still match
+  StudentRecord record = {.id = 2500050, .name = "Nur Aisyah",
+                          .prog = "Programme1", .mark = 60.5f};
+  table_add_record(table, &record);
+  db_update_record(db, 2500201, NULL, NULL, &(float){61.0f});
+  table_remove_record(table, 2500202);
+  table_set_view(table, TABLE_VIEW_STORAGE);
+  adv_query_select(db, "MARK BETWEEN 60 AND 61.5", &result);
+  ASSERT_TRUE(matches_in_view_order(table, &result, marks_60_to_61),
+              "Intervals follow inserts, updates and deletes");
+  adv_query_result_free(&result);
+  db_free(db);
+}
+
+static bool any_record(const StudentTable *table, size_t position) {
+  (void)table;
+  (void)position;
+  return true;
+}
+
+static bool programme1(const StudentTable *table, size_t position) {
+  return strcmp(table_record_prog(table, position), "Programme1") == 0;
+}
+
+static bool named_t12(const StudentTable *table, size_t position) {
+  return strstr(table_record_name(table, position), "t12") != NULL;
+}
+
+// true if a result holds the first limit records passing test, taken in
+// the table's active view order and then stably sorted by mark or id when
+// by is 'M' or 'I' (by '-' leaves view order)
+static bool matches_in_rank_order(const StudentTable *table,
+                                  const AdvQueryResult *result,
+                                  RecordTest test, char by, bool descending,
+                                  size_t limit) {
+  size_t *expected = malloc(table->record_count * sizeof(size_t));
+  double *keys = malloc(table->record_count * sizeof(double));
+  if (!expected || !keys) {
+    free(expected);
+    free(keys);
+    return false;
+  }
+  size_t n = 0;
+  size_t cursor = 0;
+  size_t position;
+  while ((position = table_view_next(table, &cursor)) !=
+         TABLE_VIEW_NOT_FOUND) {
+    if (!test(table, position)) {
+      continue;
+    }
+    double key = by == 'M' ? table_record_mark(table, position)
+                           : table_record_id(table, position);
+    key = descending ? -key : key;
+    // insertion sort after every equal key, so ties keep view order
+    size_t slot = n++;
+    while (by != '-' && slot > 0 && keys[slot - 1] > key) {
+      expected[slot] = expected[slot - 1];
+      keys[slot] = keys[slot - 1];
+      slot--;
+    }
+    expected[slot] = position;
+    keys[slot] = key;
+  }
+  n = n < limit ? n : limit;
+  bool same = result->count == n;
+  for (size_t i = 0; same && i < n; i++) {
+    same = result->matches[i].position == expected[i];
+  }
+  free(expected);
+  free(keys);
+  return same;
+}
+
+void test_adv_query_select_top_k(void) {
+  // the first k matches by mark or id must be those a full stable sort of
+  // the matches would give, without reordering the stored records
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", ADV_QUERY_BATCH_SIZE + 300);
+  db_add_table(db, table);
+  for (int i = 0; i < 200; i += 3) {
+    table_remove_record(table, 2500100 + i);
+  }
+  db_update_record(db, 2500101, NULL, NULL, &(float){99.5f});
+  long stored = 0;
+  for (size_t p = 0; p < table->slot_count; p++) {
+    stored += (long)(p % 97) * table_record_id(table, p);
+  }
+
+  static const struct {
+    const char *pipeline;
+    RecordTest test;
+    char by;
+    bool descending;
+    size_t limit;
+  } cases[] = {
+      {"GREP PROGRAMME = Programme1 | ORDER BY MARK DESC | LIMIT 20",
+       programme1, 'M', true, 20},
+      {"MARK > 52 | ORDER BY MARK | LIMIT 7", marks_above_52, 'M', false, 7},
+      {"MARK > 52 | LIMIT 7", marks_above_52, '-', false, 7},
+      {"ORDER BY ID DESC | LIMIT 1", any_record, 'I', true, 1},
+      {"ORDER BY MARK DESC", any_record, 'M', true, SIZE_MAX},
+      {"MARK BETWEEN 60 AND 61.5 | ORDER BY MARK DESC | LIMIT 5000",
+       marks_60_to_61, 'M', true, 5000},
+      {"GREP NAME = t12 | ORDER BY ID | LIMIT 4", named_t12, 'I', false, 4},
+      {"ID BETWEEN 2500200 AND 2500260 | ORDER BY MARK | LIMIT 9",
+       ids_200_to_260, 'M', false, 9},
+      {"LIMIT 1500", any_record, '-', false, 1500}};
+  bool same = true;
+  bool counted = true;
+  for (size_t run = 0; run < 3; run++) {
+    // plain scan, then every index, then answered from the query cache
+    if (run == 1) {
+      db->range_index = true;
+      table_set_filter_index(table, true);
+      table_set_name_index(table, true);
+      db_set_query_cache(db, 1 << 20);
+    }
+    for (size_t q = 0; q < sizeof cases / sizeof cases[0]; q++) {
+      AdvQueryResult result;
+      size_t count = 0;
+      adv_query_select(db, cases[q].pipeline, &result);
+      adv_query_count(db, cases[q].pipeline, &count);
+      same = same && matches_in_rank_order(table, &result, cases[q].test,
+                                           cases[q].by, cases[q].descending,
+                                           cases[q].limit);
+      counted = counted && count == result.count;
+      adv_query_result_free(&result);
+    }
+    if (run == 0) {
+      long after = 0;
+      for (size_t p = 0; p < table->slot_count; p++) {
+        after += (long)(p % 97) * table_record_id(table, p);
+      }
+      ASSERT_TRUE(after == stored && !table->views.built &&
+                      table->active_view == TABLE_VIEW_STORAGE,
+                  "Ordering moves no record and builds no view");
+    }
+  }
+  ASSERT_TRUE(same, "Top matches should equal a stable sort of the matches");
+  ASSERT_TRUE(counted, "Counts should stop at the limit");
+  ASSERT_TRUE(db->query_cache->hits > 0, "Ordered results are cached");
+
+  // ties keep the order of the active view, here the mark view's
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+  AdvQueryResult result;
+  adv_query_select(db, "MARK > 52 | ORDER BY MARK | LIMIT 30", &result);
+  ASSERT_TRUE(matches_in_rank_order(table, &result, marks_above_52, 'M',
+                                    false, 30),
+              "Equal marks keep the active view's order");
+  adv_query_result_free(&result);
+  db_free(db);
+}
+
+// true if two results hold the same matches in the same order
+static bool same_matches(const AdvQueryResult *a, const AdvQueryResult *b) {
+  if (a->count != b->count) {
+    return false;
+  }
+  for (size_t i = 0; i < a->count; i++) {
+    if (a->matches[i].table != b->matches[i].table ||
+        a->matches[i].position != b->matches[i].position) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void test_adv_query_select_in_parallel_morsels(void) {
+  // workers pulling morsels must return what one thread returns, in the
+  // same order, whatever the view, indexes and clauses
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records(
+      "StudentRecords", 5 * ADV_QUERY_MORSEL_SIZE + 123);
+  db_add_table(db, table);
+  for (int i = 0; i < 30000; i += 7) {
+    table_remove_record(table, 2500100 + i);
+  }
+  db->query_workers = 4;
+
+  static const char *pipelines[] = {
+      "MARK > 60", "GREP NAME = 12 | MARK <= 70",
+      "GREP PROGRAMME = programme2 | ID BETWEEN 2500500 AND 2560000",
+      "MARK = 99", "ORDER BY MARK DESC | LIMIT 50",
+      "GREP NAME = 3 | ORDER BY ID | LIMIT 20000", "MARK > 52 | LIMIT 777",
+      "LIMIT 70000", "GREP NAME = 7 | ORDER BY MARK"};
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC,
+                                    TABLE_VIEW_STORAGE};
+  bool same = true;
+  bool counted = true;
+  for (size_t v = 0; v < 3; v++) {
+    // stored and sorted views, then candidates from every index
+    table_set_view(table, views[v]);
+    table_set_filter_index(table, v == 2);
+    table_set_name_index(table, v == 2);
+    db->range_index = v == 2;
+    for (size_t q = 0; q < sizeof pipelines / sizeof pipelines[0]; q++) {
+      AdvQueryResult serial;
+      AdvQueryResult parallel;
+      size_t count = 0;
+      db->query_parallel_rows = 0;
+      adv_query_select(db, pipelines[q], &serial);
+      db->query_parallel_rows = 1;
+      adv_query_select(db, pipelines[q], &parallel);
+      adv_query_count(db, pipelines[q], &count);
+      same = same && serial.count > 0 && same_matches(&serial, &parallel);
+      counted = counted && count == serial.count;
+      adv_query_result_free(&serial);
+      adv_query_result_free(&parallel);
+    }
+  }
+  ASSERT_TRUE(same, "Morsels should give the single-threaded matches");
+  ASSERT_TRUE(counted, "Counts on workers should equal the matches");
+
+  // the default threshold keeps small tables on the calling thread
+  StudentDatabase *fresh = db_init();
+  ASSERT_EQUAL_INT(QUERY_PARALLEL_MIN_ROWS, (int)fresh->query_parallel_rows,
+                   "Queries use workers from the default threshold");
+  db_free(fresh);
+  db_free(db);
+}
+
+void test_adv_query_select_parses_before_filtering(void) {
+  StudentDatabase *db = load_fixture_db();
+  if (!db) {
+    ASSERT_TRUE(false, "Fixture DB should load");
+    return;
+  }
+
+  AdvQueryResult result;
+  ASSERT_EQUAL_INT(ADV_QUERY_ERROR_PARSE,
+                   adv_query_select(db, "MARK > 0 | GREP ID = 1", &result),
+                   "A bad later stage should fail the whole pipeline");
+  ASSERT_EQUAL_INT(0, (int)result.count, "Failed select returns no matches");
+  ASSERT_EQUAL_INT(ADV_QUERY_ERROR_PARSE,
+                   adv_query_select(db, "GREP NAME = \"\"", &result),
+                   "Empty pattern should parse-fail");
+
+  ASSERT_EQUAL_INT(ADV_QUERY_SUCCESS,
+                   adv_query_select(db, "MARK < 0", &result),
+                   "Select with no matches should succeed");
+  ASSERT_EQUAL_INT(0, (int)result.count, "No marks are below zero");
+  adv_query_result_free(&result);
+
+  db_free(db);
+}
+
 // ---------------------------------------------------------------------------
 // test suite runner
 // ---------------------------------------------------------------------------
@@ -235,6 +894,8 @@ int main(void) {
   RUN_TEST(test_adv_query_disallowed_field);
   RUN_TEST(test_adv_query_duplicate_filters);
   RUN_TEST(test_adv_query_invalid_mark_operator_or_value);
+  RUN_TEST(test_adv_query_range_syntax);
+  RUN_TEST(test_adv_query_order_and_limit_syntax);
 
   // success paths
   RUN_TEST(test_adv_query_valid_grep_name);
@@ -243,5 +904,16 @@ int main(void) {
   RUN_TEST(test_adv_query_combined_filters);
   RUN_TEST(test_adv_query_success_zero_matches);
 
+  // batch execution
+  RUN_TEST(test_adv_query_select_across_batches);
+  RUN_TEST(test_adv_query_select_column_kernels);
+  RUN_TEST(test_adv_query_select_names_after_updates);
+  RUN_TEST(test_adv_query_select_with_name_index);
+  RUN_TEST(test_adv_query_select_with_filter_bitmaps);
+  RUN_TEST(test_adv_query_select_with_sorted_views);
+  RUN_TEST(test_adv_query_select_top_k);
+  RUN_TEST(test_adv_query_select_in_parallel_morsels);
+  RUN_TEST(test_adv_query_select_parses_before_filtering);
+
   TEST_SUITE_END();
 }
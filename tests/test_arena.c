@@ -0,0 +1,246 @@
+#include "../include/arena.h"
+#include "../include/database.h"
+#include "../include/parser.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// arena allocation tests
+// =============================================================================
+
+void test_arena_alloc_is_aligned_and_counted(void) {
+  Arena arena;
+  arena_init(&arena);
+
+  char *a = arena_alloc(&arena, 3);
+  double *b = arena_alloc(&arena, 5 * sizeof(double));
+  ASSERT_NOT_NULL(a, "First allocation should succeed");
+  ASSERT_NOT_NULL(b, "Second allocation should succeed");
+  ASSERT_TRUE((uintptr_t)a % ARENA_ALIGNMENT == 0 &&
+                  (uintptr_t)b % ARENA_ALIGNMENT == 0,
+              "Allocations should be aligned");
+  ASSERT_TRUE((char *)b >= a + 3, "Allocations should not overlap");
+
+  ASSERT_EQUAL_INT(1, (int)arena.stats.block_mallocs,
+                   "Small allocations should share one block");
+  ASSERT_EQUAL_INT(2, (int)arena.stats.allocations,
+                   "Allocations should be counted");
+
+  arena_free(&arena);
+  ASSERT_NULL(arena.head, "Free should drop every block");
+}
+
+void test_arena_resize_in_place_and_copy(void) {
+  Arena arena;
+  arena_init(&arena);
+
+  int *values = arena_alloc(&arena, 4 * sizeof(int));
+  for (int i = 0; i < 4; i++) {
+    values[i] = i;
+  }
+  int *grown = arena_resize(&arena, values, 4 * sizeof(int), 64 * sizeof(int));
+  ASSERT_TRUE(grown == values, "Latest allocation should grow in place");
+
+  char *other = arena_alloc(&arena, 8);
+  int *moved =
+      arena_resize(&arena, grown, 64 * sizeof(int), 128 * sizeof(int));
+  ASSERT_TRUE(moved != grown && moved != NULL,
+              "Older allocation should be copied");
+  ASSERT_EQUAL_INT(3, moved[3], "Contents should survive the copy");
+  ASSERT_NOT_NULL(other, "Interleaved allocation should succeed");
+
+  arena_free(&arena);
+}
+
+void test_arena_large_allocation_gets_own_block(void) {
+  Arena arena;
+  arena_init(&arena);
+
+  arena_alloc(&arena, 16);
+  void *big = arena_alloc(&arena, ARENA_BLOCK_SIZE * 2);
+  ASSERT_NOT_NULL(big, "Large allocation should succeed");
+  ASSERT_EQUAL_INT(2, (int)arena.stats.block_mallocs,
+                   "Large allocation should get a block of its own");
+  ASSERT_TRUE(arena.stats.bytes_reserved >= ARENA_BLOCK_SIZE * 3,
+              "Reserved bytes should cover both blocks");
+
+  arena_free(&arena);
+}
+
+void test_arena_reset_reuses_blocks(void) {
+  Arena arena;
+  arena_init(&arena);
+  size_t sizes[] = {100, ARENA_BLOCK_SIZE / 2, ARENA_BLOCK_SIZE * 3, 40, 7};
+
+  for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+    arena_alloc(&arena, sizes[i]);
+  }
+  size_t blocks = arena.stats.block_mallocs;
+
+  arena_reset(&arena);
+  ASSERT_EQUAL_INT(0, (int)arena.stats.allocations,
+                   "Reset should clear the allocation count");
+
+  for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+    ASSERT_NOT_NULL(arena_alloc(&arena, sizes[i]),
+                    "Allocation after reset should succeed");
+  }
+  ASSERT_EQUAL_INT((int)blocks, (int)arena.stats.block_mallocs,
+                   "Repeating the same allocations should not malloc");
+  ASSERT_EQUAL_INT(1, (int)arena.stats.resets, "Resets should be counted");
+
+  arena_free(&arena);
+}
+
+void test_arena_null_falls_back_to_heap(void) {
+  char *text = arena_strdup(NULL, "heap copy");
+  ASSERT_EQUAL_STRING("heap copy", text, "strdup should copy to the heap");
+
+  int *values = arena_calloc(NULL, 4, sizeof(int));
+  ASSERT_TRUE(values && values[3] == 0, "calloc should zero heap memory");
+  values = arena_resize(NULL, values, 4 * sizeof(int), 8 * sizeof(int));
+  ASSERT_NOT_NULL(values, "Resize should realloc heap memory");
+
+  arena_release(NULL, text);
+  arena_release(NULL, values);
+  arena_free(NULL);
+  arena_reset(NULL);
+}
+
+// =============================================================================
+// database arena tests
+// =============================================================================
+
+void test_table_in_arena_matches_heap_table(void) {
+  Arena arena;
+  arena_init(&arena);
+  StudentTable *table = table_init_in_arena(&arena, "Test");
+
+  for (int i = 0; i < 200; i++) {
+    StudentRecord r = create_test_record(2500000 + i, "Student", "CS",
+                                         (float)(i % 100));
+    table_add_record(table, &r);
+  }
+  table_remove_record(table, 2500007);
+
+  ASSERT_TRUE(table->arena == &arena, "Table should remember its arena");
+  ASSERT_EQUAL_INT(199, (int)table->record_count, "Records should be added");
+  ASSERT_TRUE(table_find_position(table, 2500150) != ID_INDEX_NOT_FOUND,
+              "Index should find arena records");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_layout(table, TABLE_LAYOUT_COLUMNS),
+                   "Column layout should allocate from the arena");
+  ASSERT_TRUE(table->columns.arena == &arena,
+              "Column store should share the table's arena");
+  ASSERT_EQUAL_INT(2500150, table_record_id(table, 149),
+                   "Records should survive the conversion");
+
+  table_free(table);
+  arena_free(&arena);
+}
+
+void test_db_reload_reuses_arena(void) {
+  StudentDatabase *db = db_init();
+  const char *path = get_test_file_path("test_valid.txt");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_load(db, path, NULL),
+                   "First load should succeed");
+  size_t records = db->tables[0]->record_count;
+  size_t blocks = db->arena.stats.block_mallocs;
+  ASSERT_TRUE(db->tables[0]->arena == &db->arena,
+              "Loaded tables should live in the database arena");
+  ASSERT_TRUE(blocks > 0, "Load should reserve arena memory");
+
+  db_clear(db);
+  ASSERT_EQUAL_INT(0, (int)db->table_count, "Clear should drop every table");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_load(db, path, NULL),
+                   "Reload should succeed");
+  ASSERT_EQUAL_INT((int)records, (int)db->tables[0]->record_count,
+                   "Reload should see the same records");
+  ASSERT_EQUAL_INT((int)blocks, (int)db->arena.stats.block_mallocs,
+                   "Reload should reuse the arena's blocks");
+  ASSERT_EQUAL_STRING("ID", db->tables[0]->column_headers[0],
+                      "Headers should be copied into the arena");
+
+  db_free(db);
+}
+
+// delete one record and insert another count times, sorting now and then
+static bool churn_table(StudentTable *table, int first_id, int count) {
+  bool ok = true;
+  for (int i = 0; i < count; i++) {
+    int id = first_id + i;
+    char name[32];
+    snprintf(name, sizeof name, "Student %d", id);
+    StudentRecord r = create_test_record(id, name, i % 2 ? "CS" : "Maths",
+                                         (float)(i % 100));
+    ok = ok && table_remove_record(table, id - 1000) == DB_SUCCESS &&
+         table_add_record(table, &r) == DB_SUCCESS;
+    if (i % 500 == 0) {
+      table_set_view(table, TABLE_VIEW_MARK_DESC);
+      ok = ok && table_compact(table) == DB_SUCCESS;
+    }
+  }
+  return ok;
+}
+
+void test_table_churn_keeps_arena_bounded(void) {
+  TableLayout layouts[] = {TABLE_LAYOUT_ROWS, TABLE_LAYOUT_COLUMNS};
+  for (size_t l = 0; l < 2; l++) {
+    Arena arena;
+    arena_init(&arena);
+    StudentTable *table = table_init_in_arena(&arena, "Test");
+    table_set_layout(table, layouts[l]);
+    for (int i = 0; i < 1000; i++) {
+      StudentRecord r = create_test_record(2500000 + i, "Student", "CS",
+                                           (float)(i % 100));
+      table_add_record(table, &r);
+    }
+
+    // purges, compactions and index rebuilds reuse the table's buffers, so
+    // once the pools have grown to fit, churn takes no more arena memory
+    bool ok = churn_table(table, 2501000, 5000);
+    size_t used = arena.stats.bytes_used;
+    ok = churn_table(table, 2506000, 20000) && ok;
+    ASSERT_TRUE(ok, "Every delete, insert and compaction should succeed");
+    ASSERT_EQUAL_INT(1000, (int)table->record_count,
+                     "Churn should keep the record count");
+    ASSERT_EQUAL_INT((int)used, (int)arena.stats.bytes_used,
+                     "Churn should not keep taking arena memory");
+    ASSERT_EQUAL_INT(DB_SUCCESS, table_rebuild_index(table),
+                     "Rebuild should succeed");
+    ASSERT_EQUAL_INT((int)used, (int)arena.stats.bytes_used,
+                     "Rebuilding the index should reuse its buffers");
+    ASSERT_EQUAL_STRING("student 2525999",
+                        folded_text_get(&table->folded_names,
+                                        table_find_position(table, 2525999)),
+                        "Folded names should follow the records");
+
+    table_free(table);
+    arena_free(&arena);
+  }
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Arena Tests");
+
+  RUN_TEST(test_arena_alloc_is_aligned_and_counted);
+  RUN_TEST(test_arena_resize_in_place_and_copy);
+  RUN_TEST(test_arena_large_allocation_gets_own_block);
+  RUN_TEST(test_arena_reset_reuses_blocks);
+  RUN_TEST(test_arena_null_falls_back_to_heap);
+
+  RUN_TEST(test_table_in_arena_matches_heap_table);
+  RUN_TEST(test_db_reload_reuses_arena);
+  RUN_TEST(test_table_churn_keeps_arena_bounded);
+
+  TEST_SUITE_END();
+}
@@ -0,0 +1,112 @@
+#include "../include/atomic_file.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ATOMIC_TEMP "tests/fixtures/test_atomic_temp.txt"
+#define ATOMIC_TEMP_TMP ATOMIC_TEMP ".tmp"
+
+static void write_file(const char *path, const char *text) {
+  FILE *fp = fopen(path, "wb");
+  if (fp) {
+    fputs(text, fp);
+    fclose(fp);
+  }
+}
+
+// the first line of a file, or "" if it cannot be read
+static void read_line(const char *path, char *out, size_t size) {
+  out[0] = '\0';
+  FILE *fp = fopen(path, "rb");
+  if (fp) {
+    if (!fgets(out, (int)size, fp)) {
+      out[0] = '\0';
+    }
+    fclose(fp);
+  }
+}
+
+static bool file_exists(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (fp) {
+    fclose(fp);
+  }
+  return fp != NULL;
+}
+
+// =============================================================================
+// atomic file tests
+// =============================================================================
+
+void test_atomic_file_commit_replaces_target(void) {
+  write_file(ATOMIC_TEMP, "old");
+
+  AtomicFile file;
+  FILE *fp = atomic_file_open(&file, ATOMIC_TEMP);
+  ASSERT_NOT_NULL(fp, "Temp file should open");
+  fputs("new", fp);
+
+  char line[16];
+  read_line(ATOMIC_TEMP, line, sizeof line);
+  ASSERT_EQUAL_STRING("old", line, "Target should be untouched while writing");
+  ASSERT_TRUE(file_exists(ATOMIC_TEMP_TMP), "Writes should go to the temp");
+
+  ASSERT_TRUE(atomic_file_commit(&file), "Commit should succeed");
+  read_line(ATOMIC_TEMP, line, sizeof line);
+  ASSERT_EQUAL_STRING("new", line, "Commit should replace the target");
+  ASSERT_FALSE(file_exists(ATOMIC_TEMP_TMP), "Temp should be renamed away");
+  ASSERT_NULL(file.fp, "Commit should close the stream");
+
+  // a target that does not exist yet is created
+  remove(ATOMIC_TEMP);
+  fp = atomic_file_open(&file, ATOMIC_TEMP);
+  fputs("created", fp);
+  ASSERT_TRUE(atomic_file_commit(&file), "Commit should create the target");
+  read_line(ATOMIC_TEMP, line, sizeof line);
+  ASSERT_EQUAL_STRING("created", line, "New target should hold the bytes");
+  remove(ATOMIC_TEMP);
+}
+
+void test_atomic_file_abort_keeps_target(void) {
+  write_file(ATOMIC_TEMP, "kept");
+
+  AtomicFile file;
+  FILE *fp = atomic_file_open(&file, ATOMIC_TEMP);
+  ASSERT_NOT_NULL(fp, "Temp file should open");
+  fputs("discarded", fp);
+  atomic_file_abort(&file);
+
+  char line[16];
+  read_line(ATOMIC_TEMP, line, sizeof line);
+  ASSERT_EQUAL_STRING("kept", line, "Abort should leave the target");
+  ASSERT_FALSE(file_exists(ATOMIC_TEMP_TMP), "Abort should remove the temp");
+  atomic_file_abort(&file);
+  atomic_file_abort(NULL);
+  remove(ATOMIC_TEMP);
+}
+
+void test_atomic_file_rejects_bad_paths(void) {
+  AtomicFile file;
+  char path[MAX_FILE_PATH + 16];
+  memset(path, 'a', sizeof path - 1);
+  path[sizeof path - 1] = '\0';
+  ASSERT_NULL(atomic_file_open(&file, path), "Over-long path should fail");
+  ASSERT_NULL(atomic_file_open(&file, "tests/no_such_dir/file.txt"),
+              "Missing directory should fail");
+  ASSERT_NULL(file.fp, "Failed open should leave no stream");
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Atomic File Tests");
+
+  RUN_TEST(test_atomic_file_commit_replaces_target);
+  RUN_TEST(test_atomic_file_abort_keeps_target);
+  RUN_TEST(test_atomic_file_rejects_bad_paths);
+
+  TEST_SUITE_END();
+}
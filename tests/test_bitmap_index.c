@@ -0,0 +1,224 @@
+/*
+ * test_bitmap_index.c
+ *
+ * unit tests for the bitmap index module
+ * checks mark bands and their verdicts against direct comparisons, adds,
+ * removes and renumbering, and that a table's filter bitmaps follow its
+ * records through adds, updates, deletes, purges and sorts
+ *
+ * functions tested:
+ * - bitmap_index_band()          : band of a mark
+ * - bitmap_index_band_verdict()  : whole-band comparison with a filter
+ * - bitmap_index_range_verdict() : whole-band comparison with an interval
+ * - bitmap_index_add()           : adding a position
+ * - bitmap_index_remove()        : removing a position
+ * - bitmap_index_remap()         : renumbering after a purge
+ * - bitmap_index_programme()     : positions of a programme code
+ * - table_set_filter_index()     : building and dropping a table's bitmaps
+ */
+
+#include "../include/bitmap_index.h"
+#include "../include/database.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <math.h>
+#include <stdlib.h>
+
+// true if a mark passes a MARK filter
+static bool passes(float mark, char op, double value) {
+  return op == '<' ? mark < value : op == '>' ? mark > value : mark == value;
+}
+
+// true if the table's bitmaps hold exactly its live records
+static bool bitmaps_match_records(const StudentTable *table) {
+  const BitmapIndex *index = table->filter_bitmaps;
+  if (!index) {
+    return false;
+  }
+  for (size_t p = 0; p < table->slot_count; p++) {
+    if (!table_is_live(table, p)) {
+      continue;
+    }
+    const RoaringBitmap *programme =
+        bitmap_index_programme(index, table->prog_codes[p]);
+    size_t band = bitmap_index_band(table_record_mark(table, p));
+    if (!programme || !roaring_contains(programme, (uint32_t)p) ||
+        !roaring_contains(&index->bands[band], (uint32_t)p)) {
+      return false;
+    }
+  }
+  size_t programmes = 0;
+  size_t bands = 0;
+  for (uint32_t code = 0; code < index->programme_count; code++) {
+    programmes += roaring_cardinality(&index->programmes[code]);
+  }
+  for (size_t b = 0; b < MARK_BAND_COUNT; b++) {
+    bands += roaring_cardinality(&index->bands[b]);
+  }
+  return programmes == table->record_count && bands == table->record_count;
+}
+
+// =============================================================================
+// band tests
+// =============================================================================
+
+void test_bands_and_verdicts(void) {
+  ASSERT_EQUAL_INT(0, (int)bitmap_index_band(4.99f), "Below 5 is band 0");
+  ASSERT_EQUAL_INT(1, (int)bitmap_index_band(5.0f), "5 starts band 1");
+  ASSERT_EQUAL_INT(19, (int)bitmap_index_band(99.99f), "Band 19 ends at 100");
+  ASSERT_EQUAL_INT(20, (int)bitmap_index_band(100.0f), "100 is the last band");
+  ASSERT_EQUAL_INT(0, (int)bitmap_index_band(-3.0f), "Negatives go in band 0");
+  ASSERT_EQUAL_INT(0, (int)bitmap_index_band(NAN), "NaN goes in band 0");
+
+  // every verdict must agree with comparing each mark of the band
+  static const char ops[] = {'<', '>', '='};
+  static const double values[] = {-1.0, 0.0, 4.5, 5.0,  60.0, 61.25,
+                                  64.99, 65.0, 99.5, 100.0, 120.0};
+  bool agree = true;
+  for (size_t o = 0; o < 3; o++) {
+    for (size_t v = 0; v < sizeof values / sizeof values[0]; v++) {
+      for (int step = -200; step <= 1100 && agree; step++) {
+        float mark = step == -200 ? NAN : (float)step / 8.0f;
+        size_t band = bitmap_index_band(mark);
+        MarkBandVerdict verdict =
+            bitmap_index_band_verdict(band, ops[o], values[v]);
+        bool pass = passes(mark, ops[o], values[v]);
+        agree = (verdict != MARK_BAND_PASS || pass) &&
+                (verdict != MARK_BAND_FAIL || !pass);
+      }
+    }
+  }
+  ASSERT_TRUE(agree, "Verdicts never contradict a direct comparison");
+
+  // and so must every interval verdict, open or closed at either end
+  static const double bounds[][2] = {{60.0, 70.0},   {62.5, 62.5},
+                                     {-5.0, 4.99},   {95.0, 100.0},
+                                     {70.0, 60.0},   {-INFINITY, 65.0},
+                                     {65.0, INFINITY}};
+  for (size_t i = 0; i < sizeof bounds / sizeof bounds[0]; i++) {
+    for (int open = 0; open < 4; open++) {
+      double low = bounds[i][0];
+      double high = bounds[i][1];
+      bool low_open = open & 1;
+      bool high_open = open & 2;
+      for (int step = -200; step <= 1100 && agree; step++) {
+        float mark = step == -200 ? NAN : (float)step / 8.0f;
+        MarkBandVerdict verdict = bitmap_index_range_verdict(
+            bitmap_index_band(mark), low, low_open, high, high_open);
+        bool pass = (low_open ? mark > low : mark >= low) &&
+                    (high_open ? mark < high : mark <= high);
+        agree = (verdict != MARK_BAND_PASS || pass) &&
+                (verdict != MARK_BAND_FAIL || !pass);
+      }
+    }
+  }
+  ASSERT_TRUE(agree, "Interval verdicts never contradict a direct check");
+  ASSERT_EQUAL_INT(MARK_BAND_PASS,
+                   bitmap_index_range_verdict(13, 65.0, false, 70.0, false),
+                   "Band [65, 70) wholly lies in [65, 70]");
+  ASSERT_EQUAL_INT(MARK_BAND_CHECK,
+                   bitmap_index_range_verdict(13, 65.0, true, 70.0, false),
+                   "Band [65, 70) straddles (65, 70]");
+  ASSERT_EQUAL_INT(MARK_BAND_FAIL,
+                   bitmap_index_range_verdict(14, 65.0, false, 70.0, true),
+                   "Band [70, 75) lies outside [65, 70)");
+  ASSERT_EQUAL_INT(MARK_BAND_PASS, bitmap_index_band_verdict(14, '>', 65.0),
+                   "Band [70, 75) wholly passes MARK > 65");
+  ASSERT_EQUAL_INT(MARK_BAND_CHECK, bitmap_index_band_verdict(13, '>', 65.0),
+                   "Band [65, 70) straddles MARK > 65");
+  ASSERT_EQUAL_INT(MARK_BAND_FAIL, bitmap_index_band_verdict(12, '>', 65.0),
+                   "Band [60, 65) wholly fails MARK > 65");
+}
+
+// =============================================================================
+// index tests
+// =============================================================================
+
+void test_add_remove_and_remap(void) {
+  BitmapIndex index;
+  bitmap_index_init(&index);
+  ASSERT_TRUE(bitmap_index_add(&index, 3, 0, 72.0f), "Add should succeed");
+  ASSERT_TRUE(bitmap_index_add(&index, 8, 20, 12.0f),
+              "A new code grows the programme bitmaps");
+  ASSERT_TRUE(bitmap_index_add(&index, 9, 0, 74.5f), "Add should succeed");
+  ASSERT_NULL(bitmap_index_programme(&index, 500), "Unseen code has none");
+  ASSERT_EQUAL_INT(2,
+                   (int)roaring_cardinality(bitmap_index_programme(&index, 0)),
+                   "Two positions hold code 0");
+  ASSERT_EQUAL_INT(2, (int)roaring_cardinality(&index.bands[14]),
+                   "Two marks fall in band 14");
+
+  bitmap_index_remove(&index, 3, 0, 72.0f);
+  ASSERT_FALSE(roaring_contains(&index.bands[14], 3), "Removed from its band");
+  ASSERT_FALSE(roaring_contains(bitmap_index_programme(&index, 0), 3),
+               "Removed from its programme");
+
+  uint32_t new_position[10] = {0};
+  new_position[8] = 0;
+  new_position[9] = 1;
+  ASSERT_TRUE(bitmap_index_remap(&index, new_position), "Remap should work");
+  ASSERT_TRUE(roaring_contains(bitmap_index_programme(&index, 20), 0) &&
+                  roaring_contains(&index.bands[14], 1),
+              "Remap renumbers the positions");
+  ASSERT_TRUE(bitmap_index_memory(&index) > 0, "Bitmaps hold memory");
+  bitmap_index_free(&index);
+  ASSERT_EQUAL_INT(0, (int)bitmap_index_memory(&index),
+                   "A freed index holds nothing");
+}
+
+// =============================================================================
+// table maintenance tests
+// =============================================================================
+
+void test_table_filter_bitmaps_follow_records(void) {
+  StudentDatabase *db = create_test_database_with_records(60);
+  ASSERT_NOT_NULL(db, "Database should be created");
+  if (!db) {
+    return;
+  }
+  StudentTable *table = db->tables[0];
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_filter_index(table, true),
+                   "Bitmaps should be built");
+  ASSERT_TRUE(bitmaps_match_records(table), "Bitmaps cover loaded records");
+
+  StudentRecord record = {.id = 2500900, .name = "Nur Aisyah",
+                          .prog = "Data Science", .mark = 99.0f};
+  table_add_record(table, &record);
+  float mark = 12.5f;
+  db_update_record(db, 2500110, NULL, "Programme3", NULL);
+  db_update_record(db, 2500111, NULL, NULL, &mark);
+  db_update_record(db, 2500112, NULL, "Cyber Security", &mark);
+  ASSERT_TRUE(bitmaps_match_records(table), "Bitmaps follow adds and updates");
+
+  for (int i = 0; i < 60; i += 4) {
+    table_remove_record(table, 2500100 + i);
+  }
+  ASSERT_TRUE(bitmaps_match_records(table), "Bitmaps follow deletes");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_purge_tombstones(table),
+                   "Purge should succeed");
+  ASSERT_TRUE(bitmaps_match_records(table), "Bitmaps follow a purge");
+
+  table_set_view(table, TABLE_VIEW_MARK_ASC);
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_compact(table), "Compact should succeed");
+  ASSERT_TRUE(bitmaps_match_records(table), "Bitmaps follow a sort");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_filter_index(table, false),
+                   "Bitmaps should be dropped");
+  ASSERT_NULL(table->filter_bitmaps, "Dropped bitmaps are gone");
+  db_free(db);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Bitmap Index Tests");
+
+  RUN_TEST(test_bands_and_verdicts);
+  RUN_TEST(test_add_remove_and_remap);
+
+  RUN_TEST(test_table_filter_bitmaps_follow_records);
+
+  TEST_SUITE_END();
+}
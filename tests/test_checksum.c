@@ -7,14 +7,24 @@
  * functions tested:
  * - compute_record_checksum()   : computes checksum of individual record
  * - compute_database_checksum() : computes checksum of entire database
+ * - tracked_database_checksum() : checksum maintained as records change
  * - compute_file_checksum()     : computes checksum of file on disk
+ * - crc32_update()              : slicing-by-8 crc32 kernel
+ * - crc32_combine()             : joins checksums of adjacent ranges
+ * - compute_fast_hash()         : fast hash used by CHECKSUM_MODE_FAST
+ * - db_load() / db_save()       : file checksums taken while reading/writing
  */
 
 #include "../include/checksum.h"
 #include "../include/database.h"
+#include "../include/table_view.h"
 #include "test_utils.h"
+#include <stdio.h>
 #include <string.h>
 
+#define CHECKSUM_TEMP "tests/fixtures/test_checksum_temp.txt"
+#define CHECKSUM_SNAPSHOT_TEMP "tests/fixtures/test_checksum_temp.cmsb"
+
 // helper functions
 // create a test database with empty student records table
 StudentDatabase *create_test_database_for_checksum(void) {
@@ -49,6 +59,18 @@ void add_test_record_to_database(StudentDatabase *db, int id, const char *name,
   table_add_record(table, &record);
 }
 
+// bit-at-a-time crc32, the definition the table kernel must match
+static unsigned long reference_crc32(const unsigned char *data, size_t length) {
+  unsigned long crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
 // compute_record_checksum() tests
 void test_record_checksum_null(void) {
   unsigned long checksum = compute_record_checksum(NULL);
@@ -254,6 +276,34 @@ void test_database_checksum_modification_detection(void) {
   }
 }
 
+void test_database_checksum_skips_tombstones(void) {
+  StudentDatabase *with_delete = create_test_database_for_checksum();
+  StudentDatabase *without = create_test_database_for_checksum();
+  ASSERT_NOT_NULL(with_delete, "test database creation should succeed");
+  ASSERT_NOT_NULL(without, "test database creation should succeed");
+
+  if (with_delete && without) {
+    add_test_record_to_database(with_delete, 2301234, "Joshua Chen",
+                                "Software Engineering", 70.5f);
+    // enough live records that one delete stays below the purge ratio
+    for (int i = 0; i < 4; i++) {
+      add_test_record_to_database(with_delete, 2201234 + i, "Isaac Teo",
+                                  "Computer Science", 63.4f + i);
+      add_test_record_to_database(without, 2201234 + i, "Isaac Teo",
+                                  "Computer Science", 63.4f + i);
+    }
+    table_remove_record(with_delete->tables[0], 2301234);
+
+    ASSERT_TRUE(with_delete->tables[0]->tombstone_count == 1,
+                "delete should leave a tombstone");
+    ASSERT_TRUE(compute_database_checksum(with_delete) ==
+                    compute_database_checksum(without),
+                "deleted records should not contribute to the checksum");
+  }
+  db_free(with_delete);
+  db_free(without);
+}
+
 void test_database_checksum_not_loaded(void) {
   StudentDatabase *db = db_init();
   ASSERT_NOT_NULL(db, "database init should succeed");
@@ -279,6 +329,272 @@ void test_database_checksum_no_tables(void) {
   }
 }
 
+// tracked_database_checksum() tests
+void test_tracked_checksum_follows_changes(void) {
+  StudentDatabase *db = create_test_database_for_checksum();
+  ASSERT_NOT_NULL(db, "test database creation should succeed");
+  StudentTable *table = db->tables[0];
+
+  ASSERT_TRUE(tracked_database_checksum(db) == 0,
+              "empty database should return 0");
+  for (int i = 0; i < 40; i++) {
+    add_test_record_to_database(db, 2300000 + i, "Mei Ling",
+                                i % 2 ? "Computing" : "Design", 40.0f + i);
+  }
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "tracked checksum should follow adds");
+
+  float mark = 99.0f;
+  db_update_record(db, 2300003, "Renamed", "Law", &mark);
+  db_update_record(db, 2300004, NULL, NULL, &mark);
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "tracked checksum should follow updates");
+
+  unsigned long before = tracked_database_checksum(db);
+  float bad_mark = 150.0f;
+  db_update_record(db, 2300005, NULL, NULL, &bad_mark);
+  ASSERT_TRUE(tracked_database_checksum(db) == before,
+              "rejected update should leave the checksum alone");
+
+  // enough deletes to trigger a purge of the tombstones
+  for (int i = 10; i < 30; i++) {
+    table_remove_record(table, 2300000 + i);
+  }
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "tracked checksum should follow deletes and purges");
+
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+  table_compact(table);
+  table_set_layout(table, TABLE_LAYOUT_COLUMNS);
+  db_update_record(db, 2300001, "Column Name", "Music", NULL);
+  table_remove_record(table, 2300002);
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "reordering and column layout should keep it in step");
+
+  for (int i = 0; i < 40; i++) {
+    table_remove_record(table, 2300000 + i);
+  }
+  ASSERT_TRUE(tracked_database_checksum(db) == 0,
+              "database emptied by deletes should return 0");
+  ASSERT_TRUE(table->record_checksum == 0,
+              "every record checksum should have been removed");
+  db_free(db);
+}
+
+void test_tracked_checksum_after_load(void) {
+  StudentDatabase *db = db_init();
+  ASSERT_EQUAL_INT(DB_SUCCESS,
+                   db_load(db, get_test_file_path("test_valid.txt"), NULL),
+                   "fixture should load");
+  db->is_loaded = true;
+  ASSERT_TRUE(tracked_database_checksum(db) != 0,
+              "loaded database should have a checksum");
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "loading should maintain the checksum");
+
+  db->is_loaded = false;
+  ASSERT_TRUE(tracked_database_checksum(db) == 0,
+              "not loaded database should return 0");
+  ASSERT_TRUE(tracked_database_checksum(NULL) == 0,
+              "null database should return 0");
+  db_free(db);
+}
+
+void test_fast_checksum_mode(void) {
+  StudentDatabase *db = create_test_database_for_checksum();
+  ASSERT_NOT_NULL(db, "test database creation should succeed");
+  for (int i = 0; i < 10; i++) {
+    add_test_record_to_database(db, 2300000 + i, "Aisha Rahman", "Biology",
+                                50.0f + i);
+  }
+  unsigned long crc_checksum = tracked_database_checksum(db);
+
+  // switching mode recomputes the tracked value with the fast hash
+  table_set_checksum_mode(db->tables[0], CHECKSUM_MODE_FAST);
+  ASSERT_TRUE(tracked_database_checksum(db) != crc_checksum,
+              "fast mode should give a different checksum");
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "fast mode should be tracked like crc32");
+
+  float mark = 12.0f;
+  unsigned long before = tracked_database_checksum(db);
+  db_update_record(db, 2300002, NULL, NULL, &mark);
+  table_remove_record(db->tables[0], 2300003);
+  ASSERT_TRUE(tracked_database_checksum(db) != before,
+              "fast mode should detect changes");
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "fast mode should follow updates and deletes");
+
+  table_set_checksum_mode(db->tables[0], CHECKSUM_MODE_CRC32);
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "switching back should recompute with crc32");
+  db_free(db);
+
+  // tables added to a fast database take its mode
+  db = db_init();
+  db->checksum_mode = CHECKSUM_MODE_FAST;
+  db_load(db, get_test_file_path("test_valid.txt"), NULL);
+  db->is_loaded = true;
+  ASSERT_EQUAL_INT(CHECKSUM_MODE_FAST, db->tables[0]->checksum_mode,
+                   "loaded table should use the database's mode");
+  ASSERT_TRUE(tracked_database_checksum(db) == compute_database_checksum(db),
+              "loaded table should be tracked in fast mode");
+  db_free(db);
+}
+
+// crc32_update() and compute_fast_hash() tests
+void test_crc32_known_value(void) {
+  ASSERT_TRUE(crc32_update(0, "123456789", 9) == 0xCBF43926,
+              "crc32 of the standard check string should be 0xCBF43926");
+  ASSERT_TRUE(crc32_update(0, "", 0) == 0, "crc32 of nothing should be 0");
+}
+
+void test_crc32_matches_reference(void) {
+  unsigned char data[200];
+  for (size_t i = 0; i < sizeof data; i++) {
+    data[i] = (unsigned char)(i * 131 + 7);
+  }
+
+  // every alignment and every tail length of the 8-byte loop
+  bool match = true;
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t length = 0; length + offset <= 80; length++) {
+      match = match && crc32_update(0, data + offset, length) ==
+                           reference_crc32(data + offset, length);
+    }
+  }
+  ASSERT_TRUE(match, "table kernel should match the bitwise definition");
+
+  // extending a checksum equals checksumming the whole buffer
+  unsigned long split = crc32_update(crc32_update(0, data, 77), data + 77,
+                                     sizeof data - 77);
+  ASSERT_TRUE(split == crc32_update(0, data, sizeof data),
+              "crc32 should extend across calls");
+}
+
+void test_crc32_combine(void) {
+  unsigned char data[300];
+  for (size_t i = 0; i < sizeof data; i++) {
+    data[i] = (unsigned char)(i * 29 + 3);
+  }
+
+  bool match = true;
+  for (size_t split = 0; split <= sizeof data; split += 7) {
+    unsigned long first = crc32_update(0, data, split);
+    unsigned long second = crc32_update(0, data + split, sizeof data - split);
+    match = match && crc32_combine(first, second, sizeof data - split) ==
+                         crc32_update(0, data, sizeof data);
+  }
+  ASSERT_TRUE(match, "combined checksums should equal the whole buffer's");
+  ASSERT_TRUE(crc32_combine(0x12345678, 0, 0) == 0x12345678,
+              "combining with an empty range should change nothing");
+}
+
+void test_file_checksum_buffered_reads(void) {
+  // larger than one read buffer, with a partial last read
+  static unsigned char data[150001];
+  for (size_t i = 0; i < sizeof data; i++) {
+    data[i] = (unsigned char)('a' + i % 26);
+  }
+  FILE *fp = fopen(CHECKSUM_TEMP, "wb");
+  fwrite(data, 1, sizeof data, fp);
+  fclose(fp);
+
+  ASSERT_TRUE(compute_file_checksum(CHECKSUM_TEMP) ==
+                  reference_crc32(data, sizeof data),
+              "file checksum should cover every byte of the file");
+  remove(CHECKSUM_TEMP);
+}
+
+void test_fast_hash(void) {
+  const char *text = "Student Records Table";
+  size_t length = strlen(text);
+  ASSERT_TRUE(compute_fast_hash(text, length) ==
+                  compute_fast_hash(text, length),
+              "fast hash should be deterministic");
+  ASSERT_TRUE(compute_fast_hash(text, length) !=
+                  compute_fast_hash("Student Records Tabl3", length),
+              "fast hash should change with one byte");
+  ASSERT_TRUE(compute_fast_hash("a", 1) != compute_fast_hash("a\0", 2),
+              "fast hash should depend on the length");
+  ASSERT_TRUE(compute_fast_hash(text, length) <= 0xFFFFFFFFul,
+              "fast hash should fit in 32 bits");
+}
+
+// db_load() and db_save() file checksum tests
+// write a text database large enough to be parsed on several threads, with
+// a blank line and an invalid record inside the record section
+static void write_large_database(const char *path, size_t count) {
+  FILE *fp = fopen(path, "wb");
+  fprintf(fp, "Database Name: Checksum\nAuthors: Tests\n\n");
+  fprintf(fp, "Table Name: StudentRecords\nID\tName\tProgramme\tMark\n");
+  for (size_t i = 0; i < count; i++) {
+    fprintf(fp, "%zu\tStudent Number %zu\tComputer Science\t%.2f\n",
+            2500000 + i, i, (double)(i % 101));
+    if (i == count / 2) {
+      fprintf(fp, "\nnot a record\n");
+    }
+  }
+  fclose(fp);
+}
+
+void test_load_sets_file_checksum(void) {
+  write_large_database(CHECKSUM_TEMP, 30000);
+
+  static const ChecksumMode modes[] = {CHECKSUM_MODE_CRC32,
+                                       CHECKSUM_MODE_FAST};
+  for (size_t m = 0; m < 2; m++) {
+    StudentDatabase *db = db_init();
+    db->checksum_mode = modes[m];
+    ASSERT_TRUE(db_load(db, CHECKSUM_TEMP, NULL) == DB_SUCCESS,
+                "large database should load");
+    db->is_loaded = true;
+    ASSERT_TRUE(db->file_loaded_checksum ==
+                    compute_file_checksum(CHECKSUM_TEMP),
+                "load should checksum the file it parses");
+    ASSERT_TRUE(tracked_database_checksum(db) ==
+                    compute_database_checksum(db),
+                "records hashed while parsing should match a recompute");
+    db_free(db);
+  }
+  remove(CHECKSUM_TEMP);
+}
+
+void test_save_sets_file_checksum(void) {
+  write_large_database(CHECKSUM_TEMP, 2000);
+  StudentDatabase *db = db_init();
+  db_load(db, CHECKSUM_TEMP, NULL);
+  db->is_loaded = true;
+  table_remove_record(db->tables[0], 2500010);
+  table_set_view(db->tables[0], TABLE_VIEW_MARK_DESC);
+
+  db->file_loaded_checksum = 0;
+  ASSERT_TRUE(db_save(db, CHECKSUM_TEMP) == DB_SUCCESS,
+              "text save should succeed");
+  ASSERT_TRUE(db->file_loaded_checksum ==
+                  compute_file_checksum(CHECKSUM_TEMP),
+              "text save should checksum the bytes it writes");
+
+  db->file_loaded_checksum = 0;
+  ASSERT_TRUE(db_save(db, CHECKSUM_SNAPSHOT_TEMP) == DB_SUCCESS,
+              "snapshot save should succeed");
+  unsigned long snapshot_checksum =
+      compute_file_checksum(CHECKSUM_SNAPSHOT_TEMP);
+  ASSERT_TRUE(db->file_loaded_checksum == snapshot_checksum,
+              "snapshot save should checksum the file as written");
+  db_free(db);
+
+  StudentDatabase *loaded = db_init();
+  ASSERT_TRUE(db_load(loaded, CHECKSUM_SNAPSHOT_TEMP, NULL) == DB_SUCCESS,
+              "snapshot should load");
+  ASSERT_TRUE(loaded->file_loaded_checksum == snapshot_checksum,
+              "snapshot load should checksum the file it verifies");
+  db_free(loaded);
+
+  remove(CHECKSUM_TEMP);
+  remove(CHECKSUM_SNAPSHOT_TEMP);
+}
+
 // compute_file_checksum() tests
 void test_file_checksum_null(void) {
   unsigned long checksum = compute_file_checksum(NULL);
@@ -337,14 +653,31 @@ int main(void) {
   RUN_TEST(test_database_checksum_multiple_records);
   RUN_TEST(test_database_checksum_consistency);
   RUN_TEST(test_database_checksum_modification_detection);
+  RUN_TEST(test_database_checksum_skips_tombstones);
   RUN_TEST(test_database_checksum_not_loaded);
   RUN_TEST(test_database_checksum_no_tables);
 
+  // tracked_database_checksum tests
+  RUN_TEST(test_tracked_checksum_follows_changes);
+  RUN_TEST(test_tracked_checksum_after_load);
+  RUN_TEST(test_fast_checksum_mode);
+
+  // crc32_update and compute_fast_hash tests
+  RUN_TEST(test_crc32_known_value);
+  RUN_TEST(test_crc32_matches_reference);
+  RUN_TEST(test_crc32_combine);
+  RUN_TEST(test_fast_hash);
+
   // compute_file_checksum tests
   RUN_TEST(test_file_checksum_null);
   RUN_TEST(test_file_checksum_nonexistent_file);
   RUN_TEST(test_file_checksum_valid_file);
   RUN_TEST(test_file_checksum_consistency);
+  RUN_TEST(test_file_checksum_buffered_reads);
+
+  // db_load and db_save file checksum tests
+  RUN_TEST(test_load_sets_file_checksum);
+  RUN_TEST(test_save_sets_file_checksum);
 
   TEST_SUITE_END();
 }
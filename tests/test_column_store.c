@@ -0,0 +1,268 @@
+#include "../include/column_store.h"
+#include "../include/database.h"
+#include "../include/statistics.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// column-layout copy of the standard test table
+static StudentTable *create_column_table(int count) {
+  StudentTable *table = create_test_table_with_records("Test", count);
+  if (table && table_set_layout(table, TABLE_LAYOUT_COLUMNS) != DB_SUCCESS) {
+    table_free(table);
+    return NULL;
+  }
+  return table;
+}
+
+// =============================================================================
+// column store tests
+// =============================================================================
+
+void test_column_store_append_and_read(void) {
+  ColumnStore store;
+  column_store_init(&store);
+
+  ASSERT_TRUE(column_store_reserve(&store, 4), "Reserve should succeed");
+  ASSERT_TRUE(column_store_append(&store, 0, 2500001, "Alice", 75.5f),
+              "First append should succeed");
+  ASSERT_TRUE(column_store_append(&store, 1, 2500002, "Bob", 60.0f),
+              "Second append should succeed");
+
+  ASSERT_EQUAL_INT(2500002, store.ids[1], "ID column should hold the id");
+  ASSERT_EQUAL_FLOAT(75.5f, store.marks[0], 0.001f,
+                     "Mark column should hold the mark");
+  ASSERT_EQUAL_STRING("Bob",
+                      string_pool_get(&store.names, store.name_offsets[1]),
+                      "Name should be read back from the pool");
+  ASSERT_FALSE(column_store_append(&store, 4, 2500003, "X", 1.0f),
+               "Append past capacity should fail");
+
+  column_store_free(&store);
+}
+
+void test_column_store_update_in_place_and_grow(void) {
+  ColumnStore store;
+  column_store_init(&store);
+  column_store_reserve(&store, 2);
+  column_store_append(&store, 0, 2500001, "Alexandra", 50.0f);
+
+  uint32_t before = store.name_offsets[0];
+  ASSERT_TRUE(column_store_update(&store, 0, "Alex", 55.0f),
+              "Shorter update should succeed");
+  ASSERT_TRUE(store.name_offsets[0] == before,
+              "Shorter name should be written in place");
+
+  ASSERT_TRUE(column_store_update(&store, 0, "Alexandra Long", 56.0f),
+              "Longer update should succeed");
+  ASSERT_TRUE(store.name_offsets[0] != before,
+              "Longer name should be appended to the pool");
+  ASSERT_EQUAL_STRING("Alexandra Long",
+                      string_pool_get(&store.names, store.name_offsets[0]),
+                      "Updated name should be readable");
+  ASSERT_TRUE(store.names.dead > 0, "Replaced bytes should be counted dead");
+
+  column_store_free(&store);
+}
+
+void test_column_store_move_row_and_compact_pools(void) {
+  ColumnStore store;
+  column_store_init(&store);
+  column_store_reserve(&store, 8);
+  for (int i = 0; i < 8; i++) {
+    char name[16];
+    snprintf(name, sizeof name, "Name%d", i);
+    column_store_append(&store, (size_t)i, 2500000 + i, name, (float)i);
+  }
+
+  // keep rows 6 and 7 only, as a tombstone purge would
+  column_store_move_row(&store, 0, 6);
+  column_store_move_row(&store, 1, 7);
+  size_t before = store.names.used;
+
+  ASSERT_TRUE(column_store_compact_pools(&store, 2),
+              "Pool compaction should succeed");
+  ASSERT_EQUAL_INT(2500006, store.ids[0], "Moved row should keep its id");
+  ASSERT_EQUAL_FLOAT(7.0f, store.marks[1], 0.001f,
+                     "Moved row should keep its mark");
+  ASSERT_EQUAL_STRING("Name7",
+                      string_pool_get(&store.names, store.name_offsets[1]),
+                      "Offsets should follow compaction");
+  ASSERT_TRUE(store.names.used < before,
+              "Compaction should drop names of dropped rows");
+
+  column_store_free(&store);
+}
+
+void test_column_store_permute(void) {
+  ColumnStore store;
+  column_store_init(&store);
+  column_store_reserve(&store, 3);
+  column_store_append(&store, 0, 2500000, "A", 1.0f);
+  column_store_append(&store, 1, 2500001, "B", 2.0f);
+  column_store_append(&store, 2, 2500002, "C", 3.0f);
+
+  uint32_t perm[3] = {2, 0, 1};
+  ASSERT_TRUE(column_store_permute(&store, perm, 3), "Permute should work");
+  ASSERT_EQUAL_INT(2500002, store.ids[0], "Row 0 should hold old row 2");
+  ASSERT_EQUAL_FLOAT(1.0f, store.marks[1], 0.001f,
+                     "Row 1 should hold old row 0");
+  ASSERT_EQUAL_STRING("B",
+                      string_pool_get(&store.names, store.name_offsets[2]),
+                      "Row 2 should hold old row 1");
+
+  column_store_free(&store);
+}
+
+// =============================================================================
+// column layout table tests
+// =============================================================================
+
+void test_layout_round_trip(void) {
+  StudentTable *rows = create_test_table_with_records("Test", 25);
+  StudentTable *table = create_column_table(25);
+
+  ASSERT_NOT_NULL(table, "Conversion to columns should succeed");
+  ASSERT_EQUAL_INT(TABLE_LAYOUT_COLUMNS, table->layout,
+                   "Table should be in column layout");
+  ASSERT_NULL(table->records, "Row array should be released");
+
+  bool same = true;
+  for (size_t i = 0; i < 25; i++) {
+    StudentRecord r;
+    table_read_record(table, i, &r);
+    same = same && r.id == rows->records[i].id &&
+           r.mark == rows->records[i].mark &&
+           strcmp(r.name, rows->records[i].name) == 0 &&
+           strcmp(r.prog, rows->records[i].prog) == 0;
+  }
+  ASSERT_TRUE(same, "Column layout should hold the same records");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_layout(table, TABLE_LAYOUT_ROWS),
+                   "Conversion back to rows should succeed");
+  ASSERT_TRUE(memcmp(table->records, rows->records,
+                     25 * sizeof(StudentRecord)) == 0,
+              "Round trip should restore identical rows");
+
+  table_free(rows);
+  table_free(table);
+}
+
+void test_column_layout_add_find_remove(void) {
+  StudentTable *table = create_column_table(5);
+  StudentRecord extra = create_test_record(2500999, "Extra", "Maths", 88.0f);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_add_record(table, &extra),
+                   "Add should succeed in column layout");
+  ASSERT_EQUAL_INT(DB_ERROR_DUPLICATE_ID, table_add_record(table, &extra),
+                   "Duplicate should be rejected in column layout");
+
+  size_t position = table_find_position(table, 2500999);
+  ASSERT_TRUE(position == 5, "New record should be found at the end");
+  ASSERT_EQUAL_STRING("Maths", table_record_prog(table, position),
+                      "Programme accessor should read the dictionary");
+  ASSERT_NULL(table_find_record(table, 2500999),
+              "Row pointer lookup is unavailable in column layout");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_remove_record(table, 2500100),
+                   "Remove should succeed in column layout");
+  ASSERT_TRUE(table_find_position(table, 2500100) == ID_INDEX_NOT_FOUND,
+              "Removed record should not be found");
+  ASSERT_EQUAL_INT(2500101, table_record_id(table, table_view_at(table, 0)),
+                   "Remaining rows should come first");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_purge_tombstones(table),
+                   "Purge should succeed in column layout");
+  ASSERT_TRUE(table_find_position(table, 2500999) == 4,
+              "Index should follow the purged columns");
+
+  table_free(table);
+}
+
+void test_column_layout_update(void) {
+  StudentDatabase *db = create_test_database_with_records(4);
+  table_set_layout(db->tables[0], TABLE_LAYOUT_COLUMNS);
+  int id = table_record_id(db->tables[0], 2);
+
+  float mark = 91.25f;
+  ASSERT_EQUAL_INT(DB_SUCCESS,
+                   db_update_record(db, id, "Renamed Student", NULL, &mark),
+                   "Update should succeed in column layout");
+
+  StudentRecord r;
+  table_read_record(db->tables[0], 2, &r);
+  ASSERT_EQUAL_STRING("Renamed Student", r.name, "Name should be updated");
+  ASSERT_EQUAL_FLOAT(91.25f, r.mark, 0.001f, "Mark should be updated");
+
+  cleanup_test_database(db);
+}
+
+void test_column_layout_statistics_match_rows(void) {
+  StudentTable *rows = create_test_table_with_records("Test", 40);
+  StudentTable *columns = create_column_table(40);
+  StudentStatistics a;
+  StudentStatistics b;
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, calculate_statistics(rows, &a),
+                   "Row statistics should succeed");
+  ASSERT_EQUAL_INT(DB_SUCCESS, calculate_statistics(columns, &b),
+                   "Column statistics should succeed");
+  ASSERT_EQUAL_FLOAT(a.average_mark, b.average_mark, 0.0001f,
+                     "Averages should match");
+  ASSERT_EQUAL_INT(a.highest_student_id, b.highest_student_id,
+                   "Highest student should match");
+  ASSERT_EQUAL_STRING(a.lowest_student_name, b.lowest_student_name,
+                      "Lowest student should match");
+
+  table_free(rows);
+  table_free(columns);
+}
+
+void test_column_layout_views_and_compaction(void) {
+  StudentTable *table = create_column_table(30);
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+
+  StudentRecord top = create_test_record(2599999, "Top", "CS", 100.0f);
+  table_add_record(table, &top);
+  table_remove_record(table, 2500110);
+
+  ASSERT_EQUAL_INT(2599999, table_record_id(table, table_view_at(table, 0)),
+                   "Views should follow inserts in column layout");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_compact(table), "Compaction should work");
+  ASSERT_EQUAL_INT(2599999, table_record_id(table, 0),
+                   "Compaction should permute the columns");
+  ASSERT_TRUE(table_find_position(table, 2599999) == 0,
+              "Index should follow compaction");
+
+  bool descending = true;
+  for (size_t i = 1; i < table->record_count; i++) {
+    descending = descending &&
+                 table_record_mark(table, i - 1) >= table_record_mark(table, i);
+  }
+  ASSERT_TRUE(descending, "Stored marks should now be descending");
+
+  table_free(table);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Column Store Tests");
+
+  RUN_TEST(test_column_store_append_and_read);
+  RUN_TEST(test_column_store_update_in_place_and_grow);
+  RUN_TEST(test_column_store_move_row_and_compact_pools);
+  RUN_TEST(test_column_store_permute);
+
+  RUN_TEST(test_layout_round_trip);
+  RUN_TEST(test_column_layout_add_find_remove);
+  RUN_TEST(test_column_layout_update);
+  RUN_TEST(test_column_layout_statistics_match_rows);
+  RUN_TEST(test_column_layout_views_and_compaction);
+
+  TEST_SUITE_END();
+}
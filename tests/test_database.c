@@ -1,6 +1,7 @@
 #include <math.h>
 #include "../include/database.h"
 #include "../include/parser.h"
+#include "../include/table_view.h"
 #include "test_utils.h"
 
 // =============================================================================
@@ -217,8 +218,8 @@ void test_table_remove_record_first(void) {
 
   ASSERT_EQUAL_INT(DB_SUCCESS, status, "Removing first record should succeed");
   if (table->record_count > 0) {
-    ASSERT_EQUAL_INT(second_id, table->records[0].id,
-                     "Second record should shift to first position");
+    ASSERT_EQUAL_INT(second_id, table_record_id(table, table_view_at(table, 0)),
+                     "Second record should now come first");
   }
 
   table_free(table);
@@ -247,8 +248,8 @@ void test_table_remove_record_middle(void) {
 
   ASSERT_EQUAL_INT(DB_SUCCESS, status, "Removing middle record should succeed");
   if (table->record_count > 2) {
-    ASSERT_EQUAL_INT(fourth_id, table->records[2].id,
-                     "Fourth record should shift to middle position");
+    ASSERT_EQUAL_INT(fourth_id, table_record_id(table, table_view_at(table, 2)),
+                     "Fourth record should now come in the middle");
   }
 
   table_free(table);
@@ -280,6 +281,186 @@ void test_table_remove_record_negative_id(void) {
   table_free(table);
 }
 
+// =============================================================================
+// tombstone tests
+// =============================================================================
+
+void test_table_remove_record_leaves_tombstone(void) {
+  StudentTable *table = create_test_table_with_records("Test", 10);
+  int id = table->records[4].id;
+  StudentRecord out;
+
+  table_remove_record(table, id);
+
+  ASSERT_EQUAL_INT(10, (int)table->slot_count, "Slot should stay in place");
+  ASSERT_EQUAL_INT(1, (int)table->tombstone_count, "One tombstone expected");
+  ASSERT_FALSE(table_is_live(table, 4), "Deleted slot should be dead");
+  ASSERT_EQUAL_INT(DB_ERROR_NOT_FOUND, table_read_record(table, 4, &out),
+                   "Deleted slot should not be readable");
+  ASSERT_EQUAL_INT(table->records[5].id,
+                   table_record_id(table, table_view_at(table, 4)),
+                   "Stored order should skip the tombstone");
+
+  StudentRecord again = create_test_record(id, "Back", "CS", 55.0f);
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_add_record(table, &again),
+                   "Deleted ID should be reusable");
+  ASSERT_TRUE(table_find_position(table, id) == 10,
+              "Re-added record should take a fresh slot");
+
+  table_free(table);
+}
+
+void test_table_tombstones_purged_past_threshold(void) {
+  StudentTable *table = create_test_table_with_records("Test", 100);
+  bool bounded = true;
+
+  for (int i = 0; i < 90; i++) {
+    table_remove_record(table, 2500100 + i);
+    bounded = bounded && table->tombstone_count * TOMBSTONE_PURGE_RATIO <=
+                             table->slot_count;
+  }
+
+  ASSERT_TRUE(bounded, "Tombstones should never pass the purge ratio");
+  ASSERT_EQUAL_INT(10, (int)table->record_count, "Ten records should remain");
+  ASSERT_EQUAL_INT(2500190, table_record_id(table, table_view_at(table, 0)),
+                   "Survivors should keep their stored order");
+  ASSERT_TRUE(table_find_position(table, 2500199) < table->slot_count,
+              "Index should follow purged positions");
+
+  table_free(table);
+}
+
+void test_table_purge_tombstones_keeps_views(void) {
+  StudentTable *table = create_test_table_with_records("Test", 20);
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+  table_remove_record(table, 2500119);
+  table_remove_record(table, 2500103);
+
+  int top = table_record_id(table, table_view_at(table, 0));
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_purge_tombstones(table),
+                   "Purge should succeed");
+  ASSERT_EQUAL_INT(18, (int)table->slot_count, "Slots should be dense");
+  ASSERT_EQUAL_INT(top, table_record_id(table, table_view_at(table, 0)),
+                   "Views should be remapped by the purge");
+  ASSERT_EQUAL_INT(DB_ERROR_NULL_POINTER, table_purge_tombstones(NULL),
+                   "NULL table should be rejected");
+
+  table_free(table);
+}
+
+void test_db_save_purges_tombstones(void) {
+  StudentDatabase *db = create_test_database_with_records(8);
+  const char *output_file = "tests/fixtures/test_output_temp.txt";
+  table_remove_record(db->tables[0], 2500102);
+  ASSERT_EQUAL_INT(1, (int)db->tables[0]->tombstone_count,
+                   "Delete should leave a tombstone");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_save(db, output_file),
+                   "Saving should succeed");
+  ASSERT_EQUAL_INT(0, (int)db->tables[0]->tombstone_count,
+                   "Save should purge tombstones");
+  ASSERT_EQUAL_INT(7, (int)db->tables[0]->slot_count,
+                   "Only live records should remain");
+
+  db_free(db);
+  remove(output_file);
+}
+
+// =============================================================================
+// table_find_record() / id index tests
+// =============================================================================
+
+void test_table_add_record_duplicate_id(void) {
+  StudentTable *table = create_test_table_with_records("Test", 3);
+  StudentRecord record =
+      create_test_record(table->records[1].id, "Copy", "Programme", 60.0f);
+
+  DBStatus status = table_add_record(table, &record);
+
+  ASSERT_EQUAL_INT(DB_ERROR_DUPLICATE_ID, status,
+                   "Adding an existing ID should be rejected");
+  ASSERT_EQUAL_INT(3, (int)table->record_count,
+                   "Record count should not change");
+
+  table_free(table);
+}
+
+void test_table_find_record_existing(void) {
+  StudentTable *table = create_test_table_with_records("Test", 20);
+  StudentRecord *record = table_find_record(table, table->records[13].id);
+
+  ASSERT_TRUE(record == &table->records[13],
+              "Should return pointer to the matching record");
+
+  table_free(table);
+}
+
+void test_table_find_record_missing(void) {
+  StudentTable *table = create_test_table_with_records("Test", 5);
+
+  ASSERT_NULL(table_find_record(table, 2599999),
+              "Unknown ID should not be found");
+  ASSERT_NULL(table_find_record(table, -1), "Negative ID should not be found");
+  ASSERT_NULL(table_find_record(NULL, 2500100), "NULL table should be safe");
+
+  table_free(table);
+}
+
+void test_table_find_record_after_remove(void) {
+  StudentTable *table = create_test_table_with_records("Test", 6);
+  int removed_id = table->records[1].id;
+  int shifted_id = table->records[4].id;
+
+  table_remove_record(table, removed_id);
+
+  ASSERT_NULL(table_find_record(table, removed_id),
+              "Removed ID should no longer be found");
+  StudentRecord *record = table_find_record(table, shifted_id);
+  ASSERT_NOT_NULL(record, "Shifted record should still be found");
+  if (record) {
+    ASSERT_EQUAL_INT(shifted_id, record->id,
+                     "Index should point at the shifted position");
+  }
+
+  table_free(table);
+}
+
+void test_table_find_record_out_of_range_ids(void) {
+  StudentTable *table = table_init("Test");
+  int ids[] = {2500500, 1001, 2599999, 42};
+  for (int i = 0; i < 4; i++) {
+    StudentRecord record = create_test_record(ids[i], "Test", "Prog", 50.0f);
+    table_add_record(table, &record);
+  }
+
+  int found = 0;
+  for (int i = 0; i < 4; i++) {
+    StudentRecord *record = table_find_record(table, ids[i]);
+    if (record && record->id == ids[i]) {
+      found++;
+    }
+  }
+  ASSERT_EQUAL_INT(4, found,
+                   "IDs inside and outside the valid range should be found");
+
+  table_free(table);
+}
+
+void test_table_rebuild_index_after_reorder(void) {
+  StudentTable *table = create_test_table_with_records("Test", 4);
+  StudentRecord temp = table->records[0];
+  table->records[0] = table->records[3];
+  table->records[3] = temp;
+
+  DBStatus status = table_rebuild_index(table);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, status, "Rebuilding index should succeed");
+  ASSERT_TRUE(table_find_record(table, temp.id) == &table->records[3],
+              "Index should follow the reordered records");
+
+  table_free(table);
+}
+
 // =============================================================================
 // db_init() tests
 // =============================================================================
@@ -611,6 +792,20 @@ int main(void) {
   RUN_TEST(test_table_remove_record_null_table);
   RUN_TEST(test_table_remove_record_negative_id);
 
+  // tombstone tests
+  RUN_TEST(test_table_remove_record_leaves_tombstone);
+  RUN_TEST(test_table_tombstones_purged_past_threshold);
+  RUN_TEST(test_table_purge_tombstones_keeps_views);
+  RUN_TEST(test_db_save_purges_tombstones);
+
+  // table_find_record / id index tests
+  RUN_TEST(test_table_add_record_duplicate_id);
+  RUN_TEST(test_table_find_record_existing);
+  RUN_TEST(test_table_find_record_missing);
+  RUN_TEST(test_table_find_record_after_remove);
+  RUN_TEST(test_table_find_record_out_of_range_ids);
+  RUN_TEST(test_table_rebuild_index_after_reorder);
+
   // db_init tests
   RUN_TEST(test_db_init_valid);
 
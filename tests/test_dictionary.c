@@ -0,0 +1,181 @@
+#include "../include/database.h"
+#include "../include/dictionary.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// true if every record's programme code decodes to its programme
+static bool codes_match_records(const StudentTable *table) {
+  for (size_t i = 0; i < table->slot_count; i++) {
+    StudentRecord r;
+    if (table_read_record(table, i, &r) != DB_SUCCESS) {
+      continue;
+    }
+    uint32_t code = table->prog_codes[i];
+    if (code >= table->programmes.count ||
+        strcmp(dictionary_get(&table->programmes, code), r.prog) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// =============================================================================
+// dictionary tests
+// =============================================================================
+
+void test_dictionary_intern_and_find(void) {
+  StringDictionary dict;
+  dictionary_init(&dict);
+  uint32_t a = 0;
+  uint32_t b = 0;
+  uint32_t again = 0;
+
+  ASSERT_TRUE(dictionary_find(&dict, "CS") == DICTIONARY_NOT_FOUND,
+              "Empty dictionary should not find anything");
+  ASSERT_TRUE(dictionary_intern(&dict, "Computer Science", &a),
+              "First intern should succeed");
+  ASSERT_TRUE(dictionary_intern(&dict, "Software Engineering", &b),
+              "Second intern should succeed");
+  ASSERT_TRUE(dictionary_intern(&dict, "Computer Science", &again),
+              "Repeated intern should succeed");
+
+  ASSERT_TRUE(a == again, "Same string should get the same code");
+  ASSERT_TRUE(a != b, "Different strings should get different codes");
+  ASSERT_EQUAL_INT(2, (int)dict.count, "Only distinct strings are stored");
+  ASSERT_EQUAL_INT(2, (int)dict.refs[a], "Repeated intern counts references");
+  ASSERT_EQUAL_STRING("Software Engineering", dictionary_get(&dict, b),
+                      "Code should decode to its string");
+  ASSERT_TRUE(dictionary_find(&dict, "computer science") ==
+                  DICTIONARY_NOT_FOUND,
+              "Lookup should be case-sensitive");
+
+  dictionary_free(&dict);
+}
+
+void test_dictionary_release_keeps_code(void) {
+  StringDictionary dict;
+  dictionary_init(&dict);
+  uint32_t code = 0;
+  dictionary_intern(&dict, "Maths", &code);
+
+  dictionary_release(&dict, code);
+  dictionary_release(&dict, code);
+  ASSERT_EQUAL_INT(0, (int)dict.refs[code], "References should not underflow");
+  ASSERT_TRUE(dictionary_find(&dict, "Maths") == code,
+              "Released entry should keep its code");
+
+  dictionary_release(&dict, 99);
+  dictionary_free(&dict);
+}
+
+void test_dictionary_growth_and_clear(void) {
+  StringDictionary dict;
+  dictionary_init(&dict);
+  char text[32];
+  bool ok = true;
+
+  for (int i = 0; i < 500; i++) {
+    uint32_t code = 0;
+    snprintf(text, sizeof text, "Programme %d", i);
+    ok = ok && dictionary_intern(&dict, text, &code) && code == (uint32_t)i;
+  }
+  ASSERT_TRUE(ok, "Codes should be dense in insertion order");
+  ASSERT_TRUE(dict.bucket_count >= 2 * (size_t)dict.count,
+              "Buckets should stay at most half full");
+  ASSERT_TRUE(dictionary_find(&dict, "Programme 321") == 321,
+              "Lookups should survive rehashing");
+
+  dictionary_clear(&dict);
+  ASSERT_EQUAL_INT(0, (int)dict.count, "Clear should drop every entry");
+  ASSERT_TRUE(dictionary_find(&dict, "Programme 1") == DICTIONARY_NOT_FOUND,
+              "Cleared entries should not be found");
+
+  dictionary_free(&dict);
+  dictionary_free(NULL);
+}
+
+// =============================================================================
+// table programme code tests
+// =============================================================================
+
+void test_table_codes_follow_mutations(void) {
+  StudentDatabase *db = create_test_database_with_records(10);
+  StudentTable *table = db->tables[0];
+
+  ASSERT_TRUE(table->programmes.count < table->record_count,
+              "Repeated programmes should share codes");
+  ASSERT_TRUE(codes_match_records(table), "Codes should match after load");
+
+  table_remove_record(table, table_record_id(table, 3));
+  ASSERT_TRUE(codes_match_records(table), "Codes should survive a delete");
+
+  int id = table_record_id(table, 0);
+  ASSERT_EQUAL_INT(DB_SUCCESS,
+                   db_update_record(db, id, NULL, "Data Science", NULL),
+                   "Programme update should succeed");
+  ASSERT_TRUE(codes_match_records(table), "Codes should follow updates");
+  ASSERT_TRUE(dictionary_find(&table->programmes, "Data Science") ==
+                  table->prog_codes[0],
+              "Updated record should use the new programme's code");
+
+  cleanup_test_database(db);
+}
+
+void test_table_codes_follow_compaction_and_rebuild(void) {
+  StudentTable *table = create_test_table_with_records("Test", 30);
+  StudentRecord extra = create_test_record(2599999, "Extra", "Law", 99.0f);
+  table_add_record(table, &extra);
+  table_remove_record(table, 2599999);
+
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_compact(table), "Compaction should work");
+  ASSERT_TRUE(codes_match_records(table), "Codes should follow compaction");
+  ASSERT_TRUE(dictionary_find(&table->programmes, "Law") ==
+                  DICTIONARY_NOT_FOUND,
+              "Rebuild should drop programmes no record uses");
+
+  table_free(table);
+}
+
+void test_column_layout_stores_programme_codes(void) {
+  StudentDatabase *db = create_test_database_with_records(6);
+  StudentTable *table = db->tables[0];
+  table_set_layout(table, TABLE_LAYOUT_COLUMNS);
+
+  StudentRecord extra = create_test_record(2599999, "Extra", "Law", 70.0f);
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_add_record(table, &extra),
+                   "Add should succeed in column layout");
+  ASSERT_EQUAL_STRING("Law", table_record_prog(table, 6),
+                      "Programme should decode from the dictionary");
+
+  db_update_record(db, 2599999, NULL, "Medicine", NULL);
+  ASSERT_EQUAL_STRING("Medicine", table_record_prog(table, 6),
+                      "Programme update should recode the record");
+  ASSERT_TRUE(codes_match_records(table), "Codes should match records");
+
+  table_set_layout(table, TABLE_LAYOUT_ROWS);
+  ASSERT_EQUAL_STRING("Medicine", table->records[6].prog,
+                      "Programme should survive conversion to rows");
+
+  cleanup_test_database(db);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Dictionary Tests");
+
+  RUN_TEST(test_dictionary_intern_and_find);
+  RUN_TEST(test_dictionary_release_keeps_code);
+  RUN_TEST(test_dictionary_growth_and_clear);
+
+  RUN_TEST(test_table_codes_follow_mutations);
+  RUN_TEST(test_table_codes_follow_compaction_and_rebuild);
+  RUN_TEST(test_column_layout_stores_programme_codes);
+
+  TEST_SUITE_END();
+}
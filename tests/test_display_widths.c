@@ -0,0 +1,200 @@
+/*
+ * test_display_widths.c
+ *
+ * unit tests for the display widths module
+ * checks the column widths a table keeps for SHOW ALL against measuring
+ * every record, through adds, removals, updates and bulk changes
+ *
+ * functions tested:
+ * - display_widths_measure() : rendered width of each field
+ * - display_widths_add()     : widening and counting records at a maximum
+ * - display_widths_remove()  : going stale only when a maximum empties
+ * - table_display_widths()   : lazy recount on the table
+ */
+
+#include "../include/database.h"
+#include "../include/display_widths.h"
+#include "../include/sorting.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// true if the table's widths equal a measurement of every live record
+static bool widths_match_records(StudentTable *table) {
+  size_t expected[DISPLAY_FIELD_COUNT] = {0};
+  for (size_t p = 0; p < table->slot_count; p++) {
+    if (!table_is_live(table, p)) {
+      continue;
+    }
+    size_t measured[DISPLAY_FIELD_COUNT];
+    display_widths_measure(table_record_id(table, p),
+                           table_record_name(table, p),
+                           table_record_prog(table, p),
+                           table_record_mark(table, p), measured);
+    for (size_t f = 0; f < DISPLAY_FIELD_COUNT; f++) {
+      if (measured[f] > expected[f]) {
+        expected[f] = measured[f];
+      }
+    }
+  }
+
+  const DisplayWidths *widths = table_display_widths(table);
+  return widths &&
+         memcmp(widths->max, expected, sizeof expected) == 0;
+}
+
+// =============================================================================
+// display_widths_* tests
+// =============================================================================
+
+void test_measure_matches_printf(void) {
+  size_t measured[DISPLAY_FIELD_COUNT];
+  display_widths_measure(-2500001, "Joshua Chen", "Software Engineering",
+                         -70.555f, measured);
+
+  char text[64];
+  ASSERT_EQUAL_INT(snprintf(text, sizeof text, "%d", -2500001),
+                   (int)measured[DISPLAY_FIELD_ID], "ID width as printf");
+  ASSERT_EQUAL_INT(11, (int)measured[DISPLAY_FIELD_NAME], "Name width");
+  ASSERT_EQUAL_INT(20, (int)measured[DISPLAY_FIELD_PROG], "Programme width");
+  ASSERT_EQUAL_INT(snprintf(text, sizeof text, "%.2f", -70.555f),
+                   (int)measured[DISPLAY_FIELD_MARK], "Mark width as printf");
+}
+
+void test_remove_goes_stale_only_for_last_widest(void) {
+  DisplayWidths widths;
+  display_widths_reset(&widths);
+  display_widths_add(&widths, 2500000, "Longest Name", "CS", 50.0f);
+  display_widths_add(&widths, 2500001, "Longest Nam2", "CS", 5.0f);
+  display_widths_add(&widths, 2500002, "Short", "CS", 100.0f);
+
+  ASSERT_EQUAL_INT(12, (int)widths.max[DISPLAY_FIELD_NAME], "Widest name");
+  ASSERT_EQUAL_INT(2, (int)widths.at_max[DISPLAY_FIELD_NAME],
+                   "Two records at the widest name");
+  ASSERT_EQUAL_INT(6, (int)widths.max[DISPLAY_FIELD_MARK], "Widest mark");
+
+  display_widths_remove(&widths, 2500002, "Short", "CS", 5.0f);
+  ASSERT_FALSE(widths.stale, "Removing a narrower record keeps widths");
+
+  display_widths_remove(&widths, 2500000, "Longest Name", "CS", 50.0f);
+  ASSERT_FALSE(widths.stale, "Another record still has the widest name");
+
+  display_widths_remove(&widths, 2500001, "Longest Nam2", "CS", 5.0f);
+  ASSERT_TRUE(widths.stale, "Removing the last widest record goes stale");
+}
+
+// =============================================================================
+// table_display_widths() tests
+// =============================================================================
+
+void test_table_widths_follow_changes(void) {
+  StudentTable *table = create_test_table_with_records("Test", 20);
+  ASSERT_TRUE(widths_match_records(table), "Widths after adds");
+
+  StudentRecord wide = create_test_record(2500500, "A Particularly Long Name",
+                                          "Programme", 100.0f);
+  table_add_record(table, &wide);
+  ASSERT_TRUE(widths_match_records(table), "Wider record widens the table");
+
+  table_remove_record(table, 2500500);
+  ASSERT_TRUE(table->display_widths.stale,
+              "Removing the only widest record should go stale");
+  ASSERT_TRUE(widths_match_records(table), "Recount after the widest went");
+  ASSERT_FALSE(table->display_widths.stale, "Recount clears stale");
+
+  table_free(table);
+}
+
+void test_table_widths_follow_updates(void) {
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records("StudentRecords", 10);
+  db_add_table(db, table);
+
+  float mark = 5.0f;
+  db_update_record(db, 2500101, "Renamed To Something Longer", NULL, &mark);
+  ASSERT_TRUE(widths_match_records(table), "Update widening the name");
+
+  db_update_record(db, 2500101, "Short", NULL, NULL);
+  ASSERT_TRUE(widths_match_records(table), "Update narrowing it again");
+
+  float bad_mark = 150.0f;
+  db_update_record(db, 2500102, "Rejected Because Of Its Mark", NULL,
+                   &bad_mark);
+  ASSERT_TRUE(widths_match_records(table), "Rejected update changes nothing");
+
+  db_free(db);
+}
+
+void test_table_widths_after_bulk_changes(void) {
+  StudentTable *table = create_test_table_with_records("Test", 30);
+  table_remove_record(table, 2500103);
+  table_purge_tombstones(table);
+  ASSERT_TRUE(widths_match_records(table), "Widths after a purge");
+
+  table_set_layout(table, TABLE_LAYOUT_COLUMNS);
+  StudentRecord wide = create_test_record(2500900, "Column Layout Long Name",
+                                          "Programme", 99.5f);
+  table_add_record(table, &wide);
+  table_remove_record(table, 2500900);
+  ASSERT_TRUE(widths_match_records(table), "Widths in column layout");
+
+  table_set_layout(table, TABLE_LAYOUT_ROWS);
+  sort_records(table->records, table->slot_count, SORT_FIELD_MARK,
+               SORT_ORDER_DESC);
+  table_rebuild_index(table);
+  ASSERT_TRUE(table->display_widths.stale, "Rebuilding should recount");
+  ASSERT_TRUE(widths_match_records(table), "Widths after an in-place sort");
+
+  table_free(table);
+}
+
+void test_table_widths_random_changes(void) {
+  StudentTable *table = table_init("Random");
+  srand(7);
+  bool match = true;
+  for (int step = 0; step < 3000 && match; step++) {
+    int id = 2500000 + rand() % 400;
+    if (rand() % 3 == 0) {
+      table_remove_record(table, id);
+    } else {
+      char name[MAX_NAME_LENGTH];
+      snprintf(name, sizeof name, "%.*s", 1 + rand() % 30,
+               "Abcdefghijklmnopqrstuvwxyzabcdefg");
+      StudentRecord record =
+          create_test_record(id, name, "Prog", (float)(rand() % 10001) / 100);
+      table_add_record(table, &record);
+    }
+    if (step % 7 == 0) {
+      match = widths_match_records(table);
+    }
+  }
+  ASSERT_TRUE(match, "Widths should match the records after every change");
+  table_free(table);
+}
+
+void test_table_widths_null(void) {
+  ASSERT_NULL(table_display_widths(NULL), "NULL table has no widths");
+  display_widths_reset(NULL);
+  display_widths_add(NULL, 1, "a", "b", 1.0f);
+  display_widths_remove(NULL, 1, "a", "b", 1.0f);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Display Widths Tests");
+
+  RUN_TEST(test_measure_matches_printf);
+  RUN_TEST(test_remove_goes_stale_only_for_last_widest);
+
+  RUN_TEST(test_table_widths_follow_changes);
+  RUN_TEST(test_table_widths_follow_updates);
+  RUN_TEST(test_table_widths_after_bulk_changes);
+  RUN_TEST(test_table_widths_random_changes);
+  RUN_TEST(test_table_widths_null);
+
+  TEST_SUITE_END();
+}
@@ -0,0 +1,184 @@
+#include "../include/constants.h"
+#include "../include/id_index.h"
+#include "test_utils.h"
+
+// =============================================================================
+// direct-address mode tests
+// =============================================================================
+
+void test_id_index_init_empty(void) {
+  IdIndex index;
+  id_index_init(&index);
+
+  ASSERT_EQUAL_INT(ID_INDEX_DIRECT, index.mode,
+                   "Index should start in direct-address mode");
+  ASSERT_TRUE(index.count == 0, "New index should be empty");
+  ASSERT_TRUE(id_index_find(&index, MIN_STUDENT_ID) == ID_INDEX_NOT_FOUND,
+              "Lookup on empty index should miss");
+
+  id_index_free(&index);
+}
+
+void test_id_index_direct_insert_find(void) {
+  IdIndex index;
+  id_index_init(&index);
+
+  ASSERT_TRUE(id_index_insert(&index, MIN_STUDENT_ID, 0),
+              "Inserting minimum ID should succeed");
+  ASSERT_TRUE(id_index_insert(&index, MAX_STUDENT_ID, 7),
+              "Inserting maximum ID should succeed");
+
+  ASSERT_TRUE(id_index_find(&index, MIN_STUDENT_ID) == 0,
+              "Minimum ID should map to position 0");
+  ASSERT_TRUE(id_index_find(&index, MAX_STUDENT_ID) == 7,
+              "Maximum ID should map to position 7");
+  ASSERT_EQUAL_INT(ID_INDEX_DIRECT, index.mode,
+                   "In-range IDs should keep direct-address mode");
+
+  id_index_free(&index);
+}
+
+void test_id_index_direct_remove(void) {
+  IdIndex index;
+  id_index_init(&index);
+  id_index_insert(&index, 2500123, 3);
+
+  ASSERT_TRUE(id_index_remove(&index, 2500123), "Removing ID should succeed");
+  ASSERT_FALSE(id_index_remove(&index, 2500123),
+               "Removing twice should report missing ID");
+  ASSERT_TRUE(id_index_find(&index, 2500123) == ID_INDEX_NOT_FOUND,
+              "Removed ID should not be found");
+
+  id_index_free(&index);
+}
+
+void test_id_index_overwrite_keeps_count(void) {
+  IdIndex index;
+  id_index_init(&index);
+  id_index_insert(&index, 2500001, 1);
+  id_index_insert(&index, 2500001, 9);
+
+  ASSERT_TRUE(index.count == 1, "Overwriting an ID should not grow count");
+  ASSERT_TRUE(id_index_find(&index, 2500001) == 9,
+              "Overwritten ID should map to the new position");
+
+  id_index_free(&index);
+}
+
+// =============================================================================
+// hash fallback tests
+// =============================================================================
+
+void test_id_index_out_of_range_switches_to_hash(void) {
+  IdIndex index;
+  id_index_init(&index);
+  id_index_insert(&index, 2500010, 0);
+  id_index_insert(&index, 1001, 1);
+
+  ASSERT_EQUAL_INT(ID_INDEX_HASH, index.mode,
+                   "Out-of-range ID should switch to hash mode");
+  ASSERT_TRUE(id_index_find(&index, 2500010) == 0,
+              "Existing entries should survive the switch");
+  ASSERT_TRUE(id_index_find(&index, 1001) == 1,
+              "Out-of-range ID should be found");
+
+  id_index_free(&index);
+}
+
+void test_id_index_hash_many_entries(void) {
+  IdIndex index;
+  id_index_init(&index);
+
+  int ok = 1;
+  for (int i = 0; i < 5000; i++) {
+    ok &= id_index_insert(&index, -2500 + i * 7, (size_t)i);
+  }
+  ASSERT_TRUE(ok, "Inserting 5000 hashed IDs should succeed");
+
+  int found = 0;
+  for (int i = 0; i < 5000; i++) {
+    if (id_index_find(&index, -2500 + i * 7) == (size_t)i) {
+      found++;
+    }
+  }
+  ASSERT_EQUAL_INT(5000, found, "All hashed IDs should map correctly");
+
+  id_index_free(&index);
+}
+
+void test_id_index_hash_remove_keeps_chains(void) {
+  IdIndex index;
+  id_index_init(&index);
+  for (int i = 0; i < 200; i++) {
+    id_index_insert(&index, i, (size_t)i);
+  }
+
+  // remove every other id, then make sure the rest are still reachable
+  for (int i = 0; i < 200; i += 2) {
+    id_index_remove(&index, i);
+  }
+
+  int found = 0;
+  int missing = 0;
+  for (int i = 0; i < 200; i++) {
+    size_t pos = id_index_find(&index, i);
+    if (i % 2 == 0) {
+      missing += (pos == ID_INDEX_NOT_FOUND);
+    } else {
+      found += (pos == (size_t)i);
+    }
+  }
+  ASSERT_EQUAL_INT(100, found, "Remaining IDs should still be found");
+  ASSERT_EQUAL_INT(100, missing, "Removed IDs should be gone");
+  ASSERT_TRUE(index.count == 100, "Count should reflect removals");
+
+  id_index_free(&index);
+}
+
+void test_id_index_clear(void) {
+  IdIndex index;
+  id_index_init(&index);
+  id_index_insert(&index, 2500001, 0);
+  id_index_insert(&index, 5, 1);
+
+  id_index_clear(&index);
+
+  ASSERT_TRUE(index.count == 0, "Cleared index should be empty");
+  ASSERT_TRUE(id_index_find(&index, 5) == ID_INDEX_NOT_FOUND,
+              "Cleared index should not find old IDs");
+  ASSERT_TRUE(id_index_insert(&index, 5, 3),
+              "Cleared index should accept new entries");
+
+  id_index_free(&index);
+}
+
+void test_id_index_null_safety(void) {
+  id_index_init(NULL);
+  id_index_free(NULL);
+  id_index_clear(NULL);
+  ASSERT_FALSE(id_index_insert(NULL, 1, 0), "NULL insert should fail");
+  ASSERT_TRUE(id_index_find(NULL, 1) == ID_INDEX_NOT_FOUND,
+              "NULL find should miss");
+  ASSERT_FALSE(id_index_remove(NULL, 1), "NULL remove should fail");
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("ID Index Tests");
+
+  RUN_TEST(test_id_index_init_empty);
+  RUN_TEST(test_id_index_direct_insert_find);
+  RUN_TEST(test_id_index_direct_remove);
+  RUN_TEST(test_id_index_overwrite_keeps_count);
+
+  RUN_TEST(test_id_index_out_of_range_switches_to_hash);
+  RUN_TEST(test_id_index_hash_many_entries);
+  RUN_TEST(test_id_index_hash_remove_keeps_chains);
+  RUN_TEST(test_id_index_clear);
+  RUN_TEST(test_id_index_null_safety);
+
+  TEST_SUITE_END();
+}
@@ -0,0 +1,512 @@
+#include "../include/checksum.h"
+#include "../include/database.h"
+#include "../include/journal.h"
+#include "../include/snapshot.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DB_TEMP "tests/fixtures/test_journal_temp.txt"
+#define JOURNAL_TEMP DB_TEMP JOURNAL_EXTENSION
+#define SNAPSHOT_TEMP "tests/fixtures/test_journal_temp.cmsb"
+
+// write a copy of the valid fixture to the temp path (no journal)
+static void reset_files(void) {
+  StudentDatabase *db = db_init();
+  db_load(db, get_test_file_path("test_valid.txt"), NULL);
+  db_save(db, DB_TEMP);
+  db_free(db);
+  remove(JOURNAL_TEMP);
+}
+
+// open the temp file the way OPEN does, replaying its journal
+static StudentDatabase *open_database(size_t *replayed) {
+  StudentDatabase *db = db_init();
+  if (db_load(db, DB_TEMP, NULL) != DB_SUCCESS) {
+    db_free(db);
+    return NULL;
+  }
+  strcpy(db->filepath, DB_TEMP);
+  db->is_loaded = true;
+  db->journal = journal_open(db, DB_TEMP, replayed);
+  db->last_saved_checksum = compute_database_checksum(db);
+  return db;
+}
+
+static bool file_exists(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (fp) {
+    fclose(fp);
+  }
+  return fp != NULL;
+}
+
+static long file_size(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    return -1;
+  }
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+// insert a record and journal it, as INSERT does
+static void insert_logged(StudentDatabase *db, int id, const char *name,
+                          float mark) {
+  StudentRecord record = create_test_record(id, name, "Computing", mark);
+  if (table_add_record(db->tables[0], &record) == DB_SUCCESS) {
+    journal_log_insert(db->journal, &record);
+  }
+}
+
+// =============================================================================
+// replay tests
+// =============================================================================
+
+void test_journal_replays_saved_changes(void) {
+  reset_files();
+  unsigned long file_checksum = compute_file_checksum(DB_TEMP);
+
+  size_t replayed = 99;
+  StudentDatabase *db = open_database(&replayed);
+  ASSERT_NOT_NULL(db, "Database should load");
+  ASSERT_NOT_NULL(db->journal, "Journal should be opened");
+  ASSERT_EQUAL_INT(0, (int)replayed, "Nothing should be replayed at first");
+
+  insert_logged(db, 2500200, "Zara Lim", 71.5f);
+  float mark = 42.0f;
+  db_update_record(db, 2500101, "Robert", NULL, &mark);
+  journal_log_update(db->journal, 2500101, "Robert", NULL, &mark);
+  table_remove_record(db->tables[0], 2500100);
+  journal_log_delete(db->journal, 2500100);
+  table_set_view(db->tables[0], TABLE_VIEW_MARK_DESC);
+  journal_log_view(db->journal, TABLE_VIEW_MARK_DESC);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Save should succeed");
+  ASSERT_TRUE(compute_file_checksum(DB_TEMP) == file_checksum,
+              "Save should not rewrite the database file");
+  ASSERT_TRUE(file_exists(JOURNAL_TEMP), "Save should write the journal");
+  ASSERT_TRUE(db->last_saved_checksum == compute_database_checksum(db),
+              "Saved state should be recorded");
+
+  StudentDatabase *reopened = open_database(&replayed);
+  ASSERT_NOT_NULL(reopened, "Database should reload");
+  ASSERT_EQUAL_INT(4, (int)replayed, "Every entry should be replayed");
+  ASSERT_TRUE(compute_database_checksum(reopened) ==
+                  compute_database_checksum(db),
+              "Replay should rebuild the saved state");
+
+  StudentTable *table = reopened->tables[0];
+  size_t p = table_find_position(table, 2500101);
+  ASSERT_EQUAL_STRING("Robert", table_record_name(table, p),
+                      "Update should be replayed");
+  ASSERT_TRUE(table_find_position(table, 2500100) == ID_INDEX_NOT_FOUND,
+              "Delete should be replayed");
+  ASSERT_TRUE(table_find_position(table, 2500200) != ID_INDEX_NOT_FOUND,
+              "Insert should be replayed");
+  ASSERT_EQUAL_INT(TABLE_VIEW_MARK_DESC, table->active_view,
+                   "View should be replayed");
+
+  db_free(db);
+  db_free(reopened);
+}
+
+void test_journal_appends_groups(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "First", 50.0f);
+  journal_save(db);
+  long first_size = file_size(JOURNAL_TEMP);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db),
+                   "Save without changes should succeed");
+  ASSERT_EQUAL_INT((int)first_size, (int)file_size(JOURNAL_TEMP),
+                   "Save without changes should write nothing");
+
+  insert_logged(db, 2500201, "Second", 60.0f);
+  table_compact(db->tables[0]);
+  journal_log_compact(db->journal);
+  journal_save(db);
+  ASSERT_TRUE(file_size(JOURNAL_TEMP) > first_size,
+              "Later saves should append to the journal");
+  db_free(db);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(3, (int)replayed, "Both groups should be replayed");
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500201) !=
+                  ID_INDEX_NOT_FOUND,
+              "Second group should be applied");
+  db_free(db);
+}
+
+void test_journal_drops_unsaved_entries(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Saved", 50.0f);
+  journal_save(db);
+  insert_logged(db, 2500201, "Unsaved", 60.0f);
+  db_free(db);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(1, (int)replayed, "Only the saved entry should replay");
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500201) ==
+                  ID_INDEX_NOT_FOUND,
+              "Unsaved insert should be lost");
+  db_free(db);
+}
+
+void test_journal_ignores_torn_tail(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Committed", 50.0f);
+  journal_save(db);
+  long committed = file_size(JOURNAL_TEMP);
+  db_free(db);
+
+  // half of a group that never got its commit entry
+  FILE *fp = fopen(JOURNAL_TEMP, "ab");
+  const unsigned char torn[] = {30, 0, 0, 0, JOURNAL_INSERT, 1, 2, 3};
+  fwrite(torn, 1, sizeof torn, fp);
+  fclose(fp);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(1, (int)replayed, "Committed group should replay");
+  ASSERT_EQUAL_INT((int)committed, (int)db->journal->committed_size,
+                   "Torn tail should not count as committed");
+
+  // the next save overwrites the torn tail
+  insert_logged(db, 2500201, "After", 55.0f);
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Save should succeed");
+  db_free(db);
+
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(2, (int)replayed, "Both groups should replay");
+  ASSERT_EQUAL_INT((int)file_size(JOURNAL_TEMP),
+                   (int)db->journal->committed_size,
+                   "Journal should be whole again");
+  db_free(db);
+}
+
+void test_journal_rejects_bad_group_checksum(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Damaged", 50.0f);
+  journal_save(db);
+  db_free(db);
+
+  // flip a byte of the name inside the only group
+  FILE *fp = fopen(JOURNAL_TEMP, "r+b");
+  fseek(fp, 12 + 5 + 8 + 1, SEEK_SET);
+  fputc('X', fp);
+  fclose(fp);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(0, (int)replayed, "Damaged group should not replay");
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500200) ==
+                  ID_INDEX_NOT_FOUND,
+              "Damaged insert should not be applied");
+  db_free(db);
+}
+
+void test_journal_ignores_stale_base(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Stale", 50.0f);
+  journal_save(db);
+  db_free(db);
+
+  // the database file is replaced behind the journal's back
+  db = db_init();
+  db_load(db, DB_TEMP, NULL);
+  table_remove_record(db->tables[0], 2500103);
+  db_save(db, DB_TEMP);
+  db_free(db);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_NOT_NULL(db->journal, "Journal should still be opened");
+  ASSERT_EQUAL_INT(0, (int)replayed, "Stale journal should not replay");
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500200) ==
+                  ID_INDEX_NOT_FOUND,
+              "Stale entries should not be applied");
+
+  // the next save starts the journal afresh against the new file
+  insert_logged(db, 2500201, "Fresh", 60.0f);
+  journal_save(db);
+  db_free(db);
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(1, (int)replayed, "Fresh journal should replay");
+  db_free(db);
+}
+
+void test_journal_unreadable_group_not_applied(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Before", 50.0f);
+  journal_save(db);
+
+  // a group whose checksum holds but whose last entry is not a valid view
+  insert_logged(db, 2500201, "Same Group", 60.0f);
+  journal_log_view(db->journal, (TableView)(TABLE_VIEW_MARK_DESC + 1));
+  journal_save(db);
+  db_free(db);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(1, (int)replayed, "Only the readable group should replay");
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500201) ==
+                  ID_INDEX_NOT_FOUND,
+              "No entry of an unreadable group should be applied");
+  ASSERT_TRUE(db->journal->needs_checkpoint,
+              "An unreadable group should force a checkpoint");
+  db_free(db);
+}
+
+void test_journal_failed_apply_forces_checkpoint(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "First", 50.0f);
+  journal_save(db);
+
+  // the second entry of this group inserts an id that already exists
+  insert_logged(db, 2500201, "Second", 60.0f);
+  StudentRecord duplicate =
+      create_test_record(2500101, "Duplicate", "Computing", 70.0f);
+  journal_log_insert(db->journal, &duplicate);
+  journal_save(db);
+  insert_logged(db, 2500202, "Third", 65.0f);
+  journal_save(db);
+  db_free(db);
+  long journal_bytes = file_size(JOURNAL_TEMP);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(2, (int)replayed, "Replay should stop at the failure");
+  ASSERT_TRUE(db->journal->needs_checkpoint,
+              "A failed entry should force a checkpoint");
+  ASSERT_EQUAL_INT((int)journal_bytes, (int)file_size(JOURNAL_TEMP),
+                   "Opening should not cut the journal");
+
+  // the save rewrites the file from memory rather than truncating the
+  // committed groups after the one that failed
+  insert_logged(db, 2500203, "After", 75.0f);
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Save should succeed");
+  ASSERT_FALSE(file_exists(JOURNAL_TEMP), "Save should checkpoint");
+  unsigned long saved = compute_database_checksum(db);
+  db_free(db);
+
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(0, (int)replayed, "Nothing should be left to replay");
+  ASSERT_TRUE(compute_database_checksum(db) == saved,
+              "Database file should hold what was in memory");
+  db_free(db);
+}
+
+void test_journal_replayed_by_convert(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Journaled", 50.0f);
+  table_remove_record(db->tables[0], 2500100);
+  journal_log_delete(db->journal, 2500100);
+  journal_save(db);
+  unsigned long saved = compute_database_checksum(db);
+  db_free(db);
+
+  // the saved changes are only in the journal, which --convert must apply
+  ASSERT_EQUAL_INT(DB_SUCCESS, snapshot_convert(DB_TEMP, SNAPSHOT_TEMP),
+                   "Conversion should succeed");
+  db = db_init();
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_load(db, SNAPSHOT_TEMP, NULL),
+                   "Converted file should load");
+  db->is_loaded = true;
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500200) !=
+                      ID_INDEX_NOT_FOUND &&
+                  table_find_position(db->tables[0], 2500100) ==
+                      ID_INDEX_NOT_FOUND,
+              "Converted file should hold the journaled changes");
+  ASSERT_TRUE(compute_database_checksum(db) == saved,
+              "Converted file should hold the saved state");
+  db_free(db);
+  remove(SNAPSHOT_TEMP);
+}
+
+// =============================================================================
+// checkpoint tests
+// =============================================================================
+
+void test_journal_checkpoints_past_threshold(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  unsigned long file_checksum = compute_file_checksum(DB_TEMP);
+
+  // enough entries to pass JOURNAL_CHECKPOINT_BYTES in one group
+  for (int i = 0; db->journal->pending_size < JOURNAL_CHECKPOINT_BYTES; i++) {
+    float mark = (float)(i % 100);
+    db_update_record(db, 2500101, NULL, NULL, &mark);
+    journal_log_update(db->journal, 2500101, NULL, NULL, &mark);
+  }
+  insert_logged(db, 2500200, "Checkpoint", 80.0f);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Checkpoint should succeed");
+  ASSERT_FALSE(file_exists(JOURNAL_TEMP), "Checkpoint should delete journal");
+  ASSERT_FALSE(file_exists(DB_TEMP ".tmp"),
+               "Checkpoint should rename its temp file into place");
+  ASSERT_TRUE(compute_file_checksum(DB_TEMP) != file_checksum,
+              "Checkpoint should rewrite the database file");
+  ASSERT_EQUAL_INT(0, (int)db->journal->pending_size,
+                   "Pending entries should be cleared");
+  ASSERT_TRUE(db->journal->base_checksum == db->file_loaded_checksum,
+              "Journal should follow the new file");
+
+  // later saves journal against the rewritten file
+  insert_logged(db, 2500201, "Later", 65.0f);
+  journal_save(db);
+  unsigned long saved = compute_database_checksum(db);
+  db_free(db);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(1, (int)replayed, "Only the later entry should replay");
+  ASSERT_TRUE(compute_database_checksum(db) == saved,
+              "Checkpoint plus journal should rebuild the saved state");
+  db_free(db);
+}
+
+void test_journal_fills_to_threshold(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "First", 50.0f);
+  journal_save(db);
+  ASSERT_EQUAL_INT((int)file_size(JOURNAL_TEMP),
+                   (int)db->journal->committed_size,
+                   "Committed size should include the header");
+
+  // fill the next group so the journal ends exactly at the threshold: mark
+  // updates close most of the gap and a name update of the right length
+  // (one byte per character) closes the rest
+  size_t commit_size = 9; // entry header and CRC32
+  size_t before = db->journal->pending_size;
+  journal_log_update(db->journal, 2500101, "A", NULL, NULL);
+  size_t name_entry = db->journal->pending_size - before;
+  size_t gap = JOURNAL_CHECKPOINT_BYTES - (size_t)db->journal->committed_size -
+               db->journal->pending_size - commit_size;
+  for (int i = 0; gap > name_entry + 30; i++) {
+    float mark = (float)(i % 100);
+    journal_log_update(db->journal, 2500101, NULL, NULL, &mark);
+    gap = JOURNAL_CHECKPOINT_BYTES - (size_t)db->journal->committed_size -
+          db->journal->pending_size - commit_size;
+  }
+  char name[MAX_NAME_LENGTH];
+  size_t length = gap - name_entry + 1;
+  memset(name, 'B', length);
+  name[length] = '\0';
+  journal_log_update(db->journal, 2500101, name, NULL, NULL);
+  db_update_record(db, 2500101, name, NULL, NULL);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Save should succeed");
+  ASSERT_EQUAL_INT(JOURNAL_CHECKPOINT_BYTES, (int)file_size(JOURNAL_TEMP),
+                   "A journal of exactly the threshold should be appended");
+  db_free(db);
+}
+
+void test_journal_removed_file_forces_checkpoint(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Journalled", 50.0f);
+  journal_save(db);
+  remove(JOURNAL_TEMP);
+
+  insert_logged(db, 2500201, "After Removal", 60.0f);
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db),
+                   "Save should fall back to a checkpoint");
+  ASSERT_FALSE(file_exists(JOURNAL_TEMP), "No journal should be recreated");
+  ASSERT_EQUAL_INT(0, (int)db->journal->committed_size,
+                   "Journal should start again from the new file");
+
+  insert_logged(db, 2500202, "Journalled Again", 70.0f);
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db),
+                   "Later saves should journal again");
+  ASSERT_TRUE(file_exists(JOURNAL_TEMP), "Journal should be rewritten");
+  unsigned long saved = compute_database_checksum(db);
+  db_free(db);
+
+  size_t replayed = 0;
+  db = open_database(&replayed);
+  ASSERT_EQUAL_INT(1, (int)replayed, "Only the later entry should replay");
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500200) !=
+                      ID_INDEX_NOT_FOUND &&
+                  table_find_position(db->tables[0], 2500201) !=
+                      ID_INDEX_NOT_FOUND,
+              "Checkpoint should hold the changes of the lost journal");
+  ASSERT_TRUE(compute_database_checksum(db) == saved,
+              "Checkpoint plus journal should rebuild the saved state");
+  db_free(db);
+}
+
+void test_journal_forced_checkpoint_and_no_journal(void) {
+  reset_files();
+  StudentDatabase *db = open_database(NULL);
+  insert_logged(db, 2500200, "Forced", 50.0f);
+  db->journal->needs_checkpoint = true;
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Save should succeed");
+  ASSERT_FALSE(file_exists(JOURNAL_TEMP),
+               "Lost entries should force a checkpoint");
+  ASSERT_FALSE(db->journal->needs_checkpoint, "Flag should be cleared");
+  db_free(db);
+
+  // without a journal every save rewrites the file
+  db = db_init();
+  db_load(db, DB_TEMP, NULL);
+  strcpy(db->filepath, DB_TEMP);
+  table_remove_record(db->tables[0], 2500200);
+  ASSERT_EQUAL_INT(DB_SUCCESS, journal_save(db), "Save should succeed");
+  ASSERT_FALSE(file_exists(JOURNAL_TEMP), "No journal should be written");
+  db_free(db);
+
+  db = open_database(NULL);
+  ASSERT_TRUE(table_find_position(db->tables[0], 2500200) ==
+                  ID_INDEX_NOT_FOUND,
+              "Rewritten file should hold the delete");
+  db_free(db);
+
+  ASSERT_EQUAL_INT(DB_ERROR_NULL_POINTER, journal_save(NULL),
+                   "NULL database should be rejected");
+  journal_log_insert(NULL, NULL);
+  journal_log_delete(NULL, 1);
+  journal_close(NULL);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Journal Tests");
+
+  RUN_TEST(test_journal_replays_saved_changes);
+  RUN_TEST(test_journal_appends_groups);
+  RUN_TEST(test_journal_drops_unsaved_entries);
+  RUN_TEST(test_journal_ignores_torn_tail);
+  RUN_TEST(test_journal_rejects_bad_group_checksum);
+  RUN_TEST(test_journal_ignores_stale_base);
+  RUN_TEST(test_journal_unreadable_group_not_applied);
+  RUN_TEST(test_journal_failed_apply_forces_checkpoint);
+  RUN_TEST(test_journal_replayed_by_convert);
+
+  RUN_TEST(test_journal_checkpoints_past_threshold);
+  RUN_TEST(test_journal_fills_to_threshold);
+  RUN_TEST(test_journal_removed_file_forces_checkpoint);
+  RUN_TEST(test_journal_forced_checkpoint_and_no_journal);
+
+  remove(DB_TEMP);
+  remove(JOURNAL_TEMP);
+  TEST_SUITE_END();
+}
@@ -0,0 +1,209 @@
+/*
+ * test_mark_kernels.c
+ *
+ * unit tests for the mark kernels module
+ * checks every kernel level the processor supports against a plain
+ * record-at-a-time scan, including comparison values that are not floats,
+ * ragged lengths that leave a scalar tail and ties across summary blocks
+ *
+ * functions tested:
+ * - mark_kernel_select()     : positions passing a MARK comparison
+ * - mark_kernel_summarise()  : sum, extremes and their first indexes
+ * - mark_kernels_set_level() : clamping to the supported level
+ */
+
+#include "../include/mark_kernels.h"
+#include "test_utils.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define KERNEL_TEST_MARKS 5000
+
+// levels to compare, scalar first
+static const MarkKernelLevel levels[] = {MARK_KERNEL_SCALAR, MARK_KERNEL_SSE2,
+                                         MARK_KERNEL_AVX2};
+
+// marks on hundredths, with repeats, as loaded from a database file
+static float *make_marks(size_t count, unsigned seed) {
+  float *marks = malloc(count * sizeof *marks);
+  srand(seed);
+  for (size_t i = 0; marks && i < count; i++) {
+    marks[i] = (float)(rand() % 10001) / 100.0f;
+  }
+  return marks;
+}
+
+// true if the kernel selects what "(double)mark op value" selects
+static bool select_matches_scan(const float *marks, size_t count, char op,
+                                double value) {
+  size_t *selected = malloc((count + 1) * sizeof *selected);
+  if (!selected) {
+    return false;
+  }
+  size_t kept = mark_kernel_select(marks, count, 100, op, value, selected);
+  size_t expected = 0;
+  bool match = true;
+  for (size_t i = 0; i < count && match; i++) {
+    double mark = marks[i];
+    bool passes = op == '<' ? mark < value : op == '>' ? mark > value
+                                                       : mark == value;
+    if (passes) {
+      match = expected < kept && selected[expected] == 100 + i;
+      expected++;
+    }
+  }
+  free(selected);
+  return match && expected == kept;
+}
+
+// =============================================================================
+// mark_kernel_select() tests
+// =============================================================================
+
+void test_select_matches_scan(void) {
+  float *marks = make_marks(KERNEL_TEST_MARKS, 11);
+  ASSERT_NOT_NULL(marks, "Marks should allocate");
+  if (!marks) {
+    return;
+  }
+
+  // 70.1 is not a float, 70.5 is; the rest reach past the float range
+  static const double values[] = {70.1,    70.5,  0.0,   100.0, -1.0,
+                                  1e300,   -1e300, INFINITY, 0.005};
+  static const char ops[] = {'<', '>', '='};
+  bool match = true;
+  for (size_t l = 0; l < 3; l++) {
+    mark_kernels_set_level(levels[l]);
+    for (size_t v = 0; v < sizeof values / sizeof values[0]; v++) {
+      for (size_t o = 0; o < 3; o++) {
+        // ragged lengths leave every possible tail after the vector loop
+        for (size_t count = KERNEL_TEST_MARKS - 17; count <= KERNEL_TEST_MARKS;
+             count++) {
+          match = match && select_matches_scan(marks, count, ops[o], values[v]);
+        }
+      }
+    }
+  }
+  ASSERT_TRUE(match, "Every level should select as a scalar scan does");
+
+  marks[3] = 70.5f;
+  marks[4000] = 70.5f;
+  mark_kernels_set_level(MARK_KERNEL_AVX2);
+  size_t selected[KERNEL_TEST_MARKS];
+  size_t kept = mark_kernel_select(marks, KERNEL_TEST_MARKS, 0, '=', 70.5,
+                                   selected);
+  ASSERT_TRUE(kept >= 2 && selected[0] <= 3,
+              "Equal marks should be selected in order");
+  ASSERT_EQUAL_INT(0, (int)mark_kernel_select(marks, KERNEL_TEST_MARKS, 0,
+                                              '=', 70.1, selected),
+                   "A value no float equals selects nothing");
+  ASSERT_EQUAL_INT(0, (int)mark_kernel_select(marks, KERNEL_TEST_MARKS, 0,
+                                              '<', NAN, selected),
+                   "NaN selects nothing");
+  free(marks);
+}
+
+void test_select_edges(void) {
+  size_t selected[4];
+  ASSERT_EQUAL_INT(0, (int)mark_kernel_select(NULL, 4, 0, '<', 1.0, selected),
+                   "NULL marks select nothing");
+  float marks[] = {-0.0f, 0.0f, FLT_MAX, -INFINITY};
+  ASSERT_EQUAL_INT(0, (int)mark_kernel_select(marks, 0, 0, '<', 1.0, selected),
+                   "No marks select nothing");
+  ASSERT_EQUAL_INT(2, (int)mark_kernel_select(marks, 4, 0, '=', 0.0, selected),
+                   "Both zeros equal zero");
+  ASSERT_EQUAL_INT(4, (int)mark_kernel_select(marks, 4, 0, '<', 1e300,
+                                              selected),
+                   "Every mark is below 1e300");
+  ASSERT_EQUAL_INT(1, (int)mark_kernel_select(marks, 4, 0, '<', -1e300,
+                                              selected),
+                   "Only -infinity is below -1e300");
+}
+
+// =============================================================================
+// mark_kernel_summarise() tests
+// =============================================================================
+
+void test_summarise_matches_scan(void) {
+  float *marks = make_marks(KERNEL_TEST_MARKS, 23);
+  ASSERT_NOT_NULL(marks, "Marks should allocate");
+  if (!marks) {
+    return;
+  }
+  // extremes repeated across summary blocks; the first must be reported
+  marks[1500] = 100.5f;
+  marks[1501] = 100.5f;
+  marks[4500] = 100.5f;
+  marks[2047] = -3.25f;
+  marks[4999] = -3.25f;
+
+  bool match = true;
+  for (size_t l = 0; l < 3; l++) {
+    mark_kernels_set_level(levels[l]);
+    for (size_t count = 1; count <= KERNEL_TEST_MARKS; count += 499) {
+      double sum = 0.0;
+      size_t min_index = 0;
+      size_t max_index = 0;
+      for (size_t i = 0; i < count; i++) {
+        sum += marks[i];
+        min_index = marks[i] < marks[min_index] ? i : min_index;
+        max_index = marks[i] > marks[max_index] ? i : max_index;
+      }
+      MarkSummary summary;
+      mark_kernel_summarise(marks, count, &summary);
+      match = match && summary.min_index == min_index &&
+              summary.max_index == max_index &&
+              summary.min == marks[min_index] &&
+              summary.max == marks[max_index] &&
+              fabs(summary.sum - sum) < 1e-6 * (fabs(sum) + 1.0);
+    }
+  }
+  ASSERT_TRUE(match, "Every level should agree with a scalar scan");
+  free(marks);
+}
+
+void test_summarise_keeps_first_zero_sign(void) {
+  float marks[20] = {0.0f};
+  marks[9] = -0.0f;
+  mark_kernels_set_level(MARK_KERNEL_AVX2);
+  MarkSummary summary;
+  mark_kernel_summarise(marks, 20, &summary);
+  ASSERT_EQUAL_INT(0, (int)summary.min_index, "First zero is the minimum");
+  ASSERT_FALSE(signbit(summary.min), "Minimum keeps the first zero's sign");
+}
+
+// =============================================================================
+// level selection tests
+// =============================================================================
+
+void test_set_level_clamps(void) {
+  MarkKernelLevel widest = mark_kernels_set_level(MARK_KERNEL_AVX2);
+  ASSERT_EQUAL_INT(MARK_KERNEL_SCALAR,
+                   mark_kernels_set_level(MARK_KERNEL_SCALAR),
+                   "Scalar is always available");
+  ASSERT_EQUAL_INT(MARK_KERNEL_SCALAR, mark_kernels_level(),
+                   "Level should stay as set");
+  ASSERT_EQUAL_INT(widest, mark_kernels_set_level(MARK_KERNEL_AVX2),
+                   "Asking for more gives the widest supported");
+  ASSERT_EQUAL_STRING("sse2", mark_kernels_level_name(MARK_KERNEL_SSE2),
+                      "Level names");
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Mark Kernel Tests");
+
+  RUN_TEST(test_select_matches_scan);
+  RUN_TEST(test_select_edges);
+
+  RUN_TEST(test_summarise_matches_scan);
+  RUN_TEST(test_summarise_keeps_first_zero_sign);
+
+  RUN_TEST(test_set_level_clamps);
+
+  TEST_SUITE_END();
+}
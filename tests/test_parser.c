@@ -245,6 +245,30 @@ void test_parse_record_line_extra_fields(void) {
   ASSERT_EQUAL_INT(PARSE_SUCCESS, status, "Extra fields should be ignored");
 }
 
+void test_parse_record_span_not_terminated(void) {
+  StudentRecord record;
+  const char buffer[] = "2500100\tJohn\tCS\t75.0XXXX";
+  ParseStatus status = parse_record_span(buffer, sizeof buffer - 5, &record);
+  ASSERT_EQUAL_INT(PARSE_SUCCESS, status, "Span should parse up to its length");
+  ASSERT_EQUAL_FLOAT(75.0f, record.mark, 0.01f,
+                     "Bytes past the span should be ignored");
+}
+
+void test_parse_record_line_long_name(void) {
+  StudentRecord record;
+  char line[700];
+  int n = snprintf(line, sizeof line, "2500100\t");
+  memset(line + n, 'a', 600);
+  snprintf(line + n + 600, sizeof line - (size_t)n - 600, "\tCS\t75.0");
+
+  ASSERT_EQUAL_INT(PARSE_SUCCESS, parse_record_line(line, &record),
+                   "Long line should not be cut short");
+  ASSERT_EQUAL_INT(MAX_NAME_LENGTH - 1, (int)strlen(record.name),
+                   "Long name should be truncated to the field");
+  ASSERT_EQUAL_FLOAT(75.0f, record.mark, 0.01f,
+                     "Fields after a long name should parse");
+}
+
 // =============================================================================
 // parse_column_headers() tests
 // =============================================================================
@@ -417,6 +441,103 @@ void test_parse_file_boundary_values(void) {
   cleanup_test_database(db);
 }
 
+void test_parse_file_long_lines_and_presize(void) {
+  const char *path = "tests/fixtures/test_output_temp.txt";
+  FILE *fp = fopen(path, "w");
+  fprintf(fp, "Database Name: Long\nAuthors: Test\n\nTable Name: Students\n");
+  fprintf(fp, "ID\tName\tProgramme\tMark\n");
+  fprintf(fp, "2500000\t");
+  for (int i = 0; i < 700; i++) {
+    fputc('n', fp);
+  }
+  fprintf(fp, "\tCS\t88.5\n");
+  for (int i = 1; i <= 50; i++) {
+    fprintf(fp, "%d\tStudent\tCS\t%d.0\n", 2500000 + i, i);
+  }
+  fclose(fp);
+
+  StudentDatabase *db = create_empty_test_database();
+  ParseStatistics stats = {0};
+  DBStatus status = parse_file(path, db, &stats);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, status, "File with a long line should parse");
+  ASSERT_EQUAL_INT(51, stats.records_loaded, "Every line should be a record");
+  ASSERT_EQUAL_INT(0, stats.parse_errors,
+                   "Long line should not be split into fragments");
+  ASSERT_EQUAL_FLOAT(88.5f, table_record_mark(db->tables[0], 0), 0.01f,
+                     "Mark after the long name should parse");
+  ASSERT_EQUAL_INT(51, (int)db->tables[0]->record_capacity,
+                   "Storage should be sized from the line count");
+
+  cleanup_test_database(db);
+  remove(path);
+}
+
+void test_parse_file_large_sections_match_serial_rules(void) {
+  const char *path = "tests/fixtures/test_output_temp.txt";
+  FILE *fp = fopen(path, "w");
+  fprintf(fp, "Database Name: Large\nAuthors: Test\n\nTable Name: Students\n");
+  fprintf(fp, "ID\tName\tProgramme\tMark\n");
+
+  // spread every kind of bad line through a section bigger than one worker
+  int loaded = 0, validation = 0, parse_errors = 0, last_id = 2500000;
+  for (int i = 0; i < 60000; i++) {
+    if (i == 30000) {
+      fprintf(fp, "Authors: Split\n");
+    }
+    if (i % 89 == 0) {
+      fprintf(fp, "\n");
+    } else if (i % 97 == 0) {
+      fprintf(fp, "%d\tDuplicate\tCS\t50.0\n", last_id);
+      validation++;
+    } else if (i % 101 == 0) {
+      fprintf(fp, "%d\tStudent %d\tCS\t150.0\n", 2500000 + i, i);
+      parse_errors++;
+    } else if (i % 103 == 0) {
+      fprintf(fp, "not a record\n");
+      parse_errors++;
+    } else {
+      fprintf(fp, "%d\tStudent %d\tCS\t%d.5\n", 2500000 + i, i, i % 100);
+      loaded++;
+      last_id = 2500000 + i;
+    }
+  }
+  fprintf(fp, "Table Name: Second\nID\tName\tProgramme\tMark\n");
+  fprintf(fp, "2500001\tOther\tDS\t70.0\n");
+  fclose(fp);
+
+  StudentDatabase *db = create_empty_test_database();
+  ParseStatistics stats = {0};
+  DBStatus status = parse_file(path, db, &stats);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, status, "Large file should parse");
+  ASSERT_EQUAL_INT(2, (int)db->table_count, "Both tables should be created");
+  ASSERT_EQUAL_STRING("Split", db->authors,
+                      "Metadata inside a section should still apply");
+  ASSERT_EQUAL_INT(loaded + 1, stats.records_loaded,
+                   "Loaded count should match the generated file");
+  ASSERT_EQUAL_INT(validation, stats.validation_errors,
+                   "Each duplicate should be counted once");
+  ASSERT_EQUAL_INT(parse_errors, stats.parse_errors,
+                   "Parse errors should be counted once");
+  ASSERT_EQUAL_INT(loaded + 1 + validation + parse_errors,
+                   stats.total_records_attempted,
+                   "Blank lines should not count as attempts");
+
+  StudentTable *table = db->tables[0];
+  ASSERT_EQUAL_INT(loaded, (int)table->record_count,
+                   "First table should hold every valid record");
+  ASSERT_EQUAL_INT(2500001, table_record_id(table, 0),
+                   "Records should keep file order");
+  ASSERT_EQUAL_INT(last_id, table_record_id(table, (size_t)loaded - 1),
+                   "Last record should be the last valid line");
+  ASSERT_EQUAL_INT(1, (int)db->tables[1]->record_count,
+                   "Ids are only unique within a table");
+
+  cleanup_test_database(db);
+  remove(path);
+}
+
 // =============================================================================
 // test suite runner
 // =============================================================================
@@ -461,6 +582,8 @@ int main(void) {
   RUN_TEST(test_parse_record_line_incomplete_three_fields);
   RUN_TEST(test_parse_record_line_with_newline);
   RUN_TEST(test_parse_record_line_extra_fields);
+  RUN_TEST(test_parse_record_span_not_terminated);
+  RUN_TEST(test_parse_record_line_long_name);
 
   // parse_column_headers tests
   RUN_TEST(test_parse_column_headers_standard);
@@ -478,6 +601,8 @@ int main(void) {
   RUN_TEST(test_parse_file_null_filename);
   RUN_TEST(test_parse_file_null_database);
   RUN_TEST(test_parse_file_boundary_values);
+  RUN_TEST(test_parse_file_long_lines_and_presize);
+  RUN_TEST(test_parse_file_large_sections_match_serial_rules);
 
   TEST_SUITE_END();
 }
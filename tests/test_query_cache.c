@@ -0,0 +1,227 @@
+/*
+ * test_query_cache.c
+ *
+ * unit tests for the query cache module
+ * checks least-recently-used eviction under a byte capacity, stale and
+ * oversized entries, the database mutation count that validates entries,
+ * and ADV QUERY answering repeated and differently spelled pipelines from
+ * the cache until the database changes
+ *
+ * functions tested:
+ * - query_cache_store()        : keeping a result, evicting to capacity
+ * - query_cache_lookup()       : hits, misses and stale entries
+ * - query_cache_set_capacity() : shrinking the capacity
+ * - db_mutation_count()        : changes on every mutating path
+ * - db_set_query_cache()       : enabling and disabling the cache
+ */
+
+#include "../include/query_cache.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_TEST_MATCHES 10
+
+// bytes one entry of CACHE_TEST_MATCHES matches under a 1-byte key holds
+static size_t entry_bytes(void) {
+  return sizeof(QueryCacheEntry) + 2 +
+         CACHE_TEST_MATCHES * sizeof(AdvQueryMatch);
+}
+
+// =============================================================================
+// cache tests
+// =============================================================================
+
+void test_store_lookup_and_evict(void) {
+  AdvQueryMatch matches[CACHE_TEST_MATCHES];
+  for (size_t i = 0; i < CACHE_TEST_MATCHES; i++) {
+    matches[i] = (AdvQueryMatch){NULL, i * 3};
+  }
+  AdvQueryResult result = {matches, CACHE_TEST_MATCHES, CACHE_TEST_MATCHES};
+
+  QueryCache *cache = query_cache_create(2 * entry_bytes());
+  ASSERT_NOT_NULL(cache, "Cache should be created");
+  if (!cache) {
+    return;
+  }
+  ASSERT_TRUE(query_cache_store(cache, "a", 1, &result), "Store a");
+  ASSERT_TRUE(query_cache_store(cache, "b", 1, &result), "Store b");
+  const QueryCacheEntry *entry = query_cache_lookup(cache, "a", 1);
+  ASSERT_NOT_NULL(entry, "a should hit");
+  ASSERT_TRUE(entry && entry->count == CACHE_TEST_MATCHES &&
+                  entry->matches[4].position == 12,
+              "A hit returns the stored matches");
+
+  // a was used last, so b is the one evicted
+  ASSERT_TRUE(query_cache_store(cache, "c", 1, &result), "Store c");
+  ASSERT_EQUAL_INT(2, (int)cache->count, "Two entries fit");
+  ASSERT_EQUAL_INT(1, (int)cache->evictions, "One entry was evicted");
+  ASSERT_NULL(query_cache_lookup(cache, "b", 1), "b was least recent");
+  ASSERT_NOT_NULL(query_cache_lookup(cache, "a", 1), "a survives");
+  ASSERT_NOT_NULL(query_cache_lookup(cache, "c", 1), "c survives");
+  ASSERT_EQUAL_INT(3, (int)cache->hits, "Three lookups hit");
+  ASSERT_EQUAL_INT(1, (int)cache->misses, "One lookup missed");
+  ASSERT_EQUAL_INT((int)(2 * entry_bytes()), (int)cache->bytes,
+                   "Bytes count the entries held");
+
+  ASSERT_TRUE(query_cache_store(cache, "c", 1, &result), "Restore c");
+  ASSERT_EQUAL_INT(2, (int)cache->count, "Storing a key again replaces it");
+  query_cache_free(cache);
+}
+
+void test_stale_and_oversized_entries(void) {
+  AdvQueryMatch matches[CACHE_TEST_MATCHES] = {{NULL, 0}};
+  AdvQueryResult result = {matches, CACHE_TEST_MATCHES, CACHE_TEST_MATCHES};
+  AdvQueryResult empty = {NULL, 0, 0};
+
+  QueryCache *cache = query_cache_create(3 * entry_bytes());
+  ASSERT_NOT_NULL(cache, "Cache should be created");
+  if (!cache) {
+    return;
+  }
+  query_cache_store(cache, "a", 7, &result);
+  ASSERT_NULL(query_cache_lookup(cache, "a", 8),
+              "An entry from before a change is stale");
+  ASSERT_EQUAL_INT(0, (int)cache->count, "A stale entry is dropped");
+
+  ASSERT_TRUE(query_cache_store(cache, "none", 8, &empty),
+              "No matches is a result too");
+  const QueryCacheEntry *entry = query_cache_lookup(cache, "none", 8);
+  ASSERT_TRUE(entry && entry->count == 0, "An empty result hits");
+
+  query_cache_store(cache, "a", 8, &result);
+  query_cache_store(cache, "b", 8, &result);
+  query_cache_set_capacity(cache, entry_bytes());
+  ASSERT_EQUAL_INT(1, (int)cache->count, "Shrinking evicts down to capacity");
+  ASSERT_NOT_NULL(query_cache_lookup(cache, "b", 8), "The latest is kept");
+
+  AdvQueryResult large = {matches, CACHE_TEST_MATCHES, CACHE_TEST_MATCHES};
+  query_cache_set_capacity(cache, entry_bytes() - 1);
+  ASSERT_FALSE(query_cache_store(cache, "x", 8, &large),
+               "A result over the capacity is not kept");
+  ASSERT_EQUAL_INT(0, (int)cache->bytes, "Nothing over capacity is held");
+  query_cache_free(cache);
+}
+
+// =============================================================================
+// database tests
+// =============================================================================
+
+void test_mutation_count_follows_changes(void) {
+  StudentDatabase *db = create_test_database_with_records(40);
+  ASSERT_NOT_NULL(db, "Database should be created");
+  if (!db) {
+    return;
+  }
+  StudentTable *table = db->tables[0];
+  uint64_t count = db_mutation_count(db);
+
+  AdvQueryResult result;
+  adv_query_select(db, "MARK > 60", &result);
+  adv_query_result_free(&result);
+  table_set_view(table, TABLE_VIEW_STORAGE);
+  ASSERT_TRUE(db_mutation_count(db) == count, "Reads change nothing");
+
+  bool grows = true;
+  StudentRecord record = {.id = 2500900, .name = "Nur Aisyah",
+                          .prog = "Programme1", .mark = 66.0f};
+  table_add_record(table, &record);
+  grows = grows && db_mutation_count(db) > count;
+  count = db_mutation_count(db);
+  db_update_record(db, 2500105, NULL, NULL, &(float){12.0f});
+  grows = grows && db_mutation_count(db) > count;
+  count = db_mutation_count(db);
+  table_remove_record(table, 2500106);
+  grows = grows && db_mutation_count(db) > count;
+  count = db_mutation_count(db);
+  table_purge_tombstones(table);
+  grows = grows && db_mutation_count(db) > count;
+  count = db_mutation_count(db);
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+  grows = grows && db_mutation_count(db) > count;
+  count = db_mutation_count(db);
+  table_compact(table);
+  grows = grows && db_mutation_count(db) > count;
+  ASSERT_TRUE(grows, "Every change moves the count on");
+
+  // a reload must not land on a count seen before it
+  count = db_mutation_count(db);
+  db_clear(db);
+  ASSERT_TRUE(db_mutation_count(db) > count, "Clearing moves the count on");
+  count = db_mutation_count(db);
+  db_add_table(db, table_init("Reloaded"));
+  ASSERT_TRUE(db_mutation_count(db) > count, "Adding a table moves it on");
+  db_free(db);
+}
+
+void test_adv_query_served_from_cache(void) {
+  StudentDatabase *db = create_test_database_with_records(90);
+  ASSERT_NOT_NULL(db, "Database should be created");
+  if (!db) {
+    return;
+  }
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_set_query_cache(db, 1 << 20),
+                   "Cache should be enabled");
+  ASSERT_NOT_NULL(db->query_cache, "Database holds the cache");
+
+  AdvQueryResult first;
+  AdvQueryResult second;
+  adv_query_select(db, "MARK > 80 | GREP PROGRAMME = Programme2", &first);
+  adv_query_select(db, "grep program = \"PROGRAMME2\"|filter > 80.0",
+                   &second);
+  ASSERT_EQUAL_INT(1, (int)db->query_cache->hits,
+                   "Case, synonyms and stage order share an entry");
+  bool same = first.count == second.count && first.count > 0;
+  for (size_t i = 0; same && i < first.count; i++) {
+    same = first.matches[i].position == second.matches[i].position;
+  }
+  ASSERT_TRUE(same, "A hit returns the same matches");
+  size_t count = 0;
+  adv_query_count(db, "GREP PROGRAMME = programme2 | MARK > 80", &count);
+  ASSERT_EQUAL_INT((int)first.count, (int)count, "Counts use the entry too");
+  ASSERT_EQUAL_INT(2, (int)db->query_cache->hits, "The count was a hit");
+  adv_query_result_free(&second);
+
+  // Student6 has Programme3 and mark 55; moving it into the result must
+  // not be hidden by the cached entry
+  db_update_record(db, 2500105, NULL, "Programme2", &(float){95.0f});
+  adv_query_select(db, "MARK > 80 | GREP PROGRAMME = Programme2", &second);
+  ASSERT_EQUAL_INT((int)first.count + 1, (int)second.count,
+                   "An update makes the entry stale");
+  ASSERT_EQUAL_INT(2, (int)db->query_cache->misses,
+                   "The first query and the stale one missed");
+  adv_query_result_free(&first);
+  adv_query_result_free(&second);
+
+  // MARK and ID stages cost the same, so the plan keeps them as written
+  adv_query_select(db, "MARK > 50 | ID >= 2500120", &first);
+  adv_query_select(db, "ID >= 2500120 | MARK > 50", &second);
+  ASSERT_EQUAL_INT(3, (int)db->query_cache->hits,
+                   "Stages of equal cost share an entry in either order");
+  ASSERT_EQUAL_INT((int)first.count, (int)second.count,
+                   "Either order finds the same matches");
+  adv_query_result_free(&first);
+  adv_query_result_free(&second);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_set_query_cache(db, 0),
+                   "Cache should be disabled");
+  ASSERT_NULL(db->query_cache, "Disabled cache is freed");
+  db_free(db);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Query Cache Tests");
+
+  RUN_TEST(test_store_lookup_and_evict);
+  RUN_TEST(test_stale_and_oversized_entries);
+
+  RUN_TEST(test_mutation_count_follows_changes);
+  RUN_TEST(test_adv_query_served_from_cache);
+
+  TEST_SUITE_END();
+}
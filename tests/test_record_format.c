@@ -0,0 +1,244 @@
+/*
+ * test_record_format.c
+ *
+ * unit tests for the record formatting module
+ * checks the hand-written formatters against printf and that db_save, which
+ * renders rows with them on several threads, writes the same bytes as
+ * fprintf("%d\t%s\t%s\t%.2f\n") would
+ *
+ * functions tested:
+ * - format_int()         : decimal integers
+ * - format_mark()        : marks with two decimal places
+ * - format_record_line() : whole record lines
+ * - db_save()            : parallel text rendering
+ */
+
+#include "../include/database.h"
+#include "../include/record_format.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FORMAT_TEMP "tests/fixtures/test_record_format_temp.txt"
+
+// true if format_mark and printf("%.2f") agree on mark
+static bool mark_matches_printf(float mark) {
+  char fast[FORMAT_MARK_MAX + 1];
+  char expected[FORMAT_MARK_MAX + 1];
+  fast[format_mark(fast, mark)] = '\0';
+  snprintf(expected, sizeof expected, "%.2f", mark);
+  return strcmp(fast, expected) == 0;
+}
+
+// the float one step above or below mark
+static float next_float(float mark, int step) {
+  uint32_t bits;
+  memcpy(&bits, &mark, sizeof bits);
+  bits += (uint32_t)step;
+  memcpy(&mark, &bits, sizeof mark);
+  return mark;
+}
+
+// read a whole file into a NUL-terminated buffer (caller frees)
+static char *read_file(const char *path, size_t *size) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    return NULL;
+  }
+  fseek(fp, 0, SEEK_END);
+  long length = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  char *text = malloc((size_t)length + 1);
+  if (text && fread(text, 1, (size_t)length, fp) != (size_t)length) {
+    free(text);
+    text = NULL;
+  }
+  fclose(fp);
+  if (text) {
+    text[length] = '\0';
+    *size = (size_t)length;
+  }
+  return text;
+}
+
+// =============================================================================
+// format_int() tests
+// =============================================================================
+
+void test_format_int(void) {
+  static const int values[] = {0,  1,   9,     10,      99,      100,
+                               -1, -10, 12345, 2500000, INT_MAX, INT_MIN};
+  bool match = true;
+  for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+    char fast[FORMAT_INT_MAX + 1];
+    char expected[FORMAT_INT_MAX + 1];
+    fast[format_int(fast, values[i])] = '\0';
+    snprintf(expected, sizeof expected, "%d", values[i]);
+    match = match && strcmp(fast, expected) == 0;
+  }
+  ASSERT_TRUE(match, "format_int should match printf for edge values");
+}
+
+// =============================================================================
+// format_mark() tests
+// =============================================================================
+
+void test_format_mark_hundredths(void) {
+  // every hundredth of the mark range and its neighbouring floats
+  bool match = true;
+  for (int i = 0; i <= 10000; i++) {
+    float mark = (float)i / 100.0f;
+    for (int step = -2; step <= 2; step++) {
+      match = match && mark_matches_printf(next_float(mark, step));
+    }
+  }
+  ASSERT_TRUE(match, "format_mark should match printf across 0..100");
+}
+
+void test_format_mark_ties(void) {
+  // exact halves of a hundredth round to even, as printf does
+  char text[FORMAT_MARK_MAX + 1];
+  text[format_mark(text, 0.125f)] = '\0';
+  ASSERT_EQUAL_STRING("0.12", text, "0.125 should round to even");
+  text[format_mark(text, 0.375f)] = '\0';
+  ASSERT_EQUAL_STRING("0.38", text, "0.375 should round to even");
+  ASSERT_TRUE(mark_matches_printf(2.5f), "2.5 should match printf");
+  ASSERT_TRUE(mark_matches_printf(99.995f), "99.995 should match printf");
+}
+
+void test_format_mark_signs_and_extremes(void) {
+  ASSERT_TRUE(mark_matches_printf(-0.0f), "Negative zero should match");
+  ASSERT_TRUE(mark_matches_printf(-0.001f), "Tiny negative should match");
+  ASSERT_TRUE(mark_matches_printf(-42.5f), "Negative mark should match");
+  ASSERT_TRUE(mark_matches_printf(1e-30f), "Tiny mark should match");
+  ASSERT_TRUE(mark_matches_printf(123456789.0f), "Large mark should match");
+  ASSERT_TRUE(mark_matches_printf(3.0e38f), "Huge mark should match");
+  ASSERT_TRUE(mark_matches_printf(-3.0e38f), "Huge negative should match");
+}
+
+void test_format_mark_random_bits(void) {
+  // a spread of bit patterns over every exponent, NaN and infinity included
+  bool match = true;
+  uint32_t bits = 12345;
+  for (int i = 0; i < 200000; i++) {
+    bits = bits * 1664525u + 1013904223u;
+    float mark;
+    memcpy(&mark, &bits, sizeof mark);
+    match = match && mark_matches_printf(mark);
+  }
+  ASSERT_TRUE(match, "format_mark should match printf for any float");
+}
+
+// =============================================================================
+// format_record_line() tests
+// =============================================================================
+
+void test_format_record_line(void) {
+  char line[RECORD_LINE_MAX + 1];
+  line[format_record_line(line, 2500123, "Joshua Chen", "Software Engineering",
+                          70.5f)] = '\0';
+  ASSERT_EQUAL_STRING(
+      "2500123\tJoshua Chen\tSoftware Engineering\t70.50" TEXT_NEWLINE, line,
+      "Record line should match the file format");
+
+  // longest fields fit within RECORD_LINE_MAX
+  char name[MAX_NAME_LENGTH];
+  char prog[MAX_PROGRAMME_LENGTH];
+  memset(name, 'n', sizeof name - 1);
+  name[sizeof name - 1] = '\0';
+  memset(prog, 'p', sizeof prog - 1);
+  prog[sizeof prog - 1] = '\0';
+  size_t length = format_record_line(line, INT_MIN, name, prog, -3.0e38f);
+  ASSERT_TRUE(length <= RECORD_LINE_MAX, "Longest line should fit");
+}
+
+// =============================================================================
+// db_save() tests
+// =============================================================================
+
+// the file fprintf would have written for table in its active view order,
+// through a text-mode stream as db_save once did
+static char *expected_text(const StudentDatabase *db,
+                           const StudentTable *table, size_t *size) {
+  FILE *fp = fopen(FORMAT_TEMP, "w");
+  if (!fp) {
+    return NULL;
+  }
+  fprintf(fp, "Database Name: %s\nAuthors: %s\n\nTable Name: %s\n",
+          db->db_name, db->authors, table->table_name);
+  fprintf(fp, "ID\tName\tProgramme\tMark\n");
+  size_t cursor = 0;
+  size_t p;
+  while ((p = table_view_next(table, &cursor)) != TABLE_VIEW_NOT_FOUND) {
+    fprintf(fp, "%d\t%s\t%s\t%.2f\n", table_record_id(table, p),
+            table_record_name(table, p), table_record_prog(table, p),
+            table_record_mark(table, p));
+  }
+  fclose(fp);
+  return read_file(FORMAT_TEMP, size);
+}
+
+void test_save_matches_fprintf(void) {
+  StudentDatabase *db = db_init();
+  StudentTable *table = create_test_table_with_records("StudentRecords", 0);
+  db_add_table(db, table);
+  strcpy(db->db_name, "Format");
+  strcpy(db->authors, "Tests");
+  db->is_loaded = true;
+
+  // enough rows for several save workers and passes
+  for (int i = 0; i < 150000; i++) {
+    char name[MAX_NAME_LENGTH];
+    snprintf(name, sizeof name, "Student %d", i);
+    StudentRecord record = create_test_record(
+        2500000 + i, name, (i % 2) ? "Computer Science" : "Mathematics",
+        (float)(i % 10001) / 100.0f + (float)(i % 7) * 0.001f);
+    table_add_record(table, &record);
+  }
+  table_remove_record(table, 2500005);
+
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC};
+  for (size_t v = 0; v < 2; v++) {
+    table_set_view(table, views[v]);
+    size_t expected_size = 0;
+    char *expected = expected_text(db, table, &expected_size);
+
+    ASSERT_TRUE(db_save(db, FORMAT_TEMP) == DB_SUCCESS, "Save should succeed");
+    size_t saved_size = 0;
+    char *saved = read_file(FORMAT_TEMP, &saved_size);
+    ASSERT_NOT_NULL(saved, "Saved file should be readable");
+    ASSERT_TRUE(expected && saved && saved_size == expected_size &&
+                    memcmp(saved, expected, saved_size) == 0,
+                "Saved file should be byte-identical to fprintf output");
+    free(expected);
+    free(saved);
+  }
+
+  remove(FORMAT_TEMP);
+  db_free(db);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Record Format Tests");
+
+  RUN_TEST(test_format_int);
+
+  RUN_TEST(test_format_mark_hundredths);
+  RUN_TEST(test_format_mark_ties);
+  RUN_TEST(test_format_mark_signs_and_extremes);
+  RUN_TEST(test_format_mark_random_bits);
+
+  RUN_TEST(test_format_record_line);
+
+  RUN_TEST(test_save_matches_fprintf);
+
+  TEST_SUITE_END();
+}
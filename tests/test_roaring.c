@@ -0,0 +1,198 @@
+/*
+ * test_roaring.c
+ *
+ * unit tests for the roaring bitmap module
+ * checks adds, removes and lookups against a plain array of flags across
+ * sparse and dense containers (so arrays turn into bitsets and back), and
+ * intersections, unions and counts against the same reference
+ *
+ * functions tested:
+ * - roaring_add()             : adding positions in and out of order
+ * - roaring_remove()          : removing positions
+ * - roaring_contains()        : membership
+ * - roaring_cardinality()     : positions held
+ * - roaring_or_into()         : union
+ * - roaring_and()             : intersection
+ * - roaring_and_cardinality() : intersection count
+ * - roaring_to_array()        : ascending positions
+ * - roaring_memory()          : bytes held
+ */
+
+#include "../include/roaring.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// positions span three containers: one dense, two sparse
+#define ROARING_TEST_RANGE (3u << 16)
+
+// fill bitmap and flags with positions; container 1 gets dense
+static bool fill_random(RoaringBitmap *bitmap, unsigned char *flags,
+                        unsigned seed) {
+  srand(seed);
+  bool added = true;
+  for (int i = 0; i < 6000; i++) {
+    uint32_t value = (uint32_t)rand() % ROARING_TEST_RANGE;
+    flags[value] = 1;
+    added = added && roaring_add(bitmap, value);
+  }
+  for (uint32_t value = 1u << 16; value < (1u << 16) + 20000; value += 3) {
+    flags[value] = 1;
+    added = added && roaring_add(bitmap, value);
+  }
+  return added;
+}
+
+// true if bitmap holds exactly the flagged positions, in ascending order
+static bool matches_flags(const RoaringBitmap *bitmap,
+                          const unsigned char *flags) {
+  size_t expected = 0;
+  bool same = true;
+  for (uint32_t value = 0; value < ROARING_TEST_RANGE && same; value++) {
+    expected += flags[value];
+    same = roaring_contains(bitmap, value) == (flags[value] != 0);
+  }
+  if (!same || roaring_cardinality(bitmap) != expected) {
+    return false;
+  }
+
+  uint32_t *values = malloc((expected ? expected : 1) * sizeof(uint32_t));
+  if (!values) {
+    return false;
+  }
+  size_t written = roaring_to_array(bitmap, values);
+  size_t at = 0;
+  for (uint32_t value = 0; value < ROARING_TEST_RANGE && same; value++) {
+    if (flags[value]) {
+      same = at < written && values[at++] == value;
+    }
+  }
+  free(values);
+  return same && written == expected;
+}
+
+void test_add_remove_contains(void) {
+  unsigned char *flags = calloc(ROARING_TEST_RANGE, 1);
+  ASSERT_NOT_NULL(flags, "Flags should allocate");
+  if (!flags) {
+    return;
+  }
+  RoaringBitmap bitmap;
+  roaring_init(&bitmap);
+  ASSERT_TRUE(fill_random(&bitmap, flags, 7), "Every position should add");
+  ASSERT_TRUE(matches_flags(&bitmap, flags), "Bitmap holds what was added");
+  ASSERT_EQUAL_INT(3, (int)bitmap.count, "One container per 65536 positions");
+  ASSERT_EQUAL_INT(ROARING_BITSET, bitmap.containers[1].kind,
+                   "A dense container becomes a bitset");
+  ASSERT_EQUAL_INT(ROARING_ARRAY, bitmap.containers[0].kind,
+                   "A sparse container stays an array");
+
+  // empty most of the dense container and all of the first
+  for (uint32_t value = 0; value < (1u << 16) + 19000; value++) {
+    roaring_remove(&bitmap, value);
+    flags[value] = 0;
+  }
+  roaring_remove(&bitmap, ROARING_TEST_RANGE + 5);
+  ASSERT_TRUE(matches_flags(&bitmap, flags), "Removes follow the flags");
+  ASSERT_EQUAL_INT(2, (int)bitmap.count, "Empty containers are dropped");
+  ASSERT_EQUAL_INT(ROARING_ARRAY, bitmap.containers[0].kind,
+                   "A thinned bitset turns back into an array");
+
+  roaring_free(&bitmap);
+  ASSERT_EQUAL_INT(0, (int)roaring_cardinality(&bitmap),
+                   "A freed bitmap is empty");
+  free(flags);
+}
+
+void test_and_or_match_reference(void) {
+  unsigned char *a_flags = calloc(ROARING_TEST_RANGE, 1);
+  unsigned char *b_flags = calloc(ROARING_TEST_RANGE, 1);
+  unsigned char *expected = calloc(ROARING_TEST_RANGE, 1);
+  ASSERT_TRUE(a_flags && b_flags && expected, "Flags should allocate");
+  if (!a_flags || !b_flags || !expected) {
+    free(a_flags);
+    free(b_flags);
+    free(expected);
+    return;
+  }
+  RoaringBitmap a;
+  RoaringBitmap b;
+  RoaringBitmap both;
+  roaring_init(&a);
+  roaring_init(&b);
+  roaring_init(&both);
+  fill_random(&a, a_flags, 11);
+  fill_random(&b, b_flags, 12);
+  // a sparse run in b's dense container meets a's bitset
+  for (uint32_t value = (1u << 16) + 1; value < (1u << 16) + 300; value += 7) {
+    b_flags[value] = 1;
+    roaring_add(&b, value);
+  }
+
+  size_t count = 0;
+  for (uint32_t value = 0; value < ROARING_TEST_RANGE; value++) {
+    expected[value] = a_flags[value] & b_flags[value];
+    count += expected[value];
+  }
+  ASSERT_TRUE(roaring_and(&a, &b, &both), "Intersection should succeed");
+  ASSERT_TRUE(matches_flags(&both, expected), "Intersection is exact");
+  ASSERT_EQUAL_INT((int)count, (int)roaring_and_cardinality(&a, &b),
+                   "Intersection count matches without building it");
+
+  for (uint32_t value = 0; value < ROARING_TEST_RANGE; value++) {
+    expected[value] = a_flags[value] | b_flags[value];
+  }
+  ASSERT_TRUE(roaring_or_into(&a, &b), "Union should succeed");
+  ASSERT_TRUE(matches_flags(&a, expected), "Union is exact");
+
+  RoaringBitmap empty;
+  roaring_init(&empty);
+  ASSERT_TRUE(roaring_and(&a, &empty, &both), "Intersecting nothing works");
+  ASSERT_EQUAL_INT(0, (int)roaring_cardinality(&both),
+                   "Intersection with an empty bitmap is empty");
+
+  roaring_free(&a);
+  roaring_free(&b);
+  roaring_free(&both);
+  free(a_flags);
+  free(b_flags);
+  free(expected);
+}
+
+void test_memory_follows_density(void) {
+  RoaringBitmap sparse;
+  RoaringBitmap dense;
+  roaring_init(&sparse);
+  roaring_init(&dense);
+  for (uint32_t value = 0; value < 1000; value++) {
+    roaring_add(&sparse, value * 60);
+  }
+  for (uint32_t value = 0; value < 60000; value++) {
+    roaring_add(&dense, value);
+  }
+  ASSERT_TRUE(roaring_memory(&sparse) >= 1000 * sizeof(uint16_t) &&
+                  roaring_memory(&sparse) < 4096,
+              "Sparse positions cost about 2 bytes each");
+  ASSERT_TRUE(roaring_memory(&dense) >=
+                  ROARING_BITSET_WORDS * sizeof(uint64_t) &&
+                  roaring_memory(&dense) < 9000,
+              "Dense positions cost about 1 bit each");
+  roaring_free(&sparse);
+  roaring_free(&dense);
+  ASSERT_EQUAL_INT(0, (int)roaring_memory(&dense),
+                   "A freed bitmap holds nothing");
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Roaring Bitmap Tests");
+
+  RUN_TEST(test_add_remove_contains);
+  RUN_TEST(test_and_or_match_reference);
+  RUN_TEST(test_memory_follows_density);
+
+  TEST_SUITE_END();
+}
@@ -0,0 +1,350 @@
+#include "../include/checksum.h"
+#include "../include/database.h"
+#include "../include/snapshot.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_TEMP "tests/fixtures/test_snapshot_temp.cmsb"
+#define SNAPSHOT_TEMP_2 "tests/fixtures/test_snapshot_temp2.cmsb"
+#define TEXT_TEMP "tests/fixtures/test_snapshot_temp.txt"
+#define TEXT_TEMP_2 "tests/fixtures/test_snapshot_temp2.txt"
+
+// load a file into a fresh database (NULL if it fails to load)
+static StudentDatabase *load_database(const char *path) {
+  StudentDatabase *db = db_init();
+  if (db && db_load(db, path, NULL) != DB_SUCCESS) {
+    db_free(db);
+    return NULL;
+  }
+  if (db) {
+    db->is_loaded = true;
+  }
+  return db;
+}
+
+// true if both tables hold the same records in the same order
+static bool tables_match(const StudentTable *a, const StudentTable *b) {
+  if (a->record_count != b->record_count) {
+    return false;
+  }
+  for (size_t i = 0; i < a->record_count; i++) {
+    StudentRecord x, y;
+    if (table_read_record(a, i, &x) != DB_SUCCESS ||
+        table_read_record(b, i, &y) != DB_SUCCESS || x.id != y.id ||
+        x.mark != y.mark || strcmp(x.name, y.name) != 0 ||
+        strcmp(x.prog, y.prog) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// overwrite one byte of a file
+static void poke_file(const char *path, long offset, int value) {
+  FILE *fp = fopen(path, "r+b");
+  if (fp) {
+    fseek(fp, offset, SEEK_SET);
+    fputc(value, fp);
+    fclose(fp);
+  }
+}
+
+// =============================================================================
+// format selection tests
+// =============================================================================
+
+void test_snapshot_is_path(void) {
+  ASSERT_TRUE(snapshot_is_path("data/records.cmsb"),
+              "Snapshot extension should select the snapshot format");
+  ASSERT_FALSE(snapshot_is_path("data/records.txt"),
+               "Text files should keep the text format");
+  ASSERT_FALSE(snapshot_is_path(".cmsb"), "Bare extension is not a file name");
+  ASSERT_FALSE(snapshot_is_path(NULL), "NULL should not be a snapshot");
+}
+
+// =============================================================================
+// save and load tests
+// =============================================================================
+
+void test_snapshot_round_trip(void) {
+  StudentDatabase *text = load_database(get_test_file_path("test_valid.txt"));
+  ASSERT_NOT_NULL(text, "Text fixture should load");
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_save(text, SNAPSHOT_TEMP),
+                   "Snapshot should be written");
+
+  StudentDatabase *snap = load_database(SNAPSHOT_TEMP);
+  ASSERT_NOT_NULL(snap, "Snapshot should load");
+  ASSERT_EQUAL_STRING(text->db_name, snap->db_name, "Name should survive");
+  ASSERT_EQUAL_STRING(text->authors, snap->authors, "Authors should survive");
+  ASSERT_EQUAL_INT(1, (int)snap->table_count, "Table should survive");
+
+  StudentTable *table = snap->tables[0];
+  ASSERT_EQUAL_STRING("StudentRecords", table->table_name,
+                      "Table name should survive");
+  ASSERT_EQUAL_INT(4, (int)table->column_count, "Headers should survive");
+  ASSERT_EQUAL_STRING("Programme", table->column_headers[2],
+                      "Header text should survive");
+  ASSERT_TRUE(tables_match(text->tables[0], table),
+              "Records should survive in order");
+  ASSERT_TRUE(table_find_position(table, 2500103) == 3,
+              "Id index should be rebuilt");
+  ASSERT_TRUE(tracked_database_checksum(snap) ==
+                  compute_database_checksum(snap),
+              "Tracked checksum should cover the mapped records");
+
+  // records are used where they lie in the mapped file
+  const char *begin = snap->mapped_files->map.data;
+  const char *record = (const char *)table->records;
+  ASSERT_TRUE(record > begin && record < begin + snap->mapped_files->map.size,
+              "Records should point into the mapped snapshot");
+
+  db_free(text);
+  db_free(snap);
+  remove(SNAPSHOT_TEMP);
+}
+
+void test_snapshot_mapped_table_is_writable(void) {
+  StudentDatabase *text = load_database(get_test_file_path("test_valid.txt"));
+  db_save(text, SNAPSHOT_TEMP);
+  db_free(text);
+
+  StudentDatabase *db = load_database(SNAPSHOT_TEMP);
+  ASSERT_NOT_NULL(db, "Snapshot should load");
+  StudentTable *table = db->tables[0];
+
+  float mark = 12.5f;
+  ASSERT_EQUAL_INT(DB_SUCCESS,
+                   db_update_record(db, 2500101, "Robert", NULL, &mark),
+                   "Mapped record should be updatable");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_remove_record(table, 2500100),
+                   "Mapped record should be deletable");
+  for (int i = 0; i < 20; i++) {
+    StudentRecord r = create_test_record(2500200 + i, "New", "CS", 60.0f);
+    ASSERT_EQUAL_INT(DB_SUCCESS, table_add_record(table, &r),
+                     "Adds past the mapped records should grow storage");
+  }
+
+  // saving over the mapped file must not disturb the mapping in use
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_save(db, SNAPSHOT_TEMP),
+                   "Saving over the open snapshot should succeed");
+  StudentDatabase *reloaded = load_database(SNAPSHOT_TEMP);
+  ASSERT_NOT_NULL(reloaded, "Rewritten snapshot should load");
+  ASSERT_TRUE(tables_match(db->tables[0], reloaded->tables[0]),
+              "Reload should see every change");
+  size_t p = table_find_position(reloaded->tables[0], 2500101);
+  ASSERT_EQUAL_STRING("Robert", table_record_name(reloaded->tables[0], p),
+                      "Update should be saved");
+  ASSERT_TRUE(table_find_position(reloaded->tables[0], 2500100) ==
+                  ID_INDEX_NOT_FOUND,
+              "Delete should be saved");
+
+  db_free(db);
+  db_free(reloaded);
+  remove(SNAPSHOT_TEMP);
+}
+
+void test_snapshot_saves_view_order(void) {
+  StudentDatabase *db = create_test_database_with_records(30);
+  db->is_loaded = true;
+  table_set_view(db->tables[0], TABLE_VIEW_MARK_DESC);
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_save(db, SNAPSHOT_TEMP),
+                   "Snapshot should be written");
+
+  StudentDatabase *snap = load_database(SNAPSHOT_TEMP);
+  ASSERT_NOT_NULL(snap, "Snapshot should load");
+  StudentTable *table = snap->tables[0];
+  bool ordered = table->record_count == 30;
+  for (size_t i = 1; i < table->record_count; i++) {
+    ordered = ordered &&
+              table_record_mark(table, i - 1) >= table_record_mark(table, i);
+  }
+  ASSERT_TRUE(ordered, "Records should be stored in the saved view order");
+
+  cleanup_test_database(db);
+  db_free(snap);
+  remove(SNAPSHOT_TEMP);
+}
+
+void test_snapshot_load_in_column_layout(void) {
+  StudentDatabase *text = load_database(get_test_file_path("test_valid.txt"));
+  db_save(text, SNAPSHOT_TEMP);
+
+  StudentDatabase *db = db_init();
+  db->table_layout = TABLE_LAYOUT_COLUMNS;
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_load(db, SNAPSHOT_TEMP, NULL),
+                   "Snapshot should load into column layout");
+  ASSERT_EQUAL_INT(TABLE_LAYOUT_COLUMNS, db->tables[0]->layout,
+                   "Loaded table should use the database layout");
+  ASSERT_TRUE(tables_match(text->tables[0], db->tables[0]),
+              "Records should survive the conversion");
+
+  db_free(text);
+  db_free(db);
+  remove(SNAPSHOT_TEMP);
+}
+
+// true if both files hold the same bytes
+static bool files_match(const char *a, const char *b) {
+  FILE *fa = fopen(a, "rb");
+  FILE *fb = fopen(b, "rb");
+  bool same = fa && fb;
+  while (same) {
+    int ca = fgetc(fa);
+    same = ca == fgetc(fb);
+    if (ca == EOF) {
+      break;
+    }
+  }
+  if (fa) {
+    fclose(fa);
+  }
+  if (fb) {
+    fclose(fb);
+  }
+  return same;
+}
+
+void test_snapshot_output_is_deterministic(void) {
+  StudentDatabase *dirty = create_test_database_with_records(0);
+  StudentDatabase *clean = create_test_database_with_records(0);
+  ASSERT_TRUE(dirty && clean, "Databases should be created");
+  if (!dirty || !clean) {
+    return;
+  }
+
+  // the same records, once with stale bytes after every string and in the
+  // padding, once zeroed
+  for (int i = 0; i < 300; i++) {
+    StudentRecord stale;
+    StudentRecord zeroed;
+    memset(&stale, 0x5A, sizeof stale);
+    memset(&zeroed, 0, sizeof zeroed);
+    stale.id = zeroed.id = 2500000 + i;
+    snprintf(stale.name, sizeof stale.name, "Student %d", i);
+    snprintf(zeroed.name, sizeof zeroed.name, "Student %d", i);
+    strcpy(stale.prog, i % 2 ? "CS" : "Maths");
+    strcpy(zeroed.prog, i % 2 ? "CS" : "Maths");
+    stale.mark = zeroed.mark = (float)(i % 100);
+    table_add_record(dirty->tables[0], &stale);
+    table_add_record(clean->tables[0], &zeroed);
+  }
+  db_save(dirty, SNAPSHOT_TEMP);
+  db_save(clean, SNAPSHOT_TEMP_2);
+  ASSERT_TRUE(files_match(SNAPSHOT_TEMP, SNAPSHOT_TEMP_2),
+              "Stale bytes in stored rows should not reach the file");
+
+  // a view and the column layout take the records through a batch
+  table_set_view(dirty->tables[0], TABLE_VIEW_MARK_DESC);
+  table_set_view(clean->tables[0], TABLE_VIEW_MARK_DESC);
+  table_set_layout(clean->tables[0], TABLE_LAYOUT_COLUMNS);
+  db_save(dirty, SNAPSHOT_TEMP);
+  db_save(clean, SNAPSHOT_TEMP_2);
+  ASSERT_TRUE(files_match(SNAPSHOT_TEMP, SNAPSHOT_TEMP_2),
+              "Rows and columns in a view should write the same bytes");
+
+  db_free(dirty);
+  db_free(clean);
+  remove(SNAPSHOT_TEMP);
+  remove(SNAPSHOT_TEMP_2);
+}
+
+void test_snapshot_rejects_invalid_records(void) {
+  // table_add_record does not validate, so these reach the file as they are
+  StudentRecord invalid[] = {
+      create_test_record(2500900, "Mark Too High", "CS", 150.0f),
+      create_test_record(99, "Id Too Low", "CS", 50.0f),
+      create_test_record(2500901, "", "CS", 50.0f)};
+  for (size_t i = 0; i < sizeof invalid / sizeof invalid[0]; i++) {
+    StudentDatabase *db = create_test_database_with_records(5);
+    db->is_loaded = true;
+    table_add_record(db->tables[0], &invalid[i]);
+    ASSERT_EQUAL_INT(DB_SUCCESS, db_save(db, SNAPSHOT_TEMP),
+                     "Snapshot should be written");
+    db_free(db);
+
+    db = db_init();
+    ASSERT_EQUAL_INT(DB_ERROR_INVALID_DATA, db_load(db, SNAPSHOT_TEMP, NULL),
+                     "A record the text parser rejects should fail the load");
+    db_free(db);
+  }
+  remove(SNAPSHOT_TEMP);
+}
+
+void test_snapshot_rejects_damaged_files(void) {
+  StudentDatabase *text = load_database(get_test_file_path("test_valid.txt"));
+  db_save(text, SNAPSHOT_TEMP);
+  db_free(text);
+
+  // a flipped byte in a record fails the checksum
+  long record_byte = (long)sizeof(SnapshotHeader) + 200;
+  poke_file(SNAPSHOT_TEMP, record_byte, 'X');
+  StudentDatabase *db = db_init();
+  ASSERT_EQUAL_INT(DB_ERROR_INVALID_DATA, db_load(db, SNAPSHOT_TEMP, NULL),
+                   "Corrupted snapshot should be rejected");
+  ASSERT_EQUAL_INT(0, (int)db->table_count, "No table should be created");
+  ASSERT_NULL(db->mapped_files, "Rejected file should not stay mapped");
+  db_free(db);
+
+  // a text file with the snapshot extension is not a snapshot
+  FILE *fp = fopen(SNAPSHOT_TEMP, "w");
+  fprintf(fp, "Database Name: Text\n");
+  fclose(fp);
+  db = db_init();
+  ASSERT_EQUAL_INT(DB_ERROR_INVALID_DATA, db_load(db, SNAPSHOT_TEMP, NULL),
+                   "Text in a snapshot file should be rejected");
+  db_free(db);
+
+  db = db_init();
+  ASSERT_EQUAL_INT(DB_ERROR_FILE_NOT_FOUND,
+                   db_load(db, "tests/fixtures/missing.cmsb", NULL),
+                   "Missing snapshot should be reported");
+  db_free(db);
+  remove(SNAPSHOT_TEMP);
+}
+
+void test_snapshot_convert_both_directions(void) {
+  // a file written by db_save converts to a snapshot and back unchanged
+  StudentDatabase *db = load_database(get_test_file_path("test_valid.txt"));
+  db_save(db, TEXT_TEMP);
+  db_free(db);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, snapshot_convert(TEXT_TEMP, SNAPSHOT_TEMP),
+                   "Text should convert to a snapshot");
+  ASSERT_EQUAL_INT(DB_SUCCESS, snapshot_convert(SNAPSHOT_TEMP, TEXT_TEMP_2),
+                   "Snapshot should convert to text");
+  ASSERT_TRUE(compute_file_checksum(TEXT_TEMP) ==
+                  compute_file_checksum(TEXT_TEMP_2),
+              "Text should be identical after the round trip");
+  ASSERT_EQUAL_INT(DB_ERROR_FILE_NOT_FOUND,
+                   snapshot_convert("tests/fixtures/missing.txt",
+                                    SNAPSHOT_TEMP),
+                   "Missing source should be reported");
+
+  remove(TEXT_TEMP);
+  remove(TEXT_TEMP_2);
+  remove(SNAPSHOT_TEMP);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Snapshot Tests");
+
+  RUN_TEST(test_snapshot_is_path);
+
+  RUN_TEST(test_snapshot_round_trip);
+  RUN_TEST(test_snapshot_mapped_table_is_writable);
+  RUN_TEST(test_snapshot_saves_view_order);
+  RUN_TEST(test_snapshot_load_in_column_layout);
+  RUN_TEST(test_snapshot_output_is_deterministic);
+  RUN_TEST(test_snapshot_rejects_invalid_records);
+  RUN_TEST(test_snapshot_rejects_damaged_files);
+  RUN_TEST(test_snapshot_convert_both_directions);
+
+  TEST_SUITE_END();
+}
@@ -263,6 +263,119 @@ void test_sort_records_large_dataset(void) {
   table_free(table);
 }
 
+// =============================================================================
+// sort engine tests (radix keys, fallbacks, parallel variant)
+// =============================================================================
+
+// fill an array with pseudo-random records (unique ids, hundredths marks)
+static StudentRecord *make_random_records(size_t count, unsigned seed) {
+  StudentRecord *records = malloc(count * sizeof(StudentRecord));
+  if (!records) {
+    return NULL;
+  }
+  srand(seed);
+  for (size_t i = 0; i < count; i++) {
+    int id = 2500000 + (int)((i * 7919) % 100001);
+    float mark = (float)(rand() % 10001) / 100.0f;
+    records[i] = create_test_record(id, "Student", "Programme", mark);
+  }
+  return records;
+}
+
+// true if records are strictly ordered by mark desc, then id asc
+static int is_mark_desc_order(const StudentRecord *records, size_t count) {
+  for (size_t i = 1; i < count; i++) {
+    const StudentRecord *a = &records[i - 1];
+    const StudentRecord *b = &records[i];
+    if (a->mark < b->mark || (a->mark == b->mark && a->id >= b->id)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void test_sort_records_random_mark_desc(void) {
+  size_t count = 5000;
+  StudentRecord *records = make_random_records(count, 42);
+
+  sort_records(records, count, SORT_FIELD_MARK, SORT_ORDER_DESC);
+
+  ASSERT_TRUE(is_mark_desc_order(records, count),
+              "Random records should be ordered by mark desc then ID asc");
+
+  free(records);
+}
+
+void test_sort_records_non_fixed_point_marks(void) {
+  StudentRecord records[] = {
+      {1001, "A", "P", 70.125f}, {1002, "B", "P", 70.12f},
+      {1003, "C", "P", -0.0f},   {1004, "D", "P", 0.0f},
+      {1005, "E", "P", 99.999f}, {1006, "F", "P", 70.125f},
+  };
+  size_t count = sizeof records / sizeof records[0];
+
+  sort_records(records, count, SORT_FIELD_MARK, SORT_ORDER_ASC);
+
+  ASSERT_EQUAL_INT(1003, records[0].id,
+                   "Negative zero should tie with zero (lower ID first)");
+  ASSERT_EQUAL_INT(1004, records[1].id, "Zero mark should follow tie");
+  ASSERT_EQUAL_INT(1002, records[2].id, "70.12 should precede 70.125");
+  ASSERT_EQUAL_INT(1001, records[3].id, "Tied 70.125 marks sort by ID");
+  ASSERT_EQUAL_INT(1006, records[4].id, "Tied 70.125 marks sort by ID");
+  ASSERT_EQUAL_INT(1005, records[5].id, "Highest mark should be last");
+}
+
+void test_sort_records_stable_for_equal_ids(void) {
+  StudentRecord records[60];
+  for (int i = 0; i < 60; i++) {
+    char name[8];
+    snprintf(name, sizeof name, "N%02d", i);
+    // ids repeat every 3 records; names record the original order
+    records[i] = create_test_record(1000 + (i % 3), name, "P", 50.0f);
+  }
+
+  sort_records(records, 60, SORT_FIELD_ID, SORT_ORDER_DESC);
+
+  int stable = 1;
+  for (int i = 1; i < 60; i++) {
+    if (records[i - 1].id == records[i].id &&
+        strcmp(records[i - 1].name, records[i].name) > 0) {
+      stable = 0;
+    }
+  }
+  ASSERT_TRUE(stable, "Equal IDs should keep their original order");
+  ASSERT_EQUAL_INT(1002, records[0].id, "Highest ID should come first");
+}
+
+void test_sort_records_parallel_matches_serial(void) {
+  size_t count = 20000;
+  StudentRecord *serial = make_random_records(count, 7);
+  StudentRecord *parallel = make_random_records(count, 7);
+
+  sort_records_parallel(serial, count, SORT_FIELD_MARK, SORT_ORDER_ASC, 1);
+  sort_records_parallel(parallel, count, SORT_FIELD_MARK, SORT_ORDER_ASC, 5);
+
+  ASSERT_TRUE(memcmp(serial, parallel, count * sizeof(StudentRecord)) == 0,
+              "Parallel sort should produce the same order as serial sort");
+
+  free(serial);
+  free(parallel);
+}
+
+void test_sort_records_nan_mark_fallback(void) {
+  StudentRecord records[] = {
+      {1003, "C", "P", 60.0f},
+      {1001, "A", "P", NAN},
+      {1002, "B", "P", 40.0f},
+  };
+
+  sort_records(records, 3, SORT_FIELD_MARK, SORT_ORDER_ASC);
+
+  int ids_present = records[0].id + records[1].id + records[2].id;
+  ASSERT_EQUAL_INT(3006, ids_present,
+                   "Merge sort fallback should keep every record");
+}
+
 // =============================================================================
 // test suite runner
 // =============================================================================
@@ -284,6 +397,11 @@ int main(void) {
   RUN_TEST(test_sort_records_boundary_ids);
   RUN_TEST(test_sort_records_boundary_marks);
   RUN_TEST(test_sort_records_large_dataset);
+  RUN_TEST(test_sort_records_random_mark_desc);
+  RUN_TEST(test_sort_records_non_fixed_point_marks);
+  RUN_TEST(test_sort_records_stable_for_equal_ids);
+  RUN_TEST(test_sort_records_parallel_matches_serial);
+  RUN_TEST(test_sort_records_nan_mark_fallback);
 
   TEST_SUITE_END();
 }
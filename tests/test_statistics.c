@@ -195,6 +195,34 @@ void test_calculate_statistics_floating_point_precision(void) {
   table_free(table);
 }
 
+void test_calculate_statistics_column_layout_with_deletes(void) {
+  // enough records for several summary blocks, with deletes splitting the
+  // mark column into runs and ties on both extremes
+  StudentTable *table = create_test_table_with_records("Test", 5000);
+  for (int id = 2500100; id < 2500100 + 5000; id += 37) {
+    table_remove_record(table, id);
+  }
+
+  StudentStatistics rows;
+  ASSERT_EQUAL_INT(DB_SUCCESS, calculate_statistics(table, &rows),
+                   "Row layout should succeed");
+  table_set_layout(table, TABLE_LAYOUT_COLUMNS);
+  StudentStatistics columns;
+  ASSERT_EQUAL_INT(DB_SUCCESS, calculate_statistics(table, &columns),
+                   "Column layout should succeed");
+
+  ASSERT_EQUAL_INT(rows.highest_student_id, columns.highest_student_id,
+                   "First highest should match row layout");
+  ASSERT_EQUAL_INT(rows.lowest_student_id, columns.lowest_student_id,
+                   "First lowest should match row layout");
+  ASSERT_EQUAL_FLOAT(rows.average_mark, columns.average_mark, 0.0001f,
+                     "Average should match row layout");
+  ASSERT_EQUAL_INT((int)rows.total_count, (int)columns.total_count,
+                   "Count should match row layout");
+
+  table_free(table);
+}
+
 void test_calculate_statistics_null_records_array(void) {
   StudentTable *table = table_init("Test");
   free(table->records);
@@ -228,6 +256,7 @@ int main(void) {
   RUN_TEST(test_calculate_statistics_boundary_marks);
   RUN_TEST(test_calculate_statistics_large_dataset);
   RUN_TEST(test_calculate_statistics_floating_point_precision);
+  RUN_TEST(test_calculate_statistics_column_layout_with_deletes);
   RUN_TEST(test_calculate_statistics_null_records_array);
 
   TEST_SUITE_END();
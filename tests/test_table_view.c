@@ -0,0 +1,350 @@
+#include "../include/database.h"
+#include "../include/sorting.h"
+#include "../include/table_view.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// id of the record at a rank of the active view
+static int view_id(StudentTable *table, size_t rank) {
+  return table_record_id(table, table_view_at(table, rank));
+}
+
+// true if every rank of view is a distinct live position in the expected
+// order
+static bool view_is_ordered(StudentTable *table, TableView view) {
+  SortField field = (view == TABLE_VIEW_ID_ASC || view == TABLE_VIEW_ID_DESC)
+                        ? SORT_FIELD_ID
+                        : SORT_FIELD_MARK;
+  SortOrder order = (view == TABLE_VIEW_ID_ASC || view == TABLE_VIEW_MARK_ASC)
+                        ? SORT_ORDER_ASC
+                        : SORT_ORDER_DESC;
+
+  bool *seen = calloc(table->slot_count + 1, sizeof(bool));
+  if (!seen) {
+    return false;
+  }
+
+  bool ok = true;
+  for (size_t rank = 0; rank < table->record_count && ok; rank++) {
+    size_t position = table_view_position(table, view, rank);
+    if (position >= table->slot_count || !table_is_live(table, position) ||
+        seen[position]) {
+      ok = false;
+      break;
+    }
+    seen[position] = true;
+    if (rank > 0) {
+      StudentRecord previous;
+      StudentRecord current;
+      table_read_record(table, table_view_position(table, view, rank - 1),
+                        &previous);
+      table_read_record(table, position, &current);
+      ok = sort_compare_records(&previous, &current, field, order) < 0;
+    }
+  }
+
+  free(seen);
+  return ok;
+}
+
+// true if all four sorted views are consistent with the records
+static bool all_views_ordered(StudentTable *table) {
+  return view_is_ordered(table, TABLE_VIEW_ID_ASC) &&
+         view_is_ordered(table, TABLE_VIEW_ID_DESC) &&
+         view_is_ordered(table, TABLE_VIEW_MARK_ASC) &&
+         view_is_ordered(table, TABLE_VIEW_MARK_DESC);
+}
+
+// =============================================================================
+// view switching tests
+// =============================================================================
+
+void test_views_start_unbuilt_in_storage_order(void) {
+  StudentTable *table = create_test_table_with_records("Test", 5);
+
+  ASSERT_FALSE(table->views.built, "Views should not be built on load");
+  ASSERT_EQUAL_INT(TABLE_VIEW_STORAGE, table->active_view,
+                   "Active view should default to storage order");
+  ASSERT_TRUE(table_view_at(table, 2) == 2,
+              "Storage view should map rank to position");
+  ASSERT_TRUE(table_view_position(table, TABLE_VIEW_MARK_ASC, 0) ==
+                  TABLE_VIEW_NOT_FOUND,
+              "Unbuilt view should not resolve ranks");
+
+  table_free(table);
+}
+
+void test_set_view_does_not_move_records(void) {
+  StudentTable *table = table_init("Test");
+  StudentRecord a = create_test_record(2500003, "Alice", "CS", 70.0f);
+  StudentRecord b = create_test_record(2500001, "Bob", "CS", 90.0f);
+  StudentRecord c = create_test_record(2500002, "Cara", "CS", 80.0f);
+  table_add_record(table, &a);
+  table_add_record(table, &b);
+  table_add_record(table, &c);
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_view(table, TABLE_VIEW_MARK_DESC),
+                   "Switching to mark descending should succeed");
+  ASSERT_EQUAL_INT(2500001, view_id(table, 0),
+                   "Highest mark should come first");
+  ASSERT_EQUAL_INT(2500003, view_id(table, 2),
+                   "Lowest mark should come last");
+  ASSERT_EQUAL_INT(2500003, table->records[0].id,
+                   "Stored order should be unchanged");
+
+  table_set_view(table, TABLE_VIEW_ID_DESC);
+  ASSERT_EQUAL_INT(2500003, view_id(table, 0),
+                   "Largest ID should come first");
+  ASSERT_EQUAL_INT(2500001, view_id(table, 2),
+                   "Smallest ID should come last");
+
+  table_set_view(table, TABLE_VIEW_STORAGE);
+  ASSERT_EQUAL_INT(2500001, view_id(table, 1),
+                   "Storage view should restore insertion order");
+  ASSERT_TRUE(table_view_at(table, 3) == TABLE_VIEW_NOT_FOUND,
+              "Rank past end should not resolve");
+
+  table_free(table);
+}
+
+void test_set_view_rejects_invalid_view(void) {
+  StudentTable *table = create_test_table_with_records("Test", 2);
+
+  ASSERT_EQUAL_INT(DB_ERROR_INVALID_DATA, table_set_view(table, (TableView)42),
+                   "Unknown view should be rejected");
+  ASSERT_EQUAL_INT(DB_ERROR_NULL_POINTER,
+                   table_set_view(NULL, TABLE_VIEW_ID_ASC),
+                   "NULL table should be rejected");
+
+  table_free(table);
+}
+
+// =============================================================================
+// incremental maintenance tests
+// =============================================================================
+
+void test_views_follow_inserts(void) {
+  StudentTable *table = create_test_table_with_records("Test", 10);
+  table_set_view(table, TABLE_VIEW_MARK_ASC);
+
+  StudentRecord low = create_test_record(2400000, "Low", "CS", 1.0f);
+  StudentRecord high = create_test_record(2600000, "High", "CS", 99.5f);
+  table_add_record(table, &low);
+  table_add_record(table, &high);
+
+  ASSERT_EQUAL_INT(2400000, view_id(table, 0),
+                   "New lowest mark should be first");
+  ASSERT_EQUAL_INT(2600000, view_id(table, 11),
+                   "New highest mark should be last");
+  ASSERT_TRUE(all_views_ordered(table), "All views should stay sorted");
+
+  table_free(table);
+}
+
+void test_views_follow_removals(void) {
+  StudentTable *table = create_test_table_with_records("Test", 10);
+  table_set_view(table, TABLE_VIEW_ID_ASC);
+
+  table_remove_record(table, 2500100);
+  table_remove_record(table, 2500105);
+
+  ASSERT_EQUAL_INT(8, (int)table->record_count, "Two records removed");
+  ASSERT_EQUAL_INT(2500101, view_id(table, 0),
+                   "Smallest remaining ID should be first");
+  ASSERT_TRUE(all_views_ordered(table),
+              "Views should stay sorted after shifting");
+
+  table_free(table);
+}
+
+void test_views_follow_mark_updates(void) {
+  StudentDatabase *db = create_test_database_with_records(5);
+  StudentTable *table = db->tables[0];
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+
+  int first_id = table->records[0].id;
+  float top = 100.0f;
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_update_record(db, first_id, NULL, NULL, &top),
+                   "Mark update should succeed");
+
+  ASSERT_EQUAL_INT(first_id, view_id(table, 0),
+                   "Updated record should move to the top");
+  ASSERT_TRUE(all_views_ordered(table), "Views should stay sorted");
+
+  cleanup_test_database(db);
+}
+
+void test_views_random_mutations(void) {
+  StudentTable *table = table_init("Test");
+  table_set_view(table, TABLE_VIEW_MARK_ASC);
+
+  srand(7);
+  for (int step = 0; step < 600; step++) {
+    int id = 2500000 + rand() % 300;
+    if (rand() % 3 == 0) {
+      table_remove_record(table, id);
+    } else {
+      StudentRecord r = create_test_record(id, "Student", "CS",
+                                           (float)(rand() % 10001) / 100.0f);
+      table_add_record(table, &r);
+    }
+  }
+
+  ASSERT_TRUE(table->record_count > 0, "Table should hold records");
+  ASSERT_TRUE(all_views_ordered(table),
+              "Views should match a full re-sort after random mutations");
+
+  table_free(table);
+}
+
+void test_rebuild_index_rebuilds_views(void) {
+  StudentTable *table = create_test_table_with_records("Test", 20);
+  table_set_view(table, TABLE_VIEW_ID_ASC);
+
+  sort_records(table->records, table->record_count, SORT_FIELD_MARK,
+               SORT_ORDER_DESC);
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_rebuild_index(table),
+                   "Rebuild should succeed");
+  ASSERT_TRUE(all_views_ordered(table),
+              "Views should be rebuilt after an in-place sort");
+
+  table_free(table);
+}
+
+// =============================================================================
+// range and compaction tests
+// =============================================================================
+
+void test_mark_and_id_ranges(void) {
+  StudentTable *table = create_test_table_with_records("Test", 20);
+  size_t first = 0;
+  size_t end = 0;
+
+  // marks are 50..69, ids 2500100..2500119
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_mark_range(table, 55.0f, 59.5f, &first,
+                                                &end),
+                   "Mark range should succeed");
+  ASSERT_EQUAL_INT(5, (int)(end - first), "Marks 55-59 should match");
+  ASSERT_TRUE(table->records[table_view_position(table, TABLE_VIEW_MARK_ASC,
+                                                 first)]
+                      .mark == 55.0f,
+              "Range should start at the lowest matching mark");
+
+  table_id_range(table, 2500110, 2500200, &first, &end);
+  ASSERT_EQUAL_INT(10, (int)(end - first), "IDs from 2500110 should match");
+
+  table_mark_range(table, 80.0f, 70.0f, &first, &end);
+  ASSERT_EQUAL_INT(0, (int)(end - first), "Inverted range should be empty");
+
+  table_free(table);
+}
+
+void test_compact_reorders_storage(void) {
+  StudentTable *table = create_test_table_with_records("Test", 30);
+  table_set_view(table, TABLE_VIEW_MARK_DESC);
+
+  int expected[30];
+  for (size_t rank = 0; rank < 30; rank++) {
+    expected[rank] = view_id(table, rank);
+  }
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_compact(table), "Compaction should work");
+  ASSERT_EQUAL_INT(TABLE_VIEW_STORAGE, table->active_view,
+                   "Compaction should return to storage order");
+
+  bool same = true;
+  for (size_t i = 0; i < 30; i++) {
+    same = same && table->records[i].id == expected[i];
+  }
+  ASSERT_TRUE(same, "Stored order should match the former view");
+  ASSERT_TRUE(table_find_record(table, expected[3]) == &table->records[3],
+              "ID index should follow compaction");
+  ASSERT_TRUE(all_views_ordered(table), "Views should follow compaction");
+
+  table_free(table);
+}
+
+// ids of the records between two cursor values, scanned as a save worker
+// would; returns how many were written to ids
+static size_t scan_cursor_range(StudentTable *table, size_t first,
+                                size_t last, int *ids) {
+  size_t count = 0;
+  size_t cursor = first;
+  while (cursor < last) {
+    size_t position = table_view_next(table, &cursor);
+    if (position == TABLE_VIEW_NOT_FOUND || cursor > last) {
+      break;
+    }
+    ids[count++] = table_record_id(table, position);
+  }
+  return count;
+}
+
+void test_cursor_ranges_split_views(void) {
+  StudentTable *table = create_test_table_with_records("Test", 12);
+  table_remove_record(table, 2500100);
+  table_remove_record(table, 2500106);
+  table_remove_record(table, 2500111);
+
+  static const TableView views[] = {TABLE_VIEW_STORAGE, TABLE_VIEW_MARK_DESC};
+  for (size_t v = 0; v < 2; v++) {
+    table_set_view(table, views[v]);
+    size_t end = table_view_cursor_end(table);
+    int whole[12];
+    size_t count = scan_cursor_range(table, 0, end, whole);
+    ASSERT_EQUAL_INT(9, (int)count, "Whole range should visit live records");
+
+    // every split point gives the same records in the same order
+    bool match = true;
+    for (size_t split = 0; split <= end; split++) {
+      int parts[12];
+      size_t first = scan_cursor_range(table, 0, split, parts);
+      size_t second = scan_cursor_range(table, split, end, parts + first);
+      match = match && first + second == count &&
+              memcmp(parts, whole, count * sizeof whole[0]) == 0;
+    }
+    ASSERT_TRUE(match, "Split cursor ranges should cover the view once");
+  }
+  ASSERT_TRUE(table_view_cursor_end(NULL) == 0, "NULL table has no range");
+
+  table_free(table);
+}
+
+void test_views_null_safety(void) {
+  size_t first = 0;
+  size_t end = 0;
+  ASSERT_TRUE(table_view_at(NULL, 0) == TABLE_VIEW_NOT_FOUND,
+              "NULL table has no records");
+  ASSERT_EQUAL_INT(DB_ERROR_NULL_POINTER, table_compact(NULL),
+                   "NULL compaction should fail");
+  ASSERT_EQUAL_INT(DB_ERROR_NULL_POINTER,
+                   table_mark_range(NULL, 0.0f, 1.0f, &first, &end),
+                   "NULL range should fail");
+  table_views_free(NULL);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Table View Tests");
+
+  RUN_TEST(test_views_start_unbuilt_in_storage_order);
+  RUN_TEST(test_set_view_does_not_move_records);
+  RUN_TEST(test_set_view_rejects_invalid_view);
+
+  RUN_TEST(test_views_follow_inserts);
+  RUN_TEST(test_views_follow_removals);
+  RUN_TEST(test_views_follow_mark_updates);
+  RUN_TEST(test_views_random_mutations);
+  RUN_TEST(test_rebuild_index_rebuilds_views);
+
+  RUN_TEST(test_mark_and_id_ranges);
+  RUN_TEST(test_compact_reorders_storage);
+  RUN_TEST(test_cursor_ranges_split_views);
+  RUN_TEST(test_views_null_safety);
+
+  TEST_SUITE_END();
+}
@@ -0,0 +1,255 @@
+/*
+ * test_text_search.c
+ *
+ * unit tests for the text search module
+ * checks the vector needle search against a plain case-insensitive scan for
+ * every needle length around the vector width, over strings packed end to
+ * end so reads past a terminator land on the next string, and checks that a
+ * table's folded names follow its records through adds, updates, deletes,
+ * purges, sorts and layout changes
+ *
+ * functions tested:
+ * - text_needle_find()     : search of a folded string
+ * - text_needle_match()    : search of a string in its original case
+ * - folded_text_append()   : folded copy for a new position
+ * - folded_text_replace()  : folded copy for an existing position
+ * - folded_text_compact()  : dropping dead folded strings
+ */
+
+#include "../include/database.h"
+#include "../include/table_view.h"
+#include "../include/text_search.h"
+#include "test_utils.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SEARCH_TEST_STRINGS 400
+
+// substring check ignoring case, one character at a time
+static bool naive_contains(const char *text, const char *pattern) {
+  size_t length = strlen(pattern);
+  for (const char *p = text; *p; p++) {
+    size_t i = 0;
+    while (p[i] &&
+           tolower((unsigned char)p[i]) == tolower((unsigned char)pattern[i])) {
+      if (++i == length) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// true if every live position's folded name is its name in lower case
+static bool folded_names_match(const StudentTable *table) {
+  for (size_t p = 0; p < table->slot_count; p++) {
+    if (!table_is_live(table, p)) {
+      continue;
+    }
+    const char *name = table_record_name(table, p);
+    const char *folded = folded_text_get(&table->folded_names, p);
+    if (strlen(name) != strlen(folded)) {
+      return false;
+    }
+    for (size_t i = 0; name[i]; i++) {
+      if (tolower((unsigned char)name[i]) != folded[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// =============================================================================
+// needle tests
+// =============================================================================
+
+void test_needle_find_matches_scan(void) {
+  // short strings over a small alphabet, so partial matches are common
+  static const char alphabet[] = "abAB c";
+  FoldedText folded;
+  folded_text_init(&folded);
+  ASSERT_TRUE(folded_text_reserve(&folded, SEARCH_TEST_STRINGS),
+              "Reserve should succeed");
+
+  char (*texts)[100] = malloc(SEARCH_TEST_STRINGS * sizeof *texts);
+  ASSERT_NOT_NULL(texts, "Texts should allocate");
+  if (!texts) {
+    folded_text_free(&folded);
+    return;
+  }
+  srand(7);
+  for (size_t i = 0; i < SEARCH_TEST_STRINGS; i++) {
+    size_t length = (size_t)rand() % 99;
+    for (size_t j = 0; j < length; j++) {
+      texts[i][j] = alphabet[rand() % 6];
+    }
+    texts[i][length] = '\0';
+    folded_text_append(&folded, i, texts[i]);
+  }
+
+  bool match = true;
+  char pattern[TEXT_NEEDLE_MAX + 8];
+  for (size_t length = 1; length < sizeof pattern && match; length++) {
+    for (int attempt = 0; attempt < 20 && match; attempt++) {
+      for (size_t j = 0; j < length; j++) {
+        pattern[j] = alphabet[rand() % (length < 6 ? 5 : 4)];
+      }
+      pattern[length] = '\0';
+      TextNeedle needle;
+      if (!text_needle_init(&needle, pattern)) {
+        match = false;
+        break;
+      }
+      for (size_t i = 0; i < SEARCH_TEST_STRINGS && match; i++) {
+        bool expected = naive_contains(texts[i], pattern);
+        match = text_needle_find(&needle, folded_text_get(&folded, i)) ==
+                    expected &&
+                text_needle_match(&needle, texts[i]) == expected;
+      }
+      text_needle_free(&needle);
+    }
+  }
+  ASSERT_TRUE(match, "Needle search should agree with a plain scan");
+
+  free(texts);
+  folded_text_free(&folded);
+}
+
+void test_needle_edges(void) {
+  TextNeedle needle;
+  ASSERT_FALSE(text_needle_init(&needle, ""), "Empty pattern is rejected");
+  ASSERT_FALSE(text_needle_init(&needle, NULL), "NULL pattern is rejected");
+  ASSERT_FALSE(text_needle_find(&needle, "abc"),
+               "A rejected needle finds nothing");
+
+  FoldedText folded;
+  folded_text_init(&folded);
+  folded_text_reserve(&folded, 3);
+  folded_text_append(&folded, 0, "Tan Wei Ming");
+  folded_text_append(&folded, 1, "xyz");
+  folded_text_append(&folded, 2, "Caf\xc3\x89");
+
+  ASSERT_TRUE(text_needle_init(&needle, "WEI"), "Pattern should fold");
+  ASSERT_TRUE(text_needle_find(&needle, folded_text_get(&folded, 0)),
+              "Upper-case pattern finds a mixed-case name");
+  ASSERT_TRUE(text_needle_match(&needle, "tan wei ming"),
+              "Unfolded search ignores case as well");
+  ASSERT_FALSE(text_needle_find(&needle, folded_text_get(&folded, 1)),
+               "A shorter string cannot hold the pattern");
+  text_needle_free(&needle);
+
+  // a match would have to run over the terminator into the next string
+  ASSERT_TRUE(text_needle_init(&needle, "mingx"), "Pattern should fold");
+  ASSERT_FALSE(text_needle_find(&needle, folded_text_get(&folded, 0)),
+               "Matches never cross the end of a string");
+  text_needle_free(&needle);
+
+  // only A-Z fold, as tolower does in the C locale
+  ASSERT_TRUE(text_needle_init(&needle, "CAF\xc3\x89"), "Pattern should fold");
+  ASSERT_TRUE(text_needle_find(&needle, folded_text_get(&folded, 2)),
+              "Bytes outside A-Z compare as they are");
+  text_needle_free(&needle);
+  ASSERT_TRUE(text_needle_init(&needle, "caf\xc3\xa9"), "Pattern should fold");
+  ASSERT_FALSE(text_needle_match(&needle, "Caf\xc3\x89"),
+               "Non-ASCII letters are not folded");
+  text_needle_free(&needle);
+  folded_text_free(&folded);
+}
+
+// =============================================================================
+// folded text tests
+// =============================================================================
+
+void test_folded_text_replace_and_compact(void) {
+  FoldedText folded;
+  folded_text_init(&folded);
+  folded_text_reserve(&folded, 3);
+  folded_text_append(&folded, 0, "Alice Tan");
+  folded_text_append(&folded, 1, "Bob Lim");
+  folded_text_append(&folded, 2, "Cheryl Ng");
+
+  uint32_t offset = folded.offsets[0];
+  ASSERT_TRUE(folded_text_replace(&folded, 0, "ALICE"),
+              "Shorter replacement should succeed");
+  ASSERT_EQUAL_INT((int)offset, (int)folded.offsets[0],
+                   "Shorter string is folded in place");
+  ASSERT_TRUE(folded_text_replace(&folded, 1, "Bob Lim Jun Jie"),
+              "Longer replacement should succeed");
+  ASSERT_EQUAL_STRING("bob lim jun jie", folded_text_get(&folded, 1),
+                      "Longer string is appended");
+
+  folded_text_move(&folded, 0, 2);
+  ASSERT_TRUE(folded_text_compact(&folded, 2), "Compact should succeed");
+  ASSERT_EQUAL_STRING("cheryl ng", folded_text_get(&folded, 0),
+                      "Moved string survives compaction");
+  ASSERT_EQUAL_STRING("bob lim jun jie", folded_text_get(&folded, 1),
+                      "Replaced string survives compaction");
+  ASSERT_EQUAL_INT((int)(strlen("cheryl ng") + strlen("bob lim jun jie") + 2),
+                   (int)folded.text.used, "Only live strings remain");
+  ASSERT_TRUE(folded.text.capacity - folded.text.used >= FOLDED_TEXT_PADDING,
+              "Padding is kept after compaction");
+  folded_text_free(&folded);
+}
+
+// =============================================================================
+// table maintenance tests
+// =============================================================================
+
+void test_table_folded_names_follow_records(void) {
+  StudentDatabase *db = create_test_database_with_records(40);
+  ASSERT_NOT_NULL(db, "Database should be created");
+  if (!db) {
+    return;
+  }
+  StudentTable *table = db->tables[0];
+  ASSERT_TRUE(folded_names_match(table), "Folded names follow adds");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS,
+                   db_update_record(db, 2500103, "MARY ANN LEE", NULL, NULL),
+                   "Longer rename should succeed");
+  ASSERT_EQUAL_INT(DB_SUCCESS, db_update_record(db, 2500104, "Al", NULL, NULL),
+                   "Shorter rename should succeed");
+  ASSERT_TRUE(folded_names_match(table), "Folded names follow updates");
+
+  for (int i = 0; i < 40; i += 3) {
+    table_remove_record(table, 2500100 + i);
+  }
+  ASSERT_TRUE(folded_names_match(table), "Folded names follow deletes");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_purge_tombstones(table),
+                   "Purge should succeed");
+  ASSERT_TRUE(folded_names_match(table), "Folded names follow a purge");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_view(table, TABLE_VIEW_MARK_DESC),
+                   "View should be set");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_compact(table), "Compact should succeed");
+  ASSERT_TRUE(folded_names_match(table), "Folded names follow a sort");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_layout(table, TABLE_LAYOUT_COLUMNS),
+                   "Layout should change");
+  ASSERT_EQUAL_INT(DB_SUCCESS,
+                   db_update_record(db, 2500101, "Zhang Wei Jie Tan", NULL,
+                                    NULL),
+                   "Rename in column layout should succeed");
+  ASSERT_TRUE(folded_names_match(table),
+              "Folded names follow the column layout");
+  db_free(db);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Text Search Tests");
+
+  RUN_TEST(test_needle_find_matches_scan);
+  RUN_TEST(test_needle_edges);
+
+  RUN_TEST(test_folded_text_replace_and_compact);
+
+  RUN_TEST(test_table_folded_names_follow_records);
+
+  TEST_SUITE_END();
+}
@@ -0,0 +1,236 @@
+/*
+ * test_trigram_index.c
+ *
+ * unit tests for the trigram index module
+ * checks candidate lookups against a scan of every name, out-of-order and
+ * repeated postings, removal and renumbering, the reported memory, and
+ * that a table's index follows its records through adds, updates,
+ * deletes, purges and sorts
+ *
+ * functions tested:
+ * - trigram_index_add()      : posting a name's trigrams
+ * - trigram_index_remove()   : withdrawing a name's trigrams
+ * - trigram_index_remap()    : renumbering after a purge
+ * - trigram_index_lookup()   : candidates for a pattern
+ * - trigram_index_memory()   : bytes held
+ * - table_set_name_index()   : building and dropping a table's index
+ */
+
+#include "../include/database.h"
+#include "../include/table_view.h"
+#include "../include/trigram_index.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TRIGRAM_TEST_NAMES 500
+
+// true if text holds every trigram of pattern (what a lookup promises)
+static bool holds_trigrams(const char *text, const char *pattern) {
+  size_t length = strlen(pattern);
+  for (size_t i = 0; i + TRIGRAM_LENGTH <= length; i++) {
+    char trigram[TRIGRAM_LENGTH + 1];
+    memcpy(trigram, pattern + i, TRIGRAM_LENGTH);
+    trigram[TRIGRAM_LENGTH] = '\0';
+    if (!strstr(text, trigram)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// true if the table's index holds exactly the trigrams of its live names
+static bool index_matches_names(const StudentTable *table) {
+  const TrigramIndex *index = table->name_trigrams;
+  if (!index) {
+    return false;
+  }
+  size_t expected = 0;
+  for (size_t p = 0; p < table->slot_count; p++) {
+    if (!table_is_live(table, p)) {
+      continue;
+    }
+    const char *name = folded_text_get(&table->folded_names, p);
+    size_t length = strlen(name);
+    for (size_t i = 0; i + TRIGRAM_LENGTH <= length; i++) {
+      // count each distinct trigram of the name once
+      bool repeat = false;
+      for (size_t j = 0; j < i && !repeat; j++) {
+        repeat = memcmp(name + j, name + i, TRIGRAM_LENGTH) == 0;
+      }
+      expected += !repeat;
+
+      uint32_t *positions;
+      size_t count;
+      bool found = false;
+      trigram_index_lookup(index, name + i, TRIGRAM_LENGTH, &positions,
+                           &count);
+      for (size_t c = 0; c < count; c++) {
+        found = found || positions[c] == p;
+      }
+      free(positions);
+      if (!found) {
+        return false;
+      }
+    }
+  }
+  return index->postings == expected;
+}
+
+// =============================================================================
+// index tests
+// =============================================================================
+
+void test_lookup_matches_scan(void) {
+  static const char alphabet[] = "abc d";
+  char (*names)[24] = malloc(TRIGRAM_TEST_NAMES * sizeof *names);
+  ASSERT_NOT_NULL(names, "Names should allocate");
+  if (!names) {
+    return;
+  }
+  TrigramIndex index;
+  trigram_index_init(&index);
+  srand(3);
+  bool added = true;
+  for (size_t i = 0; i < TRIGRAM_TEST_NAMES; i++) {
+    size_t length = (size_t)rand() % 23;
+    for (size_t j = 0; j < length; j++) {
+      names[i][j] = alphabet[rand() % 5];
+    }
+    names[i][length] = '\0';
+    added = added && trigram_index_add(&index, (uint32_t)i, names[i]);
+  }
+  ASSERT_TRUE(added, "Every name should be added");
+
+  bool match = true;
+  for (int attempt = 0; attempt < 300 && match; attempt++) {
+    char pattern[8];
+    size_t length = TRIGRAM_LENGTH + (size_t)rand() % 4;
+    for (size_t j = 0; j < length; j++) {
+      pattern[j] = alphabet[rand() % 4];
+    }
+    pattern[length] = '\0';
+
+    uint32_t *positions;
+    size_t count;
+    match = trigram_index_lookup(&index, pattern, length, &positions, &count);
+    size_t c = 0;
+    for (size_t i = 0; i < TRIGRAM_TEST_NAMES && match; i++) {
+      if (holds_trigrams(names[i], pattern)) {
+        match = c < count && positions[c] == i;
+        c++;
+      }
+    }
+    match = match && c == count;
+    free(positions);
+  }
+  ASSERT_TRUE(match, "Candidates are exactly the names holding every trigram");
+
+  uint32_t *positions;
+  size_t count;
+  ASSERT_FALSE(trigram_index_lookup(&index, "ab", 2, &positions, &count),
+               "Patterns under three bytes cannot be looked up");
+  ASSERT_TRUE(trigram_index_lookup(&index, "xyz", 3, &positions, &count),
+               "Unknown trigram should be looked up");
+  ASSERT_TRUE(count == 0 && positions == NULL,
+              "An unknown trigram rules out every name");
+
+  trigram_index_free(&index);
+  free(names);
+}
+
+void test_add_remove_and_remap(void) {
+  TrigramIndex index;
+  trigram_index_init(&index);
+  trigram_index_add(&index, 9, "aaaaa");
+  trigram_index_add(&index, 2, "aaab");
+  trigram_index_add(&index, 5, "xaaa");
+  ASSERT_EQUAL_INT(5, (int)index.postings,
+                   "Repeated trigrams are posted once per name");
+
+  uint32_t *positions;
+  size_t count;
+  trigram_index_lookup(&index, "aaa", 3, &positions, &count);
+  ASSERT_EQUAL_INT(3, (int)count, "Three names hold aaa");
+  ASSERT_TRUE(count == 3 && positions[0] == 2 && positions[1] == 5 &&
+                  positions[2] == 9,
+              "Positions added out of order come back ascending");
+  free(positions);
+
+  trigram_index_remove(&index, 5, "xaaa");
+  trigram_index_remove(&index, 5, "xaaa");
+  ASSERT_EQUAL_INT(3, (int)index.postings,
+                   "Removing a name withdraws its trigrams once");
+
+  uint32_t new_position[10] = {0};
+  new_position[2] = 0;
+  new_position[9] = 1;
+  trigram_index_remap(&index, new_position);
+  trigram_index_lookup(&index, "aaa", 3, &positions, &count);
+  ASSERT_TRUE(count == 2 && positions[0] == 0 && positions[1] == 1,
+              "Remap renumbers the positions");
+  free(positions);
+
+  size_t bytes = trigram_index_memory(&index);
+  ASSERT_TRUE(bytes >= index.bucket_count * sizeof(uint32_t) +
+                           index.count * sizeof(TrigramList),
+              "Memory covers the buckets and lists");
+  trigram_index_free(&index);
+  ASSERT_EQUAL_INT(0, (int)trigram_index_memory(&index),
+                   "A freed index holds nothing");
+}
+
+// =============================================================================
+// table maintenance tests
+// =============================================================================
+
+void test_table_name_index_follows_records(void) {
+  StudentDatabase *db = create_test_database_with_records(60);
+  ASSERT_NOT_NULL(db, "Database should be created");
+  if (!db) {
+    return;
+  }
+  StudentTable *table = db->tables[0];
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_name_index(table, true),
+                   "Index should be built");
+  ASSERT_TRUE(index_matches_names(table), "Index covers the loaded names");
+
+  StudentRecord record = {.id = 2500900, .name = "Nur Aisyah",
+                          .prog = "Programme1", .mark = 66.0f};
+  table_add_record(table, &record);
+  db_update_record(db, 2500110, "Siti Aisyah Binte Omar", NULL, NULL);
+  db_update_record(db, 2500111, "Al", NULL, NULL);
+  ASSERT_TRUE(index_matches_names(table), "Index follows adds and renames");
+
+  for (int i = 0; i < 60; i += 4) {
+    table_remove_record(table, 2500100 + i);
+  }
+  ASSERT_TRUE(index_matches_names(table), "Index follows deletes");
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_purge_tombstones(table),
+                   "Purge should succeed");
+  ASSERT_TRUE(index_matches_names(table), "Index follows a purge");
+
+  table_set_view(table, TABLE_VIEW_MARK_ASC);
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_compact(table), "Compact should succeed");
+  ASSERT_TRUE(index_matches_names(table), "Index follows a sort");
+
+  ASSERT_EQUAL_INT(DB_SUCCESS, table_set_name_index(table, false),
+                   "Index should be dropped");
+  ASSERT_NULL(table->name_trigrams, "Dropped index is gone");
+  db_free(db);
+}
+
+// =============================================================================
+// test suite runner
+// =============================================================================
+
+int main(void) {
+  TEST_SUITE_START("Trigram Index Tests");
+
+  RUN_TEST(test_lookup_matches_scan);
+  RUN_TEST(test_add_remove_and_remap);
+
+  RUN_TEST(test_table_name_index_follows_records);
+
+  TEST_SUITE_END();
+}